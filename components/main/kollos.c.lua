@@ -784,6 +784,8 @@ local libmarpa_class_name = {
 };
 
 local c_fn_signatures = {
+  {"marpa_g_clone_base"},
+  {"marpa_g_clone_base_set", "int", "value"},
   {"marpa_g_completion_symbol_activate", "Marpa_Symbol_ID", "sym_id", "int", "activate"},
   {"marpa_g_error_clear"},
   {"marpa_g_event_count"},
@@ -794,6 +796,10 @@ local c_fn_signatures = {
   {"marpa_g_is_precomputed"},
   {"marpa_g_nulled_symbol_activate", "Marpa_Symbol_ID", "sym_id", "int", "activate"},
   {"marpa_g_precompute"},
+  {"marpa_g_precompute_stats_collect"},
+  {"marpa_g_precompute_stats_collect_set", "int", "value"},
+  {"marpa_g_prediction_states"},
+  {"marpa_g_prediction_states_set", "int", "value"},
   {"marpa_g_prediction_symbol_activate", "Marpa_Symbol_ID", "sym_id", "int", "activate"},
   {"marpa_g_rule_is_accessible", "Marpa_Rule_ID", "rule_id"},
   {"marpa_g_rule_is_loop", "Marpa_Rule_ID", "rule_id"},
@@ -831,7 +837,12 @@ local c_fn_signatures = {
   {"marpa_g_zwa_place", "Marpa_Assertion_ID", "zwaid", "Marpa_Rule_ID", "xrl_id", "int", "rhs_ix"},
   {"marpa_r_completion_symbol_activate", "Marpa_Symbol_ID", "sym_id", "int", "reactivate"},
   {"marpa_r_alternative", "Marpa_Symbol_ID", "token", "int", "value", "int", "length"}, -- See note
+  {"marpa_r_alternatives_hashed"},
+  {"marpa_r_alternatives_hashed_set", "int", "value"},
+  {"marpa_r_checkpoint"},
+  {"marpa_r_checkpoint_release", "int", "checkpoint_id"},
   {"marpa_r_current_earleme"},
+  {"marpa_r_discarded_earley_set_count"},
   {"marpa_r_earleme_complete"}, -- See note below
   {"marpa_r_earleme", "Marpa_Earley_Set_ID", "ordinal"},
   {"marpa_r_earley_item_warning_threshold"},
@@ -843,10 +854,20 @@ local c_fn_signatures = {
   {"marpa_r_latest_earley_set"},
   {"marpa_r_latest_earley_set_value_set", "int", "value"},
   {"marpa_r_nulled_symbol_activate", "Marpa_Symbol_ID", "sym_id", "int", "reactivate"},
+  {"marpa_r_postdot_index_size"},
+  {"marpa_r_postdot_index_threshold"},
+  {"marpa_r_postdot_index_threshold_set", "int", "threshold"},
   {"marpa_r_prediction_symbol_activate", "Marpa_Symbol_ID", "sym_id", "int", "reactivate"},
   {"marpa_r_progress_report_finish"},
   {"marpa_r_progress_report_start", "Marpa_Earley_Set_ID", "ordinal"},
+  {"marpa_r_rollback", "int", "checkpoint_id"},
   {"marpa_r_start_input"},
+  {"marpa_r_stats_collect"},
+  {"marpa_r_stats_collect_set", "int", "value"},
+  {"marpa_r_streaming"},
+  {"marpa_r_streaming_set", "int", "value"},
+  {"marpa_r_prediction_states"},
+  {"marpa_r_prediction_states_set", "int", "value"},
   {"marpa_r_terminal_is_expected", "Marpa_Symbol_ID", "xsyid"},
   {"marpa_r_zwa_default", "Marpa_Assertion_ID", "zwaid"},
   {"marpa_r_zwa_default_set", "Marpa_Assertion_ID", "zwaid", "int", "default_value"},
@@ -857,6 +878,7 @@ local c_fn_signatures = {
   {"marpa_o_high_rank_only"},
   {"marpa_o_is_null"},
   {"marpa_o_rank"},
+  {"marpa_o_lazy_rank"},
   {"marpa_t_next"},
   {"marpa_t_parse_count"},
   {"marpa_v_valued_force"},
@@ -1347,6 +1369,203 @@ static int wrap_grammar_error(lua_State *L)
   return 2;
 }
 
+/* The image of a precomputed grammar, as a Lua string */
+static int wrap_grammar_serialize(lua_State *L)
+{
+  /* [ grammar_object ] */
+  const int grammar_stack_ix = 1;
+  Marpa_Grammar *p_g;
+  size_t image_size = 0;
+  luaL_Buffer buffer;
+  char *image;
+  int result;
+
+  lua_getfield (L, grammar_stack_ix, "_libmarpa");
+  /* [ grammar_object, grammar_ud ] */
+  p_g = (Marpa_Grammar *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+  /* [ grammar_object ] */
+  result = marpa_g_serialize (*p_g, NULL, &image_size);
+  if (result < 0)
+    {
+      common_g_error_handler (L, p_g, grammar_stack_ix,
+			      "marpa_g_serialize()");
+      lua_pushinteger (L, (lua_Integer) result);
+      return 1;
+    }
+  image = luaL_buffinitsize (L, &buffer, image_size);
+  result = marpa_g_serialize (*p_g, image, &image_size);
+  if (result < 0)
+    {
+      common_g_error_handler (L, p_g, grammar_stack_ix,
+			      "marpa_g_serialize()");
+      lua_pushinteger (L, (lua_Integer) result);
+      return 1;
+    }
+  luaL_pushresultsize (&buffer, image_size);
+  /* [ grammar_object, image ] */
+  return 1;
+}
+
+/* Create a precomputed grammar from an image,
+   as returned by wrap_grammar_serialize()
+ */
+static int
+wrap_grammar_load (lua_State * L)
+{
+  /* [ grammar_table, image ] */
+  const int grammar_stack_ix = 1;
+  const int image_stack_ix = 2;
+  Marpa_Config marpa_config;
+  Marpa_Grammar *p_g;
+  size_t image_size;
+  const char *image;
+
+  check_libmarpa_table (L, "wrap_grammar_load()", grammar_stack_ix,
+			"grammar");
+  image = luaL_checklstring (L, image_stack_ix, &image_size);
+
+  p_g = (Marpa_Grammar *) lua_newuserdata (L, sizeof (Marpa_Grammar));
+  /* [ grammar_table, image, userdata ] */
+  lua_rawgetp (L, LUA_REGISTRYINDEX, &kollos_g_ud_mt_key);
+  lua_setmetatable (L, -2);
+  lua_pushvalue (L, -1);
+  /* [ grammar_table, image, userdata, userdata ] */
+  lua_setfield (L, grammar_stack_ix, "_libmarpa");
+  lua_setfield (L, grammar_stack_ix, "_libmarpa_g");
+  /* [ grammar_table, image ] */
+
+  marpa_c_init (&marpa_config);
+  *p_g = marpa_g_load (&marpa_config, image, image_size);
+  if (!*p_g)
+    {
+      int throw_flag;
+      Marpa_Error_Code marpa_error = marpa_c_error (&marpa_config, NULL);
+      lua_getfield (L, grammar_stack_ix, "throw");
+      throw_flag = lua_toboolean (L, -1);
+      /* [ grammar_table, image, throw_flag ] */
+      if (throw_flag)
+	{
+	  kollos_throw (L, marpa_error, "marpa_g_load()");
+	}
+      lua_pushnil (L);
+      return 1;
+    }
+  lua_pushvalue (L, grammar_stack_ix);
+  /* [ grammar_table, image, grammar_table ] */
+  return 1;
+}
+
+/* Create a grammar, not precomputed, which is a copy of
+   a base grammar, and which can be extended
+ */
+static int
+wrap_grammar_clone (lua_State * L)
+{
+  /* [ grammar_table, base_grammar_object ] */
+  const int grammar_stack_ix = 1;
+  const int base_stack_ix = 2;
+  Marpa_Grammar *p_g;
+  Marpa_Grammar *p_base_g;
+
+  check_libmarpa_table (L, "wrap_grammar_clone()", grammar_stack_ix,
+			"grammar");
+  check_libmarpa_table (L, "wrap_grammar_clone()", base_stack_ix,
+			"grammar");
+  lua_getfield (L, base_stack_ix, "_libmarpa");
+  /* [ grammar_table, base_grammar_object, base_grammar_ud ] */
+  p_base_g = (Marpa_Grammar *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+
+  p_g = (Marpa_Grammar *) lua_newuserdata (L, sizeof (Marpa_Grammar));
+  /* [ grammar_table, base_grammar_object, userdata ] */
+  lua_rawgetp (L, LUA_REGISTRYINDEX, &kollos_g_ud_mt_key);
+  lua_setmetatable (L, -2);
+  lua_pushvalue (L, -1);
+  /* [ grammar_table, base_grammar_object, userdata, userdata ] */
+  lua_setfield (L, grammar_stack_ix, "_libmarpa");
+  lua_setfield (L, grammar_stack_ix, "_libmarpa_g");
+  /* [ grammar_table, base_grammar_object ] */
+
+  *p_g = marpa_g_clone (*p_base_g);
+  if (!*p_g)
+    {
+      /* The error is in the base grammar */
+      common_g_error_handler (L, p_base_g, base_stack_ix,
+			      "marpa_g_clone()");
+      lua_pushnil (L);
+      return 1;
+    }
+  lua_pushvalue (L, grammar_stack_ix);
+  /* [ grammar_table, base_grammar_object, grammar_table ] */
+  return 1;
+}
+
+/* The precompute statistics, as a sequence with a table
+   for each phase, or nil if they were not collected
+ */
+static int
+wrap_grammar_precompute_report (lua_State * L)
+{
+  /* [ grammar_object ] */
+  const int grammar_stack_ix = 1;
+  Marpa_Grammar *p_g;
+  int phase;
+
+  check_libmarpa_table (L, "wrap_grammar_precompute_report()",
+			grammar_stack_ix, "grammar");
+  lua_getfield (L, grammar_stack_ix, "_libmarpa");
+  /* [ grammar_object, grammar_ud ] */
+  p_g = (Marpa_Grammar *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+  lua_createtable (L, MARPA_PRECOMPUTE_PHASE_COUNT, 0);
+  /* [ grammar_object, report_table ] */
+  for (phase = 0; phase < MARPA_PRECOMPUTE_PHASE_COUNT; phase++)
+    {
+      Marpa_Precompute_Stats stats;
+      const int result = marpa_g_precompute_stats (*p_g, phase, &stats);
+      if (result < 0)
+	{
+	  common_g_error_handler (L, p_g, grammar_stack_ix,
+				  "marpa_g_precompute_stats()");
+	  lua_pushinteger (L, (lua_Integer) result);
+	  return 1;
+	}
+      if (result == 0)
+	{
+	  lua_pushnil (L);
+	  return 1;
+	}
+      lua_createtable (L, 0, 11);
+      /* [ grammar_object, report_table, phase_table ] */
+      lua_pushinteger (L, (lua_Integer) phase);
+      lua_setfield (L, -2, "phase");
+      lua_pushstring (L, stats.t_name);
+      lua_setfield (L, -2, "name");
+      lua_pushnumber (L, (lua_Number) stats.t_seconds);
+      lua_setfield (L, -2, "seconds");
+      lua_pushnumber (L, (lua_Number) stats.t_obstack_size);
+      lua_setfield (L, -2, "obstack_size");
+      lua_pushnumber (L, (lua_Number) stats.t_obstack_growth);
+      lua_setfield (L, -2, "obstack_growth");
+      lua_pushnumber (L, (lua_Number) stats.t_matrix_count);
+      lua_setfield (L, -2, "matrix_count");
+      lua_pushnumber (L, (lua_Number) stats.t_matrix_entry_count);
+      lua_setfield (L, -2, "matrix_entry_count");
+      lua_pushinteger (L, (lua_Integer) stats.t_xsy_count);
+      lua_setfield (L, -2, "xsy_count");
+      lua_pushinteger (L, (lua_Integer) stats.t_nsy_count);
+      lua_setfield (L, -2, "nsy_count");
+      lua_pushinteger (L, (lua_Integer) stats.t_irl_count);
+      lua_setfield (L, -2, "irl_count");
+      lua_pushinteger (L, (lua_Integer) stats.t_ahm_count);
+      lua_setfield (L, -2, "ahm_count");
+      lua_rawseti (L, -2, phase + 1);
+      /* [ grammar_object, report_table ] */
+    }
+  return 1;
+}
+
 /* The C wrapper for Libmarpa event reading.
    It assumes we just want all of them.
  */
@@ -1574,6 +1793,168 @@ static int wrap_progress_item(lua_State *L)
   return 3;
 }
 
+/* Read a batch of tokens.
+ * The token table is flat: 4 integers per token --
+ * symbol, value, length and start earleme.
+ * The optional third argument is the 1-based index
+ * of the first token to read, so that the caller can resume
+ * a batch after an event or a rejection.
+ * Returns the number of tokens consumed.
+ */
+static int wrap_alternatives_read(lua_State *L)
+{
+  /* [ recce_object, token_table, first_token ] */
+  const int recce_stack_ix = 1;
+  const int token_table_stack_ix = 2;
+  const int first_token_stack_ix = 3;
+  Marpa_Recce *p_r;
+  Marpa_Alternative *alternatives;
+  int first_token_ix = 0;
+  int token_count;
+  int result;
+
+  if (1)
+    {
+      check_libmarpa_table (L, "wrap_alternatives_read()", recce_stack_ix,
+                            "recce");
+      luaL_checktype (L, token_table_stack_ix, LUA_TTABLE);
+    }
+  if (!lua_isnoneornil (L, first_token_stack_ix))
+    {
+      first_token_ix = luaL_checkint (L, first_token_stack_ix) - 1;
+    }
+  token_count = (int)lua_rawlen (L, token_table_stack_ix) / 4 - first_token_ix;
+  if (token_count <= 0)
+    {
+      lua_pushinteger (L, 0);
+      return 1;
+    }
+
+  /* The userdata is garbage, once we return */
+  alternatives = (Marpa_Alternative *)
+    lua_newuserdata (L, sizeof (Marpa_Alternative) * (size_t)token_count);
+  /* [ recce_object, token_table, ..., alternatives_ud ] */
+  {
+    int token_ix;
+    for (token_ix = 0; token_ix < token_count; token_ix++)
+      {
+        Marpa_Alternative *const alternative = alternatives + token_ix;
+        const int base_ix = (first_token_ix + token_ix) * 4;
+        lua_rawgeti (L, token_table_stack_ix, base_ix + 1);
+        lua_rawgeti (L, token_table_stack_ix, base_ix + 2);
+        lua_rawgeti (L, token_table_stack_ix, base_ix + 3);
+        lua_rawgeti (L, token_table_stack_ix, base_ix + 4);
+        /* [ ..., alternatives_ud, symbol, value, length, earleme ] */
+        alternative->t_token_id = (Marpa_Symbol_ID) lua_tointeger (L, -4);
+        alternative->t_value = (int) lua_tointeger (L, -3);
+        alternative->t_length = (int) lua_tointeger (L, -2);
+        alternative->t_earleme = (Marpa_Earleme) lua_tointeger (L, -1);
+        lua_pop (L, 4);
+      }
+  }
+
+  lua_getfield (L, recce_stack_ix, "_libmarpa");
+  /* [ ..., alternatives_ud, recce_ud ] */
+  p_r = (Marpa_Recce *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+  result = marpa_r_alternatives_read (*p_r, alternatives, token_count);
+  if (result < 0)
+    {
+      common_r_error_handler (L, recce_stack_ix,
+                              "marpa_r_alternatives_read()");
+    }
+  lua_pushinteger (L, (lua_Integer) result);
+  /* [ ..., alternatives_ud, result ] */
+  return 1;
+}
+
+static int wrap_memory_report(lua_State *L)
+{
+  /* [ recce_object ] */
+  const int recce_stack_ix = 1;
+  Marpa_Recce *p_r;
+  Marpa_Memory_Report report;
+  int result;
+
+  if (1)
+    {
+      check_libmarpa_table (L, "wrap_memory_report()", recce_stack_ix,
+                            "recce");
+    }
+  lua_getfield (L, recce_stack_ix, "_libmarpa");
+  /* [ recce_object, recce_ud ] */
+  p_r = (Marpa_Recce *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+  result = marpa_r_memory_report (*p_r, &report);
+  if (result < 0)
+    {
+      common_r_error_handler (L, recce_stack_ix, "marpa_r_memory_report()");
+      lua_pushinteger (L, (lua_Integer) result);
+      return 1;
+    }
+  lua_createtable (L, 0, 5);
+  /* [ recce_object, report_table ] */
+  lua_pushnumber (L, (lua_Number) report.t_earley_set_count);
+  lua_setfield (L, -2, "earley_set_count");
+  lua_pushnumber (L, (lua_Number) report.t_earley_set_size);
+  lua_setfield (L, -2, "earley_set_size");
+  lua_pushnumber (L, (lua_Number) report.t_earley_item_count);
+  lua_setfield (L, -2, "earley_item_count");
+  lua_pushnumber (L, (lua_Number) report.t_earley_item_size);
+  lua_setfield (L, -2, "earley_item_size");
+  lua_pushnumber (L, (lua_Number) report.t_obstack_size);
+  lua_setfield (L, -2, "obstack_size");
+  return 1;
+}
+
+static int wrap_stats(lua_State *L)
+{
+  /* [ recce_object ] */
+  const int recce_stack_ix = 1;
+  Marpa_Recce *p_r;
+  Marpa_Recce_Stats stats;
+  int result;
+
+  if (1)
+    {
+      check_libmarpa_table (L, "wrap_stats()", recce_stack_ix, "recce");
+    }
+  lua_getfield (L, recce_stack_ix, "_libmarpa");
+  /* [ recce_object, recce_ud ] */
+  p_r = (Marpa_Recce *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+  result = marpa_r_stats (*p_r, &stats);
+  if (result < 0)
+    {
+      common_r_error_handler (L, recce_stack_ix, "marpa_r_stats()");
+      lua_pushinteger (L, (lua_Integer) result);
+      return 1;
+    }
+  lua_createtable (L, 0, 10);
+  /* [ recce_object, stats_table ] */
+  lua_pushnumber (L, (lua_Number) stats.t_earley_set_count);
+  lua_setfield (L, -2, "earley_set_count");
+  lua_pushnumber (L, (lua_Number) stats.t_earley_item_count);
+  lua_setfield (L, -2, "earley_item_count");
+  lua_pushnumber (L, (lua_Number) stats.t_prediction_count);
+  lua_setfield (L, -2, "prediction_count");
+  lua_pushnumber (L, (lua_Number) stats.t_leo_item_count);
+  lua_setfield (L, -2, "leo_item_count");
+  lua_pushnumber (L, (lua_Number) stats.t_postdot_item_count);
+  lua_setfield (L, -2, "postdot_item_count");
+  lua_pushnumber (L, (lua_Number) stats.t_token_link_count);
+  lua_setfield (L, -2, "token_link_count");
+  lua_pushnumber (L, (lua_Number) stats.t_completion_link_count);
+  lua_setfield (L, -2, "completion_link_count");
+  lua_pushnumber (L, (lua_Number) stats.t_leo_link_count);
+  lua_setfield (L, -2, "leo_link_count");
+  lua_pushnumber (L, (lua_Number) stats.t_psl_claim_count);
+  lua_setfield (L, -2, "psl_claim_count");
+  lua_pushnumber (L, (lua_Number) stats.t_prediction_state_count);
+  lua_setfield (L, -2, "prediction_state_count");
+  return 1;
+}
+
 ]=]
 
 -- bocage wrappers which need to be hand-written
@@ -1665,6 +2046,110 @@ wrap_bocage_new (lua_State * L)
   return 1;
 }
 
+/* Push a table of the first |count| elements of |array|,
+   keyed by their index, starting at zero.
+   Elements of -1, which stand for a missing node or symbol,
+   are left nil.
+*/
+static void
+export_array_push (lua_State * L, const int *array, int count)
+{
+  int ix;
+  lua_createtable (L, count, 1);
+  for (ix = 0; ix < count; ix++)
+    {
+      if (array[ix] < 0)
+        continue;
+      lua_pushinteger (L, (lua_Integer) array[ix]);
+      lua_rawseti (L, -2, ix);
+    }
+}
+
+/* The whole bocage, from a single call of marpa_b_export(),
+   as a table of arrays */
+static int
+wrap_bocage_export (lua_State * L)
+{
+  /* [ bocage_table ] */
+  const int bocage_stack_ix = 1;
+  Marpa_Bocage *bocage_ud;
+  Marpa_Bocage_Export *bocage_export;
+  size_t export_size = 0;
+  int result;
+
+  if (1)
+    {
+      check_libmarpa_table (L, "wrap_bocage_export()", bocage_stack_ix,
+                            "bocage");
+    }
+  lua_getfield (L, bocage_stack_ix, "_libmarpa");
+  /* [ bocage_table, bocage_ud ] */
+  bocage_ud = (Marpa_Bocage *) lua_touserdata (L, -1);
+  lua_pop (L, 1);
+  /* [ bocage_table ] */
+  result = marpa_b_export (*bocage_ud, NULL, &export_size);
+  if (result >= 0)
+    {
+      /* The buffer is a userdata, so that it is collected
+         even if an error is thrown */
+      bocage_export = (Marpa_Bocage_Export *) lua_newuserdata (L, export_size);
+      /* [ bocage_table, buffer ] */
+      result = marpa_b_export (*bocage_ud, bocage_export, &export_size);
+    }
+  if (result < 0)
+    {
+      common_b_error_handler (L, bocage_stack_ix, "marpa_b_export()");
+      lua_pushnil (L);
+      return 1;
+    }
+  lua_newtable (L);
+  /* [ bocage_table, buffer, forest_table ] */
+  lua_pushinteger (L, (lua_Integer) bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_count");
+  lua_pushinteger (L, (lua_Integer) bocage_export->t_and_node_count);
+  lua_setfield (L, -2, "and_node_count");
+  if (bocage_export->t_top_or_node >= 0)
+    {
+      lua_pushinteger (L, (lua_Integer) bocage_export->t_top_or_node);
+      lua_setfield (L, -2, "top_or_node");
+    }
+  export_array_push (L, bocage_export->t_or_node_irl,
+                     bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_irl");
+  export_array_push (L, bocage_export->t_or_node_position,
+                     bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_position");
+  export_array_push (L, bocage_export->t_or_node_origin,
+                     bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_origin");
+  export_array_push (L, bocage_export->t_or_node_set,
+                     bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_set");
+  export_array_push (L, bocage_export->t_or_node_first_and,
+                     bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_first_and");
+  export_array_push (L, bocage_export->t_or_node_and_count,
+                     bocage_export->t_or_node_count);
+  lua_setfield (L, -2, "or_node_and_count");
+  export_array_push (L, bocage_export->t_and_node_parent,
+                     bocage_export->t_and_node_count);
+  lua_setfield (L, -2, "and_node_parent");
+  export_array_push (L, bocage_export->t_and_node_predecessor,
+                     bocage_export->t_and_node_count);
+  lua_setfield (L, -2, "and_node_predecessor");
+  export_array_push (L, bocage_export->t_and_node_cause,
+                     bocage_export->t_and_node_count);
+  lua_setfield (L, -2, "and_node_cause");
+  export_array_push (L, bocage_export->t_and_node_symbol,
+                     bocage_export->t_and_node_count);
+  lua_setfield (L, -2, "and_node_symbol");
+  export_array_push (L, bocage_export->t_and_node_middle,
+                     bocage_export->t_and_node_count);
+  lua_setfield (L, -2, "and_node_middle");
+  /* [ bocage_table, buffer, forest_table ] */
+  return 1;
+}
+
 ]=]
 
 -- order wrappers which need to be hand-written
@@ -2020,18 +2505,40 @@ LUALIB_API int luaopen_kollos_c(lua_State *L)
     lua_pushcfunction(L, wrap_grammar_new);
     lua_setfield(L, kollos_table_stack_ix, "grammar_new");
 
+    lua_pushcfunction(L, wrap_grammar_load);
+    lua_setfield(L, kollos_table_stack_ix, "grammar_load");
+    lua_pushcfunction(L, wrap_grammar_clone);
+    lua_setfield(L, kollos_table_stack_ix, "grammar_clone");
+    lua_pushcfunction(L, wrap_grammar_precompute_report);
+    lua_setfield(L, kollos_table_stack_ix, "grammar_precompute_report");
+
     lua_pushcfunction(L, wrap_grammar_rule_new);
     lua_setfield(L, kollos_table_stack_ix, "grammar_rule_new");
 
+    lua_pushcfunction(L, wrap_grammar_serialize);
+    lua_setfield(L, kollos_table_stack_ix, "grammar_serialize");
+
     lua_pushcfunction(L, wrap_recce_new);
     lua_setfield(L, kollos_table_stack_ix, "recce_new");
 
     lua_pushcfunction(L, wrap_progress_item);
     lua_setfield(L, kollos_table_stack_ix, "recce_progress_item");
 
+    lua_pushcfunction(L, wrap_alternatives_read);
+    lua_setfield(L, kollos_table_stack_ix, "recce_alternatives_read");
+
+    lua_pushcfunction(L, wrap_memory_report);
+    lua_setfield(L, kollos_table_stack_ix, "recce_memory_report");
+
+    lua_pushcfunction(L, wrap_stats);
+    lua_setfield(L, kollos_table_stack_ix, "recce_stats");
+
     lua_pushcfunction(L, wrap_bocage_new);
     lua_setfield(L, kollos_table_stack_ix, "bocage_new");
 
+    lua_pushcfunction(L, wrap_bocage_export);
+    lua_setfield(L, kollos_table_stack_ix, "bocage_export");
+
     lua_pushcfunction(L, wrap_order_new);
     lua_setfield(L, kollos_table_stack_ix, "order_new");
 
@@ -36,14 +36,14 @@ local inspect = require "kollos.inspect" -- luacheck: ignore
 
 --[[
 
-This next function uses Warshall's algorithm. This is slower in theory
-but uses bitops, memory and pipelining well. Grune & Jacob claim that
-arc-by-arc method is better but it needs a work list, and that means
-recursion or memory management of a stack, which can easily slow things
-down by a factor of 10 or more.
-
-Of course, this is always the possibility of porting my C code, which is
-Warshall's in optimized pure C, but I suspect the LuaJIT is just as good.
+This next function finds the strongly connected components (SCCs)
+first, with Tarjan's algorithm, and then finds each SCC's closure once,
+as soon as the SCC is complete. It is the same algorithm as
+`transitive_closure()` in Libmarpa, which see.
+Warshall's algorithm, which was used before, is O(n**3)
+no matter how sparse the matrix is, and the relations in grammars
+are almost always sparse.
+The search uses explicit stacks, rather than recursion.
 
 Function summary: Given a transition matrix, which is a table of tables
 such that matrix[a][b] is true if there is a transition from a to b,
@@ -53,24 +53,113 @@ change it into its closure
 
 local matrix = {}
 
+-- Return the first column at or after `column` whose bit
+-- is set in `vector`, or nil if there is none
+local function next_column_set(vector, column, dim)
+    while column <= dim do
+        local word_ix = bit.rshift(column-1, 5)+1
+        local word = vector[word_ix]
+        if word == 0 then
+            column = word_ix*32 + 1
+        else
+            if bit.band(word, bit.lshift(1, bit.band(column-1, 0x1F))) ~= 0 then
+                return column
+            end
+            column = column + 1
+        end
+    end
+    return nil
+end
+
 function matrix.transitive_closure(matrix_arg)
-    -- as an efficiency hack, we store the
-    -- from, to duples as two entries, so
-    -- that we don't have to create a table
-    -- for each duple
     local dim = #matrix_arg
     local max_column_word = bit.rshift(dim-1, 5)+1
-    for from_ix = 1,dim do
-        local from_vector = matrix_arg[from_ix]
-        for to_ix = 1,dim do
-            local from_word = bit.rshift(from_ix-1, 5)+1
-            local from_bit = bit.band(from_ix-1, 0x1F)
-            if bit.band(matrix_arg[to_ix][from_word], bit.lshift(1, from_bit)) ~= 0 then
-                -- 32 bits at a time -- fast!
-                -- in the Luajit, it should pipeline, and be several times faster
-                local to_vector = matrix_arg[to_ix]
-                for word_ix = 1,max_column_word do
-                    to_vector[word_ix] = bit.bor(from_vector[word_ix], to_vector[word_ix])
+    local dfs_index = {}
+    local low_link = {}
+    local scc_of = {}
+    local next_column = {}
+    local dfs_stack = {}
+    local scc_stack = {}
+    local next_dfs_index = 1
+
+    local function visit(vertex)
+        dfs_index[vertex] = next_dfs_index
+        low_link[vertex] = next_dfs_index
+        next_dfs_index = next_dfs_index + 1
+        next_column[vertex] = 1
+        dfs_stack[#dfs_stack+1] = vertex
+        scc_stack[#scc_stack+1] = vertex
+    end
+
+    -- The closure of an SCC is the union of its successors
+    -- and of their closures, all of which are complete.
+    -- A successor already in the union can be skipped, because
+    -- its closure is already in the union.
+    local function scc_close(root)
+        local scc_base = #scc_stack
+        while scc_stack[scc_base] ~= root do scc_base = scc_base - 1 end
+        for member_ix = scc_base,#scc_stack do
+            scc_of[scc_stack[member_ix]] = root
+        end
+        local closure = {}
+        for word_ix = 1,max_column_word do closure[word_ix] = 0 end
+        local is_cyclic = false
+        for member_ix = scc_base,#scc_stack do
+            local member_vector = matrix_arg[scc_stack[member_ix]]
+            local successor = next_column_set(member_vector, 1, dim)
+            while successor do
+                local word_ix = bit.rshift(successor-1, 5)+1
+                local bit_mask = bit.lshift(1, bit.band(successor-1, 0x1F))
+                if scc_of[successor] == root then
+                    is_cyclic = true
+                elseif bit.band(closure[word_ix], bit_mask) == 0 then
+                    local successor_vector = matrix_arg[successor]
+                    closure[word_ix] = bit.bor(closure[word_ix], bit_mask)
+                    for column_word = 1,max_column_word do
+                        closure[column_word] = bit.bor(closure[column_word], successor_vector[column_word])
+                    end
+                end
+                successor = next_column_set(member_vector, successor+1, dim)
+            end
+        end
+        if is_cyclic then
+            for member_ix = scc_base,#scc_stack do
+                local member = scc_stack[member_ix]
+                local word_ix = bit.rshift(member-1, 5)+1
+                closure[word_ix] = bit.bor(closure[word_ix], bit.lshift(1, bit.band(member-1, 0x1F)))
+            end
+        end
+        for member_ix = #scc_stack,scc_base,-1 do
+            local member_vector = matrix_arg[scc_stack[member_ix]]
+            for word_ix = 1,max_column_word do
+                member_vector[word_ix] = closure[word_ix]
+            end
+            scc_stack[member_ix] = nil
+        end
+    end
+
+    for root = 1,dim do
+        if not dfs_index[root] then
+            visit(root)
+            while #dfs_stack > 0 do
+                local vertex = dfs_stack[#dfs_stack]
+                local successor = next_column_set(matrix_arg[vertex], next_column[vertex], dim)
+                if successor then
+                    next_column[vertex] = successor + 1
+                    if not dfs_index[successor] then
+                        visit(successor)
+                    elseif not scc_of[successor] then
+                        low_link[vertex] = math.min(low_link[vertex], dfs_index[successor])
+                    end
+                else
+                    dfs_stack[#dfs_stack] = nil
+                    local parent = dfs_stack[#dfs_stack]
+                    if parent then
+                        low_link[parent] = math.min(low_link[parent], low_link[vertex])
+                    end
+                    if low_link[vertex] == dfs_index[vertex] then
+                        scc_close(vertex)
+                    end
                 end
             end
         end
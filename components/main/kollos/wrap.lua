@@ -33,6 +33,8 @@ local luif_err_unexpected_token = kollos_c.error_code_by_name['LUIF_ERR_UNEXPECT
 
 local grammar_class  = {
   ["rule_new"] = kollos_c.grammar_rule_new,
+  ["clone_base"] = kollos_c.grammar_clone_base,
+  ["clone_base_set"] = kollos_c.grammar_clone_base_set,
   ["completion_symbol_activate"] = kollos_c.grammar_completion_symbol_activate,
   ["error"] = kollos_c.grammar_error,
   ["error_clear"] = kollos_c.grammar_error_clear,
@@ -46,6 +48,11 @@ local grammar_class  = {
   ["is_precomputed"] = kollos_c.grammar_is_precomputed,
   ["nulled_symbol_activate"] = kollos_c.grammar_nulled_symbol_activate,
   ["precompute"] = kollos_c.grammar_precompute,
+  ["precompute_report"] = kollos_c.grammar_precompute_report,
+  ["precompute_stats_collect"] = kollos_c.grammar_precompute_stats_collect,
+  ["precompute_stats_collect_set"] = kollos_c.grammar_precompute_stats_collect_set,
+  ["prediction_states"] = kollos_c.grammar_prediction_states,
+  ["prediction_states_set"] = kollos_c.grammar_prediction_states_set,
   ["prediction_symbol_activate"] = kollos_c.grammar_prediction_symbol_activate,
   ["rule_is_accessible"] = kollos_c.grammar_rule_is_accessible,
   ["rule_is_loop"] = kollos_c.grammar_rule_is_loop,
@@ -58,6 +65,7 @@ local grammar_class  = {
   ["rule_null_high"] = kollos_c.grammar_rule_null_high,
   ["rule_null_high_set"] = kollos_c.grammar_rule_null_high_set,
   ["rule_rhs"] = kollos_c.grammar_rule_rhs,
+  ["serialize"] = kollos_c.grammar_serialize,
   ["sequence_min"] = kollos_c.grammar_sequence_min,
   ["sequence_separator"] = kollos_c.grammar_sequence_separator,
   ["start_symbol"] = kollos_c.grammar_start_symbol,
@@ -93,9 +101,59 @@ function wrap.grammar()
   return grammar_object
 end
 
+-- Create a precomputed grammar from an image,
+-- as returned by grammar:serialize()
+function wrap.grammar_load(image)
+  local grammar_object = kollos_c.grammar_load(
+      { _type = "grammar", throw = true }, image
+  )
+  setmetatable(grammar_object, {
+      __index = grammar_class,
+  })
+  return grammar_object
+end
+
+-- Create a grammar which is a copy of `base`, as it was built,
+-- with the same symbol and rule IDs.
+-- The copy is not precomputed, so that more symbols and rules
+-- can be added to it.
+function wrap.grammar_clone(base)
+  local grammar_object = kollos_c.grammar_clone(
+      { _type = "grammar", throw = true }, base
+  )
+  setmetatable(grammar_object, {
+      __index = grammar_class,
+  })
+  return grammar_object
+end
+
+-- Grammar images, by key.
+-- The key is chosen by the caller, and is usually a hash of
+-- whatever the grammar was built from.
+local grammar_images = {}
+
+-- Return a precomputed grammar for `key`.
+-- The first time, the grammar is created by calling `build`,
+-- which must return a precomputed grammar,
+-- and its image is kept.
+-- Afterwards, the grammar is loaded from the image.
+function wrap.grammar_cached(key, build)
+  local image = grammar_images[key]
+  if image then return wrap.grammar_load(image) end
+  local grammar_object = build()
+  grammar_images[key] = grammar_object:serialize()
+  return grammar_object
+end
+
 local recce_class  = {
+  ["alternatives_hashed"] = kollos_c.recce_alternatives_hashed,
+  ["alternatives_hashed_set"] = kollos_c.recce_alternatives_hashed_set,
+  ["alternatives_read"] = kollos_c.recce_alternatives_read,
+  ["checkpoint"] = kollos_c.recce_checkpoint,
+  ["checkpoint_release"] = kollos_c.recce_checkpoint_release,
   ["completion_symbol_activate"] = kollos_c.recce_completion_symbol_activate,
   ["current_earleme"] = kollos_c.recce_current_earleme,
+  ["discarded_earley_set_count"] = kollos_c.recce_discarded_earley_set_count,
   ["earleme_complete"] = kollos_c.recce_earleme_complete,
   ["earleme"] = kollos_c.recce_earleme,
   ["earley_item_warning_threshold"] = kollos_c.recce_earley_item_warning_threshold,
@@ -106,12 +164,24 @@ local recce_class  = {
   ["is_exhausted"] = kollos_c.recce_is_exhausted,
   ["latest_earley_set"] = kollos_c.recce_latest_earley_set,
   ["latest_earley_set_value_set"] = kollos_c.recce_latest_earley_set_value_set,
+  ["memory_report"] = kollos_c.recce_memory_report,
   ["nulled_symbol_activate"] = kollos_c.recce_nulled_symbol_activate,
+  ["postdot_index_size"] = kollos_c.recce_postdot_index_size,
+  ["postdot_index_threshold"] = kollos_c.recce_postdot_index_threshold,
+  ["postdot_index_threshold_set"] = kollos_c.recce_postdot_index_threshold_set,
   ["prediction_symbol_activate"] = kollos_c.recce_prediction_symbol_activate,
   ["progress_item"] = kollos_c.recce_progress_item,
   ["progress_report_finish"] = kollos_c.recce_progress_report_finish,
   ["progress_report_start"] = kollos_c.recce_progress_report_start,
+  ["rollback"] = kollos_c.recce_rollback,
   ["start_input"] = kollos_c.recce_start_input,
+  ["stats"] = kollos_c.recce_stats,
+  ["stats_collect"] = kollos_c.recce_stats_collect,
+  ["stats_collect_set"] = kollos_c.recce_stats_collect_set,
+  ["streaming"] = kollos_c.recce_streaming,
+  ["streaming_set"] = kollos_c.recce_streaming_set,
+  ["prediction_states"] = kollos_c.recce_prediction_states,
+  ["prediction_states_set"] = kollos_c.recce_prediction_states_set,
   ["terminal_is_expected"] = kollos_c.recce_terminal_is_expected,
   ["zwa_default"] = kollos_c.recce_zwa_default,
   ["zwa_default_set"] = kollos_c.recce_zwa_default_set,
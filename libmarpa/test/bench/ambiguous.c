@@ -0,0 +1,132 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A micro-benchmark for bocage construction on ambiguous input.
+ * The grammar is of expressions with prefix operators,
+ * whose operand is a name with many readings:
+ *   expr ::= op expr | primary_i,  primary_i ::= name,
+ * for each of reading_count readings.
+ * The prefix operators are right-recursive, so the parse uses Leo items,
+ * and the or-node at the bottom of the Leo path gets a draft and-node
+ * for every reading.
+ * Bocage construction time should grow linearly with the readings.
+ * Usage: ambiguous [op_count [repeat_count]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+Marpa_Symbol_ID S_expr;
+Marpa_Symbol_ID S_op;
+Marpa_Symbol_ID S_name;
+
+static Marpa_Grammar
+grammar_new (int reading_count)
+{
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[2];
+  int reading_ix;
+
+  S_expr = bench_symbol_new (g);
+  S_op = bench_symbol_new (g);
+  S_name = bench_symbol_new (g);
+
+  rhs[0] = S_op;
+  rhs[1] = S_expr;
+  bench_rule_new (g, S_expr, rhs, 2);
+  for (reading_ix = 0; reading_ix < reading_count; reading_ix++)
+    {
+      Marpa_Symbol_ID S_primary = bench_symbol_new (g);
+      bench_rule_new (g, S_expr, &S_primary, 1);
+      bench_rule_new (g, S_primary, &S_name, 1);
+    }
+  bench_precompute (g, S_expr);
+  return g;
+}
+
+/* Returns the number of parse trees */
+static int
+tree_count (Marpa_Grammar g, Marpa_Bocage b)
+{
+  int count = 0;
+  Marpa_Order o = marpa_o_new (b);
+  Marpa_Tree t;
+  if (!o)
+    bench_fail ("marpa_o_new", g);
+  t = marpa_t_new (o);
+  if (!t)
+    bench_fail ("marpa_t_new", g);
+  while (marpa_t_next (t) >= 0)
+    count++;
+  marpa_t_unref (t);
+  marpa_o_unref (o);
+  return count;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int op_count = argc > 1 ? atoi (argv[1]) : 20;
+  const int repeat_count = argc > 2 ? atoi (argv[2]) : 20;
+  int reading_count;
+
+  for (reading_count = 250; reading_count <= 4000; reading_count *= 2)
+    {
+      Marpa_Grammar g = grammar_new (reading_count);
+      Marpa_Recognizer r = marpa_r_new (g);
+      Marpa_Bocage b = NULL;
+      double start;
+      double seconds;
+      int op_ix;
+      int repeat_ix;
+
+      if (!r)
+        bench_fail ("marpa_r_new", g);
+      if (!marpa_r_start_input (r))
+        bench_fail ("marpa_r_start_input", g);
+      for (op_ix = 0; op_ix <= op_count; op_ix++)
+        bench_read (g, r, op_ix < op_count ? S_op : S_name);
+
+      start = bench_seconds ();
+      for (repeat_ix = 0; repeat_ix < repeat_count; repeat_ix++)
+        {
+          if (b)
+            marpa_b_unref (b);
+          b = marpa_b_new (r, -1);
+          if (!b)
+            bench_fail ("marpa_b_new", g);
+        }
+      seconds = bench_seconds () - start;
+      if (tree_count (g, b) != reading_count)
+        {
+          printf ("%d readings: wrong number of parses\n", reading_count);
+          exit (1);
+        }
+      printf ("%d readings: %.3f ms per bocage\n", reading_count,
+              seconds * 1000 / repeat_count);
+      marpa_b_unref (b);
+      marpa_r_unref (r);
+      marpa_g_unref (g);
+    }
+  return 0;
+}
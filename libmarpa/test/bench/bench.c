@@ -0,0 +1,102 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Libmarpa benchmark helpers -- bench */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "bench.h"
+
+int
+bench_fail (const char *s, Marpa_Grammar g)
+{
+  const char *error_string;
+  Marpa_Error_Code errcode = marpa_g_error (g, &error_string);
+  printf ("%s returned %d: %s\n", s, errcode, error_string);
+  exit (1);
+}
+
+Marpa_Grammar
+bench_grammar_new (Marpa_Config * config)
+{
+  Marpa_Config default_configuration;
+  Marpa_Grammar g;
+  if (!config)
+    {
+      marpa_c_init (&default_configuration);
+      config = &default_configuration;
+    }
+  g = marpa_g_new (config);
+  if (!g)
+    {
+      const char *error_string;
+      Marpa_Error_Code errcode = marpa_c_error (config, &error_string);
+      printf ("marpa_g_new returned %d: %s\n", errcode, error_string);
+      exit (1);
+    }
+  return g;
+}
+
+Marpa_Symbol_ID
+bench_symbol_new (Marpa_Grammar g)
+{
+  const Marpa_Symbol_ID symbol_id = marpa_g_symbol_new (g);
+  if (symbol_id < 0)
+    bench_fail ("marpa_g_symbol_new", g);
+  return symbol_id;
+}
+
+Marpa_Rule_ID
+bench_rule_new (Marpa_Grammar g, Marpa_Symbol_ID lhs, Marpa_Symbol_ID * rhs,
+                int length)
+{
+  const Marpa_Rule_ID rule_id = marpa_g_rule_new (g, lhs, rhs, length);
+  if (rule_id < 0)
+    bench_fail ("marpa_g_rule_new", g);
+  return rule_id;
+}
+
+void
+bench_precompute (Marpa_Grammar g, Marpa_Symbol_ID start)
+{
+  (marpa_g_start_symbol_set (g, start) >= 0)
+    || bench_fail ("marpa_g_start_symbol_set", g);
+  (marpa_g_precompute (g) >= 0) || bench_fail ("marpa_g_precompute", g);
+}
+
+int
+bench_read (Marpa_Grammar g, Marpa_Recognizer r, Marpa_Symbol_ID token)
+{
+  int result;
+  if (marpa_r_alternative (r, token, 1, 1) != MARPA_ERR_NONE)
+    bench_fail ("marpa_r_alternative", g);
+  result = marpa_r_earleme_complete (r);
+  if (result < 0)
+    bench_fail ("marpa_r_earleme_complete", g);
+  return result;
+}
+
+double
+bench_seconds (void)
+{
+  return (double) clock () / CLOCKS_PER_SEC;
+}
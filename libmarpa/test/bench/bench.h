@@ -0,0 +1,65 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Libmarpa benchmark helpers -- bench */
+
+#ifndef MARPA_BENCH_H
+#define MARPA_BENCH_H 1
+
+#include "marpa.h"
+
+/* Prints the error of |g|, as returned to |s|, and exits */
+int bench_fail (const char *s, Marpa_Grammar g);
+
+/* Returns a new grammar, or exits.
+ * If |config| is NULL, a default configuration is used.
+ */
+Marpa_Grammar bench_grammar_new (Marpa_Config * config);
+
+Marpa_Symbol_ID bench_symbol_new (Marpa_Grammar g);
+Marpa_Rule_ID bench_rule_new (Marpa_Grammar g, Marpa_Symbol_ID lhs,
+                              Marpa_Symbol_ID * rhs, int length);
+
+/* Sets the start symbol and precomputes |g| */
+void bench_precompute (Marpa_Grammar g, Marpa_Symbol_ID start);
+
+/* Reads one token of length 1 and completes its earleme.
+ * Returns the result of marpa_r_earleme_complete().
+ */
+int bench_read (Marpa_Grammar g, Marpa_Recognizer r, Marpa_Symbol_ID token);
+
+/* Processor time, in seconds, for measuring intervals */
+double bench_seconds (void);
+
+/* In bench_threads.c, for benchmarks linked with the thread library */
+
+/* A fork-join function which starts a thread for each piece of work
+ * but the first, which it does itself.
+ */
+void bench_fork_join (Marpa_Work work, void **work_args, int work_count,
+                      void *fork_join_data);
+
+/* Elapsed time, in seconds, for measuring intervals.
+ * Processor time would add up the threads.
+ */
+double bench_elapsed_seconds (void);
+
+#endif /* MARPA_BENCH_H */
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Libmarpa benchmark helpers for threads -- bench */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "bench.h"
+
+struct work
+{
+  Marpa_Work work;
+  void *work_arg;
+};
+
+static void *
+work_run (void *arg)
+{
+  struct work *work = arg;
+  work->work (work->work_arg);
+  return NULL;
+}
+
+void
+bench_fork_join (Marpa_Work work, void **work_args, int work_count,
+                 void *fork_join_data)
+{
+  pthread_t *threads = malloc (sizeof (pthread_t) * (size_t) work_count);
+  struct work *works = malloc (sizeof (struct work) * (size_t) work_count);
+  int work_ix;
+  (void) fork_join_data;
+  for (work_ix = 0; work_ix < work_count; work_ix++)
+    {
+      works[work_ix].work = work;
+      works[work_ix].work_arg = work_args[work_ix];
+    }
+  for (work_ix = 1; work_ix < work_count; work_ix++)
+    {
+      if (pthread_create (threads + work_ix, NULL, work_run, works + work_ix))
+        {
+          printf ("pthread_create failed\n");
+          exit (1);
+        }
+    }
+  work_run (works);
+  for (work_ix = 1; work_ix < work_count; work_ix++)
+    pthread_join (threads[work_ix], NULL);
+  free (works);
+  free (threads);
+}
+
+double
+bench_elapsed_seconds (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
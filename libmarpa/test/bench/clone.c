@@ -0,0 +1,149 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/* A benchmark for the precomputation of clones.
+ * It builds the grammar of the precompute benchmark,
+ * as the base of clones, and precomputes it.
+ * Then, several times, it extends a clone of the base with
+ * a few rules, and precomputes the clone,
+ * and it builds the same extended grammar from scratch,
+ * and precomputes that.
+ * Each extension gives a different leaf a new alternative,
+ * so that the rows of its ancestors must be found again.
+ * The two grammars must have the same internal rules and AHM's.
+ * Usage: clone [symbol_count [extension_count]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+static int symbol_count;
+static Marpa_Symbol_ID S_a;
+static Marpa_Symbol_ID S_b;
+static Marpa_Symbol_ID first_symbol;
+
+static Marpa_Grammar
+base_new (void)
+{
+  int symbol_ix;
+  Marpa_Symbol_ID rhs[2];
+  Marpa_Grammar g = bench_grammar_new (NULL);
+
+  S_a = bench_symbol_new (g);
+  S_b = bench_symbol_new (g);
+  first_symbol = bench_symbol_new (g);
+  for (symbol_ix = 1; symbol_ix < symbol_count; symbol_ix++)
+    bench_symbol_new (g);
+
+  for (symbol_ix = 0; symbol_ix < symbol_count; symbol_ix++)
+    {
+      const Marpa_Symbol_ID lhs = first_symbol + symbol_ix;
+      const int left_child = 2 * symbol_ix + 1;
+      const int right_child = 2 * symbol_ix + 2;
+      if (right_child < symbol_count)
+        {
+          rhs[0] = first_symbol + left_child;
+          rhs[1] = first_symbol + right_child;
+          bench_rule_new (g, lhs, rhs, 2);
+        }
+      else
+        {
+          bench_rule_new (g, lhs, &S_a, 1);
+        }
+      if (symbol_ix >= 3 && symbol_ix % 16 == 0)
+        {
+          rhs[0] = S_b;
+          rhs[1] = first_symbol + ((symbol_ix - 1) / 2 - 1) / 2;
+          bench_rule_new (g, lhs, rhs, 2);
+        }
+    }
+  (marpa_g_start_symbol_set (g, first_symbol) >= 0)
+    || bench_fail ("marpa_g_start_symbol_set", g);
+  return g;
+}
+
+/* leaf ::= extension; extension ::= b a */
+static void
+extend (Marpa_Grammar g, int extension_ix)
+{
+  Marpa_Symbol_ID rhs[2];
+  Marpa_Symbol_ID extension = bench_symbol_new (g);
+  const Marpa_Symbol_ID leaf =
+    first_symbol + symbol_count / 2 + extension_ix * 7 % (symbol_count / 2 - 1);
+  rhs[0] = S_b;
+  rhs[1] = S_a;
+  bench_rule_new (g, extension, rhs, 2);
+  bench_rule_new (g, leaf, &extension, 1);
+}
+
+static double
+precompute (Marpa_Grammar g)
+{
+  const double start = bench_seconds ();
+  (marpa_g_precompute (g) >= 0) || bench_fail ("marpa_g_precompute", g);
+  return bench_seconds () - start;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int extension_count = argc > 2 ? atoi (argv[2]) : 10;
+  int extension_ix;
+  double base_seconds;
+  double clone_seconds = 0.0;
+  double scratch_seconds = 0.0;
+  Marpa_Grammar base;
+
+  symbol_count = argc > 1 ? atoi (argv[1]) : 50000;
+  base = base_new ();
+  marpa_g_clone_base_set (base, 1);
+  base_seconds = precompute (base);
+
+  for (extension_ix = 0; extension_ix < extension_count; extension_ix++)
+    {
+      Marpa_Grammar clone = marpa_g_clone (base);
+      Marpa_Grammar scratch = base_new ();
+      if (!clone)
+        bench_fail ("marpa_g_clone", base);
+      extend (clone, extension_ix);
+      extend (scratch, extension_ix);
+      clone_seconds += precompute (clone);
+      scratch_seconds += precompute (scratch);
+      if (_marpa_g_irl_count (clone) != _marpa_g_irl_count (scratch)
+          || _marpa_g_ahm_count (clone) != _marpa_g_ahm_count (scratch))
+        {
+          printf ("Clone and scratch grammars differ\n");
+          exit (1);
+        }
+      marpa_g_unref (clone);
+      marpa_g_unref (scratch);
+    }
+
+  printf ("%d symbols: base precomputed in %.3f s\n", symbol_count + 2,
+          base_seconds);
+  printf ("%d extensions: %.3f s as clones, %.3f s from scratch\n",
+          extension_count, clone_seconds, scratch_seconds);
+  marpa_g_unref (base);
+  return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A benchmark for grammars with many events.
+ * Every symbol of the grammar has completion,
+ * prediction and nulled events.
+ * The grammar is a cycle of right recursions,
+ * X[i] ::= a[i] X[i+1] | a[i] n[i],
+ * where n[i] is nulling,
+ * and X[i+1] wraps around to X[0].
+ * Every Leo item in it has events, so that the recognizer
+ * interns many lists of event AHM's,
+ * and the precomputation interns many lists of its own.
+ * Usage: events [symbol_count [document_count [document_length]]]
+ * Time it externally.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+int
+main (int argc, char *argv[])
+{
+  const int symbol_count = argc > 1 ? atoi (argv[1]) : 1000;
+  const int document_count = argc > 2 ? atoi (argv[2]) : 100;
+  const int document_length = argc > 3 ? atoi (argv[3]) : 1000;
+  int symbol_ix;
+  int document_ix;
+  long event_count = 0;
+  size_t earley_item_count = 0;
+
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID *X;
+  Marpa_Symbol_ID *a;
+  Marpa_Symbol_ID *n;
+  Marpa_Symbol_ID rhs[2];
+
+  (marpa_g_force_valued (g) >= 0) || bench_fail ("marpa_g_force_valued", g);
+
+  X = malloc (sizeof (Marpa_Symbol_ID) * (size_t) symbol_count);
+  a = malloc (sizeof (Marpa_Symbol_ID) * (size_t) symbol_count);
+  n = malloc (sizeof (Marpa_Symbol_ID) * (size_t) symbol_count);
+  for (symbol_ix = 0; symbol_ix < symbol_count; symbol_ix++)
+    {
+      X[symbol_ix] = bench_symbol_new (g);
+      a[symbol_ix] = bench_symbol_new (g);
+      n[symbol_ix] = bench_symbol_new (g);
+    }
+  for (symbol_ix = 0; symbol_ix < symbol_count; symbol_ix++)
+    {
+      const Marpa_Symbol_ID next = X[(symbol_ix + 1) % symbol_count];
+      rhs[0] = a[symbol_ix];
+      rhs[1] = next;
+      bench_rule_new (g, X[symbol_ix], rhs, 2);
+      rhs[1] = n[symbol_ix];
+      bench_rule_new (g, X[symbol_ix], rhs, 2);
+      bench_rule_new (g, n[symbol_ix], rhs, 0);
+      (marpa_g_symbol_is_completion_event_set (g, X[symbol_ix], 1) >= 0)
+        || bench_fail ("marpa_g_symbol_is_completion_event_set", g);
+      (marpa_g_symbol_is_prediction_event_set (g, X[symbol_ix], 1) >= 0)
+        || bench_fail ("marpa_g_symbol_is_prediction_event_set", g);
+      (marpa_g_symbol_is_nulled_event_set (g, n[symbol_ix], 1) >= 0)
+        || bench_fail ("marpa_g_symbol_is_nulled_event_set", g);
+    }
+  bench_precompute (g, X[0]);
+
+  for (document_ix = 0; document_ix < document_count; document_ix++)
+    {
+      int token_ix;
+      Marpa_Recce_Stats stats;
+      Marpa_Recognizer r = marpa_r_new (g);
+      if (!r)
+        bench_fail ("marpa_r_new", g);
+      marpa_r_stats_collect_set (r, 1);
+      if (!marpa_r_start_input (r))
+        bench_fail ("marpa_r_start_input", g);
+      for (token_ix = 0; token_ix < document_length; token_ix++)
+        event_count += bench_read (g, r, a[token_ix % symbol_count]);
+      marpa_r_stats (r, &stats);
+      earley_item_count += stats.t_earley_item_count;
+      marpa_r_unref (r);
+    }
+
+  printf ("%d symbols, %d documents of %d tokens: %lu Earley items,"
+          " %ld events\n",
+          symbol_count, document_count, document_length,
+          (unsigned long) earley_item_count, event_count);
+  marpa_g_unref (g);
+  free (X);
+  free (a);
+  free (n);
+  return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A micro-benchmark for Leo item creation.
+ * It parses many short documents with one right-recursive
+ * list grammar, as a service parsing many small inputs would.
+ * Usage: leo [document_count [document_length]]
+ * Time it externally.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+Marpa_Symbol_ID S_list;
+Marpa_Symbol_ID S_item;
+Marpa_Symbol_ID S_a;
+
+int
+main (int argc, char *argv[])
+{
+  const int document_count = argc > 1 ? atoi (argv[1]) : 100000;
+  const int document_length = argc > 2 ? atoi (argv[2]) : 20;
+  int document_ix;
+  size_t leo_item_count = 0;
+  size_t earley_item_count = 0;
+
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[2];
+
+  S_list = bench_symbol_new (g);
+  S_item = bench_symbol_new (g);
+  S_a = bench_symbol_new (g);
+
+  /* list ::= item list | item; item ::= a */
+  rhs[0] = S_item;
+  rhs[1] = S_list;
+  bench_rule_new (g, S_list, rhs, 2);
+  bench_rule_new (g, S_list, rhs, 1);
+  bench_rule_new (g, S_item, &S_a, 1);
+  bench_precompute (g, S_list);
+
+  for (document_ix = 0; document_ix < document_count; document_ix++)
+    {
+      int token_ix;
+      Marpa_Recce_Stats stats;
+      Marpa_Recognizer r = marpa_r_new (g);
+      if (!r)
+        bench_fail ("marpa_r_new", g);
+      marpa_r_stats_collect_set (r, 1);
+      if (!marpa_r_start_input (r))
+        bench_fail ("marpa_r_start_input", g);
+      for (token_ix = 0; token_ix < document_length; token_ix++)
+        bench_read (g, r, S_a);
+      marpa_r_stats (r, &stats);
+      leo_item_count += stats.t_leo_item_count;
+      earley_item_count += stats.t_earley_item_count;
+      marpa_r_unref (r);
+    }
+
+  printf ("%d documents of %d tokens: %lu Earley items, %lu Leo items\n",
+          document_count, document_length,
+          (unsigned long) earley_item_count, (unsigned long) leo_item_count);
+  marpa_g_unref (g);
+  return 0;
+}
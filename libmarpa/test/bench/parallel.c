@@ -0,0 +1,268 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A benchmark for bocages built by several workers.
+ * It recognizes one long input,
+ * a list of statements of arithmetic expressions,
+ * then builds its bocage with 1, 2, 4, ... workers,
+ * up to max_worker_count,
+ * each worker in its own thread.
+ * Every bocage must be the same as the one built by marpa_b_new().
+ * Usage: parallel [statement_count [max_worker_count [repeat_count]]]
+ * Build it with -pthread.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+Marpa_Symbol_ID S_top;
+Marpa_Symbol_ID S_statement;
+Marpa_Symbol_ID S_expr;
+Marpa_Symbol_ID S_term;
+Marpa_Symbol_ID S_factor;
+Marpa_Symbol_ID S_number;
+Marpa_Symbol_ID S_plus;
+Marpa_Symbol_ID S_times;
+Marpa_Symbol_ID S_lparen;
+Marpa_Symbol_ID S_rparen;
+Marpa_Symbol_ID S_semicolon;
+
+/*
+ * top ::= statement+
+ * statement ::= expr ';'
+ * expr ::= term | expr '+' term
+ * term ::= factor | term '*' factor
+ * factor ::= number | '(' expr ')'
+ */
+static Marpa_Grammar
+grammar_new (void)
+{
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[3];
+
+  S_top = bench_symbol_new (g);
+  S_statement = bench_symbol_new (g);
+  S_expr = bench_symbol_new (g);
+  S_term = bench_symbol_new (g);
+  S_factor = bench_symbol_new (g);
+  S_number = bench_symbol_new (g);
+  S_plus = bench_symbol_new (g);
+  S_times = bench_symbol_new (g);
+  S_lparen = bench_symbol_new (g);
+  S_rparen = bench_symbol_new (g);
+  S_semicolon = bench_symbol_new (g);
+
+  if (marpa_g_sequence_new (g, S_top, S_statement, -1, 1, 0) < 0)
+    bench_fail ("marpa_g_sequence_new", g);
+  rhs[0] = S_expr;
+  rhs[1] = S_semicolon;
+  bench_rule_new (g, S_statement, rhs, 2);
+  rhs[0] = S_term;
+  bench_rule_new (g, S_expr, rhs, 1);
+  rhs[0] = S_expr;
+  rhs[1] = S_plus;
+  rhs[2] = S_term;
+  bench_rule_new (g, S_expr, rhs, 3);
+  rhs[0] = S_factor;
+  bench_rule_new (g, S_term, rhs, 1);
+  rhs[0] = S_term;
+  rhs[1] = S_times;
+  rhs[2] = S_factor;
+  bench_rule_new (g, S_term, rhs, 3);
+  rhs[0] = S_number;
+  bench_rule_new (g, S_factor, rhs, 1);
+  rhs[0] = S_lparen;
+  rhs[1] = S_expr;
+  rhs[2] = S_rparen;
+  bench_rule_new (g, S_factor, rhs, 3);
+
+  bench_precompute (g, S_top);
+  return g;
+}
+
+/* A small linear congruential generator,
+   so that the input is the same on every platform. */
+static unsigned long random_state = 1;
+static int
+random_below (int n)
+{
+  random_state = (random_state * 1103515245ul + 12345ul) & 0x7ffffffful;
+  return (int) ((random_state >> 16) % (unsigned long) n);
+}
+
+static void read_expr (Marpa_Grammar g, Marpa_Recognizer r, int depth);
+
+static void
+read_factor (Marpa_Grammar g, Marpa_Recognizer r, int depth)
+{
+  if (depth < 4 && random_below (4) == 0)
+    {
+      bench_read (g, r, S_lparen);
+      read_expr (g, r, depth + 1);
+      bench_read (g, r, S_rparen);
+      return;
+    }
+  bench_read (g, r, S_number);
+}
+
+static void
+read_expr (Marpa_Grammar g, Marpa_Recognizer r, int depth)
+{
+  int term_count = 1 + random_below (3);
+  while (term_count--)
+    {
+      int factor_count = 1 + random_below (3);
+      while (factor_count--)
+        {
+          read_factor (g, r, depth);
+          if (factor_count)
+            bench_read (g, r, S_times);
+        }
+      if (term_count)
+        bench_read (g, r, S_plus);
+    }
+}
+
+/* Returns a checksum of the valuator steps of the first tree of |b| */
+static unsigned long
+steps_checksum (Marpa_Grammar g, Marpa_Bocage b)
+{
+  unsigned long checksum = 0;
+  Marpa_Order o;
+  Marpa_Tree t;
+  Marpa_Value v;
+  o = marpa_o_new (b);
+  if (!o)
+    bench_fail ("marpa_o_new", g);
+  t = marpa_t_new (o);
+  if (!t)
+    bench_fail ("marpa_t_new", g);
+  if (marpa_t_next (t) < 0)
+    bench_fail ("marpa_t_next", g);
+  v = marpa_v_new (t);
+  if (!v)
+    bench_fail ("marpa_v_new", g);
+  for (;;)
+    {
+      const Marpa_Step_Type step_type = marpa_v_step (v);
+      if (step_type < 0)
+        bench_fail ("marpa_v_step", g);
+      if (step_type == MARPA_STEP_INACTIVE)
+        break;
+      checksum = checksum * 31 + (unsigned long) step_type;
+      checksum = checksum * 31 + (unsigned long) marpa_v_es_id (v);
+      switch (step_type)
+        {
+        case MARPA_STEP_RULE:
+          checksum = checksum * 31 + (unsigned long) marpa_v_rule (v);
+          checksum = checksum * 31 + (unsigned long) marpa_v_arg_0 (v);
+          checksum = checksum * 31 + (unsigned long) marpa_v_arg_n (v);
+          break;
+        case MARPA_STEP_TOKEN:
+          checksum = checksum * 31 + (unsigned long) marpa_v_token (v);
+          checksum = checksum * 31 + (unsigned long) marpa_v_result (v);
+          break;
+        default:
+          break;
+        }
+    }
+  marpa_v_unref (v);
+  marpa_t_unref (t);
+  marpa_o_unref (o);
+  return checksum;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int statement_count = argc > 1 ? atoi (argv[1]) : 50000;
+  const int max_worker_count = argc > 2 ? atoi (argv[2]) : 8;
+  const int repeat_count = argc > 3 ? atoi (argv[3]) : 3;
+  Marpa_Grammar g = grammar_new ();
+  Marpa_Recognizer r = marpa_r_new (g);
+  int statement_ix;
+  int worker_count;
+  int and_node_count;
+  Marpa_Or_Node_ID top_or_node;
+  unsigned long checksum;
+  Marpa_Bocage serial_b;
+  double single_worker_seconds = 0;
+  double start;
+
+  if (!r)
+    bench_fail ("marpa_r_new", g);
+  if (!marpa_r_start_input (r))
+    bench_fail ("marpa_r_start_input", g);
+  start = bench_elapsed_seconds ();
+  for (statement_ix = 0; statement_ix < statement_count; statement_ix++)
+    {
+      read_expr (g, r, 0);
+      bench_read (g, r, S_semicolon);
+    }
+  printf ("%d statements, %d Earley sets: recognized in %.3f s\n",
+          statement_count, marpa_r_latest_earley_set (r) + 1,
+          bench_elapsed_seconds () - start);
+
+  serial_b = marpa_b_new (r, -1);
+  if (!serial_b)
+    bench_fail ("marpa_b_new", g);
+  and_node_count = _marpa_b_and_node_count (serial_b);
+  top_or_node = _marpa_b_top_or_node (serial_b);
+  checksum = steps_checksum (g, serial_b);
+  marpa_b_unref (serial_b);
+
+  for (worker_count = 1; worker_count <= max_worker_count; worker_count *= 2)
+    {
+      double best_seconds = 0;
+      int repeat_ix;
+      for (repeat_ix = 0; repeat_ix < repeat_count; repeat_ix++)
+        {
+          Marpa_Bocage b;
+          double seconds;
+          start = bench_elapsed_seconds ();
+          b = marpa_b_new_parallel (r, -1, worker_count, bench_fork_join,
+                                    NULL);
+          seconds = bench_elapsed_seconds () - start;
+          if (!b)
+            bench_fail ("marpa_b_new_parallel", g);
+          if (_marpa_b_and_node_count (b) != and_node_count
+              || _marpa_b_top_or_node (b) != top_or_node
+              || marpa_b_ambiguity_metric (b) != 1
+              || (repeat_ix == 0 && steps_checksum (g, b) != checksum))
+            {
+              printf ("%d workers: bocage is not the same\n", worker_count);
+              exit (1);
+            }
+          marpa_b_unref (b);
+          if (repeat_ix == 0 || seconds < best_seconds)
+            best_seconds = seconds;
+        }
+      if (worker_count == 1)
+        single_worker_seconds = best_seconds;
+      printf ("%d workers: %.3f s, speedup %.2f\n", worker_count,
+              best_seconds, single_worker_seconds / best_seconds);
+    }
+  marpa_r_unref (r);
+  marpa_g_unref (g);
+  return 0;
+}
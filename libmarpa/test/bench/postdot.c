@@ -0,0 +1,128 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A benchmark for postdot workers.
+ * The grammar has many statement rules which start with the same token,
+ *   top ::= statement+,  statement ::= a b_i,  b_i ::= b,
+ * for each of keyword_count rules,
+ * so that every Earley set has thousands of Earley items,
+ * and the sets after each a have thousands of postdot symbols.
+ * It recognizes the same input with 1, 2, 4, ... postdot workers,
+ * up to max_worker_count, each worker in its own thread,
+ * and reports the time per Earley set.
+ * Every parse must have the same Earley items and bocage.
+ * Usage: postdot [keyword_count [statement_count [max_worker_count]]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+Marpa_Symbol_ID S_top;
+Marpa_Symbol_ID S_statement;
+Marpa_Symbol_ID S_a;
+Marpa_Symbol_ID S_b;
+
+static Marpa_Grammar
+grammar_new (int keyword_count)
+{
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[2];
+  int keyword_ix;
+
+  S_top = bench_symbol_new (g);
+  S_statement = bench_symbol_new (g);
+  S_a = bench_symbol_new (g);
+  S_b = bench_symbol_new (g);
+  if (marpa_g_sequence_new (g, S_top, S_statement, -1, 1, 0) < 0)
+    bench_fail ("marpa_g_sequence_new", g);
+  for (keyword_ix = 0; keyword_ix < keyword_count; keyword_ix++)
+    {
+      const Marpa_Symbol_ID S_b_i = bench_symbol_new (g);
+      rhs[0] = S_a;
+      rhs[1] = S_b_i;
+      bench_rule_new (g, S_statement, rhs, 2);
+      bench_rule_new (g, S_b_i, &S_b, 1);
+    }
+  bench_precompute (g, S_top);
+  return g;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int keyword_count = argc > 1 ? atoi (argv[1]) : 5000;
+  const int statement_count = argc > 2 ? atoi (argv[2]) : 200;
+  const int max_worker_count = argc > 3 ? atoi (argv[3]) : 8;
+  Marpa_Grammar g = grammar_new (keyword_count);
+  size_t earley_item_count = 0;
+  int and_node_count = 0;
+  int worker_count;
+
+  for (worker_count = 1; worker_count <= max_worker_count; worker_count *= 2)
+    {
+      Marpa_Recognizer r = marpa_r_new (g);
+      Marpa_Recce_Stats stats;
+      Marpa_Bocage b;
+      double start;
+      double seconds;
+      int statement_ix;
+      if (!r)
+        bench_fail ("marpa_r_new", g);
+      marpa_r_stats_collect_set (r, 1);
+      (marpa_r_postdot_workers_set (r, worker_count, bench_fork_join, NULL)
+       == worker_count) || bench_fail ("marpa_r_postdot_workers_set", g);
+      start = bench_elapsed_seconds ();
+      if (!marpa_r_start_input (r))
+        bench_fail ("marpa_r_start_input", g);
+      for (statement_ix = 0; statement_ix < statement_count; statement_ix++)
+        {
+          bench_read (g, r, S_a);
+          bench_read (g, r, S_b);
+        }
+      seconds = bench_elapsed_seconds () - start;
+      marpa_r_stats (r, &stats);
+      b = marpa_b_new (r, -1);
+      if (!b)
+        bench_fail ("marpa_b_new", g);
+      if (worker_count == 1)
+        {
+          earley_item_count = stats.t_earley_item_count;
+          and_node_count = _marpa_b_and_node_count (b);
+        }
+      if (stats.t_earley_item_count != earley_item_count
+          || _marpa_b_and_node_count (b) != and_node_count)
+        {
+          printf ("%d workers: parse is not the same\n", worker_count);
+          exit (1);
+        }
+      printf ("%d workers: %lu Earley items in %d Earley sets,"
+              " %.1f us per Earley set\n",
+              worker_count, (unsigned long) earley_item_count,
+              marpa_r_latest_earley_set (r) + 1,
+              seconds * 1e6 / (marpa_r_latest_earley_set (r) + 1));
+      marpa_b_unref (b);
+      marpa_r_unref (r);
+    }
+  marpa_g_unref (g);
+  return 0;
+}
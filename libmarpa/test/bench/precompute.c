@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A benchmark for grammar precomputation.
+ * It builds a synthetic grammar with many symbols,
+ * as a grammar generator would, and precomputes it.
+ * The grammar is a binary tree of symbols.
+ * Each symbol either has two children or derives a terminal,
+ * and every sixteenth symbol also derives its grandparent,
+ * so that there are many small cycles in the prediction
+ * and right derivation relations.
+ * Usage: precompute [symbol_count]
+ * Try it with 10000 and 50000 symbols.
+ * Time it externally.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+int
+main (int argc, char *argv[])
+{
+  const int symbol_count = argc > 1 ? atoi (argv[1]) : 10000;
+  int symbol_ix;
+  int rule_count = 0;
+  Marpa_Symbol_ID S_a;
+  Marpa_Symbol_ID S_b;
+  Marpa_Symbol_ID first_symbol;
+
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[2];
+
+  S_a = bench_symbol_new (g);
+  S_b = bench_symbol_new (g);
+  first_symbol = bench_symbol_new (g);
+  for (symbol_ix = 1; symbol_ix < symbol_count; symbol_ix++)
+    bench_symbol_new (g);
+
+  for (symbol_ix = 0; symbol_ix < symbol_count; symbol_ix++)
+    {
+      const Marpa_Symbol_ID lhs = first_symbol + symbol_ix;
+      const int left_child = 2 * symbol_ix + 1;
+      const int right_child = 2 * symbol_ix + 2;
+      if (right_child < symbol_count)
+        {
+          /* lhs ::= left right */
+          rhs[0] = first_symbol + left_child;
+          rhs[1] = first_symbol + right_child;
+          bench_rule_new (g, lhs, rhs, 2);
+          rule_count++;
+        }
+      else
+        {
+          /* lhs ::= a */
+          bench_rule_new (g, lhs, &S_a, 1);
+          rule_count++;
+        }
+      if (symbol_ix >= 3 && symbol_ix % 16 == 0)
+        {
+          /* lhs ::= b grandparent */
+          rhs[0] = S_b;
+          rhs[1] = first_symbol + ((symbol_ix - 1) / 2 - 1) / 2;
+          bench_rule_new (g, lhs, rhs, 2);
+          rule_count++;
+        }
+    }
+  bench_precompute (g, first_symbol);
+
+  printf ("%d symbols, %d rules precomputed\n", symbol_count + 2,
+          rule_count);
+  marpa_g_unref (g);
+  return 0;
+}
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A micro-benchmark for prediction states.
+ * It parses the same statements, with and without prediction states,
+ * using a grammar in which every statement start predicts one rule
+ * for each of many keywords, and every expression predicts
+ * the rules for all of its operands.
+ * The two parses must have the same valuator steps.
+ * Usage: predstates [keyword_count [statement_count [repeat_count]]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+Marpa_Symbol_ID S_statements;
+Marpa_Symbol_ID S_statement;
+Marpa_Symbol_ID S_expr;
+Marpa_Symbol_ID S_term;
+Marpa_Symbol_ID S_plus;
+Marpa_Symbol_ID S_lparen;
+Marpa_Symbol_ID S_rparen;
+Marpa_Symbol_ID S_num;
+Marpa_Symbol_ID S_ident;
+Marpa_Symbol_ID S_semi;
+Marpa_Symbol_ID S_keyword_base;
+
+static Marpa_Grammar
+grammar_new (int keyword_count)
+{
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[3];
+  int keyword_ix;
+
+  S_statements = bench_symbol_new (g);
+  S_statement = bench_symbol_new (g);
+  S_expr = bench_symbol_new (g);
+  S_term = bench_symbol_new (g);
+  S_plus = bench_symbol_new (g);
+  S_lparen = bench_symbol_new (g);
+  S_rparen = bench_symbol_new (g);
+  S_num = bench_symbol_new (g);
+  S_ident = bench_symbol_new (g);
+  S_semi = bench_symbol_new (g);
+  S_keyword_base = bench_symbol_new (g);
+  for (keyword_ix = 1; keyword_ix < keyword_count; keyword_ix++)
+    bench_symbol_new (g);
+
+  /* statements ::= statements statement | statement */
+  rhs[0] = S_statements;
+  rhs[1] = S_statement;
+  bench_rule_new (g, S_statements, rhs, 2);
+  bench_rule_new (g, S_statements, rhs + 1, 1);
+
+  /* statement ::= keyword_i expr semi, for each keyword */
+  for (keyword_ix = 0; keyword_ix < keyword_count; keyword_ix++)
+    {
+      rhs[0] = S_keyword_base + keyword_ix;
+      rhs[1] = S_expr;
+      rhs[2] = S_semi;
+      bench_rule_new (g, S_statement, rhs, 3);
+    }
+
+  /* expr ::= expr plus term | term */
+  rhs[0] = S_expr;
+  rhs[1] = S_plus;
+  rhs[2] = S_term;
+  bench_rule_new (g, S_expr, rhs, 3);
+  bench_rule_new (g, S_expr, rhs + 2, 1);
+
+  /* term ::= num | ident | lparen expr rparen */
+  bench_rule_new (g, S_term, &S_num, 1);
+  bench_rule_new (g, S_term, &S_ident, 1);
+  rhs[0] = S_lparen;
+  rhs[1] = S_expr;
+  rhs[2] = S_rparen;
+  bench_rule_new (g, S_term, rhs, 3);
+
+  (marpa_g_prediction_states_set (g, 1) >= 0)
+    || bench_fail ("marpa_g_prediction_states_set", g);
+  bench_precompute (g, S_statements);
+  return g;
+}
+
+static void
+term_add (Marpa_Symbol_ID ** p, int depth)
+{
+  const int choice = rand () % 4;
+  if (depth < 2 && choice == 0)
+    {
+      *(*p)++ = S_lparen;
+      term_add (p, depth + 1);
+      *(*p)++ = S_plus;
+      term_add (p, depth + 1);
+      *(*p)++ = S_rparen;
+      return;
+    }
+  *(*p)++ = choice % 2 ? S_num : S_ident;
+}
+
+/* Fills |tokens| with |statement_count| random statements,
+ * and returns the number of tokens.
+ * Each statement takes at most 64 tokens.
+ */
+static int
+input_new (Marpa_Symbol_ID * tokens, int keyword_count, int statement_count)
+{
+  Marpa_Symbol_ID *p = tokens;
+  int statement_ix;
+  for (statement_ix = 0; statement_ix < statement_count; statement_ix++)
+    {
+      int term_count = 1 + rand () % 3;
+      *p++ = S_keyword_base + rand () % keyword_count;
+      term_add (&p, 0);
+      while (--term_count > 0)
+        {
+          *p++ = S_plus;
+          term_add (&p, 0);
+        }
+      *p++ = S_semi;
+    }
+  return (int) (p - tokens);
+}
+
+/* Parses |tokens| and returns a checksum of the valuator steps.
+ * The recognizer's statistics are added to |stats|.
+ */
+static unsigned long
+parse (Marpa_Grammar g, int use_prediction_states, Marpa_Symbol_ID * tokens,
+       int token_count, Marpa_Recce_Stats * stats)
+{
+  unsigned long checksum = 0;
+  int token_ix;
+  Marpa_Recce_Stats recce_stats;
+  Marpa_Bocage b;
+  Marpa_Order o;
+  Marpa_Tree t;
+  Marpa_Value v;
+  Marpa_Recognizer r = marpa_r_new (g);
+  if (!r)
+    bench_fail ("marpa_r_new", g);
+  marpa_r_stats_collect_set (r, 1);
+  (marpa_r_prediction_states_set (r, use_prediction_states) >= 0)
+    || bench_fail ("marpa_r_prediction_states_set", g);
+  if (!marpa_r_start_input (r))
+    bench_fail ("marpa_r_start_input", g);
+  for (token_ix = 0; token_ix < token_count; token_ix++)
+    bench_read (g, r, tokens[token_ix]);
+  marpa_r_stats (r, &recce_stats);
+  stats->t_earley_item_count += recce_stats.t_earley_item_count;
+  stats->t_prediction_count += recce_stats.t_prediction_count;
+  stats->t_prediction_state_count += recce_stats.t_prediction_state_count;
+
+  b = marpa_b_new (r, -1);
+  if (!b)
+    bench_fail ("marpa_b_new", g);
+  o = marpa_o_new (b);
+  if (!o)
+    bench_fail ("marpa_o_new", g);
+  t = marpa_t_new (o);
+  if (!t)
+    bench_fail ("marpa_t_new", g);
+  if (marpa_t_next (t) < 0)
+    bench_fail ("marpa_t_next", g);
+  v = marpa_v_new (t);
+  if (!v)
+    bench_fail ("marpa_v_new", g);
+  for (;;)
+    {
+      const Marpa_Step_Type step_type = marpa_v_step (v);
+      if (step_type < 0)
+        bench_fail ("marpa_v_step", g);
+      if (step_type == MARPA_STEP_INACTIVE)
+        break;
+      checksum = checksum * 31 + (unsigned long) step_type;
+      switch (step_type)
+        {
+        case MARPA_STEP_RULE:
+          checksum = checksum * 31 + (unsigned long) marpa_v_rule (v);
+          checksum = checksum * 31 + (unsigned long) marpa_v_arg_0 (v);
+          checksum = checksum * 31 + (unsigned long) marpa_v_arg_n (v);
+          break;
+        case MARPA_STEP_TOKEN:
+          checksum = checksum * 31 + (unsigned long) marpa_v_token (v);
+          checksum = checksum * 31 + (unsigned long) marpa_v_result (v);
+          break;
+        default:
+          break;
+        }
+    }
+  marpa_v_unref (v);
+  marpa_t_unref (t);
+  marpa_o_unref (o);
+  marpa_b_unref (b);
+  marpa_r_unref (r);
+  return checksum;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int keyword_count = argc > 1 ? atoi (argv[1]) : 50;
+  const int statement_count = argc > 2 ? atoi (argv[2]) : 200;
+  const int repeat_count = argc > 3 ? atoi (argv[3]) : 100;
+  Marpa_Symbol_ID *const tokens =
+    malloc (sizeof (Marpa_Symbol_ID) * (size_t) statement_count * 64);
+  Marpa_Recce_Stats stats[2] = { {0}, {0} };
+  double seconds[2] = { 0, 0 };
+  int repeat_ix;
+  int mode;
+  Marpa_Grammar g;
+
+  if (keyword_count < 1 || statement_count < 1 || !tokens)
+    {
+      printf ("bad arguments\n");
+      exit (1);
+    }
+  g = grammar_new (keyword_count);
+  srand (42);
+  for (repeat_ix = 0; repeat_ix < repeat_count; repeat_ix++)
+    {
+      unsigned long checksum[2];
+      const int token_count =
+        input_new (tokens, keyword_count, statement_count);
+      for (mode = 0; mode <= 1; mode++)
+        {
+          const double start = bench_seconds ();
+          checksum[mode] = parse (g, mode, tokens, token_count, stats + mode);
+          seconds[mode] += bench_seconds () - start;
+        }
+      if (checksum[0] != checksum[1])
+        {
+          printf ("parse %d differs with prediction states\n", repeat_ix);
+          exit (1);
+        }
+    }
+
+  for (mode = 0; mode <= 1; mode++)
+    {
+      printf ("%s: %lu Earley items, %lu predictions, "
+              "%lu prediction states, %.3f seconds\n",
+              mode ? "prediction states" : "all predictions",
+              (unsigned long) stats[mode].t_earley_item_count,
+              (unsigned long) stats[mode].t_prediction_count,
+              (unsigned long) stats[mode].t_prediction_state_count,
+              seconds[mode]);
+    }
+  marpa_g_unref (g);
+  free (tokens);
+  return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/* A micro-benchmark for extracting the best parses of a highly
+ * ambiguous input.
+ * The grammar is of expressions with a single infix operator:
+ *   expr ::= expr op expr | expr op term,  expr ::= term,  term ::= num,
+ * where the rule with a term on the right is ranked higher.
+ * The number of parses grows exponentially with the length of the input,
+ * and the bocage has a number of and-nodes cubic in that length.
+ * The top k parse trees are extracted from an ordering ranked with
+ * marpa_o_rank() and from one ranked with marpa_o_lazy_rank(),
+ * and the first k trees of the two are checked to be the same.
+ * Usage: ranked [op_count [k [repeat_count]]]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "bench.h"
+
+Marpa_Symbol_ID S_expr;
+Marpa_Symbol_ID S_term;
+Marpa_Symbol_ID S_op;
+Marpa_Symbol_ID S_num;
+
+static Marpa_Grammar
+grammar_new (void)
+{
+  Marpa_Grammar g = bench_grammar_new (NULL);
+  Marpa_Symbol_ID rhs[3];
+  Marpa_Rule_ID rule_id;
+
+  S_expr = bench_symbol_new (g);
+  S_term = bench_symbol_new (g);
+  S_op = bench_symbol_new (g);
+  S_num = bench_symbol_new (g);
+
+  rhs[0] = S_expr;
+  rhs[1] = S_op;
+  rhs[2] = S_expr;
+  bench_rule_new (g, S_expr, rhs, 3);
+  rhs[2] = S_term;
+  rule_id = bench_rule_new (g, S_expr, rhs, 3);
+  (marpa_g_rule_rank_set (g, rule_id, 1) == 1)
+    || bench_fail ("marpa_g_rule_rank_set", g);
+  bench_rule_new (g, S_expr, &S_term, 1);
+  bench_rule_new (g, S_term, &S_num, 1);
+  bench_precompute (g, S_expr);
+  return g;
+}
+
+/* Creates an ordering ranked by rule, lazily or not */
+static Marpa_Order
+ranked_order_new (Marpa_Grammar g, Marpa_Bocage b, int is_lazy)
+{
+  Marpa_Order o = marpa_o_new (b);
+  if (!o)
+    bench_fail ("marpa_o_new", g);
+  (marpa_o_high_rank_only_set (o, 0) == 0)
+    || bench_fail ("marpa_o_high_rank_only_set", g);
+  ((is_lazy ? marpa_o_lazy_rank (o) : marpa_o_rank (o)) >= 0)
+    || bench_fail ("marpa_o_rank", g);
+  return o;
+}
+
+/* Creates an ordering ranked by rule, lazily or not,
+   and positions a tree iterator on each of its first k parse trees.
+   Returns the tree iterator, positioned on the last of those trees */
+static Marpa_Tree
+top_trees (Marpa_Grammar g, Marpa_Bocage b, int is_lazy, int k)
+{
+  Marpa_Order o = ranked_order_new (g, b, is_lazy);
+  Marpa_Tree t;
+  int tree_ix;
+  t = marpa_t_new (o);
+  if (!t)
+    bench_fail ("marpa_t_new", g);
+  for (tree_ix = 0; tree_ix < k; tree_ix++)
+    if (marpa_t_next (t) < 0)
+      bench_fail ("marpa_t_next", g);
+  marpa_o_unref (o);
+  return t;
+}
+
+/* Exits unless each of the first k trees is the same,
+   whether ranked lazily or not */
+static void
+top_trees_check (Marpa_Grammar g, Marpa_Bocage b, int k)
+{
+  Marpa_Order eager_o = ranked_order_new (g, b, 0);
+  Marpa_Order lazy_o = ranked_order_new (g, b, 1);
+  Marpa_Tree eager_t = marpa_t_new (eager_o);
+  Marpa_Tree lazy_t = marpa_t_new (lazy_o);
+  int tree_ix;
+  if (!eager_t || !lazy_t)
+    bench_fail ("marpa_t_new", g);
+  for (tree_ix = 1; tree_ix <= k; tree_ix++)
+    {
+      int nook_id;
+      if (marpa_t_next (eager_t) < 0 || marpa_t_next (lazy_t) < 0)
+        bench_fail ("marpa_t_next", g);
+      if (_marpa_t_size (eager_t) != _marpa_t_size (lazy_t))
+        {
+          printf ("tree %d differs\n", tree_ix);
+          exit (1);
+        }
+      for (nook_id = 0; nook_id < _marpa_t_size (eager_t); nook_id++)
+        if (_marpa_t_nook_or_node (eager_t, nook_id)
+            != _marpa_t_nook_or_node (lazy_t, nook_id)
+            || _marpa_t_nook_choice (eager_t, nook_id)
+            != _marpa_t_nook_choice (lazy_t, nook_id))
+          {
+            printf ("tree %d differs\n", tree_ix);
+            exit (1);
+          }
+    }
+  marpa_t_unref (eager_t);
+  marpa_t_unref (lazy_t);
+  marpa_o_unref (eager_o);
+  marpa_o_unref (lazy_o);
+}
+
+/* Returns the number of seconds taken by each call of top_trees() */
+static double
+top_trees_time (Marpa_Grammar g, Marpa_Bocage b, int is_lazy, int k,
+                int repeat_count)
+{
+  const double start = bench_seconds ();
+  int repeat_ix;
+  for (repeat_ix = 0; repeat_ix < repeat_count; repeat_ix++)
+    marpa_t_unref (top_trees (g, b, is_lazy, k));
+  return (bench_seconds () - start) / repeat_count;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int op_count = argc > 1 ? atoi (argv[1]) : 100;
+  const int k = argc > 2 ? atoi (argv[2]) : 5;
+  const int repeat_count = argc > 3 ? atoi (argv[3]) : 10;
+  Marpa_Grammar g = grammar_new ();
+  Marpa_Recognizer r = marpa_r_new (g);
+  Marpa_Bocage b;
+  double eager_seconds;
+  double lazy_seconds;
+  int op_ix;
+
+  if (!r)
+    bench_fail ("marpa_r_new", g);
+  if (!marpa_r_start_input (r))
+    bench_fail ("marpa_r_start_input", g);
+  for (op_ix = 0; op_ix <= op_count; op_ix++)
+    {
+      if (op_ix > 0)
+        bench_read (g, r, S_op);
+      bench_read (g, r, S_num);
+    }
+  b = marpa_b_new (r, -1);
+  if (!b)
+    bench_fail ("marpa_b_new", g);
+
+  top_trees_check (g, b, k);
+  eager_seconds = top_trees_time (g, b, 0, k, repeat_count);
+  lazy_seconds = top_trees_time (g, b, 1, k, repeat_count);
+  printf ("%d and-nodes, top %d trees: marpa_o_rank %.3f ms, "
+          "marpa_o_lazy_rank %.3f ms\n",
+          _marpa_b_and_node_count (b), k,
+          eager_seconds * 1000, lazy_seconds * 1000);
+
+  marpa_b_unref (b);
+  marpa_r_unref (r);
+  marpa_g_unref (g);
+  return 0;
+}
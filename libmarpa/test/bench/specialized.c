@@ -0,0 +1,321 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A micro-benchmark for specialized recognizers.
+ * It compares a JSON grammar built and precomputed at startup
+ * with the same grammar compiled into the program,
+ * first for the cost of getting the grammar,
+ * then for the cost of recognizing many short documents.
+ * Usage: specialized [startup_count [document_count [document_length]]]
+ *        specialized -image image_file
+ * The second form writes the grammar image.
+ * To compile a generated specialization into the benchmark,
+ *   perl ../../work/bin/image2c.pl json < image_file > json_grammar.c
+ * and compile with -DJSON_GRAMMAR_C='"json_grammar.c"'.
+ * Otherwise, the specialization points to an image written at startup.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+#ifdef JSON_GRAMMAR_C
+#include JSON_GRAMMAR_C
+#endif
+
+/* From RFC 7159, in the same order as the JSON test */
+Marpa_Symbol_ID S_begin_array;
+Marpa_Symbol_ID S_begin_object;
+Marpa_Symbol_ID S_end_array;
+Marpa_Symbol_ID S_end_object;
+Marpa_Symbol_ID S_name_separator;
+Marpa_Symbol_ID S_value_separator;
+Marpa_Symbol_ID S_member;
+Marpa_Symbol_ID S_value;
+Marpa_Symbol_ID S_false;
+Marpa_Symbol_ID S_null;
+Marpa_Symbol_ID S_true;
+Marpa_Symbol_ID S_object;
+Marpa_Symbol_ID S_array;
+Marpa_Symbol_ID S_number;
+Marpa_Symbol_ID S_string;
+Marpa_Symbol_ID S_object_contents;
+Marpa_Symbol_ID S_array_contents;
+
+static Marpa_Grammar
+grammar_new (Marpa_Config * config)
+{
+  Marpa_Grammar g = bench_grammar_new (config);
+  Marpa_Symbol_ID rhs[3];
+
+  S_begin_array = bench_symbol_new (g);
+  S_begin_object = bench_symbol_new (g);
+  S_end_array = bench_symbol_new (g);
+  S_end_object = bench_symbol_new (g);
+  S_name_separator = bench_symbol_new (g);
+  S_value_separator = bench_symbol_new (g);
+  S_member = bench_symbol_new (g);
+  S_value = bench_symbol_new (g);
+  S_false = bench_symbol_new (g);
+  S_null = bench_symbol_new (g);
+  S_true = bench_symbol_new (g);
+  S_object = bench_symbol_new (g);
+  S_array = bench_symbol_new (g);
+  S_number = bench_symbol_new (g);
+  S_string = bench_symbol_new (g);
+  S_object_contents = bench_symbol_new (g);
+  S_array_contents = bench_symbol_new (g);
+
+  bench_rule_new (g, S_value, &S_false, 1);
+  bench_rule_new (g, S_value, &S_null, 1);
+  bench_rule_new (g, S_value, &S_true, 1);
+  bench_rule_new (g, S_value, &S_object, 1);
+  bench_rule_new (g, S_value, &S_array, 1);
+  bench_rule_new (g, S_value, &S_number, 1);
+  bench_rule_new (g, S_value, &S_string, 1);
+
+  rhs[0] = S_begin_array;
+  rhs[1] = S_array_contents;
+  rhs[2] = S_end_array;
+  bench_rule_new (g, S_array, rhs, 3);
+
+  rhs[0] = S_begin_object;
+  rhs[1] = S_object_contents;
+  rhs[2] = S_end_object;
+  bench_rule_new (g, S_object, rhs, 3);
+
+  (marpa_g_sequence_new
+   (g, S_array_contents, S_value, S_value_separator, 0,
+    MARPA_PROPER_SEPARATION) >= 0) || bench_fail ("marpa_g_sequence_new", g);
+  (marpa_g_sequence_new
+   (g, S_object_contents, S_member, S_value_separator, 0,
+    MARPA_PROPER_SEPARATION) >= 0) || bench_fail ("marpa_g_sequence_new", g);
+
+  rhs[0] = S_string;
+  rhs[1] = S_name_separator;
+  rhs[2] = S_value;
+  bench_rule_new (g, S_member, rhs, 3);
+
+  bench_precompute (g, S_value);
+  return g;
+}
+
+static void
+value_add (Marpa_Symbol_ID ** p, Marpa_Symbol_ID * end, int depth)
+{
+  static const int scalar_count = 5;
+  Marpa_Symbol_ID scalars[5];
+  const int choice = rand () % 8;
+  int item_count;
+  int item_ix;
+  scalars[0] = S_false;
+  scalars[1] = S_null;
+  scalars[2] = S_true;
+  scalars[3] = S_number;
+  scalars[4] = S_string;
+  if (depth >= 4 || *p + 40 > end || choice >= 2)
+    {
+      *(*p)++ = scalars[rand () % scalar_count];
+      return;
+    }
+  item_count = rand () % 4;
+  *(*p)++ = choice ? S_begin_array : S_begin_object;
+  for (item_ix = 0; item_ix < item_count; item_ix++)
+    {
+      if (item_ix > 0)
+        *(*p)++ = S_value_separator;
+      if (!choice)
+        {
+          *(*p)++ = S_string;
+          *(*p)++ = S_name_separator;
+        }
+      value_add (p, end, depth + 1);
+    }
+  *(*p)++ = choice ? S_end_array : S_end_object;
+}
+
+/* Fills |tokens| with an array of random values,
+ * of roughly |length| tokens,
+ * and returns the number of tokens.
+ * |tokens| must have room for |length| plus 50 tokens.
+ */
+static int
+document_new (Marpa_Symbol_ID * tokens, int length)
+{
+  Marpa_Symbol_ID *p = tokens;
+  Marpa_Symbol_ID *const end = tokens + length;
+  *p++ = S_begin_array;
+  value_add (&p, end + 40, 1);
+  while (p < end)
+    {
+      *p++ = S_value_separator;
+      value_add (&p, end + 40, 1);
+    }
+  *p++ = S_end_array;
+  return (int) (p - tokens);
+}
+
+/* Returns the number of Earley items */
+static size_t
+recognize (Marpa_Recognizer r, Marpa_Grammar g, Marpa_Symbol_ID * tokens,
+           int token_count)
+{
+  int token_ix;
+  Marpa_Bocage b;
+  Marpa_Memory_Report report;
+  if (!marpa_r_start_input (r))
+    bench_fail ("marpa_r_start_input", g);
+  for (token_ix = 0; token_ix < token_count; token_ix++)
+    bench_read (g, r, tokens[token_ix]);
+  b = marpa_b_new (r, -1);
+  if (!b)
+    bench_fail ("marpa_b_new", g);
+  marpa_b_unref (b);
+  marpa_r_memory_report (r, &report);
+  return report.t_earley_item_count;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int startup_count;
+  int document_count;
+  int document_length;
+  Marpa_Config marpa_configuration;
+  Marpa_Grammar g;
+  Marpa_Specialization *specialization;
+  Marpa_Specialization fresh_specialization;
+  Marpa_Symbol_ID *tokens;
+  size_t image_size = 0;
+  unsigned char *image;
+  size_t earley_item_count[2] = { 0, 0 };
+  double seconds[2] = { 0, 0 };
+  double start;
+  int ix;
+
+  marpa_c_init (&marpa_configuration);
+  g = grammar_new (&marpa_configuration);
+  marpa_g_serialize (g, NULL, &image_size);
+  image = malloc (image_size);
+  if (!image || marpa_g_serialize (g, image, &image_size) != 1)
+    bench_fail ("marpa_g_serialize", g);
+
+  if (argc == 3 && !strcmp (argv[1], "-image"))
+    {
+      FILE *image_file = fopen (argv[2], "wb");
+      if (!image_file || fwrite (image, 1, image_size, image_file) != image_size
+          || fclose (image_file) != 0)
+        {
+          perror (argv[2]);
+          exit (1);
+        }
+      return 0;
+    }
+  startup_count = argc > 1 ? atoi (argv[1]) : 1000;
+  document_count = argc > 2 ? atoi (argv[2]) : 10000;
+  document_length = argc > 3 ? atoi (argv[3]) : 100;
+
+#ifdef JSON_GRAMMAR_C
+  specialization = &json_specialization;
+  fresh_specialization = json_specialization;
+#else
+  fresh_specialization.t_name = "json";
+  fresh_specialization.t_image = image;
+  fresh_specialization.t_image_size = image_size;
+  fresh_specialization.t_grammar = NULL;
+  specialization = &fresh_specialization;
+#endif
+
+  /* Getting the grammar, each time as if at startup */
+  start = bench_seconds ();
+  for (ix = 0; ix < startup_count; ix++)
+    marpa_g_unref (grammar_new (&marpa_configuration));
+  seconds[0] = bench_seconds () - start;
+  start = bench_seconds ();
+  for (ix = 0; ix < startup_count; ix++)
+    {
+      Marpa_Specialization startup_specialization = fresh_specialization;
+      Marpa_Recognizer r =
+        marpa_r_new_specialized (&marpa_configuration,
+                                 &startup_specialization);
+      if (!r)
+        {
+          printf ("marpa_r_new_specialized returned %d\n",
+                  marpa_c_error (&marpa_configuration, NULL));
+          exit (1);
+        }
+      marpa_r_unref (r);
+      marpa_g_unref (startup_specialization.t_grammar);
+    }
+  seconds[1] = bench_seconds () - start;
+  printf ("%d startups: %.3f seconds to precompute, "
+          "%.3f seconds to load a specialization\n",
+          startup_count, seconds[0], seconds[1]);
+
+  /* Recognizing, with the grammar in hand */
+  tokens = malloc (sizeof (Marpa_Symbol_ID) * (size_t) (document_length + 50));
+  if (!tokens)
+    exit (1);
+  srand (42);
+  seconds[0] = seconds[1] = 0;
+  for (ix = 0; ix < document_count; ix++)
+    {
+      const int token_count = document_new (tokens, document_length);
+      Marpa_Recognizer r;
+      start = bench_seconds ();
+      r = marpa_r_new (g);
+      if (!r)
+        bench_fail ("marpa_r_new", g);
+      earley_item_count[0] += recognize (r, g, tokens, token_count);
+      marpa_r_unref (r);
+      seconds[0] += bench_seconds () - start;
+      start = bench_seconds ();
+      r = marpa_r_new_specialized (&marpa_configuration, specialization);
+      if (!r)
+        {
+          printf ("marpa_r_new_specialized returned %d\n",
+                  marpa_c_error (&marpa_configuration, NULL));
+          exit (1);
+        }
+      earley_item_count[1] +=
+        recognize (r, specialization->t_grammar, tokens, token_count);
+      marpa_r_unref (r);
+      seconds[1] += bench_seconds () - start;
+    }
+  if (earley_item_count[0] != earley_item_count[1])
+    {
+      printf ("Earley item counts differ: %lu and %lu\n",
+              (unsigned long) earley_item_count[0],
+              (unsigned long) earley_item_count[1]);
+      exit (1);
+    }
+  printf ("%d documents of about %d tokens: %lu Earley items, "
+          "%.3f seconds precomputed, %.3f seconds specialized\n",
+          document_count, document_length,
+          (unsigned long) earley_item_count[0], seconds[0], seconds[1]);
+
+  marpa_g_unref (g);
+  free (tokens);
+  free (image);
+  return 0;
+}
@@ -21,7 +21,9 @@
 
 /* Tests of Libmarpa methods on trivial grammar that is not merely nulling */
 
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "marpa.h"
 
 #include "marpa_m_test.h"
@@ -135,6 +137,183 @@ marpa_g_simple_precompute(Marpa_Grammar g, Marpa_Symbol_ID S_start)
   return rc;
 }
 
+/* The grammar of the clone base tests, in which Z is inaccessible:
+   top ::= X a; X ::= Y; Y ::= ; Y ::= c; Z ::= ; Z ::= c
+   Its extension adds, with a new symbol W:
+   Y ::= Z; top ::= W; W ::= c
+   so that the symbols nulled with X, and those reached from top, change */
+enum { CB_top, CB_X, CB_Y, CB_Z, CB_a, CB_c, CB_W };
+
+static Marpa_Grammar
+clone_base_grammar_new (void)
+{
+  Marpa_Symbol_ID symbol_rhs[2];
+  Marpa_Grammar g = marpa_g_new (NULL);
+  int symbol_ix;
+  if (!g)
+    fail ("marpa_g_new", g);
+  marpa_g_force_valued (g);
+  for (symbol_ix = CB_top; symbol_ix <= CB_c; symbol_ix++)
+    (marpa_g_symbol_new (g) == symbol_ix) || fail ("marpa_g_symbol_new", g);
+  symbol_rhs[0] = CB_X;
+  symbol_rhs[1] = CB_a;
+  (marpa_g_rule_new (g, CB_top, symbol_rhs, 2) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  symbol_rhs[0] = CB_Y;
+  (marpa_g_rule_new (g, CB_X, symbol_rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  (marpa_g_rule_new (g, CB_Y, symbol_rhs, 0) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  (marpa_g_rule_new (g, CB_Z, symbol_rhs, 0) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  symbol_rhs[0] = CB_c;
+  (marpa_g_rule_new (g, CB_Y, symbol_rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  (marpa_g_rule_new (g, CB_Z, symbol_rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  (marpa_g_symbol_is_nulled_event_set (g, CB_Z, 1) == 1)
+    || fail ("marpa_g_symbol_is_nulled_event_set", g);
+  (marpa_g_start_symbol_set (g, CB_top) >= 0)
+    || fail ("marpa_g_start_symbol_set", g);
+  return g;
+}
+
+static void
+clone_base_grammar_extend (Marpa_Grammar g)
+{
+  Marpa_Symbol_ID symbol_rhs[1];
+  (marpa_g_symbol_new (g) == CB_W) || fail ("marpa_g_symbol_new", g);
+  symbol_rhs[0] = CB_Z;
+  (marpa_g_rule_new (g, CB_Y, symbol_rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  symbol_rhs[0] = CB_W;
+  (marpa_g_rule_new (g, CB_top, symbol_rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  symbol_rhs[0] = CB_c;
+  (marpa_g_rule_new (g, CB_W, symbol_rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+}
+
+/* Returns the number of nulled events in a parse of "a" */
+static int
+nulled_event_count (Marpa_Grammar g)
+{
+  int count = 0;
+  int event_ix;
+  Marpa_Event event;
+  Marpa_Recognizer r = marpa_r_new (g);
+  if (!r)
+    fail ("marpa_r_new", g);
+  if (!marpa_r_start_input (r))
+    fail ("marpa_r_start_input", g);
+  for (event_ix = 0; event_ix < marpa_g_event_count (g); event_ix++)
+    if (marpa_g_event (g, &event, event_ix) == MARPA_EVENT_SYMBOL_NULLED)
+      count++;
+  marpa_r_alternative (r, CB_a, 1, 1);
+  marpa_r_earleme_complete (r);
+  for (event_ix = 0; event_ix < marpa_g_event_count (g); event_ix++)
+    if (marpa_g_event (g, &event, event_ix) == MARPA_EVENT_SYMBOL_NULLED)
+      count++;
+  marpa_r_unref (r);
+  return count;
+}
+
+/* Does the work of a parallel bocage in one thread,
+   and counts its calls */
+static void
+serial_fork_join (Marpa_Work work, void **work_args, int work_count,
+                  void *fork_join_data)
+{
+  int work_ix;
+  for (work_ix = 0; work_ix < work_count; work_ix++)
+    work (work_args[work_ix]);
+  (*(int *) fork_join_data)++;
+}
+
+/* Like serial_fork_join(), but does the work last to first */
+static void
+reverse_fork_join (Marpa_Work work, void **work_args, int work_count,
+                   void *fork_join_data)
+{
+  int work_ix;
+  for (work_ix = work_count - 1; work_ix >= 0; work_ix--)
+    work (work_args[work_ix]);
+  (*(int *) fork_join_data)++;
+}
+
+/* Returns the number of parse trees of the two orderings,
+   or -1 if the trees are not the same, in the same order */
+static int
+trees_compare (Marpa_Order o1, Marpa_Order o2)
+{
+  Marpa_Tree t1 = marpa_t_new (o1);
+  Marpa_Tree t2 = marpa_t_new (o2);
+  int tree_count = 0;
+  for (;;)
+    {
+      const int rc1 = marpa_t_next (t1);
+      const int rc2 = marpa_t_next (t2);
+      int nook_id;
+      if (rc1 != rc2 || _marpa_t_size (t1) != _marpa_t_size (t2))
+        { tree_count = -1; break; }
+      if (rc1 < 0)
+        break;
+      for (nook_id = 0; nook_id < _marpa_t_size (t1); nook_id++)
+        if (_marpa_t_nook_or_node (t1, nook_id) != _marpa_t_nook_or_node (t2, nook_id)
+          || _marpa_t_nook_choice (t1, nook_id) != _marpa_t_nook_choice (t2, nook_id))
+          tree_count = -1;
+      if (tree_count < 0)
+        break;
+      tree_count++;
+    }
+  marpa_t_unref (t1);
+  marpa_t_unref (t2);
+  return tree_count;
+}
+
+/* Returns the number of parse trees of the two orderings,
+   or -1 if their valuators do not take the same steps */
+static int
+steps_compare (Marpa_Order o1, Marpa_Order o2)
+{
+  Marpa_Tree t1 = marpa_t_new (o1);
+  Marpa_Tree t2 = marpa_t_new (o2);
+  int tree_count = 0;
+  while (tree_count >= 0)
+    {
+      const int rc1 = marpa_t_next (t1);
+      const int rc2 = marpa_t_next (t2);
+      Marpa_Value v1, v2;
+      if (rc1 != rc2)
+        { tree_count = -1; break; }
+      if (rc1 < 0)
+        break;
+      v1 = marpa_v_new (t1);
+      v2 = marpa_v_new (t2);
+      for (;;)
+        {
+          const Marpa_Step_Type step1 = marpa_v_step (v1);
+          const Marpa_Step_Type step2 = marpa_v_step (v2);
+          if (step1 != step2 || marpa_v_rule (v1) != marpa_v_rule (v2)
+            || marpa_v_symbol (v1) != marpa_v_symbol (v2)
+            || marpa_v_token_value (v1) != marpa_v_token_value (v2)
+            || marpa_v_result (v1) != marpa_v_result (v2)
+            || marpa_v_arg_0 (v1) != marpa_v_arg_0 (v2)
+            || marpa_v_arg_n (v1) != marpa_v_arg_n (v2)
+            || marpa_v_rule_start_es_id (v1) != marpa_v_rule_start_es_id (v2)
+            || marpa_v_es_id (v1) != marpa_v_es_id (v2))
+            { tree_count = -1; break; }
+          if (step1 == MARPA_STEP_INACTIVE)
+            { tree_count++; break; }
+        }
+      marpa_v_unref (v1);
+      marpa_v_unref (v2);
+    }
+  marpa_t_unref (t1);
+  marpa_t_unref (t2);
+  return tree_count;
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -145,7 +324,7 @@ main (int argc, char *argv[])
   Marpa_Grammar g;
   Marpa_Recognizer r;
 
-  plan(20);
+  plan(77);
 
   marpa_c_init (&marpa_configuration);
   g = marpa_g_simple_new(&marpa_configuration);
@@ -214,5 +393,1097 @@ main (int argc, char *argv[])
   marpa_m_test("marpa_o_high_rank_only_set", o, flag, -2, MARPA_ERR_ORDER_FROZEN);
   marpa_m_test("marpa_o_high_rank_only", o, flag);
 
+  /* marpa_b_new_parallel() */
+  {
+    int fork_join_count = 0;
+    Marpa_Bocage parallel_b;
+    ok (marpa_b_new_parallel (r, -1, 0, serial_fork_join, &fork_join_count)
+          == NULL
+      && marpa_g_error (g, NULL) == MARPA_ERR_INVALID_WORKER_COUNT
+      && marpa_b_new_parallel (r, -1, 2, NULL, NULL) == NULL
+      && marpa_g_error (g, NULL) == MARPA_ERR_POINTER_ARG_NULL,
+      "marpa_b_new_parallel() checks its workers");
+    parallel_b =
+      marpa_b_new_parallel (r, -1, 3, serial_fork_join, &fork_join_count);
+    ok (parallel_b != NULL && fork_join_count == 3
+      && _marpa_b_top_or_node (parallel_b) == _marpa_b_top_or_node (b)
+      && _marpa_b_and_node_count (parallel_b) == _marpa_b_and_node_count (b),
+      "marpa_b_new_parallel() builds the same bocage");
+    marpa_b_unref (parallel_b);
+  }
+
+  /* parallel bocages have the trees of marpa_b_new() */
+  {
+    Marpa_Grammar amb_g = marpa_g_new (&marpa_configuration);
+    Marpa_Symbol_ID S_E, S_a;
+    Marpa_Recognizer amb_r;
+    Marpa_Bocage amb_b;
+    Marpa_Order amb_o;
+    int worker_count;
+    int token_ix;
+    int is_same = 1;
+    /* E ::= E E | a, which has 42 parses of 6 a's */
+    if (!amb_g)
+      fail("marpa_g_new", g);
+    S_E = marpa_g_symbol_new (amb_g);
+    S_a = marpa_g_symbol_new (amb_g);
+    rhs[0] = S_E;
+    rhs[1] = S_E;
+    (marpa_g_rule_new (amb_g, S_E, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", amb_g);
+    (marpa_g_rule_new (amb_g, S_E, &S_a, 1) >= 0)
+      || fail ("marpa_g_rule_new", amb_g);
+    marpa_g_simple_precompute (amb_g, S_E);
+    amb_r = marpa_r_new (amb_g);
+    if (!amb_r)
+      fail("marpa_r_new", amb_g);
+    if (!marpa_r_start_input (amb_r))
+      fail("marpa_r_start_input", amb_g);
+    for (token_ix = 0; token_ix < 6; token_ix++)
+      {
+        marpa_r_alternative (amb_r, S_a, 1, 1);
+        marpa_r_earleme_complete (amb_r);
+      }
+    amb_b = marpa_b_new (amb_r, -1);
+    if (!amb_b)
+      fail("marpa_b_new", amb_g);
+    amb_o = marpa_o_new (amb_b);
+    for (worker_count = 2; worker_count <= 8; worker_count *= 2)
+      {
+        int fork_join_count = 0;
+        Marpa_Bocage parallel_b = marpa_b_new_parallel (amb_r, -1,
+          worker_count, reverse_fork_join, &fork_join_count);
+        Marpa_Order parallel_o;
+        if (!parallel_b)
+          fail("marpa_b_new_parallel", amb_g);
+        parallel_o = marpa_o_new (parallel_b);
+        is_same = is_same && fork_join_count == 3
+          && trees_compare (amb_o, parallel_o) == 42
+          && steps_compare (amb_o, parallel_o) == 42;
+        marpa_o_unref (parallel_o);
+        marpa_b_unref (parallel_b);
+      }
+    ok (is_same,
+      "marpa_b_new_parallel() gives the trees of marpa_b_new(), in order");
+
+    /* postdot workers */
+    {
+      int fork_join_count = 0;
+      Marpa_Recognizer workers_r = marpa_r_new (amb_g);
+      Marpa_Bocage workers_b;
+      Marpa_Order workers_o;
+      if (!workers_r)
+        fail("marpa_r_new", amb_g);
+      is_same = marpa_r_postdot_workers (workers_r) == 1
+        && marpa_r_postdot_workers_set (workers_r, 0, reverse_fork_join,
+             &fork_join_count) == -2
+        && marpa_g_error (amb_g, NULL) == MARPA_ERR_INVALID_WORKER_COUNT
+        && marpa_r_postdot_workers_set (workers_r, 2, NULL, NULL) == -2
+        && marpa_g_error (amb_g, NULL) == MARPA_ERR_POINTER_ARG_NULL
+        && marpa_r_postdot_workers_set (workers_r, 3, reverse_fork_join,
+             &fork_join_count) == 3
+        && marpa_r_postdot_workers (workers_r) == 3
+        && marpa_r_postdot_worker_threshold (workers_r) == 4096
+        && marpa_r_postdot_worker_threshold_set (workers_r, 1) == 1;
+      if (!marpa_r_start_input (workers_r))
+        fail("marpa_r_start_input", amb_g);
+      for (token_ix = 0; token_ix < 6; token_ix++)
+        {
+          marpa_r_alternative (workers_r, S_a, 1, 1);
+          marpa_r_earleme_complete (workers_r);
+        }
+      workers_b = marpa_b_new (workers_r, -1);
+      if (!workers_b)
+        fail("marpa_b_new", amb_g);
+      workers_o = marpa_o_new (workers_b);
+      ok (is_same && fork_join_count == 7 * 3
+        && trees_compare (amb_o, workers_o) == 42
+        && steps_compare (amb_o, workers_o) == 42,
+        "postdot workers give the trees of a recognizer without them");
+      marpa_o_unref (workers_o);
+      marpa_b_unref (workers_b);
+      marpa_r_unref (workers_r);
+    }
+
+    /* postdot workers set after a checkpoint survive a rollback */
+    {
+      int fork_join_count = 0;
+      Marpa_Recognizer workers_r = marpa_r_new (amb_g);
+      Marpa_Bocage workers_b;
+      Marpa_Order workers_o;
+      if (!workers_r)
+        fail("marpa_r_new", amb_g);
+      if (!marpa_r_start_input (workers_r))
+        fail("marpa_r_start_input", amb_g);
+      if (marpa_r_checkpoint (workers_r) < 0)
+        fail("marpa_r_checkpoint", amb_g);
+      for (token_ix = 0; token_ix < 3; token_ix++)
+        {
+          marpa_r_alternative (workers_r, S_a, 1, 1);
+          marpa_r_earleme_complete (workers_r);
+        }
+      marpa_r_postdot_workers_set (workers_r, 2, reverse_fork_join,
+        &fork_join_count);
+      marpa_r_postdot_worker_threshold_set (workers_r, 1);
+      is_same = marpa_r_rollback (workers_r, 0) == 0;
+      for (token_ix = 0; token_ix < 6; token_ix++)
+        {
+          marpa_r_alternative (workers_r, S_a, 1, 1);
+          marpa_r_earleme_complete (workers_r);
+        }
+      workers_b = marpa_b_new (workers_r, -1);
+      if (!workers_b)
+        fail("marpa_b_new", amb_g);
+      workers_o = marpa_o_new (workers_b);
+      ok (is_same && fork_join_count == 6 * 3
+        && trees_compare (amb_o, workers_o) == 42,
+        "postdot workers are kept across a rollback");
+      marpa_o_unref (workers_o);
+      marpa_b_unref (workers_b);
+      marpa_r_unref (workers_r);
+    }
+    marpa_o_unref (amb_o);
+    marpa_b_unref (amb_b);
+    marpa_r_unref (amb_r);
+    marpa_g_unref (amb_g);
+  }
+
+  /* marpa_b_export() */
+  {
+    size_t export_size = 0;
+    Marpa_Bocage_Export *bocage_export;
+    int is_same;
+    int id;
+    rc = marpa_b_export (b, NULL, &export_size);
+    bocage_export = malloc (export_size);
+    is_same = rc == 0
+      && marpa_b_export (b, bocage_export, &export_size) == 1
+      && bocage_export->t_top_or_node == _marpa_b_top_or_node (b)
+      && bocage_export->t_and_node_count == _marpa_b_and_node_count (b)
+      && _marpa_b_or_node_irl (b, bocage_export->t_or_node_count) == -1;
+    for (id = 0; is_same && id < bocage_export->t_or_node_count; id++)
+      is_same = bocage_export->t_or_node_irl[id] == _marpa_b_or_node_irl (b, id)
+        && bocage_export->t_or_node_position[id] == _marpa_b_or_node_position (b, id)
+        && bocage_export->t_or_node_origin[id] == _marpa_b_or_node_origin (b, id)
+        && bocage_export->t_or_node_set[id] == _marpa_b_or_node_set (b, id)
+        && bocage_export->t_or_node_first_and[id] == _marpa_b_or_node_first_and (b, id)
+        && bocage_export->t_or_node_and_count[id] == _marpa_b_or_node_and_count (b, id);
+    for (id = 0; is_same && id < bocage_export->t_and_node_count; id++)
+      is_same = bocage_export->t_and_node_parent[id] == _marpa_b_and_node_parent (b, id)
+        && bocage_export->t_and_node_predecessor[id] == _marpa_b_and_node_predecessor (b, id)
+        && bocage_export->t_and_node_cause[id] == _marpa_b_and_node_cause (b, id)
+        && bocage_export->t_and_node_symbol[id] == _marpa_b_and_node_symbol (b, id)
+        && bocage_export->t_and_node_middle[id] == _marpa_b_and_node_middle (b, id);
+    ok (is_same, "marpa_b_export() agrees with the trace functions");
+    free (bocage_export);
+  }
+
+  /* marpa_r_alternatives_read() */
+  {
+    Marpa_Alternative alternatives[2];
+
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", g);
+
+    alternatives[0].t_token_id = S_top;
+    alternatives[0].t_value = 1;
+    alternatives[0].t_length = 1;
+    alternatives[0].t_earleme = 0;
+    rc = marpa_r_alternatives_read (r, alternatives, 1);
+    ok (rc == 0 && marpa_g_error (g, NULL) == MARPA_ERR_TOKEN_IS_NOT_TERMINAL,
+      "marpa_r_alternatives_read() stops at rejected token");
+
+    alternatives[0].t_token_id = S_C1;
+    alternatives[1].t_token_id = S_C2;
+    alternatives[1].t_value = 1;
+    alternatives[1].t_length = 1;
+    alternatives[1].t_earleme = 1;
+    rc = marpa_r_alternatives_read (r, alternatives, 2);
+    ok (rc == 1 && marpa_g_error (g, NULL) == MARPA_ERR_NONE,
+      "marpa_r_alternatives_read() stops at event");
+    ok (marpa_r_current_earleme (r) == 1 && marpa_r_is_exhausted (r),
+      "marpa_r_alternatives_read() completed earleme 0");
+
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    ok (marpa_r_alternatives_hashed_set (r, 1) == 1,
+      "marpa_r_alternatives_hashed_set() before input");
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", g);
+    ok (marpa_r_alternatives_hashed_set (r, 0) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_RECCE_STARTED,
+      "marpa_r_alternatives_hashed_set() fails after input starts");
+    alternatives[0].t_earleme = 1;
+    rc = marpa_r_alternatives_read (r, alternatives, 1);
+    ok (rc == -2, "marpa_r_alternatives_read() fails when input is exhausted");
+  }
+
+  /* hashed alternatives */
+  {
+    Marpa_Recognizer hashed_r[2];
+    Marpa_Bocage hashed_b[2];
+    Marpa_Order hashed_o[2];
+    int is_hashed;
+    int duplicates_rejected = 1;
+    for (is_hashed = 0; is_hashed <= 1; is_hashed++)
+      {
+        Marpa_Recognizer this_r = marpa_r_new (g);
+        if (!this_r)
+          fail("marpa_r_new", g);
+        marpa_r_alternatives_hashed_set (this_r, is_hashed);
+        if (!marpa_r_start_input (this_r))
+          fail("marpa_r_start_input", g);
+        duplicates_rejected = duplicates_rejected
+          && marpa_r_alternative (this_r, S_C1, 1, 1) == MARPA_ERR_NONE
+          && marpa_r_alternative (this_r, S_C1, 1, 1) == MARPA_ERR_DUPLICATE_TOKEN
+          && marpa_r_clean (this_r) == 0
+          && marpa_r_alternative (this_r, S_C1, 1, 1) == MARPA_ERR_DUPLICATE_TOKEN
+          && marpa_r_alternative (this_r, S_C2, 1, 1) == MARPA_ERR_NONE
+          && marpa_r_clean (this_r) == 0
+          && marpa_r_alternative (this_r, S_C2, 1, 1) == MARPA_ERR_DUPLICATE_TOKEN
+          && marpa_r_earleme_complete (this_r) >= 0;
+        hashed_r[is_hashed] = this_r;
+        hashed_b[is_hashed] = marpa_b_new (this_r, -1);
+        if (!hashed_b[is_hashed])
+          fail("marpa_b_new", g);
+        hashed_o[is_hashed] = marpa_o_new (hashed_b[is_hashed]);
+      }
+    ok (duplicates_rejected,
+      "hashed alternatives reject duplicates after marpa_r_clean()");
+    ok (trees_compare (hashed_o[0], hashed_o[1]) == 2
+      && steps_compare (hashed_o[0], hashed_o[1]) == 2,
+      "hashed alternatives give the same trees and steps");
+    for (is_hashed = 0; is_hashed <= 1; is_hashed++)
+      {
+        marpa_o_unref (hashed_o[is_hashed]);
+        marpa_b_unref (hashed_b[is_hashed]);
+        marpa_r_unref (hashed_r[is_hashed]);
+      }
+  }
+
+  /* postdot index */
+  {
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    ok (marpa_r_postdot_index_threshold_set (r, 1) == 1
+      && marpa_r_postdot_index_threshold (r) == 1,
+      "marpa_r_postdot_index_threshold_set()");
+    ok (marpa_r_postdot_index_threshold_set (r, 0) == INT_MAX,
+      "marpa_r_postdot_index_threshold_set() disables the index");
+    ok (marpa_r_postdot_index_size (r) == 0,
+      "marpa_r_postdot_index_size() before input");
+  }
+
+  /* an index on every Earley set changes nothing but its size */
+  {
+    Marpa_Recognizer indexed_r[2];
+    Marpa_Bocage indexed_b[2];
+    Marpa_Order indexed_o[2];
+    int is_indexed;
+    int is_same = 1;
+    Marpa_Earley_Set_ID ys_id;
+    for (is_indexed = 0; is_indexed <= 1; is_indexed++)
+      {
+        Marpa_Recognizer this_r = marpa_r_new (g);
+        if (!this_r)
+          fail("marpa_r_new", g);
+        if (is_indexed)
+          marpa_r_postdot_index_threshold_set (this_r, 1);
+        if (!marpa_r_start_input (this_r))
+          fail("marpa_r_start_input", g);
+        is_same = is_same
+          && marpa_r_alternative (this_r, S_C1, 1, 1) == MARPA_ERR_NONE
+          && marpa_r_alternative (this_r, S_C2, 1, 1) == MARPA_ERR_NONE
+          && marpa_r_earleme_complete (this_r) >= 0;
+        indexed_r[is_indexed] = this_r;
+        indexed_b[is_indexed] = marpa_b_new (this_r, -1);
+        if (!indexed_b[is_indexed])
+          fail("marpa_b_new", g);
+        indexed_o[is_indexed] = marpa_o_new (indexed_b[is_indexed]);
+      }
+    for (ys_id = 0; is_same && ys_id <= 1; ys_id++)
+      {
+        const int report_count =
+          marpa_r_progress_report_start (indexed_r[0], ys_id);
+        int item_ix;
+        is_same = report_count > 0
+          && marpa_r_progress_report_start (indexed_r[1], ys_id)
+            == report_count;
+        for (item_ix = 0; is_same && item_ix < report_count; item_ix++)
+          {
+            int position[2];
+            Marpa_Earley_Set_ID origin[2];
+            is_same = marpa_r_progress_item (indexed_r[0], position, origin)
+              == marpa_r_progress_item (indexed_r[1], position + 1, origin + 1)
+              && position[0] == position[1] && origin[0] == origin[1];
+          }
+        marpa_r_progress_report_finish (indexed_r[0]);
+        marpa_r_progress_report_finish (indexed_r[1]);
+      }
+    ok (is_same && marpa_r_postdot_index_size (indexed_r[0]) == 0
+      && marpa_r_postdot_index_size (indexed_r[1]) > 0
+      && trees_compare (indexed_o[0], indexed_o[1]) == 2
+      && steps_compare (indexed_o[0], indexed_o[1]) == 2,
+      "postdot index threshold 1 gives the same parse");
+    for (is_indexed = 0; is_indexed <= 1; is_indexed++)
+      {
+        marpa_o_unref (indexed_o[is_indexed]);
+        marpa_b_unref (indexed_b[is_indexed]);
+        marpa_r_unref (indexed_r[is_indexed]);
+      }
+  }
+
+  /* marpa_r_memory_report() */
+  {
+    Marpa_Memory_Report report;
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", g);
+    rc = marpa_r_memory_report (r, &report);
+    ok (rc == 1 && report.t_earley_set_count == 1
+      && report.t_earley_item_count > 0
+      && report.t_obstack_size >=
+        report.t_earley_item_count * report.t_earley_item_size,
+      "marpa_r_memory_report()");
+    ok (marpa_r_memory_report (r, NULL) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_POINTER_ARG_NULL,
+      "marpa_r_memory_report() fails with NULL report");
+  }
+
+  /* streaming mode */
+  {
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    ok (marpa_r_streaming_set (r, 1) == 1 && marpa_r_streaming (r) == 1,
+      "marpa_r_streaming_set()");
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", g);
+    ok (marpa_r_streaming_set (r, 0) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_RECCE_STARTED,
+      "marpa_r_streaming_set() fails after input starts");
+    ok (marpa_r_discarded_earley_set_count (r) == 0,
+      "marpa_r_discarded_earley_set_count()");
+  }
+
+  /* streaming mode discards Earley sets */
+  {
+    Marpa_Grammar seq_g = marpa_g_new (&marpa_configuration);
+    Marpa_Symbol_ID S_top_seq, S_seq, S_x, S_y;
+    Marpa_Recognizer seq_r[2];
+    int is_streaming;
+    int is_same = 1;
+    int earleme;
+    if (!seq_g)
+      fail("marpa_g_new", g);
+    S_top_seq = marpa_g_symbol_new (seq_g);
+    S_seq = marpa_g_symbol_new (seq_g);
+    S_x = marpa_g_symbol_new (seq_g);
+    S_y = marpa_g_symbol_new (seq_g);
+    /* top ::= seq y; seq ::= seq x; seq ::= x */
+    rhs[0] = S_seq;
+    rhs[1] = S_y;
+    (marpa_g_rule_new (seq_g, S_top_seq, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", seq_g);
+    rhs[1] = S_x;
+    (marpa_g_rule_new (seq_g, S_seq, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", seq_g);
+    (marpa_g_rule_new (seq_g, S_seq, rhs + 1, 1) >= 0)
+      || fail ("marpa_g_rule_new", seq_g);
+    marpa_g_simple_precompute (seq_g, S_top_seq);
+    for (is_streaming = 0; is_streaming <= 1; is_streaming++)
+      {
+        seq_r[is_streaming] = marpa_r_new (seq_g);
+        if (!seq_r[is_streaming])
+          fail("marpa_r_new", seq_g);
+        marpa_r_streaming_set (seq_r[is_streaming], is_streaming);
+        if (!marpa_r_start_input (seq_r[is_streaming]))
+          fail("marpa_r_start_input", seq_g);
+      }
+    /* Enough Earley sets to fill several segments */
+    for (earleme = 0; is_same && earleme < 20000; earleme++)
+      {
+        const Marpa_Symbol_ID token = earleme == 19998 ? S_y : S_x;
+        is_same =
+          marpa_r_alternative (seq_r[0], token, 1, 1)
+            == marpa_r_alternative (seq_r[1], token, 1, 1)
+          && marpa_r_earleme_complete (seq_r[0])
+            == marpa_r_earleme_complete (seq_r[1])
+          && marpa_r_is_exhausted (seq_r[0])
+            == marpa_r_is_exhausted (seq_r[1])
+          && marpa_r_latest_earley_set_value_set (seq_r[1], earleme + 1)
+            == earleme + 1;
+      }
+    ok (is_same && marpa_r_is_exhausted (seq_r[1])
+      && marpa_r_discarded_earley_set_count (seq_r[0]) == 0
+      && marpa_r_discarded_earley_set_count (seq_r[1]) > 0
+      && marpa_r_progress_report_start (seq_r[1],
+           marpa_r_latest_earley_set (seq_r[1]))
+        == marpa_r_progress_report_start (seq_r[0],
+             marpa_r_latest_earley_set (seq_r[0])),
+      "streaming mode discards Earley sets and reads the same input");
+    ok (marpa_r_progress_report_start (seq_r[1], 0) == -2
+      && marpa_g_error (seq_g, NULL) == MARPA_ERR_EARLEY_SET_DISCARDED
+      && marpa_b_new (seq_r[1], -1) == NULL
+      && marpa_g_error (seq_g, NULL) == MARPA_ERR_EARLEY_SET_DISCARDED,
+      "discarded Earley sets cannot be used");
+    /* Set 0 is the origin of the top rule, so its segment is kept */
+    ok (marpa_r_earley_set_value (seq_r[1], 1) == 1
+      && marpa_r_earley_set_value (seq_r[1], 19998) == 19998
+      && marpa_r_earley_set_value (seq_r[1], 10000) == -2
+      && marpa_g_error (seq_g, NULL) == MARPA_ERR_EARLEY_SET_DISCARDED,
+      "kept Earley sets are found after a discard");
+    marpa_r_unref (seq_r[0]);
+    marpa_r_unref (seq_r[1]);
+    marpa_g_unref (seq_g);
+  }
+
+  /* checkpoint and rollback */
+  {
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", g);
+    ok (marpa_r_checkpoint (r) == 0, "marpa_r_checkpoint()");
+    marpa_r_alternative (r, S_C1, 1, 1);
+    marpa_r_earleme_complete (r);
+    ok (marpa_r_rollback (r, 0) == 0
+      && marpa_r_current_earleme (r) == 0 && !marpa_r_is_exhausted (r)
+      && marpa_r_alternative (r, S_C1, 1, 1) == MARPA_ERR_NONE,
+      "marpa_r_rollback()");
+    ok (marpa_r_rollback (r, 1) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_NO_SUCH_CHECKPOINT,
+      "marpa_r_rollback() fails with no such checkpoint");
+    ok (marpa_r_checkpoint_release (r, 0) == 0,
+      "marpa_r_checkpoint_release()");
+  }
+
+  /* rollbacks in hashed mode leave no stale hash entries */
+  {
+    int round;
+    int is_accepted = 1;
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    marpa_r_alternatives_hashed_set (r, 1);
+    if (!marpa_r_start_input (r))
+      fail("marpa_r_start_input", g);
+    if (marpa_r_checkpoint (r) < 0)
+      fail("marpa_r_checkpoint", g);
+    for (round = 0; round < 64; round++)
+      {
+        is_accepted = is_accepted
+          && marpa_r_alternative (r, S_C1, 1, round + 1) == MARPA_ERR_NONE
+          && marpa_r_rollback (r, 0) == 0;
+      }
+    ok (is_accepted
+      && marpa_r_alternative (r, S_C1, 1, 1) == MARPA_ERR_NONE
+      && marpa_r_alternative (r, S_C2, 1, 1) == MARPA_ERR_NONE
+      && marpa_r_alternative (r, S_C1, 1, 1) == MARPA_ERR_DUPLICATE_TOKEN,
+      "hashed alternatives after repeated rollbacks");
+  }
+
+  /* rollbacks in mid-parse, with Leo items */
+  {
+    Marpa_Grammar cp_g = marpa_g_new (&marpa_configuration);
+    Marpa_Symbol_ID S_list, S_item, S_a, S_b;
+    Marpa_Symbol_ID input[6];
+    int token_ix;
+    int is_hashed;
+    /* list ::= item list | item, item ::= a | b | a b,
+       which has 8 parses of "a b a b a b" */
+    if (!cp_g)
+      fail("marpa_g_new", g);
+    S_list = marpa_g_symbol_new (cp_g);
+    S_item = marpa_g_symbol_new (cp_g);
+    S_a = marpa_g_symbol_new (cp_g);
+    S_b = marpa_g_symbol_new (cp_g);
+    rhs[0] = S_item;
+    rhs[1] = S_list;
+    (marpa_g_rule_new (cp_g, S_list, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", cp_g);
+    (marpa_g_rule_new (cp_g, S_list, &S_item, 1) >= 0)
+      || fail ("marpa_g_rule_new", cp_g);
+    (marpa_g_rule_new (cp_g, S_item, &S_a, 1) >= 0)
+      || fail ("marpa_g_rule_new", cp_g);
+    (marpa_g_rule_new (cp_g, S_item, &S_b, 1) >= 0)
+      || fail ("marpa_g_rule_new", cp_g);
+    rhs[0] = S_a;
+    rhs[1] = S_b;
+    (marpa_g_rule_new (cp_g, S_item, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", cp_g);
+    marpa_g_simple_precompute (cp_g, S_list);
+    for (token_ix = 0; token_ix < 6; token_ix++)
+      input[token_ix] = token_ix % 2 ? S_b : S_a;
+    for (is_hashed = 0; is_hashed <= 1; is_hashed++)
+      {
+        Marpa_Recognizer cp_r[2];
+        Marpa_Bocage cp_b[2];
+        Marpa_Order cp_o[2];
+        Marpa_Symbol_ID expected[2][4];
+        int is_same = 1;
+        int set_id;
+        int r_ix;
+        for (r_ix = 0; r_ix <= 1; r_ix++)
+          {
+            cp_r[r_ix] = marpa_r_new (cp_g);
+            if (!cp_r[r_ix])
+              fail("marpa_r_new", cp_g);
+            marpa_r_alternatives_hashed_set (cp_r[r_ix], is_hashed);
+            if (!marpa_r_start_input (cp_r[r_ix]))
+              fail("marpa_r_start_input", cp_g);
+          }
+        /* cp_r[0] is the control */
+        for (token_ix = 0; token_ix < 6; token_ix++)
+          {
+            marpa_r_alternative (cp_r[0], input[token_ix], 1, 1);
+            marpa_r_earleme_complete (cp_r[0]);
+          }
+        /* cp_r[1] checkpoints with a token pending,
+           reads other input, and rolls back */
+        for (token_ix = 0; token_ix < 3; token_ix++)
+          {
+            marpa_r_alternative (cp_r[1], input[token_ix], 1, 1);
+            if (token_ix < 2)
+              marpa_r_earleme_complete (cp_r[1]);
+          }
+        if (marpa_r_checkpoint (cp_r[1]) < 0)
+          fail("marpa_r_checkpoint", cp_g);
+        is_same = marpa_r_alternative (cp_r[1], S_b, 1, 1) == MARPA_ERR_NONE
+          && marpa_r_alternative (cp_r[1], S_a, 1, 2) == MARPA_ERR_NONE;
+        for (token_ix = 0; token_ix < 4; token_ix++)
+          {
+            marpa_r_earleme_complete (cp_r[1]);
+            marpa_r_alternative (cp_r[1], S_a, 1, 1);
+          }
+        is_same = is_same && marpa_r_rollback (cp_r[1], 0) == 2
+          && marpa_r_alternative (cp_r[1], S_a, 1, 1)
+            == MARPA_ERR_DUPLICATE_TOKEN;
+        for (token_ix = 2; token_ix < 6; token_ix++)
+          {
+            if (token_ix > 2)
+              marpa_r_alternative (cp_r[1], input[token_ix], 1, 1);
+            marpa_r_earleme_complete (cp_r[1]);
+          }
+        is_same = is_same
+          && marpa_r_latest_earley_set (cp_r[0]) == 6
+          && marpa_r_latest_earley_set (cp_r[1]) == 6;
+        for (set_id = 0; is_same && set_id <= 6; set_id++)
+          is_same = _marpa_r_earley_set_size (cp_r[0], set_id)
+            == _marpa_r_earley_set_size (cp_r[1], set_id);
+        is_same = is_same
+          && marpa_r_terminals_expected (cp_r[0], expected[0]) == 2
+          && marpa_r_terminals_expected (cp_r[1], expected[1]) == 2
+          && expected[0][0] == expected[1][0]
+          && expected[0][1] == expected[1][1];
+        for (r_ix = 0; r_ix <= 1; r_ix++)
+          {
+            cp_b[r_ix] = marpa_b_new (cp_r[r_ix], -1);
+            if (!cp_b[r_ix])
+              fail("marpa_b_new", cp_g);
+            cp_o[r_ix] = marpa_o_new (cp_b[r_ix]);
+          }
+        ok (is_same && trees_compare (cp_o[0], cp_o[1]) == 8
+          && steps_compare (cp_o[0], cp_o[1]) == 8,
+          is_hashed ? "a rollback in mid-parse, with hashed alternatives"
+            : "a rollback in mid-parse");
+        for (r_ix = 0; r_ix <= 1; r_ix++)
+          {
+            marpa_o_unref (cp_o[r_ix]);
+            marpa_b_unref (cp_b[r_ix]);
+            marpa_r_unref (cp_r[r_ix]);
+          }
+      }
+    marpa_g_unref (cp_g);
+  }
+
+  /* marpa_r_stats() */
+  {
+    Marpa_Recce_Stats stats;
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    ok (marpa_r_stats_collect_set (r, 1) == 1 && marpa_r_stats_collect (r) == 1,
+      "marpa_r_stats_collect_set()");
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", g);
+    marpa_r_alternative (r, S_C1, 1, 1);
+    marpa_r_earleme_complete (r);
+    rc = marpa_r_stats (r, &stats);
+    ok (rc == 1 && stats.t_earley_set_count == 2
+      && stats.t_earley_item_count >= stats.t_prediction_count
+      && stats.t_prediction_count > 0
+      && stats.t_token_link_count > 0,
+      "marpa_r_stats()");
+    ok (marpa_r_stats (r, NULL) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_POINTER_ARG_NULL,
+      "marpa_r_stats() fails with NULL stats");
+  }
+
+  /* grammar images */
+  {
+    size_t image_size = 0;
+    void *image;
+    Marpa_Grammar loaded_g;
+    Marpa_Bocage b;
+    ok (marpa_g_serialize (g, NULL, &image_size) == 0 && image_size > 0,
+      "marpa_g_serialize() finds the image size");
+    image = malloc (image_size);
+    rc = marpa_g_serialize (g, image, &image_size);
+    if (rc != 1)
+      fail("marpa_g_serialize", g);
+    loaded_g = marpa_g_load (&marpa_configuration, image, image_size);
+    if (!loaded_g)
+      fail("marpa_g_load", g);
+    r = marpa_r_new (loaded_g);
+    if (!r)
+      fail("marpa_r_new", loaded_g);
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", loaded_g);
+    marpa_r_alternative (r, S_C1, 1, 1);
+    marpa_r_earleme_complete (r);
+    b = marpa_b_new (r, -1);
+    ok (marpa_g_is_precomputed (loaded_g) == 1
+      && marpa_g_highest_rule_id (loaded_g) == marpa_g_highest_rule_id (g)
+      && b != NULL,
+      "marpa_g_load()");
+    ok (marpa_g_load (&marpa_configuration, image, image_size - 1) == NULL
+      && marpa_c_error (&marpa_configuration, NULL)
+        == MARPA_ERR_BAD_GRAMMAR_IMAGE,
+      "marpa_g_load() fails with a truncated image");
+    marpa_b_unref (b);
+    marpa_r_unref (r);
+    marpa_g_unref (loaded_g);
+
+    {
+      Marpa_Specialization specialization =
+        { "nits", image, 0, NULL };
+      Marpa_Recognizer r1, r2;
+      specialization.t_image_size = image_size;
+      r1 = marpa_r_new_specialized (&marpa_configuration, &specialization);
+      r2 = marpa_r_new_specialized (&marpa_configuration, &specialization);
+      ok (r1 && r2 && specialization.t_grammar
+        && marpa_g_highest_rule_id (specialization.t_grammar)
+          == marpa_g_highest_rule_id (g),
+        "marpa_r_new_specialized() loads the image once");
+      ok (marpa_r_new_specialized (&marpa_configuration, NULL) == NULL
+        && marpa_c_error (&marpa_configuration, NULL)
+          == MARPA_ERR_POINTER_ARG_NULL,
+        "marpa_r_new_specialized() fails with NULL specialization");
+      marpa_r_unref (r1);
+      marpa_r_unref (r2);
+      marpa_g_unref (specialization.t_grammar);
+    }
+    free (image);
+  }
+
+  /* cloning a grammar */
+  {
+    Marpa_Grammar clone_g;
+    Marpa_Symbol_ID S_D;
+    Marpa_Rule_ID R_top_D;
+    Marpa_Bocage b;
+    clone_g = marpa_g_clone (g);
+    if (!clone_g)
+      fail("marpa_g_clone", g);
+    ok (marpa_g_is_precomputed (clone_g) == 0
+      && marpa_g_highest_symbol_id (clone_g) == marpa_g_highest_symbol_id (g)
+      && marpa_g_highest_rule_id (clone_g) == marpa_g_highest_rule_id (g)
+      && marpa_g_start_symbol (clone_g) == S_top
+      && marpa_g_rule_lhs (clone_g, R_top_2) == S_top
+      && marpa_g_rule_rhs (clone_g, R_top_2, 0) == S_A2,
+      "marpa_g_clone()");
+    ((S_D = marpa_g_symbol_new (clone_g)) >= 0)
+      || fail ("marpa_g_symbol_new", clone_g);
+    rhs[0] = S_D;
+    ((R_top_D = marpa_g_rule_new (clone_g, S_top, rhs, 1)) >= 0)
+      || fail ("marpa_g_rule_new", clone_g);
+    ok (marpa_g_share (clone_g) == -2
+      && marpa_g_error (clone_g, NULL) == MARPA_ERR_NOT_PRECOMPUTED,
+      "marpa_g_share() fails before precomputation");
+    if (marpa_g_precompute (clone_g) < 0)
+      fail("marpa_g_precompute", clone_g);
+    if (marpa_g_share (clone_g) != 1)
+      fail("marpa_g_share", clone_g);
+    r = marpa_r_new (clone_g);
+    if (!r)
+      fail("marpa_r_new", clone_g);
+    rc = marpa_r_start_input (r);
+    if (!rc)
+      fail("marpa_r_start_input", clone_g);
+    marpa_r_alternative (r, S_D, 1, 1);
+    marpa_r_earleme_complete (r);
+    b = marpa_b_new (r, -1);
+    ok (R_top_D == marpa_g_highest_rule_id (g) + 1
+      && b != NULL
+      && marpa_g_rule_new (g, S_top, rhs, 1) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_PRECOMPUTED,
+      "an extended clone is parsed, and the base is unchanged");
+    marpa_b_unref (b);
+    marpa_r_unref (r);
+    marpa_g_unref (clone_g);
+  }
+
+  /* a clone reuses the closures of its base */
+  {
+    Marpa_Grammar base_g = clone_base_grammar_new ();
+    Marpa_Grammar clone_g;
+    Marpa_Grammar scratch_g = clone_base_grammar_new ();
+    Marpa_Symbol_ID symbol_id;
+    int symbols_are_same = 1;
+    ok (marpa_g_clone_base_set (base_g, 2) == -2
+      && marpa_g_error (base_g, NULL) == MARPA_ERR_INVALID_BOOLEAN
+      && marpa_g_clone_base_set (base_g, 1) == 1
+      && marpa_g_clone_base (base_g) == 1,
+      "marpa_g_clone_base_set()");
+    if (marpa_g_precompute (base_g) < 0)
+      fail ("marpa_g_precompute", base_g);
+    clone_g = marpa_g_clone (base_g);
+    if (!clone_g)
+      fail ("marpa_g_clone", base_g);
+    rc = marpa_g_clone_base_set (base_g, 0) == -2
+      && marpa_g_error (base_g, NULL) == MARPA_ERR_PRECOMPUTED
+      && marpa_g_clone_base (clone_g) == 0
+      && nulled_event_count (base_g) == 0;
+    marpa_g_unref (base_g);
+    clone_base_grammar_extend (clone_g);
+    clone_base_grammar_extend (scratch_g);
+    if (marpa_g_precompute (clone_g) < 0)
+      fail ("marpa_g_precompute", clone_g);
+    if (marpa_g_precompute (scratch_g) < 0)
+      fail ("marpa_g_precompute", scratch_g);
+    for (symbol_id = CB_top; symbol_id <= CB_W; symbol_id++)
+      {
+        if (marpa_g_symbol_is_accessible (clone_g, symbol_id)
+              != marpa_g_symbol_is_accessible (scratch_g, symbol_id)
+          || marpa_g_symbol_is_nullable (clone_g, symbol_id)
+              != marpa_g_symbol_is_nullable (scratch_g, symbol_id)
+          || marpa_g_symbol_is_nulling (clone_g, symbol_id)
+              != marpa_g_symbol_is_nulling (scratch_g, symbol_id)
+          || marpa_g_symbol_is_productive (clone_g, symbol_id)
+              != marpa_g_symbol_is_productive (scratch_g, symbol_id))
+          symbols_are_same = 0;
+      }
+    ok (rc && symbols_are_same
+      && marpa_g_symbol_is_accessible (clone_g, CB_Z) == 1
+      && marpa_g_symbol_is_nullable (clone_g, CB_Z) == 1
+      && nulled_event_count (clone_g) == nulled_event_count (scratch_g)
+      && nulled_event_count (clone_g) > 0,
+      "a clone precomputes as the same grammar built from scratch");
+    marpa_g_unref (clone_g);
+    marpa_g_unref (scratch_g);
+  }
+
+  /* precompute statistics */
+  {
+    Marpa_Grammar clone_g;
+    Marpa_Precompute_Stats stats;
+    Marpa_Precompute_Stats ahm_stats;
+    Marpa_Precompute_Stats prediction_stats;
+    rc = marpa_g_precompute_stats (g, MARPA_PRECOMPUTE_PHASE_CENSUS, &stats);
+    ok (rc == 0 && stats.t_name != NULL && stats.t_xsy_count == 0,
+      "marpa_g_precompute_stats() without statistics");
+    clone_g = marpa_g_clone (g);
+    if (!clone_g)
+      fail("marpa_g_clone", g);
+    if (marpa_g_precompute_stats_collect_set (clone_g, 1) != 1)
+      fail("marpa_g_precompute_stats_collect_set", clone_g);
+    if (marpa_g_precompute (clone_g) < 0)
+      fail("marpa_g_precompute", clone_g);
+    rc = marpa_g_precompute_stats (clone_g, MARPA_PRECOMPUTE_PHASE_CENSUS,
+      &stats);
+    ok (rc == 1
+      && marpa_g_precompute_stats (clone_g, MARPA_PRECOMPUTE_PHASE_AHMS,
+           &ahm_stats) == 1
+      && marpa_g_precompute_stats (clone_g, MARPA_PRECOMPUTE_PHASE_PREDICTIONS,
+           &prediction_stats) == 1
+      && stats.t_xsy_count == marpa_g_highest_symbol_id (g) + 1
+      && stats.t_matrix_count > 0
+      && ahm_stats.t_ahm_count > 0
+      && ahm_stats.t_obstack_size >= stats.t_obstack_size
+      && prediction_stats.t_matrix_entry_count > 0,
+      "marpa_g_precompute_stats()");
+    ok (marpa_g_precompute_stats (clone_g, MARPA_PRECOMPUTE_PHASE_COUNT,
+          &stats) == -2
+      && marpa_g_error (clone_g, NULL) == MARPA_ERR_INVALID_PRECOMPUTE_PHASE,
+      "marpa_g_precompute_stats() fails with an invalid phase");
+    marpa_g_unref (clone_g);
+  }
+
+  /* prediction states */
+  {
+    Marpa_Grammar clone_g;
+    Marpa_Recognizer eager_r;
+    Marpa_Symbol_ID S_D;
+    Marpa_Recce_Stats stats;
+    Marpa_Bocage b;
+    int progress_count;
+    ok (marpa_g_prediction_states_set (g, 1) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_PRECOMPUTED,
+      "marpa_g_prediction_states_set() fails after precomputation");
+    r = marpa_r_new (g);
+    if (!r)
+      fail("marpa_r_new", g);
+    ok (marpa_r_prediction_states_set (r, 1) == -2
+      && marpa_g_error (g, NULL) == MARPA_ERR_NO_PREDICTION_STATES,
+      "marpa_r_prediction_states_set() fails without prediction states");
+    marpa_r_unref (r);
+
+    /* top ::= A1 D; D ::= B2 */
+    clone_g = marpa_g_clone (g);
+    if (!clone_g)
+      fail("marpa_g_clone", g);
+    ((S_D = marpa_g_symbol_new (clone_g)) >= 0)
+      || fail ("marpa_g_symbol_new", clone_g);
+    rhs[0] = S_A1;
+    rhs[1] = S_D;
+    (marpa_g_rule_new (clone_g, S_top, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", clone_g);
+    rhs[0] = S_B2;
+    (marpa_g_rule_new (clone_g, S_D, rhs, 1) >= 0)
+      || fail ("marpa_g_rule_new", clone_g);
+    if (marpa_g_prediction_states_set (clone_g, 1) != 1)
+      fail("marpa_g_prediction_states_set", clone_g);
+    if (marpa_g_precompute (clone_g) < 0)
+      fail("marpa_g_precompute", clone_g);
+
+    r = marpa_r_new (clone_g);
+    if (!r)
+      fail("marpa_r_new", clone_g);
+    marpa_r_streaming_set (r, 1);
+    rc = marpa_r_prediction_states_set (r, 1) == -2
+      && marpa_g_error (clone_g, NULL) == MARPA_ERR_PREDICTION_STATES_STREAMING;
+    marpa_r_streaming_set (r, 0);
+    ok (rc && marpa_r_prediction_states_set (r, 1) == 1
+      && marpa_r_streaming_set (r, 1) == -2
+      && marpa_g_error (clone_g, NULL) == MARPA_ERR_PREDICTION_STATES_STREAMING,
+      "prediction states and streaming mode exclude each other");
+
+    eager_r = marpa_r_new (clone_g);
+    if (!eager_r)
+      fail("marpa_r_new", clone_g);
+    if (!marpa_r_start_input (eager_r))
+      fail("marpa_r_start_input", clone_g);
+    marpa_r_alternative (eager_r, S_C1, 1, 1);
+    marpa_r_earleme_complete (eager_r);
+    progress_count = marpa_r_progress_report_start (eager_r, 1);
+
+    marpa_r_stats_collect_set (r, 1);
+    if (!marpa_r_start_input (r))
+      fail("marpa_r_start_input", clone_g);
+    marpa_r_alternative (r, S_C1, 1, 1);
+    marpa_r_earleme_complete (r);
+    marpa_r_stats (r, &stats);
+    ok (stats.t_prediction_state_count == 1
+      && marpa_r_progress_report_start (r, 1) == progress_count
+      && progress_count > 0,
+      "progress report with prediction states");
+    marpa_r_progress_report_finish (r);
+    marpa_r_alternative (r, S_C2, 1, 1);
+    marpa_r_earleme_complete (r);
+    b = marpa_b_new (r, -1);
+    ok (b != NULL, "parse with prediction states");
+    marpa_b_unref (b);
+    marpa_r_unref (eager_r);
+    marpa_r_unref (r);
+    marpa_g_unref (clone_g);
+  }
+
+  /* prediction states do not change the bocage */
+  {
+    Marpa_Grammar ps_g = marpa_g_new (&marpa_configuration);
+    Marpa_Symbol_ID S_S, S_a, S_y, S_b, S_Y, S_P1, S_P2;
+    Marpa_Bocage ps_b[2];
+    Marpa_Order ps_o[2];
+    Marpa_Recognizer ps_r[2];
+    int is_using_prediction_states;
+    if (!ps_g)
+      fail("marpa_g_new", g);
+    S_S = marpa_g_symbol_new (ps_g);
+    S_a = marpa_g_symbol_new (ps_g);
+    S_y = marpa_g_symbol_new (ps_g);
+    S_b = marpa_g_symbol_new (ps_g);
+    S_Y = marpa_g_symbol_new (ps_g);
+    S_P1 = marpa_g_symbol_new (ps_g);
+    S_P2 = marpa_g_symbol_new (ps_g);
+    /* S ::= a P1; S ::= a P2; P1 ::= Y b; P2 ::= Y b; Y ::= y
+       The deferred predictions of P1 and P2 are not found
+       in the order of their rule IDs */
+    rhs[0] = S_a;
+    rhs[1] = S_P1;
+    (marpa_g_rule_new (ps_g, S_S, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", ps_g);
+    rhs[1] = S_P2;
+    (marpa_g_rule_new (ps_g, S_S, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", ps_g);
+    rhs[0] = S_Y;
+    rhs[1] = S_b;
+    (marpa_g_rule_new (ps_g, S_P1, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", ps_g);
+    (marpa_g_rule_new (ps_g, S_P2, rhs, 2) >= 0)
+      || fail ("marpa_g_rule_new", ps_g);
+    rhs[0] = S_y;
+    (marpa_g_rule_new (ps_g, S_Y, rhs, 1) >= 0)
+      || fail ("marpa_g_rule_new", ps_g);
+    if (marpa_g_prediction_states_set (ps_g, 1) != 1)
+      fail("marpa_g_prediction_states_set", ps_g);
+    marpa_g_simple_precompute (ps_g, S_S);
+    for (is_using_prediction_states = 0; is_using_prediction_states <= 1;
+         is_using_prediction_states++)
+      {
+        Marpa_Recognizer this_r = marpa_r_new (ps_g);
+        if (!this_r)
+          fail("marpa_r_new", ps_g);
+        marpa_r_prediction_states_set (this_r, is_using_prediction_states);
+        if (!marpa_r_start_input (this_r))
+          fail("marpa_r_start_input", ps_g);
+        marpa_r_alternative (this_r, S_a, 1, 1);
+        marpa_r_earleme_complete (this_r);
+        marpa_r_alternative (this_r, S_y, 1, 1);
+        marpa_r_earleme_complete (this_r);
+        marpa_r_alternative (this_r, S_b, 1, 1);
+        marpa_r_earleme_complete (this_r);
+        ps_r[is_using_prediction_states] = this_r;
+        ps_b[is_using_prediction_states] = marpa_b_new (this_r, -1);
+        if (!ps_b[is_using_prediction_states])
+          fail("marpa_b_new", ps_g);
+        ps_o[is_using_prediction_states] =
+          marpa_o_new (ps_b[is_using_prediction_states]);
+      }
+    ok (trees_compare (ps_o[0], ps_o[1]) == 2
+      && steps_compare (ps_o[0], ps_o[1]) == 2,
+      "prediction states give the same trees and steps");
+    for (is_using_prediction_states = 0; is_using_prediction_states <= 1;
+         is_using_prediction_states++)
+      {
+        marpa_o_unref (ps_o[is_using_prediction_states]);
+        marpa_b_unref (ps_b[is_using_prediction_states]);
+        marpa_r_unref (ps_r[is_using_prediction_states]);
+      }
+    marpa_g_unref (ps_g);
+  }
+
+  /* marpa_o_lazy_rank() */
+  {
+    Marpa_Grammar ranked_g = marpa_g_simple_new (&marpa_configuration);
+    Marpa_Bocage ranked_b;
+    int high_rank_only;
+    int tree_counts[2];
+    marpa_g_rule_rank_set (ranked_g, R_top_2, 1);
+    marpa_g_simple_precompute (ranked_g, S_top);
+    r = marpa_r_new (ranked_g);
+    if (!r)
+      fail("marpa_r_new", ranked_g);
+    if (!marpa_r_start_input (r))
+      fail("marpa_r_start_input", ranked_g);
+    marpa_r_alternative (r, S_C1, 1, 1);
+    marpa_r_alternative (r, S_C2, 1, 1);
+    marpa_r_earleme_complete (r);
+    ranked_b = marpa_b_new (r, -1);
+    if (!ranked_b)
+      fail("marpa_b_new", ranked_g);
+    for (high_rank_only = 0; high_rank_only <= 1; high_rank_only++)
+      {
+        Marpa_Order eager_o = marpa_o_new (ranked_b);
+        Marpa_Order lazy_o = marpa_o_new (ranked_b);
+        marpa_o_high_rank_only_set (eager_o, high_rank_only);
+        marpa_o_high_rank_only_set (lazy_o, high_rank_only);
+        marpa_o_rank (eager_o);
+        marpa_o_lazy_rank (lazy_o);
+        tree_counts[high_rank_only] = trees_compare (eager_o, lazy_o);
+        marpa_o_unref (eager_o);
+        marpa_o_unref (lazy_o);
+      }
+    ok (tree_counts[0] == 2 && tree_counts[1] == 1,
+      "marpa_o_lazy_rank() gives the trees of marpa_o_rank()");
+    marpa_b_unref (ranked_b);
+    marpa_r_unref (r);
+    marpa_g_unref (ranked_g);
+  }
+
+  /* marpa_o_lazy_rank() on an ambiguous expression */
+  {
+    Marpa_Grammar expr_g = marpa_g_new (&marpa_configuration);
+    Marpa_Symbol_ID S_expr, S_term, S_op, S_num;
+    Marpa_Rule_ID R_expr_term;
+    Marpa_Bocage expr_b;
+    int high_rank_only;
+    int tree_counts[2];
+    int step_counts[2];
+    int op_ix;
+    /* expr ::= expr op expr | expr op term | term, term ::= num,
+       with expr op term ranked higher,
+       which has 394 parses of 6 num's, and 1 of high rank */
+    if (!expr_g)
+      fail("marpa_g_new", g);
+    S_expr = marpa_g_symbol_new (expr_g);
+    S_term = marpa_g_symbol_new (expr_g);
+    S_op = marpa_g_symbol_new (expr_g);
+    S_num = marpa_g_symbol_new (expr_g);
+    rhs[0] = S_expr;
+    rhs[1] = S_op;
+    rhs[2] = S_expr;
+    (marpa_g_rule_new (expr_g, S_expr, rhs, 3) >= 0)
+      || fail ("marpa_g_rule_new", expr_g);
+    rhs[2] = S_term;
+    ((R_expr_term = marpa_g_rule_new (expr_g, S_expr, rhs, 3)) >= 0)
+      || fail ("marpa_g_rule_new", expr_g);
+    (marpa_g_rule_new (expr_g, S_expr, &S_term, 1) >= 0)
+      || fail ("marpa_g_rule_new", expr_g);
+    (marpa_g_rule_new (expr_g, S_term, &S_num, 1) >= 0)
+      || fail ("marpa_g_rule_new", expr_g);
+    marpa_g_rule_rank_set (expr_g, R_expr_term, 1);
+    marpa_g_simple_precompute (expr_g, S_expr);
+    r = marpa_r_new (expr_g);
+    if (!r)
+      fail("marpa_r_new", expr_g);
+    if (!marpa_r_start_input (r))
+      fail("marpa_r_start_input", expr_g);
+    for (op_ix = 0; op_ix <= 5; op_ix++)
+      {
+        if (op_ix > 0)
+          {
+            marpa_r_alternative (r, S_op, 1, 1);
+            marpa_r_earleme_complete (r);
+          }
+        marpa_r_alternative (r, S_num, 1, 1);
+        marpa_r_earleme_complete (r);
+      }
+    expr_b = marpa_b_new (r, -1);
+    if (!expr_b)
+      fail("marpa_b_new", expr_g);
+    for (high_rank_only = 0; high_rank_only <= 1; high_rank_only++)
+      {
+        Marpa_Order eager_o = marpa_o_new (expr_b);
+        Marpa_Order lazy_o = marpa_o_new (expr_b);
+        marpa_o_high_rank_only_set (eager_o, high_rank_only);
+        marpa_o_high_rank_only_set (lazy_o, high_rank_only);
+        marpa_o_rank (eager_o);
+        marpa_o_lazy_rank (lazy_o);
+        tree_counts[high_rank_only] = trees_compare (eager_o, lazy_o);
+        step_counts[high_rank_only] = steps_compare (eager_o, lazy_o);
+        marpa_o_unref (eager_o);
+        marpa_o_unref (lazy_o);
+      }
+    ok (tree_counts[0] == 394 && step_counts[0] == 394
+      && tree_counts[1] == 1 && step_counts[1] == 1,
+      "marpa_o_lazy_rank() gives the trees and steps of marpa_o_rank()");
+    marpa_b_unref (expr_b);
+    marpa_r_unref (r);
+    marpa_g_unref (expr_g);
+  }
+
   return 0;
 }
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2015 Jeffrey Kegler
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* A stress test for grammars shared among threads.
+ * One precomputed grammar is shared,
+ * and each thread parses many short documents with it,
+ * with its own recognizers,
+ * reading its recognizers' events,
+ * counting the parses, and provoking errors,
+ * while other threads are doing the same.
+ * Every thread must get the same results as a single
+ * thread does.
+ * Usage: threads [thread_count [document_count [document_length]]]
+ * Build it with -pthread.
+ * Running it under the thread sanitizer is the best check.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "marpa.h"
+
+static int
+fail (const char *s, Marpa_Grammar g)
+{
+  const char *error_string;
+  Marpa_Error_Code errcode = marpa_g_error (g, &error_string);
+  printf ("%s returned %d: %s\n", s, errcode, error_string);
+  exit (1);
+}
+
+Marpa_Grammar g;
+Marpa_Symbol_ID S_list;
+Marpa_Symbol_ID S_item;
+Marpa_Symbol_ID S_rest;
+Marpa_Symbol_ID S_E;
+Marpa_Symbol_ID S_a;
+Marpa_Symbol_ID S_plus;
+
+int document_count;
+int document_length;
+
+struct results
+{
+  long event_count;
+  long parse_count;
+  long step_count;
+  long error_count;
+};
+
+/* Each document is a list of items,
+   and each item is the ambiguous expression "a + a + a".
+ */
+static void
+parse_document (struct results *results)
+{
+  int item_ix;
+  int token_ix;
+  int rc;
+  Marpa_Event event;
+  Marpa_Bocage b;
+  Marpa_Order o;
+  Marpa_Tree t;
+  Marpa_Grammar my_g = marpa_g_ref (g);
+  Marpa_Recognizer r = marpa_r_new (my_g);
+  if (!r)
+    fail ("marpa_r_new", my_g);
+  if (!marpa_r_start_input (r))
+    fail ("marpa_r_start_input", my_g);
+  for (item_ix = 0; item_ix < document_length; item_ix++)
+    {
+      for (token_ix = 0; token_ix < 5; token_ix++)
+        {
+          int event_ix;
+          int event_count;
+          const Marpa_Symbol_ID token = token_ix % 2 ? S_plus : S_a;
+          if (marpa_r_alternative (r, token, 1, 1) != MARPA_ERR_NONE)
+            fail ("marpa_r_alternative", my_g);
+          event_count = marpa_r_earleme_complete (r);
+          if (event_count < 0)
+            fail ("marpa_r_earleme_complete", my_g);
+          if (marpa_r_event_count (r) != event_count)
+            fail ("marpa_r_event_count", my_g);
+          for (event_ix = 0; event_ix < event_count; event_ix++)
+            {
+              if (marpa_r_event (r, &event, event_ix) < 0)
+                fail ("marpa_r_event", my_g);
+              if (marpa_g_event_value (&event) == S_item)
+                results->event_count++;
+            }
+          /* An error, to be seen only by this thread */
+          if (marpa_r_event (r, &event, -1) != -2
+              || marpa_g_error (my_g, NULL) != MARPA_ERR_EVENT_IX_NEGATIVE)
+            fail ("marpa_r_event", my_g);
+          results->error_count++;
+          marpa_g_error_clear (my_g);
+        }
+    }
+  b = marpa_b_new (r, -1);
+  if (!b)
+    fail ("marpa_b_new", my_g);
+  o = marpa_o_new (b);
+  if (!o)
+    fail ("marpa_o_new", my_g);
+  t = marpa_t_new (o);
+  if (!t)
+    fail ("marpa_t_new", my_g);
+  while ((rc = marpa_t_next (t)) >= 0)
+    {
+      Marpa_Value v = marpa_v_new (t);
+      if (!v)
+        fail ("marpa_v_new", my_g);
+      while (marpa_v_step (v) != MARPA_STEP_INACTIVE)
+        results->step_count++;
+      marpa_v_unref (v);
+      results->parse_count++;
+    }
+  if (rc != -1)
+    fail ("marpa_t_next", my_g);
+  marpa_t_unref (t);
+  marpa_o_unref (o);
+  marpa_b_unref (b);
+  marpa_r_unref (r);
+  marpa_g_unref (my_g);
+}
+
+static void *
+parse_documents (void *p_results)
+{
+  int document_ix;
+  for (document_ix = 0; document_ix < document_count; document_ix++)
+    parse_document ((struct results *) p_results);
+  return NULL;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const int thread_count = argc > 1 ? atoi (argv[1]) : 8;
+  int thread_ix;
+  struct results expected = { 0, 0, 0, 0 };
+  struct results *results;
+  pthread_t *threads;
+
+  Marpa_Config marpa_configuration;
+  Marpa_Symbol_ID rhs[3];
+
+  document_count = argc > 2 ? atoi (argv[2]) : 200;
+  document_length = argc > 3 ? atoi (argv[3]) : 4;
+
+  marpa_c_init (&marpa_configuration);
+  g = marpa_g_new (&marpa_configuration);
+  if (!g)
+    {
+      const char *error_string;
+      Marpa_Error_Code errcode =
+        marpa_c_error (&marpa_configuration, &error_string);
+      printf ("marpa_g_new returned %d: %s", errcode, error_string);
+      exit (1);
+    }
+  (marpa_g_force_valued (g) >= 0) || fail ("marpa_g_force_valued", g);
+
+  ((S_list = marpa_g_symbol_new (g)) >= 0) || fail ("marpa_g_symbol_new", g);
+  ((S_item = marpa_g_symbol_new (g)) >= 0) || fail ("marpa_g_symbol_new", g);
+  ((S_rest = marpa_g_symbol_new (g)) >= 0) || fail ("marpa_g_symbol_new", g);
+  ((S_E = marpa_g_symbol_new (g)) >= 0) || fail ("marpa_g_symbol_new", g);
+  ((S_a = marpa_g_symbol_new (g)) >= 0) || fail ("marpa_g_symbol_new", g);
+  ((S_plus = marpa_g_symbol_new (g)) >= 0) || fail ("marpa_g_symbol_new", g);
+
+  /* list ::= item rest | item; rest ::= list;
+     item ::= E; E ::= E + E | a.
+     The right recursion through |rest|, with its completion events,
+     makes the recognizer create CIL's of its own. */
+  rhs[0] = S_list;
+  (marpa_g_rule_new (g, S_rest, rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  rhs[0] = S_item;
+  rhs[1] = S_rest;
+  (marpa_g_rule_new (g, S_list, rhs, 2) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  (marpa_g_rule_new (g, S_list, rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  rhs[0] = S_E;
+  (marpa_g_rule_new (g, S_item, rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  rhs[0] = S_E;
+  rhs[1] = S_plus;
+  rhs[2] = S_E;
+  (marpa_g_rule_new (g, S_E, rhs, 3) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  rhs[0] = S_a;
+  (marpa_g_rule_new (g, S_E, rhs, 1) >= 0)
+    || fail ("marpa_g_rule_new", g);
+  (marpa_g_symbol_is_completion_event_set (g, S_rest, 1) >= 0)
+    || fail ("marpa_g_symbol_is_completion_event_set", g);
+  (marpa_g_symbol_is_completion_event_set (g, S_list, 1) >= 0)
+    || fail ("marpa_g_symbol_is_completion_event_set", g);
+  (marpa_g_symbol_is_completion_event_set (g, S_item, 1) >= 0)
+    || fail ("marpa_g_symbol_is_completion_event_set", g);
+
+  (marpa_g_start_symbol_set (g, S_list) >= 0)
+    || fail ("marpa_g_start_symbol_set", g);
+  (marpa_g_precompute (g) >= 0) || fail ("marpa_g_precompute", g);
+  (marpa_g_share (g) >= 0) || fail ("marpa_g_share", g);
+
+  parse_documents (&expected);
+
+  results = calloc ((size_t) thread_count, sizeof (*results));
+  threads = calloc ((size_t) thread_count, sizeof (*threads));
+  for (thread_ix = 0; thread_ix < thread_count; thread_ix++)
+    {
+      if (pthread_create
+          (threads + thread_ix, NULL, parse_documents, results + thread_ix))
+        {
+          printf ("pthread_create failed\n");
+          exit (1);
+        }
+    }
+  for (thread_ix = 0; thread_ix < thread_count; thread_ix++)
+    {
+      pthread_join (threads[thread_ix], NULL);
+    }
+  for (thread_ix = 0; thread_ix < thread_count; thread_ix++)
+    {
+      const struct results *actual = results + thread_ix;
+      if (actual->event_count != expected.event_count
+          || actual->parse_count != expected.parse_count
+          || actual->step_count != expected.step_count
+          || actual->error_count != expected.error_count)
+        {
+          printf ("thread %d: %ld events, %ld parses, %ld steps,"
+                  " %ld errors; expected %ld, %ld, %ld, %ld\n",
+                  thread_ix, actual->event_count, actual->parse_count,
+                  actual->step_count, actual->error_count,
+                  expected.event_count, expected.parse_count,
+                  expected.step_count, expected.error_count);
+          exit (1);
+        }
+    }
+  printf ("%d threads, %d documents each: %ld events, %ld parses\n",
+          thread_count, document_count,
+          expected.event_count, expected.parse_count);
+  marpa_g_unref (g);
+  free (threads);
+  free (results);
+  return 0;
+}
@@ -440,6 +440,9 @@ int marpa__default_debug_handler (const char *format, ...)
 #undef      MAX
 #define MAX(a, b)  (((a) > (b)) ? (a) : (b))
 
+#undef      MIN
+#define MIN(a, b)  (((a) < (b)) ? (a) : (b))
+
 #undef      CLAMP
 #define CLAMP(x, low, high)  (((x) > (high)) ? (high) : (((x) < (low)) ? (low) : (x)))
 
@@ -470,6 +473,40 @@ int marpa__default_debug_handler (const char *format, ...)
 # define alignof(type) (offsetof (struct { char __slot1; type __slot2; }, __slot2))
 #endif
 
+@ Atomic counters, pointers and thread-local storage,
+for objects which are shared among threads.
+Where the compiler offers neither,
+|MARPA_HAS_THREADS| is 0,
+the counters are ordinary increments and decrements,
+and objects must not be shared.
+|MARPA_ATOMIC_CAS| sets |lvalue| to |desired| if it is |expected|,
+and otherwise sets |expected| to |lvalue|.
+It is true if it set |lvalue|.
+@<Internal macros@> =
+#if defined(__GNUC__) \
+  && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#  define MARPA_HAS_THREADS 1
+#  define MARPA_ATOMIC_INC(lvalue) \
+     (__atomic_add_fetch (&(lvalue), 1, __ATOMIC_RELAXED))
+#  define MARPA_ATOMIC_DEC(lvalue) \
+     (__atomic_sub_fetch (&(lvalue), 1, __ATOMIC_ACQ_REL))
+#  define MARPA_ATOMIC_LOAD(lvalue) \
+     (__atomic_load_n (&(lvalue), __ATOMIC_ACQUIRE))
+#  define MARPA_ATOMIC_CAS(lvalue, expected, desired) \
+     (__atomic_compare_exchange_n (&(lvalue), &(expected), (desired), 0, \
+       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+#  define MARPA_THREAD_LOCAL __thread
+#else
+#  define MARPA_HAS_THREADS 0
+#  define MARPA_ATOMIC_INC(lvalue) (++(lvalue))
+#  define MARPA_ATOMIC_DEC(lvalue) (--(lvalue))
+#  define MARPA_ATOMIC_LOAD(lvalue) (lvalue)
+#  define MARPA_ATOMIC_CAS(lvalue, expected, desired) \
+     ((lvalue) == (expected) \
+       ? ((lvalue) = (desired), 1) : ((expected) = (lvalue), 0))
+#  define MARPA_THREAD_LOCAL
+#endif
+
 @** Internal typdefs.
 @<Internal typedefs@> =
 typedef unsigned int BITFIELD;
@@ -0,0 +1,69 @@
+#!perl
+# Copyright 2015 Jeffrey Kegler
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+# OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+# ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+# OTHER DEALINGS IN THE SOFTWARE.
+
+# Writes a C file which compiles a grammar image,
+# as written by marpa_g_serialize(), into an application.
+# The C file defines name_specialization,
+# for use with marpa_r_new_specialized().
+
+use 5.010;
+use strict;
+use warnings;
+use English qw( -no_match_vars );
+
+sub usage {
+    say STDERR "usage: $PROGRAM_NAME name <grammar_image >name.c";
+    exit 1;
+}
+
+usage() if scalar @ARGV != 1;
+my $name = $ARGV[0];
+usage() if $name !~ m/\A [[:alpha:]_] \w* \z/xms;
+
+binmode STDIN;
+my $image = do { local $RS = undef; <STDIN> };
+die "$PROGRAM_NAME: empty grammar image\n"
+    if not defined $image or length $image == 0;
+my @bytes = unpack 'C*', $image;
+
+print <<"END_OF_PREAMBLE";
+/* Generated by image2c.pl from a Libmarpa grammar image.
+ * Do not edit.
+ * Generate it again whenever Libmarpa is changed.
+ */
+
+#include "marpa.h"
+
+static const unsigned char ${name}_image[] = {
+END_OF_PREAMBLE
+
+while ( my @line = splice @bytes, 0, 12 ) {
+    say q{  }, join q{ }, map { sprintf '0x%02x,', $_ } @line;
+}
+
+print <<"END_OF_POSTAMBLE";
+};
+
+Marpa_Specialization ${name}_specialization = {
+  "${name}", ${name}_image, sizeof (${name}_image), NULL
+};
+END_OF_POSTAMBLE
+
+# vim: expandtab shiftwidth=4:
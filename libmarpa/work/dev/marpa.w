@@ -680,12 +680,209 @@ Marpa_Grammar marpa_g_new (Marpa_Config* configuration)
    return g;
 }
 
+@*0 Cloning a grammar.
+A clone is a new grammar, not precomputed,
+with the same symbols, rules and zero-width assertions
+as |g|,
+and with the same ID's,
+to which the application can go on to add more.
+|g| may be precomputed, and is usually a base grammar,
+to be extended in several different ways.
+Only what the application specified is copied.
+Everything found by the precomputation is left to the
+precomputation of the clone,
+which reuses what it can of the precomputation of |g|,
+if |g| is precomputed.
+\par
+The clone is built with the same logic as
+the application used to build |g|,
+so that the clone's rule duplication tree and its
+derived symbol flags, such as ``is LHS'', are
+set up exactly as they would be.
+None of this logic can fail,
+because it did not fail for |g|.
+@<Function definitions@> =
+Marpa_Grammar
+marpa_g_clone (Marpa_Grammar g)
+{
+  @<Return |NULL| on failure@>@;
+  GRAMMAR clone;
+  @<Fail if fatal error@>@;
+  clone = marpa_g_new (NULL);
+  Default_Rank_of_G (clone) = Default_Rank_of_G (g);
+  clone->t_force_valued = g->t_force_valued;
+  G_has_Prediction_States (clone) = G_has_Prediction_States (g);
+  @<Clone the symbols of |g|@>@;
+  @<Clone the rules of |g|@>@;
+  @<Clone the ZWA's of |g|@>@;
+  if (g->t_start_xsy_id >= 0)
+    {
+      marpa_g_start_symbol_set (clone, g->t_start_xsy_id);
+    }
+  if (G_is_Precomputed (g))
+    {
+      Base_of_G (clone) = grammar_ref (g);
+    }
+  return clone;
+}
+
+@ Whether a symbol is a terminal is only copied
+if it was set by the application.
+Otherwise it is left for the precomputation to decide.
+@<Clone the symbols of |g|@> =
+{
+  XSYID xsy_id;
+  for (xsy_id = 0; xsy_id < XSY_Count_of_G (g); xsy_id++)
+    {
+      const XSY xsy = XSY_by_ID (xsy_id);
+      const XSY clone_xsy = symbol_new (clone);
+      Rank_of_XSY (clone_xsy) = Rank_of_XSY (xsy);
+      XSY_is_Valued (clone_xsy) = XSY_is_Valued (xsy);
+      XSY_is_Valued_Locked (clone_xsy) = XSY_is_Valued_Locked (xsy);
+      if (XSY_is_Locked_Terminal (xsy))
+        {
+          XSY_is_Locked_Terminal (clone_xsy) = 1;
+          XSY_is_Terminal (clone_xsy) = XSY_is_Terminal (xsy);
+        }
+      XSY_is_Completion_Event (clone_xsy) = XSY_is_Completion_Event (xsy);
+      XSY_Completion_Event_Starts_Active (clone_xsy) =
+        XSY_Completion_Event_Starts_Active (xsy);
+      XSY_is_Nulled_Event (clone_xsy) = XSY_is_Nulled_Event (xsy);
+      XSY_Nulled_Event_Starts_Active (clone_xsy) =
+        XSY_Nulled_Event_Starts_Active (xsy);
+      XSY_is_Prediction_Event (clone_xsy) = XSY_is_Prediction_Event (xsy);
+      XSY_Prediction_Event_Starts_Active (clone_xsy) =
+        XSY_Prediction_Event_Starts_Active (xsy);
+    }
+}
+
+@ @<Clone the rules of |g|@> =
+{
+  XRLID xrl_id;
+  for (xrl_id = 0; xrl_id < XRL_Count_of_G (g); xrl_id++)
+    {
+      const XRL xrl = XRL_by_ID (xrl_id);
+      XRLID clone_xrl_id;
+      if (XRL_is_Sequence (xrl))
+        {
+          const int flags =
+            (xrl->t_is_discard ? 0 : MARPA_KEEP_SEPARATION)
+            | (XRL_is_Proper_Separation (xrl) ? MARPA_PROPER_SEPARATION : 0);
+          clone_xrl_id =
+            marpa_g_sequence_new (clone, LHS_ID_of_XRL (xrl),
+                                  RHS_ID_of_XRL (xrl, 0),
+                                  Separator_of_XRL (xrl),
+                                  Minimum_of_XRL (xrl), flags);
+        }
+      else
+        {
+          clone_xrl_id =
+            marpa_g_rule_new (clone, LHS_ID_of_XRL (xrl),
+                              xrl->t_symbols + 1, Length_of_XRL (xrl));
+        }
+      MARPA_ASSERT (clone_xrl_id == xrl_id);
+      marpa_g_rule_rank_set (clone, clone_xrl_id, Rank_of_XRL (xrl));
+      marpa_g_rule_null_high_set (clone, clone_xrl_id,
+                                  Null_Ranks_High_of_RULE (xrl));
+    }
+}
+
+@ The placements are copied from the ZWP tree of |g|.
+@<Clone the ZWA's of |g|@> =
+{
+  ZWAID zwaid;
+  MARPA_AVL_TRAV traverser;
+  ZWP zwp;
+  for (zwaid = 0; zwaid < ZWA_Count_of_G (g); zwaid++)
+    {
+      marpa_g_zwa_new (clone, Default_Value_of_GZWA (GZWA_by_ID (zwaid)));
+    }
+  traverser = _marpa_avl_t_init (g->t_zwp_tree);
+  for (zwp = _marpa_avl_t_first (traverser); zwp;
+       zwp = _marpa_avl_t_next (traverser))
+    {
+      const ZWP clone_zwp = marpa_obs_new (clone->t_obs, ZWP_Object, 1);
+      *clone_zwp = *zwp;
+      _marpa_avl_insert (clone->t_zwp_tree, clone_zwp);
+    }
+}
+
+@*0 The base of a clone.
+A clone of a precomputed grammar keeps a reference to it,
+its {\bf base}, until the clone is precomputed.
+The symbols and rules of the base are those of the clone
+with the same ID's, and the clone may only have more of them.
+Its precomputation reuses the closures of the base
+over the external symbols,
+and finds again only the rows that the added rules can change.
+See |reach_rows_keep()|.
+The internal grammar is not reused,
+because the CHAF rewrite numbers the internal symbols
+and rules of the clone differently.
+@d Base_of_G(g) ((g)->t_base)
+@<Widely aligned grammar elements@> = GRAMMAR t_base;
+@ @<Initialize grammar elements@> =
+Base_of_G (g) = NULL;
+@ @<Destroy grammar elements@> =
+base_release (g);
+@ The base is released as soon as it is no longer needed,
+so that a clone does not keep a large base grammar
+in memory for all of its life.
+@<Function definitions@> =
+PRIVATE void
+base_release (GRAMMAR g)
+{
+  if (Base_of_G (g))
+    {
+      grammar_unref (Base_of_G (g));
+      Base_of_G (g) = NULL;
+    }
+}
+
+@ The nullification CIL's of every precomputed grammar
+are kept, but the symbol reach relation is large,
+and is only kept in a grammar which the application
+says will be the base of clones.
+Even then, it is not kept in a grammar image.
+@d G_is_Clone_Base(g) ((g)->t_is_clone_base)
+@d Symbol_Reach_of_G(g) ((g)->t_symbol_reach)
+@<Bit aligned grammar elements@> = BITFIELD t_is_clone_base:1;
+@ @<Widely aligned grammar elements@> = CIL* t_symbol_reach;
+@ @<Initialize grammar elements@> =
+g->t_is_clone_base = 0;
+Symbol_Reach_of_G (g) = NULL;
+@ @<Function definitions@> =
+int
+marpa_g_clone_base (Marpa_Grammar g)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return G_is_Clone_Base (g);
+}
+
+int
+marpa_g_clone_base_set (Marpa_Grammar g, int value)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  @<Fail if precomputed@>@;
+  if (_MARPA_UNLIKELY (value < 0 || value > 1))
+    {
+      MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+      return failure_indicator;
+    }
+  return G_is_Clone_Base (g) = value ? 1 : 0;
+}
+
 @*0 Reference counting and destructors.
 @ @<Int aligned grammar elements@>= int t_ref_count;
 @ @<Initialize grammar elements@> =
 g->t_ref_count = 1;
 
 @ Decrement the grammar reference count.
+The count is changed atomically,
+so that recognizers in several threads
+may reference and unreference a shared grammar.
 GNU practice seems to be to return |void|,
 and not the reference count.
 True, that would be mainly useful to help
@@ -698,8 +895,7 @@ void
 grammar_unref (GRAMMAR g)
 {
   MARPA_ASSERT (g->t_ref_count > 0)
-  g->t_ref_count--;
-  if (g->t_ref_count <= 0)
+  if (MARPA_ATOMIC_DEC (g->t_ref_count) <= 0)
     {
       grammar_free(g);
     }
@@ -714,7 +910,7 @@ PRIVATE GRAMMAR
 grammar_ref (GRAMMAR g)
 {
   MARPA_ASSERT(g->t_ref_count > 0)
-  g->t_ref_count++;
+  MARPA_ATOMIC_INC (g->t_ref_count);
   return g;
 }
 Marpa_Grammar
@@ -729,6 +925,46 @@ void grammar_free(GRAMMAR g)
     my_free(g);
 }
 
+@*0 Sharing a grammar among threads.
+A precomputed grammar may be shared,
+so that recognizers in different threads can use it
+at the same time.
+Once shared, the grammar is never written to by
+its recognizers, or by their bocages, orders, trees and valuators,
+except for its atomic reference count,
+and except that a fatal error is fatal in every thread.
+Each recognizer of a shared grammar keeps its own event queue,
+and its own CIL arena,
+and errors go to a per-thread error code.
+Sharing cannot be undone.
+@d G_is_Shared(g) ((g)->t_is_shared)
+@<Bit aligned grammar elements@> = BITFIELD t_is_shared:1;
+@ @<Initialize grammar elements@> =
+g->t_is_shared = 0;
+@ @<Function definitions@> =
+int
+marpa_g_share (Marpa_Grammar g)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  @<Fail if not precomputed@>@;
+  if (_MARPA_UNLIKELY (!MARPA_HAS_THREADS))
+    {
+      MARPA_ERROR (MARPA_ERR_NO_THREADS);
+      return failure_indicator;
+    }
+  G_is_Shared (g) = 1;
+  return 1;
+}
+@ @<Function definitions@> =
+int
+marpa_g_is_shared (Marpa_Grammar g)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return G_is_Shared (g);
+}
+
 @*0 The grammar's symbol list.
 This lists the symbols for the grammar,
 with their
@@ -989,6 +1225,17 @@ can tell if there is a boolean vector to be freed.
 @<Widely aligned grammar elements@> = Bit_Vector t_bv_nsyid_is_terminal;
 @ @<Initialize grammar elements@> = g->t_bv_nsyid_is_terminal = NULL;
 
+@*0 Leo postdot boolean vector.
+A boolean vector, with bits set if the symbol is the postdot
+symbol of some AHM on which a Leo item can be based.
+In an Earley set, only these symbols can have a Leo item,
+and only these symbols can be the transition symbol to
+a predecessor Leo item.
+Like the terminal boolean vector,
+it cannot be sized at grammar initialization.
+@<Widely aligned grammar elements@> = Bit_Vector t_bv_nsyid_is_leo_postdot;
+@ @<Initialize grammar elements@> = g->t_bv_nsyid_is_leo_postdot = NULL;
+
 @*0 Event boolean vectors.
 A boolean vector, with bits set if there is an event
 on completion of a rule with that symbol on the LHS.
@@ -1053,25 +1300,28 @@ but it must be written to before another event
 is added,
 because that may cause
 the locations of |MARPA_DSTACK| elements to change.
+The events go to the stack |events|,
+which is either the grammar's,
+or that of a recognizer.
 @d G_EVENTS_CLEAR(g) MARPA_DSTACK_CLEAR((g)->t_events)
-@d G_EVENT_PUSH(g) MARPA_DSTACK_PUSH((g)->t_events, GEV_Object)
+@d EVENT_PUSH(events) MARPA_DSTACK_PUSH(*(events), GEV_Object)
 @ @<Function definitions@> =
 PRIVATE
-void event_new(GRAMMAR g, int type)
+void event_new(MARPA_DSTACK events, int type)
 {
     @t}\comment{@>
   /* may change base of dstack */
-  GEV end_of_stack = G_EVENT_PUSH(g);
+  GEV end_of_stack = EVENT_PUSH(events);
   end_of_stack->t_type = type;
   end_of_stack->t_value = 0;
 }
 @ @<Function definitions@> =
 PRIVATE
-void int_event_new(GRAMMAR g, int type, int value)
+void int_event_new(MARPA_DSTACK events, int type, int value)
 {
   /* may change base of dstack */
     @t}\comment{@>
-  GEV end_of_stack = G_EVENT_PUSH(g);
+  GEV end_of_stack = EVENT_PUSH(events);
   end_of_stack->t_type = type;
   end_of_stack->t_value =  value;
 }
@@ -1224,8 +1474,10 @@ if it is non=fatal.
 @<Function definitions@> =
 Marpa_Error_Code marpa_g_error(Marpa_Grammar g, const char** p_error_string)
 {
-    const Marpa_Error_Code error_code = g->t_error;
-    const char* error_string = g->t_error_string;
+    const Marpa_Error_Code error_code =
+      G_is_Shared (g) && IS_G_OK (g) ? shared_error : g->t_error;
+    const char* error_string =
+      G_is_Shared (g) && IS_G_OK (g) ? shared_error_string : g->t_error_string;
     if (p_error_string) {
        *p_error_string = error_string;
     }
@@ -1236,8 +1488,7 @@ Marpa_Error_Code marpa_g_error(Marpa_Grammar g, const char** p_error_string)
 Marpa_Error_Code
 marpa_g_error_clear (Marpa_Grammar g)
 {
-  clear_error (g);
-  return g->t_error;
+  return clear_error (g);
 }
 
 @** Symbol (XSY) code.
@@ -2042,6 +2293,47 @@ is the LHS.
 @<Widely aligned NSY elements@> = CIL t_lhs_cil;
 @ @<Initialize NSY elements@> = LHS_CIL_of_NSY(nsy) = NULL;
 
+@*0 Predicted AHM CIL.
+A CIL which records the prediction AHM's
+which are added to an Earley set
+when this NSY is postdot.
+It is the closure of the predictions,
+and so contains the first AHM of every IRL
+which this NSY predicts, directly or indirectly.
+@ The first LHS AHM is the prediction AHM of the first IRL
+with this NSY on its LHS,
+or |-1| if this NSY is not on the LHS of any IRL.
+If it has been predicted,
+every AHM in this NSY's predicted AHM CIL
+has been as well.
+@d Predicted_AHM_CIL_of_NSY(nsy) ((nsy)->t_predicted_ahm_cil)
+@d First_LHS_AHMID_of_NSY(nsy) ((nsy)->t_first_lhs_ahmid)
+@<Widely aligned NSY elements@> = CIL t_predicted_ahm_cil;
+@ @<Int aligned NSY elements@> = AHMID t_first_lhs_ahmid;
+@ @<Initialize NSY elements@> =
+  Predicted_AHM_CIL_of_NSY(nsy) = NULL;
+  First_LHS_AHMID_of_NSY(nsy) = -1;
+
+@*0 Prediction state CILs.
+These CIL's are only populated if the grammar
+has prediction states.
+They are described with the prediction states.
+@d Predicted_NSY_CIL_of_NSY(nsy) ((nsy)->t_predicted_nsy_cil)
+@d Immediate_AHM_CIL_of_NSY(nsy) ((nsy)->t_immediate_ahm_cil)
+@d Deferred_Postdot_CIL_of_NSY(nsy) ((nsy)->t_deferred_postdot_cil)
+@d Deferred_AHM_CIL_of_NSY(nsy) ((nsy)->t_deferred_ahm_cil)
+@d Deferred_AHM_CIL_of_NSYID(nsyid) Deferred_AHM_CIL_of_NSY(NSY_by_ID(nsyid))
+@<Widely aligned NSY elements@> =
+  CIL t_predicted_nsy_cil;
+  CIL t_immediate_ahm_cil;
+  CIL t_deferred_postdot_cil;
+  CIL t_deferred_ahm_cil;
+@ @<Initialize NSY elements@> =
+  Predicted_NSY_CIL_of_NSY(nsy) = NULL;
+  Immediate_AHM_CIL_of_NSY(nsy) = NULL;
+  Deferred_Postdot_CIL_of_NSY(nsy) = NULL;
+  Deferred_AHM_CIL_of_NSY(nsy) = NULL;
+
 @*0 Semantic XSY.
 Set if the internal symbol is semantically visible
 externally.
@@ -3191,6 +3483,7 @@ int marpa_g_precompute(Marpa_Grammar g)
     @t}\comment{@>
     /* After this point, errors are not recoverable */
 
+    @<Start the precompute stats@>@;
     @<Clear rule duplication tree@>@;
 
     @t}\comment{@>
@@ -3198,7 +3491,9 @@ int marpa_g_precompute(Marpa_Grammar g)
     { /* Scope with only external grammar */
         @<Declare census variables@>@;
         @<Perform census of grammar |g|@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_CENSUS);
         @<Detect cycles@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_CYCLES);
     }
 
     @t}\comment{@>
@@ -3208,7 +3503,9 @@ int marpa_g_precompute(Marpa_Grammar g)
     @<Rewrite grammar |g| into CHAF form@>@;
     @<Augment grammar |g|@>@;
     post_census_xsy_count = XSY_Count_of_G(g);
+    PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_REWRITE);
     @<Populate the event boolean vectors@>@;
+    PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_EVENTS);
 
     @t}\comment{@>
     /* Phase 3: memoize the internal grammar */
@@ -3217,16 +3514,28 @@ int marpa_g_precompute(Marpa_Grammar g)
         memoizations@>@;
         @<Calculate Rule by LHS lists@>@;
         @<Create AHMs@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_AHMS);
         @<Construct prediction matrix@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_PREDICTIONS);
         @<Construct right derivation matrix@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_RIGHT_DERIVATIONS);
         @<Populate the predicted IRL CIL's in the AHM's@>
+        @<Populate the predicted AHM CIL's in the NSY's@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_PREDICTIONS);
         @<Populate the terminal boolean vector@>@;
+        @<Populate the Leo trailheads and postdot boolean vector@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_RIGHT_DERIVATIONS);
+        if (G_has_Prediction_States (g))
+          prediction_states_populate (g);
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_PREDICTIONS);
         @<Populate the prediction
           and nulled symbol CILs@>@;
         @<Mark the event AHMs@>@;
         @<Calculate AHM Event Group Sizes@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_EVENTS);
         @<Find the direct ZWA's for each AHM@>@;
         @<Find the indirect ZWA's for each AHM's@>@;
+        PRECOMPUTE_PHASE_END(MARPA_PRECOMPUTE_PHASE_ZWAS);
     }
     g->t_is_precomputed = 1;
     if (g->t_has_cycle)
@@ -3240,6 +3549,8 @@ int marpa_g_precompute(Marpa_Grammar g)
     FAILURE:;
     goto CLEANUP;
     CLEANUP:;
+    if (G_is_Precomputed (g))
+      base_release (g);
     marpa_obs_free (obs_precompute);
     return return_value;
 }
@@ -3250,11 +3561,258 @@ A large allocation may be required in the grammar, which
 thereafter would be wasted space.
 @<Reinitialize the CILAR@> =
 { cilar_buffer_reinit(&g->t_cilar); }
-@ {\bf To Do}: @^To Do@>
-Perhaps someday there should be a CILAR for each recognizer.
-This probably is an issue to be dealt with,
-when adding the ability
-to clone grammars.
+@ The recognizers of a shared grammar each have a CILAR
+of their own,
+as an overlay on the grammar's.
+Other recognizers intern their CIL's in the grammar's CILAR.
+
+@*0 Precompute statistics.
+On request, the precomputation records, for each of its phases,
+the time it took,
+the memory in use at its end,
+the sizes of the relations it closed,
+and the number of grammar elements at its end.
+This is meant to find out why a large grammar is
+slow to precompute,
+and costs a few clock readings when it is turned on,
+and nothing when it is not.
+\par
+Some phases are done in more than one piece,
+and their statistics are the totals for all their pieces.
+The Leo trailheads and the terminal boolean vector
+are counted with the right derivations,
+and the predicted IRL and AHM CIL's,
+and the prediction states,
+with the predictions.
+\par
+The memory is that of the grammar's obstacks,
+its CILAR,
+and the obstack used only during the precomputation.
+These only grow while the precomputation is running,
+so the memory at the end of a phase is the most
+used up to that point,
+and the growth of the memory in each phase
+adds up to the most used by the precomputation.
+Memory which is obtained directly with |malloc()|,
+such as that for the AHM's, is not included.
+@d G_is_Collecting_Precompute_Stats(g) ((g)->t_is_collecting_precompute_stats)
+@d Precompute_Stats_of_G(g) ((g)->t_precompute_stats)
+@<Public defines@> =
+#define MARPA_PRECOMPUTE_PHASE_CENSUS 0
+#define MARPA_PRECOMPUTE_PHASE_CYCLES 1
+#define MARPA_PRECOMPUTE_PHASE_REWRITE 2
+#define MARPA_PRECOMPUTE_PHASE_AHMS 3
+#define MARPA_PRECOMPUTE_PHASE_PREDICTIONS 4
+#define MARPA_PRECOMPUTE_PHASE_RIGHT_DERIVATIONS 5
+#define MARPA_PRECOMPUTE_PHASE_EVENTS 6
+#define MARPA_PRECOMPUTE_PHASE_ZWAS 7
+#define MARPA_PRECOMPUTE_PHASE_COUNT 8
+@ @<Public structures@> =
+struct marpa_precompute_stats {
+     const char *t_name;
+     double t_seconds;
+     size_t t_obstack_size;
+     size_t t_obstack_growth;
+     size_t t_matrix_count;
+     size_t t_matrix_entry_count;
+     int t_xsy_count;
+     int t_nsy_count;
+     int t_irl_count;
+     int t_ahm_count;
+};
+typedef struct marpa_precompute_stats Marpa_Precompute_Stats;
+
+@ @<Global constant variables@> =
+static const char *const precompute_phase_names[MARPA_PRECOMPUTE_PHASE_COUNT] = {
+  "census",
+  "cycles",
+  "rewrite",
+  "AHMs",
+  "predictions",
+  "right derivations",
+  "events",
+  "zero-width assertions"
+};
+
+@ The statistics are only allocated if they are collected.
+@<Bit aligned grammar elements@> = BITFIELD t_is_collecting_precompute_stats:1;
+@ @<Widely aligned grammar elements@> =
+Marpa_Precompute_Stats* t_precompute_stats;
+@ @<Initialize grammar elements@> =
+g->t_is_collecting_precompute_stats = 0;
+g->t_precompute_stats = NULL;
+
+@ The precompute meter keeps the time
+at which the current phase started,
+and the memory in use then,
+and counts the relations closed since then.
+The relations are counted whether or not statistics are
+collected, because that is cheaper than testing whether
+to count them.
+@d PRECOMPUTE_REACH_COUNT(reach)
+  (precompute_meter.t_matrix_count++,
+  precompute_meter.t_matrix_entry_count +=
+    (size_t) Entry_Count_of_REACH(reach))
+@d PRECOMPUTE_PHASE_END(phase)
+  (G_is_Collecting_Precompute_Stats(g) ?
+    precompute_phase_end(g, obs_precompute, &precompute_meter, (phase)) :
+    (void)0)
+@<Private structures@> =
+struct s_precompute_meter {
+  double t_start;
+  size_t t_obstack_size;
+  size_t t_matrix_count;
+  size_t t_matrix_entry_count;
+};
+@ @<Declare precompute variables@> =
+struct s_precompute_meter precompute_meter;
+
+@ @<Start the precompute stats@> =
+{
+  precompute_meter.t_matrix_count = 0;
+  precompute_meter.t_matrix_entry_count = 0;
+  if (G_is_Collecting_Precompute_Stats (g))
+    {
+      int phase;
+      Marpa_Precompute_Stats *stats = Precompute_Stats_of_G (g);
+      if (!stats)
+        {
+          stats = Precompute_Stats_of_G (g) =
+            marpa_obs_new (g->t_obs, Marpa_Precompute_Stats,
+                           MARPA_PRECOMPUTE_PHASE_COUNT);
+        }
+      for (phase = 0; phase < MARPA_PRECOMPUTE_PHASE_COUNT; phase++)
+        {
+          precompute_stats_clear (stats + phase, phase);
+        }
+      precompute_meter.t_start = precompute_clock ();
+      precompute_meter.t_obstack_size =
+        precompute_obstack_size (g, obs_precompute);
+    }
+}
+
+@ The time is wall time,
+if the system has a monotonic clock,
+and processor time if it does not.
+@<Function definitions@> =
+PRIVATE double
+precompute_clock (void)
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec now;
+  if (clock_gettime (CLOCK_MONOTONIC, &now) == 0)
+    {
+      return (double) now.tv_sec + (double) now.tv_nsec / 1.0e9;
+    }
+#endif
+  return (double) clock () / (double) CLOCKS_PER_SEC;
+}
+
+@ @<Function definitions@> =
+PRIVATE size_t
+precompute_obstack_size (GRAMMAR g, struct marpa_obstack *obs_precompute)
+{
+  return marpa__obs_size (obs_precompute) + marpa__obs_size (g->t_obs) +
+    marpa__obs_size (g->t_xrl_obs) + marpa__obs_size (g->t_cilar.t_obs);
+}
+
+@ @<Function definitions@> =
+PRIVATE void
+precompute_stats_clear (Marpa_Precompute_Stats * stats, int phase)
+{
+  stats->t_name = precompute_phase_names[phase];
+  stats->t_seconds = 0.0;
+  stats->t_obstack_size = 0;
+  stats->t_obstack_growth = 0;
+  stats->t_matrix_count = 0;
+  stats->t_matrix_entry_count = 0;
+  stats->t_xsy_count = 0;
+  stats->t_nsy_count = 0;
+  stats->t_irl_count = 0;
+  stats->t_ahm_count = 0;
+}
+
+@ Add the time and the relations since the last phase ended
+to |phase|,
+and start the next phase.
+@<Function definitions@> =
+PRIVATE void
+precompute_phase_end (GRAMMAR g, struct marpa_obstack *obs_precompute,
+                      struct s_precompute_meter *meter, int phase)
+{
+  Marpa_Precompute_Stats *const stats = Precompute_Stats_of_G (g) + phase;
+  const double now = precompute_clock ();
+  const size_t obstack_size = precompute_obstack_size (g, obs_precompute);
+  stats->t_seconds += now - meter->t_start;
+  stats->t_obstack_size = obstack_size;
+  stats->t_obstack_growth += obstack_size - meter->t_obstack_size;
+  stats->t_matrix_count += meter->t_matrix_count;
+  stats->t_matrix_entry_count += meter->t_matrix_entry_count;
+  stats->t_xsy_count = XSY_Count_of_G (g);
+  stats->t_nsy_count = NSY_Count_of_G (g);
+  stats->t_irl_count = IRL_Count_of_G (g);
+  stats->t_ahm_count = AHM_Count_of_G (g);
+  meter->t_matrix_count = 0;
+  meter->t_matrix_entry_count = 0;
+  meter->t_start = now;
+  meter->t_obstack_size = obstack_size;
+}
+
+@ Returns 1 if the grammar will collect precompute statistics,
+0 if not,
+and |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_g_precompute_stats_collect (Marpa_Grammar g)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return G_is_Collecting_Precompute_Stats (g);
+}
+
+@ The setting only matters when the grammar is precomputed,
+so it may be changed at any time.
+@<Function definitions@> =
+int
+marpa_g_precompute_stats_collect_set (Marpa_Grammar g, int value)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  if (_MARPA_UNLIKELY (value < 0 || value > 1))
+    {
+      MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+      return failure_indicator;
+    }
+  return G_is_Collecting_Precompute_Stats (g) = value ? 1 : 0;
+}
+
+@ If no statistics were collected,
+the phase's name is filled in, and the rest is zeroed.
+@<Function definitions@> =
+int
+marpa_g_precompute_stats (Marpa_Grammar g, int phase,
+                          Marpa_Precompute_Stats * stats)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  if (_MARPA_UNLIKELY (!stats))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  if (_MARPA_UNLIKELY (phase < 0 || phase >= MARPA_PRECOMPUTE_PHASE_COUNT))
+    {
+      MARPA_ERROR (MARPA_ERR_INVALID_PRECOMPUTE_PHASE);
+      return failure_indicator;
+    }
+  if (!Precompute_Stats_of_G (g))
+    {
+      precompute_stats_clear (stats, phase);
+      return 0;
+    }
+  *stats = Precompute_Stats_of_G (g)[phase];
+  return 1;
+}
 
 @** The grammar census.
 
@@ -3547,7 +4105,7 @@ RULEID** xrl_list_x_lh_sym = NULL;
           if (_MARPA_UNLIKELY(xsy->t_is_counted))
             {
               counted_nullables++;
-              int_event_new (g, MARPA_EVENT_COUNTED_NULLABLE, xsy_id);
+              int_event_new (&g->t_events, MARPA_EVENT_COUNTED_NULLABLE, xsy_id);
             }
         }
     }
@@ -3589,9 +4147,8 @@ if (_MARPA_UNLIKELY(!bv_bit_test(productive_v, start_xsy_id)))
 Bit_Vector productive_v = NULL;
 Bit_Vector nullable_v = NULL;
 
-@ The reach matrix is the an $n\times n$ matrix,
-where $n$ is the number of symbols.
-Bit $(i,j)$ is set in the reach matrix if and only if
+@ The reach relation is over the symbols.
+Symbol $j$ is in row $i$ of the reach relation if and only if
 symbol $i$ can reach symbol $j$.
 \par
 This logic could be put earlier, and a child array
@@ -3610,18 +4167,26 @@ where many of the right hand sides repeat symbols.
 @<Calculate reach matrix@> =
 {
   XRLID rule_id;
-  reach_matrix =
-    matrix_obs_create (obs_precompute, pre_census_xsy_count,
-		       pre_census_xsy_count);
+  const GRAMMAR base = Base_of_G (g);
+  XRLID base_xrl_count = 0;
+  reach_init (&symbol_reach, obs_precompute, pre_census_xsy_count);
+  if (base && Symbol_Reach_of_G (base))
+    {
+      base_xrl_count = XRL_Count_of_G (base);
+      reach_rows_keep (&symbol_reach, Symbol_Reach_of_G (base),
+                       MIN (XSY_Count_of_G (base), pre_census_xsy_count));
+    }
   for (rule_id = 0; rule_id < xrl_count; rule_id++)
     {
       XRL rule = XRL_by_ID (rule_id);
       XSYID lhs_id = LHS_ID_of_RULE (rule);
       int rhs_ix;
       int rule_length = Length_of_XRL (rule);
+      if (rule_id >= base_xrl_count)
+        reach_vertex_change (&symbol_reach, lhs_id);
       for (rhs_ix = 0; rhs_ix < rule_length; rhs_ix++)
 	{
-	  matrix_bit_set (reach_matrix,
+	  reach_edge_add (&symbol_reach,
 			  lhs_id,
 			  RHS_ID_of_RULE (rule, rhs_ix));
 	}
@@ -3630,34 +4195,48 @@ where many of the right hand sides repeat symbols.
 	  const XSYID separator_id = Separator_of_XRL (rule);
 	  if (separator_id >= 0)
 	    {
-	      matrix_bit_set (reach_matrix,
+	      reach_edge_add (&symbol_reach,
 			      lhs_id,
 			      separator_id);
 	    }
 	}
     }
-  transitive_closure (reach_matrix);
+  reach_close (&symbol_reach);
+  PRECOMPUTE_REACH_COUNT (&symbol_reach);
+  if (G_is_Clone_Base (g))
+    {
+      XSYID xsy_id;
+      Symbol_Reach_of_G (g) =
+        marpa_obs_new (g->t_obs, CIL, pre_census_xsy_count);
+      for (xsy_id = 0; xsy_id < pre_census_xsy_count; xsy_id++)
+        {
+          Symbol_Reach_of_G (g)[xsy_id] =
+            cil_add (&g->t_cilar, Row_of_REACH (&symbol_reach, xsy_id));
+        }
+    }
 }
 
-@ @<Declare precompute variables@> =
-Bit_Matrix reach_matrix = NULL;
+@ The symbol reach relation is sparse, and is kept as a |REACH|.
+In a clone, the rows of the base are kept for the symbols
+which reach only symbols that no added rule has on its LHS.
+The rules of the base have the same ID's in the clone,
+so that the added rules are those with the higher ID's.
+@<Declare precompute variables@> =
+REACH_Object symbol_reach;
 
-@ |accessible_v| is a pointer into the |reach_matrix|.
+@ |accessible_cil| is a row of the |symbol_reach|,
+which is on the precompute obstack.
 Therefore there is no code to free it.
 @<Census accessible symbols@> =
 {
-  Bit_Vector accessible_v =
-    matrix_row (reach_matrix, start_xsy_id);
-  int min, max, start;
-  XSYID symid;
-  for (start = 0; bv_scan (accessible_v, start, &min, &max); start = max + 2)
+  const CIL accessible_cil = Row_of_REACH (&symbol_reach, start_xsy_id);
+  const int accessible_count = Count_of_CIL (accessible_cil);
+  int accessible_ix;
+  for (accessible_ix = 0; accessible_ix < accessible_count; accessible_ix++)
     {
-      for (symid =  min;
-           symid <=  max; symid++)
-        {
-          XSY symbol = XSY_by_ID (symid);
-          symbol->t_is_accessible = 1;
-        }
+      const XSYID symid = Item_of_CIL (accessible_cil, accessible_ix);
+      XSY symbol = XSY_by_ID (symid);
+      symbol->t_is_accessible = 1;
     }
     XSY_by_ID(start_xsy_id)->t_is_accessible = 1;
 }
@@ -3666,7 +4245,6 @@ Therefore there is no code to free it.
 reach a terminal symbol.
 @<Census nulling symbols@> =
 {
-  Bit_Vector reaches_terminal_v = bv_shadow (terminal_v);
   int nulling_terminal_found = 0;
   int min, max, start;
   for (start = 0; bv_scan (lhs_v, start, &min, &max); start = max + 2)
@@ -3675,22 +4253,31 @@ reach a terminal symbol.
       for (productive_id =  min;
            productive_id <=  max; productive_id++)
         {
-          bv_and (reaches_terminal_v, terminal_v,
-                  matrix_row (reach_matrix, productive_id));
-          if (bv_is_empty (reaches_terminal_v))
+          const CIL reach_cil = Row_of_REACH (&symbol_reach, productive_id);
+          const int reach_count = Count_of_CIL (reach_cil);
+          int reaches_terminal = 0;
+          int reach_ix;
+          for (reach_ix = 0; reach_ix < reach_count; reach_ix++)
+            {
+              if (bv_bit_test (terminal_v, Item_of_CIL (reach_cil, reach_ix)))
+                {
+                  reaches_terminal = 1;
+                  break;
+                }
+            }
+          if (!reaches_terminal)
             {
               const XSY symbol = XSY_by_ID (productive_id);
               XSY_is_Nulling (symbol) = 1;
               if (_MARPA_UNLIKELY (XSY_is_Terminal (symbol)))
                 {
                   nulling_terminal_found = 1;
-                  int_event_new (g, MARPA_EVENT_NULLING_TERMINAL,
+                  int_event_new (&g->t_events, MARPA_EVENT_NULLING_TERMINAL,
                                  productive_id);
                 }
             }
         }
     }
-  bv_free (reaches_terminal_v);
   if (_MARPA_UNLIKELY (nulling_terminal_found))
     {
       MARPA_ERROR (MARPA_ERR_NULLING_TERMINAL);
@@ -3856,22 +4443,27 @@ Change so that this runs only if there are prediction events.
   /* Use this to make sure we have enough CILAR buffer space */
   int nullable_xsy_count = 0;
 
-    @t}\comment{@>
-   /* This matrix is large and very temporary,
-   so it does not go on the obstack */
-  void* matrix_buffer = my_malloc(matrix_sizeof(
-     pre_census_xsy_count,
-                       pre_census_xsy_count));
-  Bit_Matrix nullification_matrix =
-    matrix_buffer_create (matrix_buffer, pre_census_xsy_count,
-                       pre_census_xsy_count);
+  REACH_Object nullification_reach;
+  const GRAMMAR base = Base_of_G (g);
+  const XSYID base_xsy_count =
+    base ? MIN (XSY_Count_of_G (base), pre_census_xsy_count) : 0;
+  const XRLID base_xrl_count = base ? XRL_Count_of_G (base) : 0;
+  reach_init (&nullification_reach, obs_precompute, pre_census_xsy_count);
+  if (base)
+    {
+      @<Keep the nullification CILs of the base@>@;
+    }
 
   for (xsyid = 0; xsyid < pre_census_xsy_count; xsyid++)
     {                           /* Every nullable symbol symbol nullifies itself */
+      if (xsyid < base_xsy_count
+          && XSY_is_Nullable (XSY_of_Base (xsyid)) !=
+          XSYID_is_Nullable (xsyid))
+        reach_vertex_change (&nullification_reach, xsyid);
       if (!XSYID_is_Nullable (xsyid))
         continue;
       nullable_xsy_count++;
-      matrix_bit_set (nullification_matrix, xsyid,
+      reach_edge_add (&nullification_reach, xsyid,
                       xsyid);
     }
   for (xrlid = 0; xrlid < xrl_count; xrlid++)
@@ -3879,25 +4471,48 @@ Change so that this runs only if there are prediction events.
       int rh_ix;
       XRL xrl = XRL_by_ID (xrlid);
       const XSYID lhs_id = LHS_ID_of_XRL (xrl);
+      if (xrlid >= base_xrl_count
+          || XRL_is_Nullable (XRL_of_Base (xrlid)) != XRL_is_Nullable (xrl))
+        reach_vertex_change (&nullification_reach, lhs_id);
       if (XRL_is_Nullable (xrl))
         {
           for (rh_ix = 0; rh_ix < Length_of_XRL (xrl); rh_ix++)
             {
               const XSYID rhs_id = RHS_ID_of_XRL (xrl, rh_ix);
-              matrix_bit_set (nullification_matrix, lhs_id,
+              reach_edge_add (&nullification_reach, lhs_id,
                               rhs_id);
             }
         }
     }
-  transitive_closure (nullification_matrix);
+  reach_close (&nullification_reach);
+  PRECOMPUTE_REACH_COUNT (&nullification_reach);
   for (xsyid = 0; xsyid < pre_census_xsy_count; xsyid++)
     {
-      Bit_Vector bv_nullifications_by_to_xsy =
-        matrix_row (nullification_matrix, xsyid);
       Nulled_XSYIDs_of_XSYID (xsyid) =
-        cil_bv_add(&g->t_cilar, bv_nullifications_by_to_xsy);
+        cil_add (&g->t_cilar, Row_of_REACH (&nullification_reach, xsyid));
+    }
+}
+
+@ In a clone, the nullification CIL's of the base are kept
+for the symbols which do not reach a change.
+A change is a rule that was added,
+or a symbol or rule of the base
+whose nullability is not the same in the clone.
+Adding rules only makes more symbols and rules nullable,
+but this logic does not depend on that.
+The nullification CIL's are kept in every precomputed grammar,
+including grammars loaded from an image.
+@d XSY_of_Base(xsyid) (*MARPA_DSTACK_INDEX (base->t_xsy_stack, XSY, (xsyid)))
+@d XRL_of_Base(xrlid) (*MARPA_DSTACK_INDEX (base->t_xrl_stack, XRL, (xrlid)))
+@<Keep the nullification CILs of the base@> =
+{
+  CIL *const base_rows =
+    marpa_obs_new (obs_precompute, CIL, MAX (base_xsy_count, 1));
+  for (xsyid = 0; xsyid < base_xsy_count; xsyid++)
+    {
+      base_rows[xsyid] = Nulled_XSYIDs_of_XSY (XSY_of_Base (xsyid));
     }
-    my_free(matrix_buffer);
+  reach_rows_keep (&nullification_reach, base_rows, base_xsy_count);
 }
 
 @** The sequence rewrite.
@@ -4703,16 +5318,16 @@ loop rule count, with the final tally.
 @<Detect cycles@> =
 {
     int loop_rule_count = 0;
-    Bit_Matrix unit_transition_matrix =
-        matrix_obs_create (obs_precompute, xrl_count,
-            xrl_count);
-    @<Mark direct unit transitions in |unit_transition_matrix|@>@;
-    transitive_closure(unit_transition_matrix);
+    REACH_Object unit_transition_reach;
+    reach_init (&unit_transition_reach, obs_precompute, xrl_count);
+    @<Mark direct unit transitions in |unit_transition_reach|@>@;
+    reach_close (&unit_transition_reach);
+    PRECOMPUTE_REACH_COUNT (&unit_transition_reach);
     @<Mark loop rules@>@;
     if (loop_rule_count)
       {
         g->t_has_cycle = 1;
-        int_event_new (g, MARPA_EVENT_LOOP_RULES, loop_rule_count);
+        int_event_new (&g->t_events, MARPA_EVENT_LOOP_RULES, loop_rule_count);
       }
 }
 
@@ -4721,7 +5336,7 @@ but not trivial ones.
 That is, bit |(x,x)| is not set true in advance.
 In other words, for this purpose,
 unit transitions are not in general reflexive.
-@<Mark direct unit transitions in |unit_transition_matrix|@> =
+@<Mark direct unit transitions in |unit_transition_reach|@> =
 {
   Marpa_Rule_ID rule_id;
   for (rule_id = 0; rule_id < xrl_count; rule_id++)
@@ -4749,7 +5364,7 @@ unit transitions are not in general reflexive.
           /* If exactly one RHS symbol is non-nullable, it is a unit transition,
              and the only one for this rule */
 	  @<For |nonnullable_id|, set to-,
-          from-rule bit in |unit_transition_matrix|@>@;
+          from-rule edge in |unit_transition_reach|@>@;
 	}
       else if (nonnullable_count == 0)
 	{
@@ -4767,7 +5382,7 @@ unit transitions are not in general reflexive.
               @t}\comment{@>
 	      /* If here, |nonnullable_id| is a proper nullable */
 	      @<For |nonnullable_id|, set to-,
-              from-rule bit in |unit_transition_matrix|@>@;
+              from-rule edge in |unit_transition_reach|@>@;
 	    }
 	}
     }
@@ -4776,7 +5391,7 @@ unit transitions are not in general reflexive.
 @ We have a lone |nonnullable_id| in |rule_id|,
 so there is a unit transition from |rule_id| to every
 rule with |nonnullable_id| on the LHS.
-@<For |nonnullable_id|, set to-, from-rule bit in |unit_transition_matrix|@> =
+@<For |nonnullable_id|, set to-, from-rule edge in |unit_transition_reach|@> =
 {
   RULEID *p_xrl = xrl_list_x_lh_sym[nonnullable_id];
   const RULEID *p_one_past_rules = xrl_list_x_lh_sym[nonnullable_id + 1];
@@ -4785,7 +5400,7 @@ rule with |nonnullable_id| on the LHS.
       /* Direct loops ($A \RA A$) only need the $(rule_id, rule_id)$ bit set,
          but it is not clear that it is a win to special case them. */
       const RULEID to_rule_id = *p_xrl;
-      matrix_bit_set (unit_transition_matrix, rule_id,
+      reach_edge_add (&unit_transition_reach, rule_id,
                       to_rule_id);
     }
 }
@@ -4796,8 +5411,8 @@ rule with |nonnullable_id| on the LHS.
   for (rule_id = 0; rule_id < xrl_count; rule_id++)
     {
       XRL rule;
-      if (!matrix_bit_test
-          (unit_transition_matrix, rule_id,
+      if (!reach_test
+          (&unit_transition_reach, rule_id,
            rule_id))
         continue;
       loop_rule_count++;
@@ -4846,8 +5461,10 @@ involved exist.
 @ The space is allocated during precomputation.
 Because the grammar may be destroyed before precomputation,
 I test that |g->t_ahms| is non-zero.
-@ @<Initialize grammar elements@> =
+@ A trivial grammar has no AHM's.
+@<Initialize grammar elements@> =
 g->t_ahms = NULL;
+AHM_Count_of_G(g) = 0;
 @ @<Destroy grammar elements@> =
      my_free(g->t_ahms);
 
@@ -4876,6 +5493,18 @@ return item_id < (AHMID)AHM_Count_of_G(g) && item_id >= 0;
   (AHM_is_Completion(ahm) && AHM_is_Leo(ahm))
 @<Int aligned AHM elements@> = NSYID t_postdot_nsyid;
 
+@*0 Leo trailhead.
+If a Leo item can be based on an Earley item with this AHM,
+the AHM of that Leo item's trailhead.
+Otherwise, |NULL|.
+This is a fact about the grammar,
+and it is found once, at precomputation,
+so that the recognizer does not repeat the tests
+in every Earley set.
+@d Leo_Trailhead_AHM_of_AHM(ahm) ((ahm)->t_leo_trailhead_ahm)
+@<Widely aligned AHM elements@> =
+    AHM t_leo_trailhead_ahm;
+
 @*0 Leading nulls.
 In libmarpa's AHM's, the dot position is never in front
 of a nulling symbol.  (Due to rewriting, every nullable symbol
@@ -4936,6 +5565,8 @@ so the emphasis is on what precedes the dot position.
 @ @d SYMI_Count_of_G(g) ((g)->t_symbol_instance_count)
 @<Int aligned grammar elements@> =
 int t_symbol_instance_count;
+@ @<Initialize grammar elements@> =
+SYMI_Count_of_G(g) = 0;
 @ @d SYMI_of_IRL(irl) ((irl)->t_symbol_instance_base)
 @d Last_Proper_SYMI_of_IRL(irl) ((irl)->t_last_proper_symi)
 @d SYMI_of_Completed_IRL(irl)
@@ -5104,6 +5735,7 @@ Marpa_Symbol_ID _marpa_g_ahm_postdot(Marpa_Grammar g,
 {
   IRL_of_AHM (current_item) = irl;
   Null_Count_of_AHM (current_item) = leading_nulls;
+  Leo_Trailhead_AHM_of_AHM (current_item) = NULL;
   Quasi_Position_of_AHM (current_item) = current_item - first_ahm_of_irl;
   if (Quasi_Position_of_AHM (current_item) == 0) {
      if (ID_of_IRL(irl) == ID_of_IRL (g->t_start_irl))
@@ -5246,6 +5878,7 @@ int t_event_group_size;
 @*0 The NSY right derivation matrix.
 The NSY right derivation matrix is used in determining which
 states are Leo completions.
+It is kept in sparse form, as a |REACH|.
 The bit for the $(|nsy1|, |nsy2|)$ duple is set if and only
 if |nsy1| right derives a sentential form whose rightmost
 non-null symbol is |nsy2|.
@@ -5253,17 +5886,18 @@ Trivial derivations are included --
 the bit is set if $|nsy1| = |nsy2|$.
 
 @ @<Construct right derivation matrix@> = {
-    nsy_by_right_nsy_matrix =
-        matrix_obs_create (obs_precompute, nsy_count, nsy_count);
-    @<Initialize the |nsy_by_right_nsy_matrix| for right derivations@>@/
-    transitive_closure(nsy_by_right_nsy_matrix);
+    reach_init(&nsy_by_right_nsy_reach, obs_precompute, nsy_count);
+    @<Initialize the |nsy_by_right_nsy_reach| for right derivations@>@/
+    reach_close(&nsy_by_right_nsy_reach);
+    PRECOMPUTE_REACH_COUNT (&nsy_by_right_nsy_reach);
     @<Mark the right recursive IRLs@>@/
-    matrix_clear(nsy_by_right_nsy_matrix);
-    @<Initialize the |nsy_by_right_nsy_matrix| for right recursions@>@/
-    transitive_closure(nsy_by_right_nsy_matrix);
+    reach_init(&nsy_by_right_nsy_reach, obs_precompute, nsy_count);
+    @<Initialize the |nsy_by_right_nsy_reach| for right recursions@>@/
+    reach_close(&nsy_by_right_nsy_reach);
+    PRECOMPUTE_REACH_COUNT (&nsy_by_right_nsy_reach);
 }
 
-@ @<Initialize the |nsy_by_right_nsy_matrix| for right derivations@> =
+@ @<Initialize the |nsy_by_right_nsy_reach| for right derivations@> =
 {
   IRLID irl_id;
   for (irl_id = 0; irl_id < irl_count; irl_id++)
@@ -5279,7 +5913,7 @@ one non-nulling symbol in each IRL. */
           const NSYID rh_nsyid = RHSID_of_IRL (irl, rhs_ix);
           if (!NSY_is_Nulling (NSY_by_ID (rh_nsyid)))
             {
-              matrix_bit_set (nsy_by_right_nsy_matrix,
+              reach_edge_add (&nsy_by_right_nsy_reach,
                               LHSID_of_IRL (irl),
                               rh_nsyid);
               break;
@@ -5303,7 +5937,7 @@ one non-nulling symbol in each IRL. */
 /* Does the last non-nulling symbol right derive the LHS?
 If so, the rule is right recursive.
 (There is at least one non-nulling symbol in each IRL.) */
-              if (matrix_bit_test (nsy_by_right_nsy_matrix,
+              if (reach_test (&nsy_by_right_nsy_reach,
                                    rh_nsyid,
                                    LHSID_of_IRL (irl)))
                 {
@@ -5315,7 +5949,7 @@ If so, the rule is right recursive.
     }
 }
 
-@ @<Initialize the |nsy_by_right_nsy_matrix| for right recursions@> =
+@ @<Initialize the |nsy_by_right_nsy_reach| for right recursions@> =
 {
   IRLID irl_id;
   for (irl_id = 0; irl_id < irl_count; irl_id++)
@@ -5332,7 +5966,7 @@ one non-nulling symbol in each IRL. */
           const NSYID rh_nsyid = RHSID_of_IRL (irl, rhs_ix);
           if (!NSY_is_Nulling (NSY_by_ID (rh_nsyid)))
             {
-              matrix_bit_set (nsy_by_right_nsy_matrix,
+              reach_edge_add (&nsy_by_right_nsy_reach,
                               LHSID_of_IRL (irl),
                               rh_nsyid);
               break;
@@ -5345,8 +5979,8 @@ one non-nulling symbol in each IRL. */
         memoizations@> =
   const RULEID irl_count = IRL_Count_of_G(g);
   const NSYID nsy_count = NSY_Count_of_G(g);
-  Bit_Matrix nsy_by_right_nsy_matrix;
-   Bit_Matrix prediction_nsy_by_irl_matrix;
+  REACH_Object nsy_by_right_nsy_reach;
+  CIL *predicted_irl_cil_by_nsyid;
 
 @ Initialized based on the capacity of the XRL stack, rather
 than its length, as a convenient way to deal with issues
@@ -5364,68 +5998,85 @@ of minimum sizes.
   MARPA_DSTACK_INIT (g->t_nsy_stack, NSY, 2 * MARPA_DSTACK_CAPACITY (g->t_xsy_stack));
 }
 
-@ @<Calculate Rule by LHS lists@> =
+@ Every IRL has exactly one LHS,
+so the IRL's are sorted into per-LHS lists by counting.
+The IRL's of |lhsid| are
+|irls_by_lhs[first_irl_ix[lhsid]]| up to, but not including,
+|irls_by_lhs[first_irl_ix[lhsid+1]]|.
+They are placed in ID order, so that each list is sorted.
+@<Calculate Rule by LHS lists@> =
 {
   NSYID lhsid;
+  IRLID irl_id;
 
     @t}\comment{@>
-   /* This matrix is large and very temporary,
-   so it does not go on the obstack */
-  void* matrix_buffer = my_malloc(matrix_sizeof(
-     nsy_count, irl_count));
-  Bit_Matrix irl_by_lhs_matrix =
-        matrix_buffer_create (matrix_buffer, nsy_count, irl_count);
+   /* These arrays are very temporary,
+   so they do not go on the obstack */
+  int *const first_irl_ix = marpa_new (int, nsy_count + 1);
+  int *const next_irl_ix = marpa_new (int, nsy_count);
+  IRLID *const irls_by_lhs = marpa_new (IRLID, MAX (irl_count, 1));
 
-  IRLID irl_id;
+  for (lhsid = 0; lhsid <= nsy_count; lhsid++)
+    {
+      first_irl_ix[lhsid] = 0;
+    }
   for (irl_id = 0; irl_id < irl_count; irl_id++)
     {
-      const IRL irl = IRL_by_ID (irl_id);
-      const NSYID lhs_nsyid = LHSID_of_IRL(irl);
-      matrix_bit_set (irl_by_lhs_matrix, lhs_nsyid, irl_id);
+      first_irl_ix[LHSID_of_IRL (IRL_by_ID (irl_id)) + 1]++;
+    }
+  for (lhsid = 0; lhsid < nsy_count; lhsid++)
+    {
+      first_irl_ix[lhsid + 1] += first_irl_ix[lhsid];
+      next_irl_ix[lhsid] = first_irl_ix[lhsid];
+    }
+  for (irl_id = 0; irl_id < irl_count; irl_id++)
+    {
+      const NSYID lhs_nsyid = LHSID_of_IRL (IRL_by_ID (irl_id));
+      irls_by_lhs[next_irl_ix[lhs_nsyid]++] = irl_id;
     }
 
   @t}\comment{@>
-  /* for every LHS row of the IRL-by-LHS matrix, add
+  /* for every LHS, add
   all its IRL's to the LHS CIL */
   for (lhsid = 0; lhsid < nsy_count; lhsid++)
     {
-      IRLID irlid;
-      int min, max, start;
+      int irl_ix;
       cil_buffer_clear (&g->t_cilar);
-      for (start = 0;
-           bv_scan (matrix_row
-                    (irl_by_lhs_matrix, lhsid),
-                    start, &min, &max); start = max + 2)
+      for (irl_ix = first_irl_ix[lhsid]; irl_ix < first_irl_ix[lhsid + 1];
+           irl_ix++)
         {
-          for (irlid = min; irlid <= max; irlid++)
-          {
-            cil_buffer_push (&g->t_cilar, irlid);
-          }
+          cil_buffer_push (&g->t_cilar, irls_by_lhs[irl_ix]);
         }
       LHS_CIL_of_NSYID(lhsid) = cil_buffer_add (&g->t_cilar);
     }
 
-  my_free(matrix_buffer);
+  my_free (irls_by_lhs);
+  my_free (next_irl_ix);
+  my_free (first_irl_ix);
 
 }
 
 @*0 Predictions.
-@ For the predicted states, I construct a symbol-by-rule matrix
-of predictions.  First, I determine which symbols directly predict
-others.  Then I compute the transitive closure.
-Finally, I convert this to a symbol-by-rule matrix.
-The symbol-by-rule matrix will be used in constructing the prediction
+@ For the predicted states, I find, for each symbol,
+the rules it predicts.
+First, I determine which symbols directly predict
+others.  Then I compute the transitive closure,
+in sparse form.
+Finally, I convert this to a CIL of predicted rules for
+each symbol.
+These CIL's will be used in constructing the prediction
 states.
 
 @ @<Construct prediction matrix@> = {
-    Bit_Matrix prediction_nsy_by_nsy_matrix =
-        matrix_obs_create (obs_precompute, nsy_count, nsy_count);
-    @<Initialize the |prediction_nsy_by_nsy_matrix|@>@/
-    transitive_closure(prediction_nsy_by_nsy_matrix);
-    @<Create the prediction matrix from the symbol-by-symbol matrix@>@/
+    REACH_Object prediction_nsy_by_nsy_reach;
+    reach_init(&prediction_nsy_by_nsy_reach, obs_precompute, nsy_count);
+    @<Initialize the |prediction_nsy_by_nsy_reach|@>@/
+    reach_close(&prediction_nsy_by_nsy_reach);
+    PRECOMPUTE_REACH_COUNT (&prediction_nsy_by_nsy_reach);
+    @<Create the predicted IRL CIL's from the symbol-by-symbol closure@>@/
 }
 
-@ @<Initialize the |prediction_nsy_by_nsy_matrix|@> =
+@ @<Initialize the |prediction_nsy_by_nsy_reach|@> =
 {
   IRLID irl_id;
   NSYID nsyid;
@@ -5434,7 +6085,7 @@ states.
       /* If a symbol appears on a LHS, it predicts itself. */
       NSY nsy = NSY_by_ID (nsyid);
       if (!NSY_is_LHS(nsy)) continue;
-      matrix_bit_set (prediction_nsy_by_nsy_matrix, nsyid,
+      reach_edge_add (&prediction_nsy_by_nsy_reach, nsyid,
                 nsyid);
     }
   for (irl_id = 0; irl_id < irl_count; irl_id++)
@@ -5449,56 +6100,51 @@ states.
         continue;
       /* Set a bit in the matrix */
       from_nsyid = LHS_NSYID_of_AHM (item);
-      matrix_bit_set (prediction_nsy_by_nsy_matrix,
+      reach_edge_add (&prediction_nsy_by_nsy_reach,
         from_nsyid,
         to_nsyid);
     }
 }
 
-@ At this point I have a full matrix showing which symbol implies a prediction
+@ At this point I have the closure showing which symbol implies a prediction
 of which others.  To save repeated processing when creating the prediction Earley
 items,
-I now convert it into a matrix from symbols to the rules they predict.
+I now convert it into a CIL, for each symbol, of the rules it predicts.
 Specifically, if symbol |S1| predicts symbol |S2|, then symbol |S1|
 predicts every rule
 with |S2| on its LHS.
-@<Create the prediction matrix from the symbol-by-symbol matrix@> = {
-    @<Populate the prediction matrix@>@/
-}
-
-@ @<Populate the prediction matrix@> =
+Every IRL has only one LHS,
+so that the LHS CIL's of the predicted symbols never overlap.
+They are simply concatenated, and then sorted.
+@<Create the predicted IRL CIL's from the symbol-by-symbol closure@> =
 {
   NSYID from_nsyid;
-  prediction_nsy_by_irl_matrix =
-    matrix_obs_create (obs_precompute, nsy_count,
-                       irl_count);
+  predicted_irl_cil_by_nsyid = marpa_obs_new (obs_precompute, CIL, nsy_count);
   for (from_nsyid = 0; from_nsyid < nsy_count; from_nsyid++)
     {
-      @t}\comment{@>
-      /* for every row of the symbol-by-symbol matrix */
-      int min, max, start;
-      for (start = 0;
-           bv_scan (matrix_row
-                    (prediction_nsy_by_nsy_matrix, from_nsyid),
-                    start, &min, &max); start = max + 2)
+      const CIL predicted_nsy_cil =
+        Row_of_REACH (&prediction_nsy_by_nsy_reach, from_nsyid);
+      const int predicted_nsy_count = Count_of_CIL (predicted_nsy_cil);
+      int predicted_nsy_ix;
+      CIL irl_cil;
+      cil_buffer_clear (&g->t_cilar);
+      for (predicted_nsy_ix = 0; predicted_nsy_ix < predicted_nsy_count;
+           predicted_nsy_ix++)
         {
-          NSYID to_nsyid;
-
-          @t}\comment{@>
-          /* for every predicted symbol */
-          for (to_nsyid = min; to_nsyid <= max; to_nsyid++)
+          const NSYID to_nsyid =
+            Item_of_CIL (predicted_nsy_cil, predicted_nsy_ix);
+          const CIL lhs_cil = LHS_CIL_of_NSYID (to_nsyid);
+          const int cil_count = Count_of_CIL (lhs_cil);
+          int cil_ix;
+          for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
             {
-              int cil_ix;
-              const CIL lhs_cil = LHS_CIL_of_NSYID(to_nsyid);
-              const int cil_count = Count_of_CIL (lhs_cil);
-              for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
-              {
-                  const IRLID irlid = Item_of_CIL (lhs_cil, cil_ix);
-                  matrix_bit_set (prediction_nsy_by_irl_matrix,
-                                  from_nsyid, irlid);
-              }
+              cil_buffer_push (&g->t_cilar, Item_of_CIL (lhs_cil, cil_ix));
             }
         }
+      irl_cil = cil_buffer_reserve (&g->t_cilar, 0);
+      qsort (&Item_of_CIL (irl_cil, 0), (size_t) Count_of_CIL (irl_cil),
+             sizeof (int), int_cmp);
+      predicted_irl_cil_by_nsyid[from_nsyid] = cil_buffer_add (&g->t_cilar);
     }
 }
 
@@ -5519,43 +6165,274 @@ with |S2| on its LHS.
       else
 	{
 	  Predicted_IRL_CIL_of_AHM (ahm) =
-	    cil_bv_add (&g->t_cilar,
-			matrix_row (prediction_nsy_by_irl_matrix, postdot_nsyid));
+	    predicted_irl_cil_by_nsyid[postdot_nsyid];
 	  LHS_CIL_of_AHM (ahm) = LHS_CIL_of_NSYID(postdot_nsyid);
 	}
     }
 }
 
-@** Populating the terminal boolean vector.
-@<Populate the terminal boolean vector@> =
+@ The IRL's in each predicted IRL CIL are
+in ID order, and so are their first AHM's,
+so the resulting CIL's are sorted.
+@<Populate the predicted AHM CIL's in the NSY's@> =
 {
-  int xsy_id;
-  g->t_bv_nsyid_is_terminal = bv_obs_create (g->t_obs, nsy_count);
-  for (xsy_id = 0; xsy_id < post_census_xsy_count; xsy_id++)
+  NSYID nsyid;
+  for (nsyid = 0; nsyid < nsy_count; nsyid++)
     {
-      if (XSYID_is_Terminal (xsy_id))
+      const NSY nsy = NSY_by_ID (nsyid);
+      const CIL lhs_cil = LHS_CIL_of_NSY (nsy);
+      const CIL predicted_irl_cil = predicted_irl_cil_by_nsyid[nsyid];
+      const int predicted_irl_count = Count_of_CIL (predicted_irl_cil);
+      int predicted_irl_ix;
+      cil_buffer_clear (&g->t_cilar);
+      for (predicted_irl_ix = 0; predicted_irl_ix < predicted_irl_count;
+           predicted_irl_ix++)
         {
-          /* A terminal might have no corresponding NSY.
-            Currently that can happen if it is not accessible */
-          const NSY nsy = NSY_of_XSY (XSY_by_ID (xsy_id));
-          if (nsy)
-            {
-              bv_bit_set (g->t_bv_nsyid_is_terminal,
-                           ID_of_NSY (nsy));
-            }
+          const IRLID irlid = Item_of_CIL (predicted_irl_cil, predicted_irl_ix);
+          const AHM prediction_ahm = First_AHM_of_IRL (IRL_by_ID (irlid));
+          cil_buffer_push (&g->t_cilar, ID_of_AHM (prediction_ahm));
+        }
+      Predicted_AHM_CIL_of_NSY (nsy) = cil_buffer_add (&g->t_cilar);
+      if (Count_of_CIL (lhs_cil) > 0)
+        {
+          const IRL first_lhs_irl = IRL_by_ID (Item_of_CIL (lhs_cil, 0));
+          First_LHS_AHMID_of_NSY (nsy) =
+            ID_of_AHM (First_AHM_of_IRL (first_lhs_irl));
         }
     }
 }
 
-@** Populating the event boolean vectors.
-@<Populate the event boolean vectors@> =
+@** Prediction states.
+Most of the Earley items in a typical Earley set are predictions,
+and most predictions are never used.
+A prediction is of use only if its postdot symbol
+is later found at its Earley set,
+as a token or as the LHS of a completion.
+If its grammar has {\it prediction states},
+a recognizer may be asked to keep, for each Earley set,
+a single {\it prediction state} in place of most of its predictions.
+The idea is that of the Aycock-Horspool parser,
+which groups the LR(0) items of a prediction closure into shared
+states.
+@ The prediction state of an Earley set is the CIL
+of the NSY's whose rules it predicts.
+It is interned in the recognizer's CILAR,
+so that Earley sets with the same predictions share it.
+A deferred prediction is added to its Earley set,
+as an ordinary Earley item,
+only when the Earley set is searched for the postdot items
+of its postdot NSY.
+Everything which looks at an Earley set after that
+sees ordinary Earley items, and so the bocage needs no changes.
+@ A prediction cannot be deferred if its postdot NSY
+is the postdot NSY of a Leo base,
+because whether a Leo item is created depends on the
+number of Earley items with that postdot NSY,
+and that must be known when the Earley set is created.
+These {\it immediate} predictions are added along with
+the Earley set.
+@ The grammar's share of the work is done by the precomputation,
+which finds, for each NSY,
+\li the NSY's whose rules are predicted when it is postdot,
+\li the immediate predictions among its predicted AHM's,
+\li the postdot NSY's of the deferred predictions among them, and
+\li the prediction AHM's with it as their postdot NSY
+which can be deferred.
+\par
+All of these are found from the predicted AHM CIL's
+and the Leo postdot NSY's,
+and so they are found again when a grammar is loaded from an image,
+instead of being written into it.
+@d G_has_Prediction_States(g) ((g)->t_has_prediction_states)
+@<Bit aligned grammar elements@> = BITFIELD t_has_prediction_states:1;
+@ @<Initialize grammar elements@> =
+g->t_has_prediction_states = 0;
+
+@ Returns 1 if the grammar has prediction states,
+or will have them once it is precomputed,
+0 if not,
+and |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_g_prediction_states (Marpa_Grammar g)
 {
-  int xsyid;
-  g->t_lbv_xsyid_is_completion_event =
-    bv_obs_create (g->t_obs, post_census_xsy_count);
-  g->t_lbv_xsyid_completion_event_starts_active =
-    bv_obs_create (g->t_obs, post_census_xsy_count);
-  g->t_lbv_xsyid_is_nulled_event =
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return G_has_Prediction_States (g);
+}
+
+@ @<Function definitions@> =
+int
+marpa_g_prediction_states_set (Marpa_Grammar g, int value)
+{
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  @<Fail if precomputed@>@;
+  if (_MARPA_UNLIKELY (value < 0 || value > 1))
+    {
+      MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+      return failure_indicator;
+    }
+  return G_has_Prediction_States (g) = value ? 1 : 0;
+}
+
+@ The CILAR buffer is used,
+so its current contents will be destroyed.
+@<Function definitions@> =
+PRIVATE void
+prediction_states_populate (GRAMMAR g)
+{
+  const CILAR cilar = &g->t_cilar;
+  const NSYID nsy_count = NSY_Count_of_G (g);
+  const IRLID irl_count = IRL_Count_of_G (g);
+  const Bit_Vector bv_leo_postdot = g->t_bv_nsyid_is_leo_postdot;
+  int *const buffer = marpa_new (int, 2 * irl_count);
+  NSYID nsyid;
+  IRLID irlid;
+  @<Populate the prediction state CIL's of the NSY's@>@;
+  @<Populate the deferred AHM CIL's of the NSY's@>@;
+  my_free (buffer);
+}
+
+@ There is at most one predicted AHM for each IRL,
+so the buffer has room for the LHS of every predicted AHM
+in its first half,
+and for the postdot NSY of every one in its second half.
+@<Populate the prediction state CIL's of the NSY's@> =
+for (nsyid = 0; nsyid < nsy_count; nsyid++)
+  {
+    const NSY nsy = NSY_by_ID (nsyid);
+    const CIL predicted_ahm_cil = Predicted_AHM_CIL_of_NSY (nsy);
+    const int predicted_ahm_count = Count_of_CIL (predicted_ahm_cil);
+    int *const postdot_buffer = buffer + irl_count;
+    int postdot_count = 0;
+    int cil_ix;
+    cil_buffer_clear (cilar);
+    for (cil_ix = 0; cil_ix < predicted_ahm_count; cil_ix++)
+      {
+        const AHMID ahmid = Item_of_CIL (predicted_ahm_cil, cil_ix);
+        const AHM ahm = AHM_by_ID (ahmid);
+        const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
+        buffer[cil_ix] = LHS_NSYID_of_AHM (ahm);
+        if (postdot_nsyid < 0)
+          continue;
+        if (bv_bit_test (bv_leo_postdot, postdot_nsyid))
+          cil_buffer_push (cilar, ahmid);
+        else
+          postdot_buffer[postdot_count++] = postdot_nsyid;
+      }
+    Immediate_AHM_CIL_of_NSY (nsy) = cil_buffer_add (cilar);
+    Predicted_NSY_CIL_of_NSY (nsy) =
+      cil_ints_add (cilar, buffer, predicted_ahm_count);
+    Deferred_Postdot_CIL_of_NSY (nsy) =
+      cil_ints_add (cilar, postdot_buffer, postdot_count);
+  }
+
+@ The deferred AHM's are sorted into buckets by postdot NSY.
+The first AHM's of the IRL's are in ID order,
+so the AHM's in each bucket are as well.
+When they have been sorted,
+|start_by_nsyid[nsyid]| is the end of the bucket for |nsyid|,
+and so the start of the bucket for |nsyid+1|.
+@<Populate the deferred AHM CIL's of the NSY's@> =
+{
+  int *const start_by_nsyid = marpa_new (int, nsy_count + 1);
+  for (nsyid = 0; nsyid <= nsy_count; nsyid++)
+    {
+      start_by_nsyid[nsyid] = 0;
+    }
+  for (irlid = 0; irlid < irl_count; irlid++)
+    {
+      const AHM ahm = First_AHM_of_IRL (IRL_by_ID (irlid));
+      const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
+      if (postdot_nsyid < 0 || bv_bit_test (bv_leo_postdot, postdot_nsyid))
+        continue;
+      start_by_nsyid[postdot_nsyid + 1]++;
+    }
+  for (nsyid = 0; nsyid < nsy_count; nsyid++)
+    {
+      start_by_nsyid[nsyid + 1] += start_by_nsyid[nsyid];
+    }
+  for (irlid = 0; irlid < irl_count; irlid++)
+    {
+      const AHM ahm = First_AHM_of_IRL (IRL_by_ID (irlid));
+      const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
+      if (postdot_nsyid < 0 || bv_bit_test (bv_leo_postdot, postdot_nsyid))
+        continue;
+      buffer[start_by_nsyid[postdot_nsyid]++] = ID_of_AHM (ahm);
+    }
+  for (nsyid = 0; nsyid < nsy_count; nsyid++)
+    {
+      const int start = nsyid > 0 ? start_by_nsyid[nsyid - 1] : 0;
+      Deferred_AHM_CIL_of_NSY (NSY_by_ID (nsyid)) =
+        cil_ints_add (cilar, buffer + start, start_by_nsyid[nsyid] - start);
+    }
+  my_free (start_by_nsyid);
+}
+
+@** Populating the terminal boolean vector.
+@<Populate the terminal boolean vector@> =
+{
+  int xsy_id;
+  g->t_bv_nsyid_is_terminal = bv_obs_create (g->t_obs, nsy_count);
+  for (xsy_id = 0; xsy_id < post_census_xsy_count; xsy_id++)
+    {
+      if (XSYID_is_Terminal (xsy_id))
+        {
+          /* A terminal might have no corresponding NSY.
+            Currently that can happen if it is not accessible */
+          const NSY nsy = NSY_of_XSY (XSY_by_ID (xsy_id));
+          if (nsy)
+            {
+              bv_bit_set (g->t_bv_nsyid_is_terminal,
+                           ID_of_NSY (nsy));
+            }
+        }
+    }
+}
+
+@** Populating the Leo trailheads.
+An Earley item can be the base of a Leo item
+if its AHM is the penult of a right recursive IRL.
+The trailhead of the Leo item is the AHM which follows it,
+which is a Leo completion.
+It is the same IRL,
+so that the tests are on its two AHM's only.
+Whether the base Earley item is the only one in its Earley set
+with its postdot symbol
+is not a fact about the grammar,
+and is still tested in the recognizer.
+@<Populate the Leo trailheads and postdot boolean vector@> =
+{
+  AHMID ahm_id;
+  const int ahm_count_of_g = AHM_Count_of_G (g);
+  g->t_bv_nsyid_is_leo_postdot = bv_obs_create (g->t_obs, nsy_count);
+  for (ahm_id = 0; ahm_id < ahm_count_of_g; ahm_id++)
+    {
+      const AHM ahm = AHM_by_ID (ahm_id);
+      const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
+      AHM trailhead_ahm;
+      if (postdot_nsyid < 0)
+        continue;
+      if (!IRL_is_Leo (IRL_of_AHM (ahm)))
+        continue;
+      trailhead_ahm = Next_AHM_of_AHM (ahm);
+      if (!AHM_is_Leo_Completion (trailhead_ahm))
+        continue;
+      Leo_Trailhead_AHM_of_AHM (ahm) = trailhead_ahm;
+      bv_bit_set (g->t_bv_nsyid_is_leo_postdot, postdot_nsyid);
+    }
+}
+
+@** Populating the event boolean vectors.
+@<Populate the event boolean vectors@> =
+{
+  int xsyid;
+  g->t_lbv_xsyid_is_completion_event =
+    bv_obs_create (g->t_obs, post_census_xsy_count);
+  g->t_lbv_xsyid_completion_event_starts_active =
+    bv_obs_create (g->t_obs, post_census_xsy_count);
+  g->t_lbv_xsyid_is_nulled_event =
     bv_obs_create (g->t_obs, post_census_xsy_count);
   g->t_lbv_xsyid_nulled_event_starts_active =
     bv_obs_create (g->t_obs, post_census_xsy_count);
@@ -5592,22 +6469,25 @@ with |S2| on its LHS.
     }
 }
 
-@ @<Populate the prediction and nulled symbol CILs@> =
+@ Each of these CILs is built directly from the CILs
+it is made of, instead of being collected in a bit vector.
+A bit vector the size of the symbol set,
+cleared and scanned once per AHM,
+made this step quadratic in the size of the grammar.
+@<Populate the prediction and nulled symbol CILs@> =
 {
   AHMID ahm_id;
   const int ahm_count_of_g = AHM_Count_of_G (g);
-  const LBV bv_completion_xsyid = bv_create (post_census_xsy_count);
-  const LBV bv_prediction_xsyid = bv_create (post_census_xsy_count);
-  const LBV bv_nulled_xsyid = bv_create (post_census_xsy_count);
   const CILAR cilar = &g->t_cilar;
+  const CIL empty_cil = cil_empty (cilar);
   for (ahm_id = 0; ahm_id < ahm_count_of_g; ahm_id++)
     {
       const AHM ahm = AHM_by_ID (ahm_id);
       const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
       const IRL irl = IRL_of_AHM (ahm);
-      bv_clear (bv_completion_xsyid);
-      bv_clear (bv_prediction_xsyid);
-      bv_clear (bv_nulled_xsyid);
+      CIL completion_xsyids = empty_cil;
+      CIL prediction_xsyids = empty_cil;
+      CIL nulled_xsyids = empty_cil;
         {
           int rhs_ix;
           int raw_position = Position_of_AHM (ahm);
@@ -5621,7 +6501,7 @@ with |S2| on its LHS.
                   if (XSY_is_Completion_Event (xsy))
                     {
                       const XSYID xsyid = ID_of_XSY (xsy);
-                      bv_bit_set (bv_completion_xsyid, xsyid);
+                      completion_xsyids = cil_singleton (cilar, xsyid);
                     }
                 }
             }
@@ -5629,33 +6509,23 @@ with |S2| on its LHS.
             {
               const XSY xsy = Source_XSY_of_NSYID (postdot_nsyid);
               const XSYID xsyid = ID_of_XSY (xsy);
-              bv_bit_set (bv_prediction_xsyid, xsyid);
+              prediction_xsyids = cil_singleton (cilar, xsyid);
             }
           for (rhs_ix = raw_position - Null_Count_of_AHM (ahm);
                rhs_ix < raw_position; rhs_ix++)
             {
-              int cil_ix;
               const NSYID rhs_nsyid = RHSID_of_IRL (irl, rhs_ix);
               const XSY xsy = Source_XSY_of_NSYID (rhs_nsyid);
-              const CIL nulled_xsyids = Nulled_XSYIDs_of_XSY (xsy);
-              const int cil_count = Count_of_CIL (nulled_xsyids);
-              for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
-                {
-                  const XSYID nulled_xsyid =
-                    Item_of_CIL (nulled_xsyids, cil_ix);
-                  bv_bit_set (bv_nulled_xsyid, nulled_xsyid);
-                }
+              const CIL rhs_nulled_xsyids = Nulled_XSYIDs_of_XSY (xsy);
+              nulled_xsyids =
+                Count_of_CIL (nulled_xsyids) <= 0 ? rhs_nulled_xsyids :
+                cil_merge (cilar, nulled_xsyids, rhs_nulled_xsyids);
             }
         }
-      Completion_XSYIDs_of_AHM (ahm) =
-        cil_bv_add (cilar, bv_completion_xsyid);
-      Nulled_XSYIDs_of_AHM (ahm) = cil_bv_add (cilar, bv_nulled_xsyid);
-      Prediction_XSYIDs_of_AHM (ahm) =
-        cil_bv_add (cilar, bv_prediction_xsyid);
+      Completion_XSYIDs_of_AHM (ahm) = completion_xsyids;
+      Nulled_XSYIDs_of_AHM (ahm) = nulled_xsyids;
+      Prediction_XSYIDs_of_AHM (ahm) = prediction_xsyids;
     }
-  bv_free (bv_completion_xsyid);
-  bv_free (bv_prediction_xsyid);
-  bv_free (bv_nulled_xsyid);
 }
 
 @ @<Mark the event AHMs@> =
@@ -5674,14 +6544,40 @@ with |S2| on its LHS.
     }
 }
 
-@ @<Calculate AHM Event Group Sizes@> =
+@ The event group of a Leo completion AHM
+is every event AHM which is also a Leo completion,
+and whose LHS is right-derivable from the LHS of the Leo completion.
+\par
+Rather than test every pair of AHM's,
+we count the Leo completion event AHM's for each LHS,
+and sum these counts over the right derivation
+closure of each outer LHS.
+The sums are memoized by NSY,
+because many AHM's share an LHS.
+@<Calculate AHM Event Group Sizes@> =
 {
   const int ahm_count_of_g = AHM_Count_of_G (g);
-  AHMID outer_ahm_id;
-  for (outer_ahm_id = 0; outer_ahm_id < ahm_count_of_g; outer_ahm_id++)
+  const int nsy_count = NSY_Count_of_G (g);
+  int *const event_leo_count_by_nsyid =
+    marpa_obs_new (obs_precompute, int, nsy_count);
+  int *const group_size_by_nsyid =
+    marpa_obs_new (obs_precompute, int, nsy_count);
+  AHMID ahm_id;
+  NSYID nsyid;
+  for (nsyid = 0; nsyid < nsy_count; nsyid++)
+    {
+      event_leo_count_by_nsyid[nsyid] = 0;
+      group_size_by_nsyid[nsyid] = -1;
+    }
+  for (ahm_id = 0; ahm_id < ahm_count_of_g; ahm_id++)
+    {
+      const AHM ahm = AHM_by_ID (ahm_id);
+      if (AHM_has_Event (ahm) && AHM_is_Leo_Completion (ahm))
+        event_leo_count_by_nsyid[LHSID_of_AHM (ahm)]++;
+    }
+  for (ahm_id = 0; ahm_id < ahm_count_of_g; ahm_id++)
     {
-      AHMID inner_ahm_id;
-      const AHM outer_ahm = AHM_by_ID (outer_ahm_id);
+      const AHM outer_ahm = AHM_by_ID (ahm_id);
       /* There is no test that |outer_ahm|
          is an event AHM.
          An AHM, even if it is not itself an event AHM,
@@ -5695,28 +6591,23 @@ with |S2| on its LHS.
                                    so we are done. */
        }
       outer_nsyid = LHSID_of_AHM (outer_ahm);
-      for (inner_ahm_id = 0; inner_ahm_id < ahm_count_of_g;
-           inner_ahm_id++)
+      if (group_size_by_nsyid[outer_nsyid] < 0)
         {
-          NSYID inner_nsyid;
-          const AHM inner_ahm = AHM_by_ID (inner_ahm_id);
-          if (!AHM_has_Event (inner_ahm))
-            continue;           /* Not in the group, because it
-                                   is not an event AHM. */
-          if (!AHM_is_Leo_Completion(inner_ahm))
-            continue;           /* This AHM is not a Leo completion,
-                                   so we are done. */
-          inner_nsyid = LHSID_of_AHM (inner_ahm);
-          if (matrix_bit_test (nsy_by_right_nsy_matrix,
-                               outer_nsyid,
-                               inner_nsyid))
+          /* |outer_ahm| itself is not treated as a special case */
+          const CIL right_derivable_nsyids =
+            Row_of_REACH (&nsy_by_right_nsy_reach, outer_nsyid);
+          const int count = Count_of_CIL (right_derivable_nsyids);
+          int group_size = 0;
+          int cil_ix;
+          for (cil_ix = 0; cil_ix < count; cil_ix++)
             {
-              /* |inner_ahm == outer_ahm|
-              is not treated as special case
-              */
-              Event_Group_Size_of_AHM (outer_ahm)++;
+              group_size +=
+                event_leo_count_by_nsyid[Item_of_CIL
+                                         (right_derivable_nsyids, cil_ix)];
             }
+          group_size_by_nsyid[outer_nsyid] = group_size;
         }
+      Event_Group_Size_of_AHM (outer_ahm) += group_size_by_nsyid[outer_nsyid];
     }
 }
 
@@ -5952,139 +6843,1035 @@ the AHM itself.
     }
 }
 
-@** Recognizer (R, RECCE) code.
-@<Public incomplete structures@> =
-struct marpa_r;
-typedef struct marpa_r* Marpa_Recognizer;
-typedef Marpa_Recognizer Marpa_Recce;
-@ @<Private typedefs@> =
-typedef struct marpa_r* RECCE;
-@ @<Recognizer structure@> =
-struct marpa_r {
-    @<Widely aligned recognizer elements@>@;
-    @<Int aligned recognizer elements@>@;
-    @<Bit aligned recognizer elements@>@;
+@** Grammar image code.
+A grammar image is a copy of a precomputed grammar,
+in a form which can be written to a file or
+to shared memory, and from which a grammar can
+later be rebuilt without repeating the precomputation.
+The image contains no addresses.
+Objects point to each other in the image by ID,
+and CIL's are kept by content.
+Loading an image is a single, linear pass over it,
+which allocates the objects,
+turns the ID's back into pointers,
+and re-interns the CIL's into the new grammar's CILAR.
+\par
+The images are an exact copy of the internal structures,
+and they are only valid for the same build of Libmarpa.
+The image header records enough about the layout
+for the loader to reject images from another build,
+or with another byte order.
+The loader also checks that the image is not truncated,
+and that the ID's in it are in range,
+but it does not check the image's content any further.
+Images should be treated as trusted data.
+
+@ The magic number is the ASCII for |'MrpG'|.
+The image version should be incremented whenever the
+order of the records in an image changes.
+@d GRAMMAR_IMAGE_MAGIC 0x4d727047
+@d GRAMMAR_IMAGE_VERSION 2
+@<Private structures@> =
+struct s_grammar_image_header {
+  int t_magic;
+  int t_image_version;
+  int t_lib_version[3];
+  int t_xsy_size;
+  int t_nsy_size;
+  int t_xrl_size;
+  int t_irl_size;
+  int t_ahm_size;
+  int t_gzwa_size;
+  int t_word_size;
+  size_t t_image_size;
+  int t_xsy_count;
+  int t_nsy_count;
+  int t_xrl_count;
+  int t_irl_count;
+  int t_ahm_count;
+  int t_zwa_count;
+  XSYID t_start_xsy_id;
+  IRLID t_start_irl_id;
+  int t_external_size;
+  int t_max_rule_length;
+  Marpa_Rank t_default_rank;
+  int t_force_valued;
+  int t_symbol_instance_count;
+  int t_has_cycle;
+  int t_has_prediction_states;
 };
 
-@ The grammar must not be deallocated for the life of the
-recognizer.
-In the event of an error creating the recognizer,
-|NULL| is returned.
-@<Function definitions@> =
-Marpa_Recognizer marpa_r_new( Marpa_Grammar g )
+@ The writer is used twice.
+When it has no buffer,
+or not enough room in its buffer,
+it only finds the size of the image.
+@<Private structures@> =
+struct s_image_writer {
+  char *t_base;
+  size_t t_capacity;
+  size_t t_size;
+};
+struct s_image_reader {
+  const char *t_next;
+  size_t t_left;
+};
+
+@ @<Function definitions@> =
+PRIVATE void
+image_write (struct s_image_writer *writer, const void *data, size_t size)
 {
-    RECCE r;
-    int nsy_count;
-    int irl_count;
-    @<Return |NULL| on failure@>@;
-    @<Fail if not precomputed@>@;
-    nsy_count = NSY_Count_of_G(g);
-    irl_count = IRL_Count_of_G(g);
-    r = my_malloc(sizeof(struct marpa_r));
-    @<Initialize recognizer obstack@>@;
-    @<Initialize recognizer elements@>@;
-    @<Initialize dot PSAR@>@;
-    @<Initialize recognizer event variables@>@;
-    return r;
+  if (writer->t_base && writer->t_size + size <= writer->t_capacity)
+    {
+      memcpy (writer->t_base + writer->t_size, data, size);
+    }
+  writer->t_size += size;
 }
 
-@*0 Reference counting and destructors.
-@ @<Int aligned recognizer elements@>= int t_ref_count;
-@ @<Initialize recognizer elements@> =
-r->t_ref_count = 1;
+PRIVATE void
+image_int_write (struct s_image_writer *writer, int value)
+{
+  image_write (writer, &value, sizeof (value));
+}
 
-@ Decrement the recognizer reference count.
+@ A |NULL| CIL is written as a count of |-1|.
 @<Function definitions@> =
 PRIVATE void
-recce_unref (RECCE r)
+image_cil_write (struct s_image_writer *writer, CIL cil)
 {
-  MARPA_ASSERT (r->t_ref_count > 0)
-  r->t_ref_count--;
-  if (r->t_ref_count <= 0)
+  if (!cil)
     {
-      recce_free(r);
+      image_int_write (writer, -1);
+      return;
     }
+  image_write (writer, cil,
+               ((size_t) Count_of_CIL (cil) + 1) * sizeof (cil[0]));
 }
-void
-marpa_r_unref (Marpa_Recognizer r)
+
+@ A |NULL| boolean vector is written as a bit count of |-1|.
+@<Function definitions@> =
+PRIVATE void
+image_bv_write (struct s_image_writer *writer, Bit_Vector bv)
 {
-   recce_unref(r);
+  if (!bv)
+    {
+      image_int_write (writer, -1);
+      return;
+    }
+  image_int_write (writer, (int) BV_BITS (bv));
+  image_write (writer, bv, (size_t) BV_SIZE (bv) * sizeof (bv[0]));
 }
 
-@ Increment the recognizer reference count.
+@ The reader methods return 0 if the image is too short.
 @<Function definitions@> =
-PRIVATE
-RECCE recce_ref (RECCE r)
+PRIVATE int
+image_read (struct s_image_reader *reader, void *data, size_t size)
 {
-  MARPA_ASSERT(r->t_ref_count > 0)
-  r->t_ref_count++;
-  return r;
+  if (size > reader->t_left)
+    return 0;
+  memcpy (data, reader->t_next, size);
+  reader->t_next += size;
+  reader->t_left -= size;
+  return 1;
 }
-Marpa_Recognizer
-marpa_r_ref (Marpa_Recognizer r)
+
+@ Reads an ID, which must be |-1| or less than |limit|.
+@<Function definitions@> =
+PRIVATE int
+image_id_read (struct s_image_reader *reader, int *p_id, int limit)
 {
-   return recce_ref(r);
+  int id;
+  if (!image_read (reader, &id, sizeof (id)))
+    return 0;
+  if (id < -1 || id >= limit)
+    return 0;
+  *p_id = id;
+  return 1;
 }
 
 @ @<Function definitions@> =
-PRIVATE
-void recce_free(struct marpa_r *r)
+PRIVATE int
+image_cil_read (GRAMMAR g, struct s_image_reader *reader, CIL * p_cil)
 {
-    @<Unpack recognizer objects@>@;
-    @<Destroy recognizer elements@>@;
-    @<Destroy recognizer obstack@>@;
-    my_free( r);
+  int count;
+  int item_ix;
+  if (!image_read (reader, &count, sizeof (count)))
+    return 0;
+  if (count < 0)
+    {
+      *p_cil = NULL;
+      return 1;
+    }
+  cil_buffer_clear (&g->t_cilar);
+  for (item_ix = 0; item_ix < count; item_ix++)
+    {
+      int item;
+      if (!image_read (reader, &item, sizeof (item)))
+        return 0;
+      cil_buffer_push (&g->t_cilar, item);
+    }
+  *p_cil = cil_buffer_add (&g->t_cilar);
+  return 1;
 }
 
-@*0 Base objects.
-Initialized in |marpa_r_new|.
-@d G_of_R(r) ((r)->t_grammar)
-@<Widely aligned recognizer elements@> =
-    GRAMMAR t_grammar;
-@ @<Initialize recognizer elements@> =
+@ @<Function definitions@> =
+PRIVATE int
+image_bv_read (GRAMMAR g, struct s_image_reader *reader, Bit_Vector * p_bv)
 {
-  G_of_R(r) = g;
-  grammar_ref(g);
+  int bits;
+  Bit_Vector bv;
+  if (!image_read (reader, &bits, sizeof (bits)))
+    return 0;
+  if (bits < 0)
+    {
+      *p_bv = NULL;
+      return 1;
+    }
+  if (bv_bits_to_size (bits) > reader->t_left / sizeof (Bit_Vector_Word))
+    return 0;
+  bv = bv_obs_create (g->t_obs, bits);
+  image_read (reader, bv, (size_t) BV_SIZE (bv) * sizeof (bv[0]));
+  *p_bv = bv;
+  return 1;
 }
-@ @<Unpack recognizer objects@> =
-const GRAMMAR g = G_of_R(r);
-@ @<Destroy recognizer elements@> = grammar_unref(g);
-
-@*0 Input phase.
-The recognizer always is
-in a one of the following
-phases:
-@d R_BEFORE_INPUT 0x1
-@d R_DURING_INPUT 0x2
-@d R_AFTER_INPUT 0x3
-@<Bit aligned recognizer elements@> =
-   BITFIELD t_input_phase:2;
-@ @d Input_Phase_of_R(r) ((r)->t_input_phase)
-@ @<Initialize recognizer elements@> =
-    Input_Phase_of_R(r) = R_BEFORE_INPUT;
-
-@*0 Earley set container.
-@d First_YS_of_R(r) ((r)->t_first_earley_set)
-@s JEARLEME int
-@<Widely aligned recognizer elements@> =
-YS t_first_earley_set;
-YS t_latest_earley_set;
-JEARLEME t_current_earleme;
-@ @<Initialize recognizer elements@> =
-r->t_first_earley_set = NULL;
-r->t_latest_earley_set = NULL;
-r->t_current_earleme = -1;
 
-@*0 Current earleme.
-@d Latest_YS_of_R(r) ((r)->t_latest_earley_set)
-@d Current_Earleme_of_R(r) ((r)->t_current_earleme)
+@*0 Writing the image.
+The records follow the header in this order:
+the XSY's, the XRL's, the NSY's,
+the NSY's of the XSY's, the IRL's, the AHM's,
+the ZWA's, and the grammar's boolean vectors.
+This order allows every pointer,
+except those from the XSY's to the NSY's,
+to be resolved as soon as it is read.
+\par
+Each structure is written as a copy,
+with its pointers set to |NULL|.
+The ID's of the objects pointed to follow the structure,
+and then its CIL's.
 @<Function definitions@> =
-Marpa_Earleme marpa_r_current_earleme(Marpa_Recognizer r)
+PRIVATE void
+grammar_image_write (GRAMMAR g, struct s_image_writer *writer)
 {
-  @<Unpack recognizer objects@>@;
-  if (_MARPA_UNLIKELY(Input_Phase_of_R(r) == R_BEFORE_INPUT)) {
-      MARPA_ERROR(MARPA_ERR_RECCE_NOT_STARTED);
-      return -1;
+  struct s_grammar_image_header header;
+  const int xsy_count = XSY_Count_of_G (g);
+  const int nsy_count = NSY_Count_of_G (g);
+  const int xrl_count = XRL_Count_of_G (g);
+  const int irl_count = IRL_Count_of_G (g);
+  const int ahm_count = AHM_Count_of_G (g);
+  const int zwa_count = ZWA_Count_of_G (g);
+  @<Write the grammar image header@>@;
+  @<Write the XSY's to the grammar image@>@;
+  @<Write the XRL's to the grammar image@>@;
+  @<Write the NSY's to the grammar image@>@;
+  @<Write the XSY's NSY's to the grammar image@>@;
+  @<Write the IRL's to the grammar image@>@;
+  @<Write the AHM's to the grammar image@>@;
+  @<Write the ZWA's to the grammar image@>@;
+  @<Write the boolean vectors to the grammar image@>@;
+}
+
+@ The image size is not known until the image has been written once,
+so it is patched in afterwards.
+@<Write the grammar image header@> =
+{
+  header.t_magic = GRAMMAR_IMAGE_MAGIC;
+  header.t_image_version = GRAMMAR_IMAGE_VERSION;
+  header.t_lib_version[0] = MARPA_LIB_MAJOR_VERSION;
+  header.t_lib_version[1] = MARPA_LIB_MINOR_VERSION;
+  header.t_lib_version[2] = MARPA_LIB_MICRO_VERSION;
+  header.t_xsy_size = (int) sizeof (struct s_xsy);
+  header.t_nsy_size = (int) sizeof (struct s_nsy);
+  header.t_xrl_size = (int) sizeof (struct s_xrl);
+  header.t_irl_size = (int) sizeof (struct s_irl);
+  header.t_ahm_size = (int) sizeof (struct s_ahm);
+  header.t_gzwa_size = (int) sizeof (GZWA_Object);
+  header.t_word_size = (int) sizeof (Bit_Vector_Word);
+  header.t_image_size = 0;
+  header.t_xsy_count = xsy_count;
+  header.t_nsy_count = nsy_count;
+  header.t_xrl_count = xrl_count;
+  header.t_irl_count = irl_count;
+  header.t_ahm_count = ahm_count;
+  header.t_zwa_count = zwa_count;
+  header.t_start_xsy_id = g->t_start_xsy_id;
+  header.t_start_irl_id = G_is_Trivial (g) ? -1 : ID_of_IRL (g->t_start_irl);
+  header.t_external_size = External_Size_of_G (g);
+  header.t_max_rule_length = g->t_max_rule_length;
+  header.t_default_rank = Default_Rank_of_G (g);
+  header.t_force_valued = g->t_force_valued;
+  header.t_symbol_instance_count = SYMI_Count_of_G (g);
+  header.t_has_cycle = g->t_has_cycle;
+  header.t_has_prediction_states = G_has_Prediction_States (g);
+  image_write (writer, &header, sizeof (header));
+}
+
+@ @<Write the XSY's to the grammar image@> =
+{
+  XSYID xsy_id;
+  for (xsy_id = 0; xsy_id < xsy_count; xsy_id++)
+    {
+      const XSY xsy = XSY_by_ID (xsy_id);
+      struct s_xsy xsy_copy;
+      memcpy (&xsy_copy, xsy, sizeof (xsy_copy));
+      Nulled_XSYIDs_of_XSY (&xsy_copy) = NULL;
+      NSY_of_XSY (&xsy_copy) = NULL;
+      Nulling_NSY_of_XSY (&xsy_copy) = NULL;
+      image_write (writer, &xsy_copy, sizeof (xsy_copy));
+      image_cil_write (writer, Nulled_XSYIDs_of_XSY (xsy));
+    }
+}
+
+@ XRL's contain no pointers,
+but they vary in length,
+so each is preceded by its length.
+@<Write the XRL's to the grammar image@> =
+{
+  XRLID xrl_id;
+  for (xrl_id = 0; xrl_id < xrl_count; xrl_id++)
+    {
+      const XRL xrl = XRL_by_ID (xrl_id);
+      const int length = Length_of_XRL (xrl);
+      image_int_write (writer, length);
+      image_write (writer, xrl, offsetof (struct s_xrl, t_symbols) +
+                   ((size_t) length + 1) * sizeof (xrl->t_symbols[0]));
+    }
+}
+
+@ @<Write the NSY's to the grammar image@> =
+{
+  NSYID nsy_id;
+  for (nsy_id = 0; nsy_id < nsy_count; nsy_id++)
+    {
+      const NSY nsy = NSY_by_ID (nsy_id);
+      const XRL lhs_xrl = LHS_XRL_of_NSY (nsy);
+      struct s_nsy nsy_copy;
+      memcpy (&nsy_copy, nsy, sizeof (nsy_copy));
+      LHS_CIL_of_NSY (&nsy_copy) = NULL;
+      Predicted_AHM_CIL_of_NSY (&nsy_copy) = NULL;
+      Predicted_NSY_CIL_of_NSY (&nsy_copy) = NULL;
+      Immediate_AHM_CIL_of_NSY (&nsy_copy) = NULL;
+      Deferred_Postdot_CIL_of_NSY (&nsy_copy) = NULL;
+      Deferred_AHM_CIL_of_NSY (&nsy_copy) = NULL;
+      Source_XSY_of_NSY (&nsy_copy) = NULL;
+      LHS_XRL_of_NSY (&nsy_copy) = NULL;
+      image_write (writer, &nsy_copy, sizeof (nsy_copy));
+      image_int_write (writer, ID_of_XSY (Source_XSY_of_NSY (nsy)));
+      image_int_write (writer, lhs_xrl ? ID_of_XRL (lhs_xrl) : -1);
+      image_cil_write (writer, LHS_CIL_of_NSY (nsy));
+      image_cil_write (writer, Predicted_AHM_CIL_of_NSY (nsy));
+    }
+}
+
+@ @<Write the XSY's NSY's to the grammar image@> =
+{
+  XSYID xsy_id;
+  for (xsy_id = 0; xsy_id < xsy_count; xsy_id++)
+    {
+      const XSY xsy = XSY_by_ID (xsy_id);
+      const NSY nsy = NSY_of_XSY (xsy);
+      const NSY nulling_nsy = Nulling_NSY_of_XSY (xsy);
+      image_int_write (writer, nsy ? ID_of_NSY (nsy) : -1);
+      image_int_write (writer, nulling_nsy ? ID_of_NSY (nulling_nsy) : -1);
+    }
+}
+
+@ IRL's also vary in length.
+The fixed part of the IRL is copied,
+so that its pointers can be cleared,
+and its symbols are written directly.
+@<Write the IRL's to the grammar image@> =
+{
+  IRLID irl_id;
+  for (irl_id = 0; irl_id < irl_count; irl_id++)
+    {
+      const IRL irl = IRL_by_ID (irl_id);
+      const int length = Length_of_IRL (irl);
+      const size_t sizeof_irl_head = offsetof (struct s_irl, t_nsyid_array);
+      const XRL source_xrl = Source_XRL_of_IRL (irl);
+      const AHM first_ahm = First_AHM_of_IRL (irl);
+      IRL_Object irl_copy;
+      memcpy (&irl_copy, irl, sizeof_irl_head);
+      Source_XRL_of_IRL (&irl_copy) = NULL;
+      First_AHM_of_IRL (&irl_copy) = NULL;
+      image_int_write (writer, length);
+      image_write (writer, &irl_copy, sizeof_irl_head);
+      image_write (writer, irl->t_nsyid_array,
+                   ((size_t) length + 1) * sizeof (irl->t_nsyid_array[0]));
+      image_int_write (writer, source_xrl ? ID_of_XRL (source_xrl) : -1);
+      image_int_write (writer, first_ahm ? (int) ID_of_AHM (first_ahm) : -1);
+    }
+}
+
+@ @<Write the AHM's to the grammar image@> =
+{
+  AHMID ahm_id;
+  for (ahm_id = 0; ahm_id < ahm_count; ahm_id++)
+    {
+      const AHM ahm = AHM_by_ID (ahm_id);
+      const XRL xrl = XRL_of_AHM (ahm);
+      const AHM trailhead_ahm = Leo_Trailhead_AHM_of_AHM (ahm);
+      struct s_ahm ahm_copy;
+      memcpy (&ahm_copy, ahm, sizeof (ahm_copy));
+      IRL_of_AHM (&ahm_copy) = NULL;
+      XRL_of_AHM (&ahm_copy) = NULL;
+      Leo_Trailhead_AHM_of_AHM (&ahm_copy) = NULL;
+      Predicted_IRL_CIL_of_AHM (&ahm_copy) = NULL;
+      LHS_CIL_of_AHM (&ahm_copy) = NULL;
+      ZWA_CIL_of_AHM (&ahm_copy) = NULL;
+      Completion_XSYIDs_of_AHM (&ahm_copy) = NULL;
+      Nulled_XSYIDs_of_AHM (&ahm_copy) = NULL;
+      Prediction_XSYIDs_of_AHM (&ahm_copy) = NULL;
+      Event_AHMIDs_of_AHM (&ahm_copy) = NULL;
+      image_write (writer, &ahm_copy, sizeof (ahm_copy));
+      image_int_write (writer, IRLID_of_AHM (ahm));
+      image_int_write (writer, xrl ? ID_of_XRL (xrl) : -1);
+      image_int_write (writer,
+                       trailhead_ahm ? (int) ID_of_AHM (trailhead_ahm) : -1);
+      image_cil_write (writer, Predicted_IRL_CIL_of_AHM (ahm));
+      image_cil_write (writer, LHS_CIL_of_AHM (ahm));
+      image_cil_write (writer, ZWA_CIL_of_AHM (ahm));
+      image_cil_write (writer, Completion_XSYIDs_of_AHM (ahm));
+      image_cil_write (writer, Nulled_XSYIDs_of_AHM (ahm));
+      image_cil_write (writer, Prediction_XSYIDs_of_AHM (ahm));
+      image_cil_write (writer, Event_AHMIDs_of_AHM (ahm));
+    }
+}
+
+@ @<Write the ZWA's to the grammar image@> =
+{
+  ZWAID zwa_id;
+  for (zwa_id = 0; zwa_id < zwa_count; zwa_id++)
+    {
+      image_write (writer, GZWA_by_ID (zwa_id), sizeof (GZWA_Object));
+    }
+}
+
+@ @<Write the boolean vectors to the grammar image@> =
+{
+  image_bv_write (writer, g->t_bv_nsyid_is_terminal);
+  image_bv_write (writer, g->t_bv_nsyid_is_leo_postdot);
+  image_bv_write (writer, g->t_lbv_xsyid_is_completion_event);
+  image_bv_write (writer, g->t_lbv_xsyid_completion_event_starts_active);
+  image_bv_write (writer, g->t_lbv_xsyid_is_nulled_event);
+  image_bv_write (writer, g->t_lbv_xsyid_nulled_event_starts_active);
+  image_bv_write (writer, g->t_lbv_xsyid_is_prediction_event);
+  image_bv_write (writer, g->t_lbv_xsyid_prediction_event_starts_active);
+}
+
+@ The image is written into |buffer|,
+if it is not |NULL|
+and the size pointed to by |p_size| is large enough.
+In any case, on success,
+the image size is returned in |*p_size|.
+Returns 1 if the image was written,
+0 if it was not.
+@<Function definitions@> =
+int
+marpa_g_serialize (Marpa_Grammar g, void *buffer, size_t * p_size)
+{
+  @<Return |-2| on failure@>@;
+  struct s_image_writer writer;
+  @<Fail if fatal error@>@;
+  @<Fail if not precomputed@>@;
+  if (_MARPA_UNLIKELY (!p_size))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  writer.t_base = NULL;
+  writer.t_capacity = 0;
+  writer.t_size = 0;
+  grammar_image_write (g, &writer);
+  if (!buffer || writer.t_size > *p_size)
+    {
+      *p_size = writer.t_size;
+      return 0;
+    }
+  writer.t_base = buffer;
+  writer.t_capacity = *p_size;
+  writer.t_size = 0;
+  grammar_image_write (g, &writer);
+  ((struct s_grammar_image_header *) buffer)->t_image_size = writer.t_size;
+  *p_size = writer.t_size;
+  return 1;
+}
+
+@*0 Loading the image.
+@ The grammar is created in the ordinary way,
+and then populated from the image.
+On failure,
+the partially loaded grammar is destroyed,
+and the error is reported in the configuration,
+as for |marpa_g_new|.
+@<Function definitions@> =
+Marpa_Grammar
+marpa_g_load (Marpa_Config * configuration, const void *image, size_t size)
+{
+  GRAMMAR g = marpa_g_new (configuration);
+  if (!g)
+    return NULL;
+  if (!image || !grammar_image_load (g, image, size))
+    {
+      grammar_unref (g);
+      if (configuration)
+        configuration->t_error = MARPA_ERR_BAD_GRAMMAR_IMAGE;
+      return NULL;
+    }
+  return g;
+}
+
+@ Returns 1 on success, 0 if the image is bad.
+@<Function definitions@> =
+PRIVATE int
+grammar_image_load (GRAMMAR g, const void *image, size_t size)
+{
+  struct s_image_reader reader;
+  struct s_grammar_image_header header;
+  int xsy_count, nsy_count, xrl_count, irl_count, ahm_count, zwa_count;
+  reader.t_next = image;
+  reader.t_left = size;
+  @<Read the grammar image header@>@;
+  @<Read the XSY's from the grammar image@>@;
+  @<Read the XRL's from the grammar image@>@;
+  @<Read the NSY's from the grammar image@>@;
+  @<Read the XSY's NSY's from the grammar image@>@;
+  @<Read the IRL's from the grammar image@>@;
+  @<Read the AHM's from the grammar image@>@;
+  @<Read the ZWA's from the grammar image@>@;
+  @<Read the boolean vectors from the grammar image@>@;
+  if (reader.t_left != 0)
+    return 0;
+  @<Finish the grammar loaded from the image@>@;
+  return 1;
+}
+
+@ @<Read the grammar image header@> =
+{
+  if (!image_read (&reader, &header, sizeof (header)))
+    return 0;
+  if (header.t_magic != GRAMMAR_IMAGE_MAGIC
+      || header.t_image_version != GRAMMAR_IMAGE_VERSION
+      || header.t_lib_version[0] != MARPA_LIB_MAJOR_VERSION
+      || header.t_lib_version[1] != MARPA_LIB_MINOR_VERSION
+      || header.t_lib_version[2] != MARPA_LIB_MICRO_VERSION
+      || header.t_xsy_size != (int) sizeof (struct s_xsy)
+      || header.t_nsy_size != (int) sizeof (struct s_nsy)
+      || header.t_xrl_size != (int) sizeof (struct s_xrl)
+      || header.t_irl_size != (int) sizeof (struct s_irl)
+      || header.t_ahm_size != (int) sizeof (struct s_ahm)
+      || header.t_gzwa_size != (int) sizeof (GZWA_Object)
+      || header.t_word_size != (int) sizeof (Bit_Vector_Word)
+      || header.t_image_size != size)
+    return 0;
+  xsy_count = header.t_xsy_count;
+  nsy_count = header.t_nsy_count;
+  xrl_count = header.t_xrl_count;
+  irl_count = header.t_irl_count;
+  ahm_count = header.t_ahm_count;
+  zwa_count = header.t_zwa_count;
+  if (xsy_count < 0 || nsy_count < 0 || xrl_count < 0
+      || irl_count < 0 || ahm_count < 0 || zwa_count < 0)
+    return 0;
+  if (header.t_start_irl_id < -1 || header.t_start_irl_id >= irl_count)
+    return 0;
+}
+
+@ @<Read the XSY's from the grammar image@> =
+{
+  XSYID xsy_id;
+  for (xsy_id = 0; xsy_id < xsy_count; xsy_id++)
+    {
+      const XSY xsy = marpa_obs_new (g->t_obs, struct s_xsy, 1);
+      if (!image_read (&reader, xsy, sizeof (*xsy)))
+        return 0;
+      if (ID_of_XSY (xsy) != xsy_id)
+        return 0;
+      if (!image_cil_read (g, &reader, &Nulled_XSYIDs_of_XSY (xsy)))
+        return 0;
+      *MARPA_DSTACK_PUSH (g->t_xsy_stack, XSY) = xsy;
+    }
+}
+
+@ @<Read the XRL's from the grammar image@> =
+{
+  XRLID xrl_id;
+  for (xrl_id = 0; xrl_id < xrl_count; xrl_id++)
+    {
+      XRL xrl;
+      int length;
+      size_t sizeof_xrl;
+      if (!image_read (&reader, &length, sizeof (length)))
+        return 0;
+      if (length < 0 || (size_t) length >= reader.t_left / sizeof (XSYID))
+        return 0;
+      sizeof_xrl = offsetof (struct s_xrl, t_symbols) +
+        ((size_t) length + 1) * sizeof (xrl->t_symbols[0]);
+      xrl = marpa__obs_alloc (g->t_xrl_obs, sizeof_xrl, ALIGNOF (XRL));
+      if (!image_read (&reader, xrl, sizeof_xrl))
+        return 0;
+      if (ID_of_XRL (xrl) != xrl_id || Length_of_XRL (xrl) != length)
+        return 0;
+      *MARPA_DSTACK_PUSH (g->t_xrl_stack, XRL) = xrl;
+    }
+}
+
+@ @<Read the NSY's from the grammar image@> =
+{
+  NSYID nsy_id;
+  MARPA_DSTACK_INIT (g->t_nsy_stack, NSY, MAX (nsy_count, 1));
+  for (nsy_id = 0; nsy_id < nsy_count; nsy_id++)
+    {
+      const NSY nsy = marpa_obs_new (g->t_obs, struct s_nsy, 1);
+      XSYID source_xsy_id;
+      XRLID lhs_xrl_id;
+      if (!image_read (&reader, nsy, sizeof (*nsy)))
+        return 0;
+      if (ID_of_NSY (nsy) != nsy_id)
+        return 0;
+      if (!image_id_read (&reader, &source_xsy_id, xsy_count)
+          || source_xsy_id < 0)
+        return 0;
+      Source_XSY_of_NSY (nsy) = XSY_by_ID (source_xsy_id);
+      if (!image_id_read (&reader, &lhs_xrl_id, xrl_count))
+        return 0;
+      LHS_XRL_of_NSY (nsy) = lhs_xrl_id < 0 ? NULL : XRL_by_ID (lhs_xrl_id);
+      if (!image_cil_read (g, &reader, &LHS_CIL_of_NSY (nsy)))
+        return 0;
+      if (!image_cil_read (g, &reader, &Predicted_AHM_CIL_of_NSY (nsy)))
+        return 0;
+      *MARPA_DSTACK_PUSH (g->t_nsy_stack, NSY) = nsy;
+    }
+}
+
+@ @<Read the XSY's NSY's from the grammar image@> =
+{
+  XSYID xsy_id;
+  for (xsy_id = 0; xsy_id < xsy_count; xsy_id++)
+    {
+      const XSY xsy = XSY_by_ID (xsy_id);
+      NSYID nsy_id;
+      NSYID nulling_nsy_id;
+      if (!image_id_read (&reader, &nsy_id, nsy_count))
+        return 0;
+      if (!image_id_read (&reader, &nulling_nsy_id, nsy_count))
+        return 0;
+      NSY_of_XSY (xsy) = nsy_id < 0 ? NULL : NSY_by_ID (nsy_id);
+      Nulling_NSY_of_XSY (xsy) =
+        nulling_nsy_id < 0 ? NULL : NSY_by_ID (nulling_nsy_id);
+    }
+}
+
+@ The AHM's are allocated before the IRL's are read,
+so that the IRL's first AHM's can be resolved.
+@<Read the IRL's from the grammar image@> =
+{
+  IRLID irl_id;
+  if (ahm_count > 0)
+    {
+      g->t_ahms = marpa_new (struct s_ahm, ahm_count);
+    }
+  AHM_Count_of_G (g) = ahm_count;
+  MARPA_DSTACK_INIT (g->t_irl_stack, IRL, MAX (irl_count, 1));
+  for (irl_id = 0; irl_id < irl_count; irl_id++)
+    {
+      IRL irl;
+      int length;
+      size_t sizeof_irl;
+      XRLID source_xrl_id;
+      AHMID first_ahm_id;
+      if (!image_read (&reader, &length, sizeof (length)))
+        return 0;
+      if (length < 0 || (size_t) length >= reader.t_left / sizeof (NSYID))
+        return 0;
+      sizeof_irl = offsetof (struct s_irl, t_nsyid_array) +
+        ((size_t) length + 1) * sizeof (irl->t_nsyid_array[0]);
+      irl = marpa__obs_alloc (g->t_obs, sizeof_irl, ALIGNOF (IRL_Object));
+      if (!image_read (&reader, irl, sizeof_irl))
+        return 0;
+      if (ID_of_IRL (irl) != irl_id || Length_of_IRL (irl) != length)
+        return 0;
+      if (!image_id_read (&reader, &source_xrl_id, xrl_count))
+        return 0;
+      if (!image_id_read (&reader, &first_ahm_id, ahm_count))
+        return 0;
+      Source_XRL_of_IRL (irl) =
+        source_xrl_id < 0 ? NULL : XRL_by_ID (source_xrl_id);
+      First_AHM_of_IRL (irl) =
+        first_ahm_id < 0 ? NULL : AHM_by_ID (first_ahm_id);
+      *MARPA_DSTACK_PUSH (g->t_irl_stack, IRL) = irl;
+    }
+}
+
+@ @<Read the AHM's from the grammar image@> =
+{
+  AHMID ahm_id;
+  for (ahm_id = 0; ahm_id < ahm_count; ahm_id++)
+    {
+      const AHM ahm = AHM_by_ID (ahm_id);
+      IRLID irl_id;
+      XRLID xrl_id;
+      AHMID trailhead_ahm_id;
+      if (!image_read (&reader, ahm, sizeof (*ahm)))
+        return 0;
+      if (!image_id_read (&reader, &irl_id, irl_count) || irl_id < 0)
+        return 0;
+      if (!image_id_read (&reader, &xrl_id, xrl_count))
+        return 0;
+      if (!image_id_read (&reader, &trailhead_ahm_id, ahm_count))
+        return 0;
+      IRL_of_AHM (ahm) = IRL_by_ID (irl_id);
+      XRL_of_AHM (ahm) = xrl_id < 0 ? NULL : XRL_by_ID (xrl_id);
+      Leo_Trailhead_AHM_of_AHM (ahm) =
+        trailhead_ahm_id < 0 ? NULL : AHM_by_ID (trailhead_ahm_id);
+      if (!image_cil_read (g, &reader, &Predicted_IRL_CIL_of_AHM (ahm))
+          || !image_cil_read (g, &reader, &LHS_CIL_of_AHM (ahm))
+          || !image_cil_read (g, &reader, &ZWA_CIL_of_AHM (ahm))
+          || !image_cil_read (g, &reader, &Completion_XSYIDs_of_AHM (ahm))
+          || !image_cil_read (g, &reader, &Nulled_XSYIDs_of_AHM (ahm))
+          || !image_cil_read (g, &reader, &Prediction_XSYIDs_of_AHM (ahm))
+          || !image_cil_read (g, &reader, &Event_AHMIDs_of_AHM (ahm)))
+        return 0;
+    }
+}
+
+@ @<Read the ZWA's from the grammar image@> =
+{
+  ZWAID zwa_id;
+  for (zwa_id = 0; zwa_id < zwa_count; zwa_id++)
+    {
+      const GZWA gzwa = marpa_obs_new (g->t_obs, GZWA_Object, 1);
+      if (!image_read (&reader, gzwa, sizeof (*gzwa)))
+        return 0;
+      if (ID_of_GZWA (gzwa) != zwa_id)
+        return 0;
+      *MARPA_DSTACK_PUSH (g->t_gzwa_stack, GZWA) = gzwa;
+    }
+}
+
+@ @<Read the boolean vectors from the grammar image@> =
+{
+  if (!image_bv_read (g, &reader, &g->t_bv_nsyid_is_terminal)
+      || !image_bv_read (g, &reader, &g->t_bv_nsyid_is_leo_postdot)
+      || !image_bv_read (g, &reader, &g->t_lbv_xsyid_is_completion_event)
+      || !image_bv_read (g, &reader,
+                         &g->t_lbv_xsyid_completion_event_starts_active)
+      || !image_bv_read (g, &reader, &g->t_lbv_xsyid_is_nulled_event)
+      || !image_bv_read (g, &reader,
+                         &g->t_lbv_xsyid_nulled_event_starts_active)
+      || !image_bv_read (g, &reader, &g->t_lbv_xsyid_is_prediction_event)
+      || !image_bv_read (g, &reader,
+                         &g->t_lbv_xsyid_prediction_event_starts_active))
+    return 0;
+}
+
+@ As in precomputation,
+the rule duplication tree is no longer needed,
+and the CILAR's buffer is reinitialized.
+The prediction states are not in the image,
+and are found again here.
+@<Finish the grammar loaded from the image@> =
+{
+  g->t_start_xsy_id = header.t_start_xsy_id;
+  g->t_start_irl =
+    header.t_start_irl_id < 0 ? NULL : IRL_by_ID (header.t_start_irl_id);
+  External_Size_of_G (g) = header.t_external_size;
+  g->t_max_rule_length = header.t_max_rule_length;
+  Default_Rank_of_G (g) = header.t_default_rank;
+  g->t_force_valued = header.t_force_valued;
+  SYMI_Count_of_G (g) = header.t_symbol_instance_count;
+  g->t_has_cycle = header.t_has_cycle ? 1 : 0;
+  G_has_Prediction_States (g) = header.t_has_prediction_states ? 1 : 0;
+  if (G_has_Prediction_States (g) && !G_is_Trivial (g))
+    prediction_states_populate (g);
+  @<Clear rule duplication tree@>@;
+  g->t_is_precomputed = 1;
+  @<Reinitialize the CILAR@>@;
+}
+
+@** Recognizer (R, RECCE) code.
+@<Public incomplete structures@> =
+struct marpa_r;
+typedef struct marpa_r* Marpa_Recognizer;
+typedef Marpa_Recognizer Marpa_Recce;
+@ @<Private typedefs@> =
+typedef struct marpa_r* RECCE;
+@ @<Recognizer structure@> =
+struct marpa_r {
+    @<Widely aligned recognizer elements@>@;
+    @<Int aligned recognizer elements@>@;
+    @<Bit aligned recognizer elements@>@;
+};
+
+@ The grammar must not be deallocated for the life of the
+recognizer.
+In the event of an error creating the recognizer,
+|NULL| is returned.
+@<Function definitions@> =
+Marpa_Recognizer marpa_r_new( Marpa_Grammar g )
+{
+    RECCE r;
+    int nsy_count;
+    int irl_count;
+    @<Return |NULL| on failure@>@;
+    @<Fail if not precomputed@>@;
+    nsy_count = NSY_Count_of_G(g);
+    irl_count = IRL_Count_of_G(g);
+    r = my_malloc(sizeof(struct marpa_r));
+    @<Initialize recognizer obstack@>@;
+    @<Initialize recognizer elements@>@;
+    @<Initialize dot PSAR@>@;
+    @<Initialize recognizer event variables@>@;
+    return r;
+}
+
+@*0 Specialized recognizers.
+A {\it specialization} is a precomputed grammar
+compiled into an application.
+The \.{image2c.pl} generator turns a grammar image,
+as written by |marpa_g_serialize|,
+into a C file which holds the image
+as |static const| data,
+and a |Marpa_Specialization| which points to it.
+The image is compiled in,
+so the application needs neither a grammar file
+nor a precomputation.
+It is not used in place:
+the first call of |marpa_r_new_specialized|
+loads it with |marpa_g_load|,
+which copies it into a grammar on the heap,
+and that grammar is shared.
+If several threads make the first call at the same time,
+each loads a grammar,
+but only one is kept.
+The specialization holds its reference to the grammar
+for the life of the application.
+@<Public structures@> =
+struct marpa_specialization {
+     const char *t_name;
+     const unsigned char *t_image;
+     size_t t_image_size;
+     Marpa_Grammar t_grammar;
+};
+typedef struct marpa_specialization Marpa_Specialization;
+
+@ On failure, |NULL| is returned,
+and the error is reported in the configuration.
+@<Function definitions@> =
+Marpa_Recognizer
+marpa_r_new_specialized (Marpa_Config * configuration,
+                         Marpa_Specialization * specialization)
+{
+  GRAMMAR g;
+  RECCE r;
+  if (_MARPA_UNLIKELY (!specialization))
+    {
+      if (configuration)
+        configuration->t_error = MARPA_ERR_POINTER_ARG_NULL;
+      return NULL;
+    }
+  g = MARPA_ATOMIC_LOAD (specialization->t_grammar);
+  if (!g)
+    {
+      GRAMMAR kept_g = NULL;
+      g = marpa_g_load (configuration, specialization->t_image,
+                        specialization->t_image_size);
+      if (!g)
+        return NULL;
+      G_is_Shared (g) = MARPA_HAS_THREADS;
+      if (!MARPA_ATOMIC_CAS (specialization->t_grammar, kept_g, g))
+        {
+          grammar_unref (g);
+          g = kept_g;
+        }
+    }
+  r = marpa_r_new (g);
+  if (!r && configuration)
+    configuration->t_error = marpa_g_error (g, NULL);
+  return r;
+}
+
+@*0 Reference counting and destructors.
+@ @<Int aligned recognizer elements@>= int t_ref_count;
+@ @<Initialize recognizer elements@> =
+r->t_ref_count = 1;
+
+@ Decrement the recognizer reference count.
+@<Function definitions@> =
+PRIVATE void
+recce_unref (RECCE r)
+{
+  MARPA_ASSERT (r->t_ref_count > 0)
+  r->t_ref_count--;
+  if (r->t_ref_count <= 0)
+    {
+      recce_free(r);
+    }
+}
+void
+marpa_r_unref (Marpa_Recognizer r)
+{
+   recce_unref(r);
+}
+
+@ Increment the recognizer reference count.
+@<Function definitions@> =
+PRIVATE
+RECCE recce_ref (RECCE r)
+{
+  MARPA_ASSERT(r->t_ref_count > 0)
+  r->t_ref_count++;
+  return r;
+}
+Marpa_Recognizer
+marpa_r_ref (Marpa_Recognizer r)
+{
+   return recce_ref(r);
+}
+
+@ @<Function definitions@> =
+PRIVATE
+void recce_free(struct marpa_r *r)
+{
+    @<Unpack recognizer objects@>@;
+    @<Destroy recognizer elements@>@;
+    @<Destroy recognizer obstack@>@;
+    my_free( r);
+}
+
+@*0 Base objects.
+Initialized in |marpa_r_new|.
+@d G_of_R(r) ((r)->t_grammar)
+@<Widely aligned recognizer elements@> =
+    GRAMMAR t_grammar;
+@ @<Initialize recognizer elements@> =
+{
+  G_of_R(r) = g;
+  grammar_ref(g);
+}
+@ @<Unpack recognizer objects@> =
+const GRAMMAR g = G_of_R(r);
+@ @<Destroy recognizer elements@> = grammar_unref(g);
+
+@*0 Recognizer events and CIL arena.
+The recognizer's events go to the grammar's event stack,
+unless the grammar is shared,
+in which case the recognizer has its own.
+Similarly,
+the CIL's that the recognizer creates are interned in the
+grammar's CIL arena,
+unless the grammar is shared,
+in which case they are interned in an overlay
+on the grammar's CIL arena.
+Whether the grammar is shared is decided once,
+when the recognizer is created.
+\par
+The destructors do not look at the grammar,
+which may already have been freed.
+@d Events_of_R(r) ((r)->t_events)
+@d R_EVENT_COUNT(r) MARPA_DSTACK_LENGTH (*Events_of_R(r))
+@d R_EVENTS_CLEAR(r) MARPA_DSTACK_CLEAR (*Events_of_R(r))
+@d CILAR_of_R(r) ((r)->t_cilar)
+@<Widely aligned recognizer elements@> =
+    MARPA_DSTACK t_events;
+    MARPA_DSTACK_DECLARE(t_own_events);
+    CILAR t_cilar;
+    CILAR_Object t_own_cilar;
+@ @<Initialize recognizer elements@> =
+if (G_is_Shared (g))
+  {
+    MARPA_DSTACK_INIT (r->t_own_events, GEV_Object,
+                       INITIAL_G_EVENTS_CAPACITY);
+    Events_of_R (r) = &r->t_own_events;
+    cilar_overlay_init (&r->t_own_cilar, &g->t_cilar);
+    CILAR_of_R (r) = &r->t_own_cilar;
+  }
+else
+  {
+    Events_of_R (r) = &g->t_events;
+    CILAR_of_R (r) = &g->t_cilar;
+  }
+@ @<Destroy recognizer elements@> =
+if (Events_of_R (r) == &r->t_own_events)
+  {
+    MARPA_DSTACK_DESTROY (r->t_own_events);
+    cilar_destroy (&r->t_own_cilar);
+  }
+
+@ The events of the last event-active method
+called for the recognizer.
+Unless the grammar is shared,
+these are the grammar's events.
+@<Function definitions@> =
+Marpa_Event_Type
+marpa_r_event (Marpa_Recognizer r, Marpa_Event* public_event,
+               int ix)
+{
+  @<Return |-2| on failure@>@;
+  @<Unpack recognizer objects@>@;
+  const MARPA_DSTACK events = Events_of_R (r);
+  GEV internal_event;
+  int type;
+
+  @<Fail if fatal error@>@;
+  if (ix < 0) {
+    MARPA_ERROR(MARPA_ERR_EVENT_IX_NEGATIVE);
+    return failure_indicator;
+  }
+  if (ix >= MARPA_DSTACK_LENGTH (*events)) {
+    MARPA_ERROR(MARPA_ERR_EVENT_IX_OOB);
+    return failure_indicator;
+  }
+  internal_event = MARPA_DSTACK_INDEX (*events, GEV_Object, ix);
+  type = internal_event->t_type;
+  public_event->t_type = type;
+  public_event->t_value = internal_event->t_value;
+  return type;
+}
+
+@ @<Function definitions@> =
+int
+marpa_r_event_count (Marpa_Recognizer r)
+{
+  @<Return |-2| on failure@>@;
+  @<Unpack recognizer objects@>@;
+  @<Fail if fatal error@>@;
+  return R_EVENT_COUNT (r);
+}
+
+@*0 Input phase.
+The recognizer always is
+in a one of the following
+phases:
+@d R_BEFORE_INPUT 0x1
+@d R_DURING_INPUT 0x2
+@d R_AFTER_INPUT 0x3
+@<Bit aligned recognizer elements@> =
+   BITFIELD t_input_phase:2;
+@ @d Input_Phase_of_R(r) ((r)->t_input_phase)
+@ @<Initialize recognizer elements@> =
+    Input_Phase_of_R(r) = R_BEFORE_INPUT;
+
+@*0 Earley set container.
+@d First_YS_of_R(r) ((r)->t_first_earley_set)
+@s JEARLEME int
+@<Widely aligned recognizer elements@> =
+YS t_first_earley_set;
+YS t_latest_earley_set;
+JEARLEME t_current_earleme;
+@ @<Initialize recognizer elements@> =
+r->t_first_earley_set = NULL;
+r->t_latest_earley_set = NULL;
+r->t_current_earleme = -1;
+
+@*0 Current earleme.
+@d Latest_YS_of_R(r) ((r)->t_latest_earley_set)
+@d Current_Earleme_of_R(r) ((r)->t_current_earleme)
+@<Function definitions@> =
+Marpa_Earleme marpa_r_current_earleme(Marpa_Recognizer r)
+{
+  @<Unpack recognizer objects@>@;
+  if (_MARPA_UNLIKELY(Input_Phase_of_R(r) == R_BEFORE_INPUT)) {
+      MARPA_ERROR(MARPA_ERR_RECCE_NOT_STARTED);
+      return -1;
   }
   return Current_Earleme_of_R(r);
 }
@@ -6522,9 +8309,11 @@ Marpa_Recognizer r, int value)
 
 @*0 Predicted IRL boolean vector and stack.
 A boolean vector by IRL ID,
-used while building the Earley sets.
+used while building Earley set 0.
 It is set if an IRL has already been predicted,
 unset otherwise.
+The later Earley sets find duplicate predictions by AHM,
+and do not use it.
 @<Widely aligned recognizer elements@> =
   Bit_Vector t_bv_irl_seen;
   MARPA_DSTACK_DECLARE(t_irl_cil_stack);
@@ -6550,7 +8339,7 @@ earleme at which the parse became exhausted.
 {
   R_is_Exhausted (r) = 1;
   Input_Phase_of_R (r) = R_AFTER_INPUT;
-  event_new (g, MARPA_EVENT_EXHAUSTED);
+  event_new (Events_of_R (r), MARPA_EVENT_EXHAUSTED);
 }
 
 @ Exhaustion is a boolean, not a phase.
@@ -6735,6 +8524,7 @@ int marpa_r_earley_set_value(Marpa_Recognizer r, Marpa_Earley_Set_ID set_id)
       return failure_indicator;
     }
   earley_set = YS_of_R_by_Ord (r, set_id);
+  @<Fail if |earley_set| was discarded@>@;
   return Value_of_YS(earley_set);
 }
 
@@ -6760,6 +8550,7 @@ marpa_r_earley_set_values(Marpa_Recognizer r, Marpa_Earley_Set_ID set_id,
       return failure_indicator;
     }
   earley_set = YS_of_R_by_Ord (r, set_id);
+  @<Fail if |earley_set| was discarded@>@;
   if (p_value) *p_value = Value_of_YS(earley_set);
   if (p_pvalue) *p_pvalue = PValue_of_YS(earley_set);
   return 1;
@@ -6799,13 +8590,14 @@ earley_set_new( RECCE r, JEARLEME id)
 {
   YSK_Object key;
   YS set;
-  set = marpa_obs_new (r->t_obs, YS_Object, 1);
+  set = marpa_obs_new (r->t_ys_obs, YS_Object, 1);
   key.t_earleme = id;
   set->t_key = key;
   set->t_postdot_ary = NULL;
   set->t_postdot_sym_count = 0;
   YIM_Count_of_YS(set) = 0;
   set->t_ordinal = r->t_earley_set_count++;
+  R_Stat_Add (r, t_earley_set_count, 1);
   YIMs_of_YS(set) = NULL;
   Next_YS_of_YS(set) = NULL;
   @<Initialize Earley set@>@/
@@ -6854,18 +8646,15 @@ when the Earley item is initialized.
 @ The ID of the Earley item is per-Earley-set, so that
 to uniquely specify the Earley item you must also specify
 the Earley set.
-@d YS_of_YIM(yim) ((yim)->t_key.t_set)
-@d YS_Ord_of_YIM(yim) (Ord_of_YS(YS_of_YIM(yim)))
+The accessors for the Earley item key are
+in |@<Earley item key accessors@>|,
+because they depend on the layout of the Earley item.
 @d Ord_of_YIM(yim) ((yim)->t_ordinal)
 @d Earleme_of_YIM(yim) Earleme_of_YS(YS_of_YIM(yim))
-@d AHM_of_YIM(yim) ((yim)->t_key.t_ahm)
-@d AHMID_of_YIM(yim) ID_of_AHM(AHM_of_YIM(yim))
 @d Postdot_NSYID_of_YIM(yim) Postdot_NSYID_of_AHM(AHM_of_YIM(yim))
 @d IRL_of_YIM(yim) IRL_of_AHM(AHM_of_YIM(yim))
 @d IRLID_of_YIM(yim) ID_of_IRL(IRL_of_YIM(yim))
 @d Origin_Earleme_of_YIM(yim) (Earleme_of_YS(Origin_of_YIM(yim)))
-@d Origin_Ord_of_YIM(yim) (Ord_of_YS(Origin_of_YIM(yim)))
-@d Origin_of_YIM(yim) ((yim)->t_key.t_origin)
 @s YIM int
 @<Private incomplete structures@> =
 struct s_earley_item;
@@ -6894,17 +8683,240 @@ struct s_earley_item_key {
      YS t_set;
 };
 typedef struct s_earley_item_key YIK_Object;
+#if MARPA_COMPACT_YIM
+struct s_earley_item {
+     AHMID t_ahmid;
+     YSID t_origin_ordinal;
+     YSID t_set_ordinal;
+     @<Earley item bit fields@>@;
+     union u_source_container t_container;
+};
+#else
 struct s_earley_item {
      YIK_Object t_key;
      union u_source_container t_container;
+     @<Earley item bit fields@>@;
+};
+#endif
+typedef struct s_earley_item YIM_Object;
+@ @<Earley item bit fields@> =
      BITFIELD t_ordinal:YIM_ORDINAL_WIDTH;
     BITFIELD t_source_type:3;
     BITFIELD t_is_rejected:1;
     BITFIELD t_is_active:1;
     BITFIELD t_was_scanned:1;
     BITFIELD t_was_fusion:1;
+
+@*0 Compact Earley items.
+On 64-bit machines, the three pointers of the Earley item key
+take up more than a third of the Earley item.
+If |MARPA_COMPACT_YIM| is defined non-zero at compile time,
+the Earley item instead keeps the ordinals of its Earley set
+and its origin,
+and the ID of its AHM,
+as |int|'s.
+The bit fields are packed into the same word as the third |int|,
+which otherwise would be padding.
+On a typical 64-bit machine,
+this shrinks the Earley item from 64 bytes to 48.
+@ The cost is that the key is no longer a set of pointers,
+and finding the Earley set or the AHM of an Earley item
+takes an extra indirection,
+through the Earley set stack or the AHM table.
+The accessors expect the recognizer,
+as |r|, and the grammar, as |g|, to be in scope,
+and the Earley set stack
+must always be up to date.
+Ordinals are cheaper to find in the compact layout,
+so code which needs only to compare Earley sets
+should use |YS_Ord_of_YIM| and |Origin_Ord_of_YIM|.
+@<Earley item key accessors@> =
+#if MARPA_COMPACT_YIM
+#define YS_of_YIM(yim) (YS_of_R_by_Ord((r), (yim)->t_set_ordinal))
+#define YS_Ord_of_YIM(yim) ((yim)->t_set_ordinal)
+#define AHM_of_YIM(yim) (AHM_by_ID((yim)->t_ahmid))
+#define AHMID_of_YIM(yim) ((yim)->t_ahmid)
+#define Origin_of_YIM(yim) (YS_of_R_by_Ord((r), (yim)->t_origin_ordinal))
+#define Origin_Ord_of_YIM(yim) ((yim)->t_origin_ordinal)
+#define YIM_Key_Set(yim, key) \
+  ((yim)->t_ahmid = ID_of_AHM((key).t_ahm), \
+  (yim)->t_origin_ordinal = Ord_of_YS((key).t_origin), \
+  (yim)->t_set_ordinal = Ord_of_YS((key).t_set))
+#else
+#define YS_of_YIM(yim) ((yim)->t_key.t_set)
+#define YS_Ord_of_YIM(yim) (Ord_of_YS(YS_of_YIM(yim)))
+#define AHM_of_YIM(yim) ((yim)->t_key.t_ahm)
+#define AHMID_of_YIM(yim) ID_of_AHM(AHM_of_YIM(yim))
+#define Origin_of_YIM(yim) ((yim)->t_key.t_origin)
+#define Origin_Ord_of_YIM(yim) (Ord_of_YS(Origin_of_YIM(yim)))
+#define YIM_Key_Set(yim, key) ((yim)->t_key = (key))
+#endif
+
+@ Every new Earley set must be put on the Earley set stack
+before any of its Earley items are created.
+Streaming mode also needs the Earley set stack to be
+always up to date.
+@<Stack the new Earley set, if required@> =
+#if MARPA_COMPACT_YIM
+r_update_earley_sets (r);
+#else
+if (R_is_Streaming (r)) r_update_earley_sets (r);
+#endif
+
+@*0 Memory report.
+A report of the memory used by the recognizer,
+so that the application can see where it goes,
+and what difference the layout of the Earley items makes.
+The Earley items and the Earley sets live on the recognizer's
+obstacks, which are reported as a whole.
+In streaming mode, only the Earley sets which have not been
+discarded are counted.
+@<Public structures@> =
+struct marpa_memory_report {
+     size_t t_earley_set_count;
+     size_t t_earley_set_size;
+     size_t t_earley_item_count;
+     size_t t_earley_item_size;
+     size_t t_obstack_size;
 };
-typedef struct s_earley_item YIM_Object;
+typedef struct marpa_memory_report Marpa_Memory_Report;
+
+@ Finding the Earley item count requires a pass over the
+Earley sets, so this method should not be called
+at every earleme.
+@<Function definitions@> =
+int
+marpa_r_memory_report (Marpa_Recognizer r, Marpa_Memory_Report * report)
+{
+  @<Return |-2| on failure@>@;
+  YS set;
+  size_t earley_set_count = 0;
+  size_t earley_item_count = 0;
+  size_t obstack_size;
+  @<Unpack recognizer objects@>@;
+  @<Fail if fatal error@>@;
+  if (_MARPA_UNLIKELY (!report))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  for (set = First_YS_of_R (r); set; set = Next_YS_of_YS (set))
+    {
+      earley_set_count++;
+      earley_item_count += (size_t) YIM_Count_of_YS (set);
+    }
+  obstack_size = marpa__obs_size (r->t_obs);
+  if (r->t_prediction_obs)
+    obstack_size += marpa__obs_size (r->t_prediction_obs);
+  if (MARPA_DSTACK_IS_INITIALIZED (r->t_ys_segments))
+    {
+      int segment_ix;
+      const int segment_count = MARPA_DSTACK_LENGTH (r->t_ys_segments);
+      const struct s_earley_set_segment *const segments =
+        MARPA_DSTACK_BASE (r->t_ys_segments, struct s_earley_set_segment);
+      for (segment_ix = 0; segment_ix < segment_count; segment_ix++)
+        {
+          obstack_size += marpa__obs_size (segments[segment_ix].t_obs);
+        }
+    }
+  report->t_earley_set_count = earley_set_count;
+  report->t_earley_set_size = sizeof (YS_Object);
+  report->t_earley_item_count = earley_item_count;
+  report->t_earley_item_size = sizeof (YIM_Object);
+  report->t_obstack_size = obstack_size;
+  return 1;
+}
+
+@*0 Recognizer statistics.
+Counts of the work done by the recognizer,
+so that a grammar can be profiled in production
+without tracing.
+The counters are only kept if the application asks for them,
+and while they are off the cost is one test of a bit
+at each place a counter would be incremented.
+The counters are cumulative.
+An application which wants counts for each earleme
+can take the differences between calls to |marpa_r_stats()|.
+A rollback to a checkpoint does not roll the counters back,
+because the work they count has been done.
+@d R_is_Collecting_Stats(r) ((r)->t_is_collecting_stats)
+@d R_Stat_Add(r, counter, n)
+  (R_is_Collecting_Stats(r) ? ((r)->t_stats.counter += (size_t)(n)) : 0)
+@<Public structures@> =
+struct marpa_recce_stats {
+     size_t t_earley_set_count;
+     size_t t_earley_item_count;
+     size_t t_prediction_count;
+     size_t t_leo_item_count;
+     size_t t_postdot_item_count;
+     size_t t_token_link_count;
+     size_t t_completion_link_count;
+     size_t t_leo_link_count;
+     size_t t_psl_claim_count;
+     size_t t_prediction_state_count;
+};
+typedef struct marpa_recce_stats Marpa_Recce_Stats;
+
+@ @<Bit aligned recognizer elements@> =
+BITFIELD t_is_collecting_stats:1;
+@ @<Widely aligned recognizer elements@> =
+Marpa_Recce_Stats t_stats;
+@ @<Initialize recognizer elements@> =
+r->t_is_collecting_stats = 0;
+r->t_stats.t_earley_set_count = 0;
+r->t_stats.t_earley_item_count = 0;
+r->t_stats.t_prediction_count = 0;
+r->t_stats.t_leo_item_count = 0;
+r->t_stats.t_postdot_item_count = 0;
+r->t_stats.t_token_link_count = 0;
+r->t_stats.t_completion_link_count = 0;
+r->t_stats.t_leo_link_count = 0;
+r->t_stats.t_psl_claim_count = 0;
+r->t_stats.t_prediction_state_count = 0;
+
+@ Returns 1 if the recognizer is keeping statistics,
+0 if not,
+and |-2| if there was an error.
+@<Function definitions@> =
+int marpa_r_stats_collect(Marpa_Recognizer r)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@;
+    @<Fail if fatal error@>@;
+    return R_is_Collecting_Stats(r);
+}
+@ Unlike streaming mode,
+statistics may be turned on and off at any time.
+Turning them off does not clear the counters.
+@<Function definitions@> =
+int marpa_r_stats_collect_set(Marpa_Recognizer r, int value)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@/
+    @<Fail if fatal error@>@;
+    if (_MARPA_UNLIKELY (value < 0 || value > 1))
+      {
+        MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+        return failure_indicator;
+      }
+    return R_is_Collecting_Stats(r) = value ? 1 : 0;
+}
+
+@ @<Function definitions@> =
+int
+marpa_r_stats (Marpa_Recognizer r, Marpa_Recce_Stats * stats)
+{
+  @<Return |-2| on failure@>@;
+  @<Unpack recognizer objects@>@;
+  @<Fail if fatal error@>@;
+  if (_MARPA_UNLIKELY (!stats))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  *stats = r->t_stats;
+  return 1;
+}
 
 @ Signed as opposed to the the way it is kept (unsigned, for portability,
 because it is a bitfield.  I may have to change this.
@@ -6920,16 +8932,33 @@ These are not worth optimizing for.
 @<Function definitions@> =
 PRIVATE YIM earley_item_create(const RECCE r,
     const YIK_Object key)
+{
+  YIM* end_of_work_stack;
+  const YIM new_item = earley_item_new (r, key, r->t_ys_obs);
+  if (!new_item) return NULL;
+  end_of_work_stack = WORK_YIM_PUSH(r);
+  *end_of_work_stack = new_item;
+  return new_item;
+}
+
+@ Create a new Earley item on |obs|,
+without putting it on the work stack.
+Most Earley items are created with |earley_item_create|,
+but a deferred prediction is created after its Earley set
+is complete.
+@<Function definitions@> =
+PRIVATE YIM earley_item_new(const RECCE r,
+    const YIK_Object key, struct marpa_obstack* obs)
 {
   @<Return |NULL| on failure@>@;
   @<Unpack recognizer objects@>@;
   YIM new_item;
-  YIM* end_of_work_stack;
   const YS set = key.t_set;
   const int count = ++YIM_Count_of_YS(set);
   @<Check count against Earley item thresholds@>@;
-  new_item = marpa_obs_new (r->t_obs, struct s_earley_item, 1);
-  new_item->t_key = key;
+  new_item = marpa_obs_new (obs, struct s_earley_item, 1);
+  R_Stat_Add (r, t_earley_item_count, 1);
+  YIM_Key_Set (new_item, key);
   new_item->t_source_type = NO_SOURCE;
   YIM_is_Rejected(new_item) = 0;
   YIM_is_Active(new_item) = 1;
@@ -6939,8 +8968,6 @@ PRIVATE YIM earley_item_create(const RECCE r,
     SRC_is_Active (unique_yim_src) = 1;
   }
   Ord_of_YIM(new_item) = YIM_ORDINAL_CLAMP((unsigned int)count - 1);
-  end_of_work_stack = WORK_YIM_PUSH(r);
-  *end_of_work_stack = new_item;
   return new_item;
 }
 
@@ -6958,12 +8985,13 @@ earley_item_assign (const RECCE r, const YS set, const YS origin,
   if (!*psl_owner)
     {
       psl_claim (psl_owner, Dot_PSAR_of_R(r));
+      R_Stat_Add (r, t_psl_claim_count, 1);
     }
   psl = *psl_owner;
   yim = PSL_Datum (psl, ahm_id);
   if (yim
-      && Earleme_of_YIM (yim) == Earleme_of_YS (set)
-      && Earleme_of_YS (Origin_of_YIM (yim)) == Earleme_of_YS (origin))
+      && YS_Ord_of_YIM (yim) == Ord_of_YS (set)
+      && Origin_Ord_of_YIM (yim) == Ord_of_YS (origin))
     {
       return yim;
     }
@@ -6985,7 +9013,7 @@ if (count >= r->t_earley_item_warning_threshold)
         MARPA_FATAL (MARPA_ERR_YIM_COUNT);
         return failure_indicator;
       }
-      int_event_new (g, MARPA_EVENT_EARLEY_ITEM_THRESHOLD, count);
+      int_event_new (Events_of_R (r), MARPA_EVENT_EARLEY_ITEM_THRESHOLD, count);
   }
 
 @*0 Destructor.
@@ -7131,6 +9159,14 @@ pim_nsy_p_find (YS set, NSYID nsyid)
   int lo = 0;
   int hi = Postdot_SYM_Count_of_YS(set) - 1;
   PIM* postdot_array = set->t_postdot_ary;
+  const int* const postdot_index = Postdot_Index_of_YS(set);
+  if (postdot_index) {
+      const int offset = nsyid - Postdot_Index_Base_of_YS(set);
+      int postdot_ix;
+      if (offset < 0 || offset >= Postdot_Index_Size_of_YS(set)) return NULL;
+      postdot_ix = postdot_index[offset];
+      return postdot_ix < 0 ? NULL : postdot_array+postdot_ix;
+  }
   while (hi >= lo) { // A binary search
        int trial = lo+(hi-lo)/2; // guards against overflow
        PIM trial_pim = postdot_array[trial];
@@ -7151,6 +9187,123 @@ PRIVATE PIM first_pim_of_ys_by_nsyid(YS set, NSYID nsyid)
    return pim_nsy_p ? *pim_nsy_p : NULL;
 }
 
+@*0 Postdot index.
+Finding the postdot items of an origin Earley set
+is in the inner loop of the recognizer,
+and the binary search in |pim_nsy_p_find|
+is logarithmic in the number of postdot symbols.
+An Earley set with more postdot symbols than
+the postdot index threshold is also given
+a dense index, by NSYID, into its postdot item array,
+so that its lookups take constant time.
+The index spans only the NSYID's from the lowest
+to the highest postdot symbol of the Earley set.
+Its entries are offsets into the postdot item array,
+or $-1$ if there is no postdot item for that NSYID.
+@d Postdot_Index_of_YS(set) ((set)->t_postdot_index)
+@d Postdot_Index_Base_of_YS(set) ((set)->t_postdot_index_base)
+@d Postdot_Index_Size_of_YS(set) ((set)->t_postdot_index_size)
+@<Widely aligned Earley set elements@> =
+    int* t_postdot_index;
+@ @<Int aligned Earley set elements@> =
+    NSYID t_postdot_index_base;
+    int t_postdot_index_size;
+@ @<Initialize Earley set@> =
+   Postdot_Index_of_YS(set) = NULL;
+   Postdot_Index_Base_of_YS(set) = 0;
+   Postdot_Index_Size_of_YS(set) = 0;
+
+@ An index costs one |int| for every NSYID in its span,
+even those which are not postdot symbols,
+so it is not worth building for small Earley sets.
+The recognizer keeps a running total of the index entries
+it has allocated,
+so that the application can see what the
+index is costing it in memory.
+The total does not wrap around,
+but stops at |INT_MAX|.
+@d DEFAULT_POSTDOT_INDEX_THRESHOLD (16)
+@<Int aligned recognizer elements@> =
+int t_postdot_index_threshold;
+int t_postdot_index_size;
+@ @<Initialize recognizer elements@> =
+r->t_postdot_index_threshold = DEFAULT_POSTDOT_INDEX_THRESHOLD;
+r->t_postdot_index_size = 0;
+
+@ Returns the threshold,
+or |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_r_postdot_index_threshold (Marpa_Recognizer r)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return r->t_postdot_index_threshold;
+}
+
+@ Returns the new threshold,
+or |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_r_postdot_index_threshold_set (Marpa_Recognizer r, int threshold)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  {
+    const int new_threshold = threshold <= 0 ? INT_MAX : threshold;
+    r->t_postdot_index_threshold = new_threshold;
+    return new_threshold;
+  }
+}
+
+@ Returns the total size of the postdot indexes,
+or |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_r_postdot_index_size (Marpa_Recognizer r)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return r->t_postdot_index_size;
+}
+
+@ The postdot item array is sorted by NSYID,
+so its first and last entries give the span of the index.
+If the Earley set is large enough,
+its index is built on |obs|.
+@<Function definitions@> =
+PRIVATE void
+postdot_index_build (RECCE r, YS set, struct marpa_obstack *obs)
+{
+  const int postdot_sym_count = Postdot_SYM_Count_of_YS (set);
+  PIM *const postdot_array = set->t_postdot_ary;
+  if (postdot_sym_count > r->t_postdot_index_threshold)
+    {
+      const NSYID base_nsyid = Postdot_NSYID_of_PIM (postdot_array[0]);
+      const int index_size =
+        Postdot_NSYID_of_PIM (postdot_array[postdot_sym_count - 1]) -
+        base_nsyid + 1;
+      int *const postdot_index = marpa_obs_new (obs, int, index_size);
+      int ix;
+      for (ix = 0; ix < index_size; ix++)
+        postdot_index[ix] = -1;
+      for (ix = 0; ix < postdot_sym_count; ix++)
+        {
+          const NSYID nsyid = Postdot_NSYID_of_PIM (postdot_array[ix]);
+          postdot_index[nsyid - base_nsyid] = ix;
+        }
+      Postdot_Index_of_YS (set) = postdot_index;
+      Postdot_Index_Base_of_YS (set) = base_nsyid;
+      Postdot_Index_Size_of_YS (set) = index_size;
+      r->t_postdot_index_size =
+        r->t_postdot_index_size > INT_MAX - index_size
+        ? INT_MAX : r->t_postdot_index_size + index_size;
+    }
+}
+
 @** Source objects.
 Nothing internally distinguishes the various source objects
 by type.
@@ -7318,6 +9471,7 @@ tkn_link_add (RECCE r,
 {
   SRCL new_link;
   unsigned int previous_source_type = Source_Type_of_YIM (item);
+  R_Stat_Add (r, t_token_link_count, 1);
   if (previous_source_type == NO_SOURCE)
     {
       const SRCL source_link = SRCL_of_YIM(item);
@@ -7332,7 +9486,7 @@ tkn_link_add (RECCE r,
     { // If the sourcing is not already ambiguous, make it so
       earley_item_ambiguate (r, item);
     }
-  new_link = unique_srcl_new (r->t_obs);
+  new_link = unique_srcl_new (r->t_ys_obs);
   new_link->t_next = LV_First_Token_SRCL_of_YIM (item);
   new_link->t_source.t_predecessor = predecessor;
   NSYID_of_Source(new_link->t_source) = NSYID_of_ALT(alternative);
@@ -7350,6 +9504,7 @@ completion_link_add (RECCE r,
 {
   SRCL new_link;
   unsigned int previous_source_type = Source_Type_of_YIM (item);
+  R_Stat_Add (r, t_completion_link_count, 1);
   if (previous_source_type == NO_SOURCE)
     {
       const SRCL source_link = SRCL_of_YIM(item);
@@ -7363,7 +9518,7 @@ completion_link_add (RECCE r,
     { // If the sourcing is not already ambiguous, make it so
       earley_item_ambiguate (r, item);
     }
-  new_link = unique_srcl_new (r->t_obs);
+  new_link = unique_srcl_new (r->t_ys_obs);
   new_link->t_next = LV_First_Completion_SRCL_of_YIM (item);
   new_link->t_source.t_predecessor = predecessor;
   Cause_of_Source(new_link->t_source) = cause;
@@ -7379,6 +9534,7 @@ leo_link_add (RECCE r,
 {
   SRCL new_link;
   unsigned int previous_source_type = Source_Type_of_YIM (item);
+  R_Stat_Add (r, t_leo_link_count, 1);
   if (previous_source_type == NO_SOURCE)
     {
       const SRCL source_link = SRCL_of_YIM(item);
@@ -7392,7 +9548,7 @@ leo_link_add (RECCE r,
     { // If the sourcing is not already ambiguous, make it so
       earley_item_ambiguate (r, item);
     }
-  new_link = unique_srcl_new (r->t_obs);
+  new_link = unique_srcl_new (r->t_ys_obs);
   new_link->t_next = LV_First_Leo_SRCL_of_YIM (item);
   new_link->t_source.t_predecessor = predecessor;
   Cause_of_Source(new_link->t_source) = cause;
@@ -7437,7 +9593,7 @@ void earley_item_ambiguate (struct marpa_r * r, YIM item)
 }
 
 @ @<Ambiguate token source@> = {
-  SRCL new_link = marpa_obs_new (r->t_obs, SRCL_Object, 1);
+  SRCL new_link = marpa_obs_new (r->t_ys_obs, SRCL_Object, 1);
   *new_link = *SRCL_of_YIM(item);
   LV_First_Leo_SRCL_of_YIM (item) = NULL;
   LV_First_Completion_SRCL_of_YIM (item) = NULL;
@@ -7445,7 +9601,7 @@ void earley_item_ambiguate (struct marpa_r * r, YIM item)
 }
 
 @ @<Ambiguate completion source@> = {
-  SRCL new_link = marpa_obs_new (r->t_obs, SRCL_Object, 1);
+  SRCL new_link = marpa_obs_new (r->t_ys_obs, SRCL_Object, 1);
   *new_link = *SRCL_of_YIM(item);
   LV_First_Leo_SRCL_of_YIM (item) = NULL;
   LV_First_Completion_SRCL_of_YIM (item) = new_link;
@@ -7453,7 +9609,7 @@ void earley_item_ambiguate (struct marpa_r * r, YIM item)
 }
 
 @ @<Ambiguate Leo source@> = {
-  SRCL new_link = marpa_obs_new (r->t_obs, SRCL_Object, 1);
+  SRCL new_link = marpa_obs_new (r->t_ys_obs, SRCL_Object, 1);
   *new_link = *SRCL_of_YIM(item);
   LV_First_Leo_SRCL_of_YIM (item) = new_link;
   LV_First_Completion_SRCL_of_YIM (item) = NULL;
@@ -7605,6 +9761,195 @@ PRIVATE int alternative_insert(RECCE r, ALT new_alternative)
    return insertion_point;
 }
 
+@*0 Hashed alternatives.
+When a lexer reads many alternatives at each earleme,
+the memory moves in |alternative_insert| make
+reading the alternatives for an earleme quadratic
+in their number.
+In ``hashed'' mode, the alternatives read at the current
+earleme are instead appended to a separate, unsorted stack,
+and duplicates are detected with a hash.
+Just before the alternatives are needed,
+the new ones are sorted and merged into the alternatives stack,
+so that the alternatives stack,
+and |alternative_pop|,
+behave exactly as they would have without hashing.
+@ All new alternatives start at the current earleme,
+so their end earlemes and symbols are enough to
+identify them.
+A hash entry is live only if it is stamped with
+the current earleme,
+so the hash never needs to be cleared as the parse moves forward.
+A rollback rebuilds it.
+@<Private structures@> =
+struct s_alternative_hash_entry {
+    JEARLEME t_earleme;
+    int t_alt_ix;
+};
+
+@ @<Bit aligned recognizer elements@> =
+BITFIELD t_is_alternatives_hashed:1;
+@ @<Widely aligned recognizer elements@> =
+MARPA_DSTACK_DECLARE(t_new_alternatives);
+struct s_alternative_hash_entry* t_alternative_hash;
+@ @<Int aligned recognizer elements@> =
+int t_alternative_hash_size;
+@ @<Initialize recognizer elements@> =
+r->t_is_alternatives_hashed = 0;
+MARPA_DSTACK_SAFE(r->t_new_alternatives);
+r->t_alternative_hash = NULL;
+r->t_alternative_hash_size = 0;
+@ @<Destroy recognizer elements@> =
+MARPA_DSTACK_DESTROY(r->t_new_alternatives);
+my_free(r->t_alternative_hash);
+
+@ Returns 1 if alternatives are hashed,
+0 if not,
+and |-2| if there was an error.
+@<Function definitions@> =
+int marpa_r_alternatives_hashed(Marpa_Recognizer r)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@;
+    @<Fail if fatal error@>@;
+    return r->t_is_alternatives_hashed;
+}
+@ The mode can only be changed before input starts.
+@<Function definitions@> =
+int marpa_r_alternatives_hashed_set(
+Marpa_Recognizer r, int value)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@/
+    @<Fail if fatal error@>@;
+    @<Fail if recognizer started@>@;
+    if (_MARPA_UNLIKELY (value < 0 || value > 1))
+      {
+        MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+        return failure_indicator;
+      }
+    if (value && !MARPA_DSTACK_IS_INITIALIZED (r->t_new_alternatives))
+      {
+        MARPA_DSTACK_INIT2 (r->t_new_alternatives, ALT_Object);
+      }
+    return r->t_is_alternatives_hashed = value ? 1 : 0;
+}
+
+@ @<Function definitions@> =
+PRIVATE unsigned int alternative_hash(ALT_Const alternative)
+{
+  return (unsigned int) NSYID_of_ALT (alternative) * 2654435761u
+    ^ (unsigned int) End_Earleme_of_ALT (alternative);
+}
+
+@ Grow the hash so that its load is always less than one half,
+and re-enter the new alternatives.
+@<Function definitions@> =
+PRIVATE void alternative_hash_grow(RECCE r)
+{
+  const int new_alt_count = MARPA_DSTACK_LENGTH (r->t_new_alternatives);
+  const JEARLEME current_earleme = Current_Earleme_of_R (r);
+  const ALT new_alternatives =
+    MARPA_DSTACK_BASE (r->t_new_alternatives, ALT_Object);
+  struct s_alternative_hash_entry *hash;
+  unsigned int mask;
+  int hash_size = MAX (64, r->t_alternative_hash_size);
+  int slot;
+  int alt_ix;
+  while (hash_size <= (new_alt_count + 1) * 2)
+    hash_size *= 2;
+  my_free (r->t_alternative_hash);
+  hash = r->t_alternative_hash =
+    marpa_new (struct s_alternative_hash_entry, hash_size);
+  r->t_alternative_hash_size = hash_size;
+  for (slot = 0; slot < hash_size; slot++)
+    hash[slot].t_earleme = -1;
+  mask = (unsigned int) hash_size - 1;
+  for (alt_ix = 0; alt_ix < new_alt_count; alt_ix++)
+    {
+      unsigned int probe = alternative_hash (new_alternatives + alt_ix) & mask;
+      while (hash[probe].t_earleme == current_earleme)
+        probe = (probe + 1) & mask;
+      hash[probe].t_earleme = current_earleme;
+      hash[probe].t_alt_ix = alt_ix;
+    }
+}
+
+@ The hashed counterpart of |alternative_insert|.
+It returns -1 if the alternative is a duplicate,
+and its index in the new alternatives stack otherwise.
+@<Function definitions@> =
+PRIVATE int alternative_hashed_insert(RECCE r, ALT new_alternative)
+{
+  const int new_alt_count = MARPA_DSTACK_LENGTH (r->t_new_alternatives);
+  const JEARLEME current_earleme = Current_Earleme_of_R (r);
+  struct s_alternative_hash_entry *hash;
+  unsigned int mask;
+  unsigned int probe;
+  if ((new_alt_count + 1) * 2 >= r->t_alternative_hash_size)
+    alternative_hash_grow (r);
+  hash = r->t_alternative_hash;
+  mask = (unsigned int) r->t_alternative_hash_size - 1;
+  for (probe = alternative_hash (new_alternative) & mask;
+       hash[probe].t_earleme == current_earleme
+       && hash[probe].t_alt_ix < new_alt_count;
+       probe = (probe + 1) & mask)
+    {
+      const ALT old_alternative =
+        MARPA_DSTACK_INDEX (r->t_new_alternatives, ALT_Object,
+                            hash[probe].t_alt_ix);
+      if (alternative_cmp (new_alternative, old_alternative) == 0)
+        return -1;
+    }
+  hash[probe].t_earleme = current_earleme;
+  hash[probe].t_alt_ix = new_alt_count;
+  *MARPA_DSTACK_PUSH (r->t_new_alternatives, ALT_Object) = *new_alternative;
+  return new_alt_count;
+}
+
+@ @<Function definitions@> =
+PRIVATE_NOT_INLINE int alternative_sort_cmp(const void* ap, const void* bp)
+{
+  return alternative_cmp (ap, bp);
+}
+
+@ Sort the new alternatives and merge them into the alternatives
+stack, from the top down.
+None of the new alternatives can be a duplicate of an
+old one, because the new ones all start at the current earleme.
+@<Function definitions@> =
+PRIVATE void alternatives_merge(RECCE r)
+{
+  const int new_alt_count = MARPA_DSTACK_LENGTH (r->t_new_alternatives);
+  const int old_alt_count = MARPA_DSTACK_LENGTH (r->t_alternatives);
+  ALT new_alternatives;
+  ALT alternatives;
+  int new_alt_ix = new_alt_count - 1;
+  int old_alt_ix = old_alt_count - 1;
+  int alt_ix = old_alt_count + new_alt_count - 1;
+  if (new_alt_count <= 0)
+    return;
+  new_alternatives = MARPA_DSTACK_BASE (r->t_new_alternatives, ALT_Object);
+  qsort (new_alternatives, (size_t) new_alt_count, sizeof (ALT_Object),
+         alternative_sort_cmp);
+  MARPA_DSTACK_RESIZE (&r->t_alternatives, ALT_Object,
+                       old_alt_count + new_alt_count);
+  MARPA_DSTACK_COUNT_SET (r->t_alternatives, old_alt_count + new_alt_count);
+  alternatives = MARPA_DSTACK_BASE (r->t_alternatives, ALT_Object);
+  while (new_alt_ix >= 0)
+    {
+      if (old_alt_ix >= 0
+          && alternative_cmp (alternatives + old_alt_ix,
+                              new_alternatives + new_alt_ix) > 0)
+        {
+          alternatives[alt_ix--] = alternatives[old_alt_ix--];
+          continue;
+        }
+      alternatives[alt_ix--] = new_alternatives[new_alt_ix--];
+    }
+  MARPA_DSTACK_CLEAR (r->t_new_alternatives);
+}
+
 @** Starting recognizer input.
 @<Function definitions@> = int marpa_r_start_input(Marpa_Recognizer r)
 {
@@ -7623,11 +9968,13 @@ PRIVATE int alternative_insert(RECCE r, ALT new_alternative)
     @<Declare |marpa_r_start_input| locals@>@;
     Current_Earleme_of_R(r) = 0;
     @<Set up terminal-related boolean vectors@>@;
-    G_EVENTS_CLEAR(g);
+    R_EVENTS_CLEAR(r);
 
+    if (R_is_Streaming(r)) earley_set_segment_new(r);
     set0 = earley_set_new(r, 0);
     Latest_YS_of_R(r) = set0;
     First_YS_of_R(r) = set0;
+    @<Stack the new Earley set, if required@>@;
 
     if (G_is_Trivial(g)) {
         return_value += trigger_trivial_events(r);
@@ -7677,6 +10024,7 @@ PRIVATE int alternative_insert(RECCE r, ALT new_alternative)
                   if (!evaluate_zwas(r, 0, prediction_ahm)) continue;
                   key.t_ahm = prediction_ahm;
                   earley_item_create (r, key);
+                  R_Stat_Add (r, t_prediction_count, 1);
                   *MARPA_DSTACK_PUSH(r->t_irl_cil_stack, CIL)
                     = LHS_CIL_of_AHM(prediction_ahm);
                 }
@@ -7932,7 +10280,7 @@ are always unexpected.
       MARPA_ERROR (MARPA_ERR_NO_TOKEN_EXPECTED_HERE);
       return MARPA_ERR_NO_TOKEN_EXPECTED_HERE;
     }
-  if (!First_PIM_of_YS_by_NSYID (current_earley_set, tkn_nsyid))
+  if (!Materialized_PIM_of_YS_by_NSYID (r, current_earley_set, tkn_nsyid))
     {
       MARPA_ERROR (MARPA_ERR_UNEXPECTED_TOKEN_ID);
       return MARPA_ERR_UNEXPECTED_TOKEN_ID;
@@ -7968,13 +10316,96 @@ altered by the attempt.
     Furthest_Earleme_of_R (r) = target_earleme;
   alternative->t_start_earley_set = current_earley_set;
   End_Earleme_of_ALT(alternative) = target_earleme;
-  if (alternative_insert (r, alternative) < 0)
+  if ((r->t_is_alternatives_hashed
+       ? alternative_hashed_insert (r, alternative)
+       : alternative_insert (r, alternative)) < 0)
     {
       MARPA_ERROR (MARPA_ERR_DUPLICATE_TOKEN);
       return MARPA_ERR_DUPLICATE_TOKEN;
     }
 }
 
+@*0 Reading alternatives in batches.
+Applications with long inputs spend much of their time
+crossing into Libmarpa, once for every
+|marpa_r_alternative| and once for every |marpa_r_earleme_complete|.
+|marpa_r_alternatives_read| takes an array of alternatives,
+each of which carries the earleme at which it starts,
+and drives the read/complete loop itself.
+@ The start earleme of an alternative is also its
+completion boundary:
+before an alternative is read, every earleme
+before its start earleme is completed.
+The earleme of the last alternative in the batch is completed
+before returning.
+@<Public structures@> =
+struct marpa_alternative {
+     Marpa_Symbol_ID t_token_id;
+     int t_value;
+     int t_length;
+     Marpa_Earleme t_earleme;
+};
+typedef struct marpa_alternative Marpa_Alternative;
+
+@ Returns the number of alternatives consumed,
+which will be less than |count| if an event occurred,
+or if an alternative was rejected.
+In the first case the grammar's error code is |MARPA_ERR_NONE|.
+In the second case, the error code is that which |marpa_r_alternative|
+would have returned,
+and the rejected alternative is not counted as consumed.
+@ A rejection leaves the recognizer at the same earleme as
+the rejected alternative,
+so the application may retry, Ruby Slippers style,
+and resume the batch.
+After an event, all earlemes before the current earleme have
+been completed, and the batch may be resumed with the
+unconsumed alternatives.
+@<Function definitions@> =
+int
+marpa_r_alternatives_read(Marpa_Recognizer r,
+    const Marpa_Alternative* alternatives,
+    int count)
+{
+  @<Return |-2| on failure@>@;
+  @<Unpack recognizer objects@>@;
+  int alt_ix;
+  @<Fail if fatal error@>@;
+  @<Fail if recognizer not accepting input@>@;
+  if (count <= 0) return 0;
+  if (_MARPA_UNLIKELY (!alternatives))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  clear_error (g);
+  for (alt_ix = 0; alt_ix < count; alt_ix++)
+    {
+      const Marpa_Alternative *const alternative = alternatives + alt_ix;
+      const JEARLEME start_earleme = alternative->t_earleme;
+      if (_MARPA_UNLIKELY (start_earleme < Current_Earleme_of_R (r)))
+        {
+          MARPA_ERROR (MARPA_ERR_INVALID_LOCATION);
+          return failure_indicator;
+        }
+      while (Current_Earleme_of_R (r) < start_earleme)
+        {
+          const int event_count = marpa_r_earleme_complete (r);
+          if (event_count < 0)
+            return failure_indicator;
+          if (event_count > 0)
+            return alt_ix;
+        }
+      if (marpa_r_alternative (r, alternative->t_token_id,
+                               alternative->t_value,
+                               alternative->t_length) != MARPA_ERR_NONE)
+        return alt_ix;
+    }
+  if (marpa_r_earleme_complete (r) < 0)
+    return failure_indicator;
+  return count;
+}
+
 @** Complete an Earley set.
 In the Aycock-Horspool variation of Earley's algorithm,
 the two main phases are scanning and completion.
@@ -8057,10 +10488,9 @@ marpa_r_earleme_complete(Marpa_Recognizer r)
   {
     int count_of_expected_terminals;
     @<Declare |marpa_r_earleme_complete| locals@>@;
-    G_EVENTS_CLEAR(g);
+    R_EVENTS_CLEAR(r);
     psar_dealloc(Dot_PSAR_of_R(r));
-    bv_clear (r->t_bv_nsyid_is_expected);
-    bv_clear (r->t_bv_irl_seen);
+    if (r->t_is_alternatives_hashed) alternatives_merge (r);
     @<Initialize |current_earleme|@>@;
     @<Return 0 if no alternatives@>@;
     @<Initialize |current_earley_set|@>@;
@@ -8070,7 +10500,14 @@ marpa_r_earleme_complete(Marpa_Recognizer r)
       YIM cause = *cause_p;
         @<Add new Earley items for |cause|@>@;
     }
-    @<Add predictions to |current_earley_set|@>@;
+    if (R_is_Using_Prediction_States (r))
+      {
+        @<Add the prediction state to |current_earley_set|@>@;
+      }
+    else
+      {
+        @<Add predictions to |current_earley_set|@>@;
+      }
     postdot_items_create(r, bv_ok_for_chain, current_earley_set);
 
     @t}\comment{@>
@@ -8087,7 +10524,7 @@ marpa_r_earleme_complete(Marpa_Recognizer r)
     if (r->t_active_event_count > 0) {
         trigger_events(r);
     }
-    return_value = G_EVENT_COUNT(g);
+    return_value = R_EVENT_COUNT(r);
     CLEANUP: ;
     @<Destroy |marpa_r_earleme_complete| locals@>@;
   }
@@ -8109,6 +10546,7 @@ But I expect to use it for other purposes.
   current_earleme = ++(Current_Earleme_of_R(r));
   if (current_earleme > Furthest_Earleme_of_R (r))
     {
+        bv_clear (r->t_bv_nsyid_is_expected);
         @<Set |r| exhausted@>@;
         MARPA_ERROR(MARPA_ERR_PARSE_EXHAUSTED);
         return_value = failure_indicator;
@@ -8119,19 +10557,26 @@ But I expect to use it for other purposes.
 @ Create a new Earley set.  We know that it does not
 exist.
 @<Initialize |current_earley_set|@> = {
+    @<Start a new Earley set segment, if the current one is full@>@;
     current_earley_set = earley_set_new (r, current_earleme);
     Next_YS_of_YS(Latest_YS_of_R(r)) = current_earley_set;
     Latest_YS_of_R(r) = current_earley_set;
+    @<Stack the new Earley set, if required@>@;
 }
 
 @ If there are no alternatives for this earleme
 return 0 without creating an
 Earley set.
 The return value means success, with no events.
+No terminals are expected at this earleme.
+Otherwise, the expected terminals are reset
+when the postdot items are created,
+and there is no need to clear them here.
 @<Return 0 if no alternatives@> = {
   ALT end_of_stack = MARPA_DSTACK_TOP (r->t_alternatives, ALT_Object);
   if (!end_of_stack || current_earleme != End_Earleme_of_ALT (end_of_stack))
     {
+      bv_clear (r->t_bv_nsyid_is_expected);
       return_value = 0;
       goto CLEANUP;
     }
@@ -8159,7 +10604,7 @@ and as of this writing are not important in practical terms.
 @<Scan an Earley item from alternative@> =
 {
   YS start_earley_set = Start_YS_of_ALT (alternative);
-  PIM pim = First_PIM_of_YS_by_NSYID (start_earley_set,
+  PIM pim = Materialized_PIM_of_YS_by_NSYID (r, start_earley_set,
     NSYID_of_ALT(alternative));
   for (; pim; pim = Next_PIM_of_PIM (pim))
     {
@@ -8225,7 +10670,8 @@ add those Earley items it ``causes".
 @ @<Add new Earley items for |complete_nsyid| and |cause|@> =
 {
   PIM postdot_item;
-  for (postdot_item = First_PIM_of_YS_by_NSYID (middle, complete_nsyid);
+  for (postdot_item =
+         Materialized_PIM_of_YS_by_NSYID (r, middle, complete_nsyid);
        postdot_item; postdot_item = Next_PIM_of_PIM (postdot_item))
     {
       const YIM predecessor = YIM_of_PIM (postdot_item);
@@ -8304,28 +10750,466 @@ active.
     leo_link_add (r, effect, leo_item, cause);
 }
 
-@ @<Add predictions to |current_earley_set|@> =
+@ Predictions are added from the predicted AHM CIL of
+each postdot NSY.
+The only Earley items in the current Earley set whose origin
+is the current Earley set are predictions,
+so a boolean vector by AHM ID is enough to find duplicates,
+and the PSL's are not needed.
+Closures are added whole,
+so that if the first LHS AHM of a postdot NSY
+has already been predicted,
+all of its closure has been,
+and the NSY can be skipped.
+@<Add predictions to |current_earley_set|@> =
+{
+  int ix;
+  const int no_of_work_earley_items =
+    MARPA_DSTACK_LENGTH (r->t_yim_work_stack);
+  const DBV dbv_ahm_predicted = &r->t_dbv_ahm_predicted;
+  YIK_Object key;
+  key.t_set = current_earley_set;
+  key.t_origin = current_earley_set;
+  dbv_clear (dbv_ahm_predicted);
+  for (ix = 0; ix < no_of_work_earley_items; ix++)
+    {
+      YIM earley_item = WORK_YIM_ITEM (r, ix);
+      const NSYID postdot_nsyid = Postdot_NSYID_of_YIM (earley_item);
+      NSY postdot_nsy;
+      AHMID first_lhs_ahmid;
+      CIL prediction_cil;
+      int prediction_count;
+      int cil_ix;
+      if (postdot_nsyid < 0)
+        continue;
+      postdot_nsy = NSY_by_ID (postdot_nsyid);
+      first_lhs_ahmid = First_LHS_AHMID_of_NSY (postdot_nsy);
+      if (first_lhs_ahmid < 0 || dbv_bit_test (dbv_ahm_predicted, first_lhs_ahmid))
+        continue;
+      prediction_cil = Predicted_AHM_CIL_of_NSY (postdot_nsy);
+      prediction_count = Count_of_CIL (prediction_cil);
+      for (cil_ix = 0; cil_ix < prediction_count; cil_ix++)
+        {
+          const AHMID prediction_ahmid = Item_of_CIL (prediction_cil, cil_ix);
+          if (dbv_bit_test_then_set (dbv_ahm_predicted, prediction_ahmid))
+            continue;
+          key.t_ahm = AHM_by_ID (prediction_ahmid);
+          earley_item_create (r, key);
+          R_Stat_Add (r, t_prediction_count, 1);
+        }
+    }
+}
+
+@ There are many more AHM's than predictions in one Earley set,
+so the vector of predicted AHM's is a dirty-word vector.
+@<Widely aligned recognizer elements@> =
+  struct s_dirty_bv t_dbv_ahm_predicted;
+@ @<Initialize recognizer elements@> =
+  dbv_obs_init (r->t_obs, &r->t_dbv_ahm_predicted, AHM_Count_of_G (g));
+
+@*0 Prediction states in the recognizer.
+A recognizer using prediction states
+gives each Earley set after the first a prediction state,
+as described with the grammar's prediction states,
+and adds only its immediate predictions as Earley items.
+Earley set 0 always gets all of its predictions,
+because their zero-width assertions are evaluated as they are added.
+@ The recognizer's setting can only be changed before input starts,
+and only to use prediction states if the grammar has them.
+In streaming mode, the Earley sets are discarded by freeing the
+segments they were created in,
+but a deferred prediction may be added to an Earley set
+long after the Earley set was created.
+So streaming mode and prediction states cannot be used together.
+@d R_is_Using_Prediction_States(r) ((r)->t_is_using_prediction_states)
+@d Prediction_State_of_YS(set) ((set)->t_prediction_state)
+@<Bit aligned recognizer elements@> =
+BITFIELD t_is_using_prediction_states:1;
+@ @<Initialize recognizer elements@> =
+r->t_is_using_prediction_states = 0;
+@ @<Widely aligned Earley set elements@> =
+    CIL t_prediction_state;
+@ @<Initialize Earley set@> =
+   Prediction_State_of_YS(set) = NULL;
+
+@ Returns 1 if the recognizer is using prediction states,
+0 if not,
+and |-2| if there was an error.
+@<Function definitions@> =
+int marpa_r_prediction_states(Marpa_Recognizer r)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@;
+    @<Fail if fatal error@>@;
+    return R_is_Using_Prediction_States(r);
+}
+@ @<Function definitions@> =
+int marpa_r_prediction_states_set(Marpa_Recognizer r, int value)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@/
+    @<Fail if fatal error@>@;
+    @<Fail if recognizer started@>@;
+    if (_MARPA_UNLIKELY (value < 0 || value > 1))
+      {
+        MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+        return failure_indicator;
+      }
+    if (value && _MARPA_UNLIKELY (!G_has_Prediction_States (g)))
+      {
+        MARPA_ERROR (MARPA_ERR_NO_PREDICTION_STATES);
+        return failure_indicator;
+      }
+    if (value && _MARPA_UNLIKELY (R_is_Streaming (r)))
+      {
+        MARPA_ERROR (MARPA_ERR_PREDICTION_STATES_STREAMING);
+        return failure_indicator;
+      }
+    return R_is_Using_Prediction_States(r) = value ? 1 : 0;
+}
+
+@ The deferred predictions added to an Earley set
+after it is complete,
+and the copies of its arrays enlarged to make room for them,
+are allocated from an obstack of their own.
+They would not survive a rollback if they were on the
+Earley set obstack,
+but the Earley set they were added to may.
+@<Widely aligned recognizer elements@> =
+struct marpa_obstack* t_prediction_obs;
+Bit_Vector t_bv_nsyid_is_predicted;
+Bit_Vector t_bv_nsyid_is_deferred_postdot;
+@ @<Initialize recognizer elements@> =
+r->t_prediction_obs = NULL;
+r->t_bv_nsyid_is_predicted = NULL;
+r->t_bv_nsyid_is_deferred_postdot = NULL;
+@ @<Allocate recognizer containers@> =
+if (R_is_Using_Prediction_States (r))
+  {
+    r->t_prediction_obs = marpa_obs_init;
+    r->t_bv_nsyid_is_predicted = bv_obs_create (r->t_obs, nsy_count);
+    r->t_bv_nsyid_is_deferred_postdot = bv_obs_create (r->t_obs, nsy_count);
+  }
+@ @<Destroy recognizer obstack@> =
+if (r->t_prediction_obs)
+  marpa_obs_free (r->t_prediction_obs);
+
+@ As when all the predictions are added,
+a postdot NSY is skipped if it has already been predicted.
+An immediate prediction is skipped if its LHS has
+already been predicted,
+because all the immediate predictions with that LHS
+were added along with it.
+For this reason the NSY's predicted by a postdot NSY
+are only marked after its immediate predictions are added.
+@<Add the prediction state to |current_earley_set|@> =
+{
+  int ix;
+  int is_predicting = 0;
+  const int no_of_work_earley_items =
+    MARPA_DSTACK_LENGTH (r->t_yim_work_stack);
+  const Bit_Vector bv_nsyid_is_predicted = r->t_bv_nsyid_is_predicted;
+  const Bit_Vector bv_nsyid_is_deferred_postdot =
+    r->t_bv_nsyid_is_deferred_postdot;
+  YIK_Object key;
+  key.t_set = current_earley_set;
+  key.t_origin = current_earley_set;
+  bv_clear (bv_nsyid_is_predicted);
+  bv_clear (bv_nsyid_is_deferred_postdot);
+  for (ix = 0; ix < no_of_work_earley_items; ix++)
+    {
+      YIM earley_item = WORK_YIM_ITEM (r, ix);
+      const NSYID postdot_nsyid = Postdot_NSYID_of_YIM (earley_item);
+      NSY postdot_nsy;
+      CIL cil;
+      int cil_count;
+      int cil_ix;
+      if (postdot_nsyid < 0
+          || bv_bit_test (bv_nsyid_is_predicted, postdot_nsyid))
+        continue;
+      postdot_nsy = NSY_by_ID (postdot_nsyid);
+      cil = Immediate_AHM_CIL_of_NSY (postdot_nsy);
+      cil_count = Count_of_CIL (cil);
+      for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
+        {
+          const AHM prediction_ahm = AHM_by_ID (Item_of_CIL (cil, cil_ix));
+          if (bv_bit_test
+              (bv_nsyid_is_predicted, LHS_NSYID_of_AHM (prediction_ahm)))
+            continue;
+          key.t_ahm = prediction_ahm;
+          earley_item_create (r, key);
+          R_Stat_Add (r, t_prediction_count, 1);
+        }
+      cil = Predicted_NSY_CIL_of_NSY (postdot_nsy);
+      cil_count = Count_of_CIL (cil);
+      for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
+        {
+          bv_bit_set (bv_nsyid_is_predicted, Item_of_CIL (cil, cil_ix));
+          is_predicting = 1;
+        }
+      cil = Deferred_Postdot_CIL_of_NSY (postdot_nsy);
+      cil_count = Count_of_CIL (cil);
+      for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
+        {
+          bv_bit_set (bv_nsyid_is_deferred_postdot, Item_of_CIL (cil, cil_ix));
+        }
+    }
+  if (is_predicting)
+    {
+      Prediction_State_of_YS (current_earley_set) =
+        cil_bv_add (CILAR_of_R (r), bv_nsyid_is_predicted);
+      R_Stat_Add (r, t_prediction_state_count, 1);
+    }
+}
+
+@ The deferred predictions have no postdot items,
+but their postdot NSY's are expected all the same,
+and their expected symbol events are triggered
+in the same order as if they had postdot items.
+@<Add the deferred postdot NSY's to the postdot NSY's@> =
+{
+  bv_or_assign (r->t_bv_nsyid_is_deferred_postdot, r->t_bv_pim_symbols);
+  bv_postdot_nsyids = r->t_bv_nsyid_is_deferred_postdot;
+}
+
+@ The deferred predictions are found from the prediction state,
+through the IRL's with the predicted NSY's as their LHS.
+This also finds the immediate predictions,
+but that does no harm.
+@<Trigger the events of the deferred predictions@> =
+{
+  const CIL predicted_nsyids = Prediction_State_of_YS (current_earley_set);
+  const int predicted_nsy_count = Count_of_CIL (predicted_nsyids);
+  int nsy_ix;
+  for (nsy_ix = 0; nsy_ix < predicted_nsy_count; nsy_ix++)
+    {
+      const CIL lhs_cil =
+        LHS_CIL_of_NSYID (Item_of_CIL (predicted_nsyids, nsy_ix));
+      const int lhs_count = Count_of_CIL (lhs_cil);
+      int cil_ix;
+      for (cil_ix = 0; cil_ix < lhs_count; cil_ix++)
+        {
+          const AHM prediction_ahm =
+            First_AHM_of_IRL (IRL_by_ID (Item_of_CIL (lhs_cil, cil_ix)));
+          if (AHM_has_Event (prediction_ahm))
+            bv_bit_set (bv_ahm_event_trigger, ID_of_AHM (prediction_ahm));
+        }
+    }
+}
+
+@ Find the first postdot item of |set| for |nsyid|,
+first adding any deferred predictions of |set| which have
+|nsyid| as their postdot NSY.
+No other prediction of |set| has the postdot NSY of a deferred
+prediction,
+so if the first postdot item is a prediction of |set|,
+the deferred predictions have already been added.
+@ The Earley items and postdot items of |set| are left
+in the order they would have had if all its predictions
+had been added along with it,
+so that the bocage, and the order of its trees,
+do not depend on whether prediction states are used.
+The non-predictions come first,
+and the predictions follow in the order in which
+|@<Add predictions to |current_earley_set|@>| would have
+added them.
+That order is found again by going through the
+predicted AHM CIL's of the postdot NSY's of the non-predictions,
+as that code does.
+The predictions already in |set|, which are in this order,
+are merged with the new ones,
+and the ordinals of the predictions are reset to their
+new places.
+If a new Earley item cannot be created,
+the remaining old predictions are kept,
+in the order they were in.
+Postdot items are added at the head of their lists,
+so the postdot items of the new predictions are added
+as the new predictions are found,
+and their list is in the reverse of that order,
+as it would have been.
+@d Materialized_PIM_of_YS_by_NSYID(r, set, nsyid)
+  (Prediction_State_of_YS(set)
+    ? predictions_materialize((r), (set), (nsyid))
+    : First_PIM_of_YS_by_NSYID((set), (nsyid)))
+@<Function definitions@> =
+PRIVATE_NOT_INLINE PIM
+predictions_materialize (RECCE r, YS set, NSYID nsyid)
+{
+  @<Unpack recognizer objects@>@;
+  PIM *const pim_nsy_p = PIM_NSY_P_of_YS_by_NSYID (set, nsyid);
+  PIM first_pim = pim_nsy_p ? *pim_nsy_p : NULL;
+  const CIL predicted_nsyids = Prediction_State_of_YS (set);
+  const CIL deferred_ahmids = Deferred_AHM_CIL_of_NSYID (nsyid);
+  const int deferred_ahm_count = Count_of_CIL (deferred_ahmids);
+  const int old_yim_count = YIM_Count_of_YS (set);
+  const YIM *const old_yims = YIMs_of_YS (set);
+  int new_yim_count = 0;
+  int cil_ix;
+  YIM *yims;
+  if (deferred_ahm_count <= 0)
+    return first_pim;
+  if (first_pim
+      && Origin_Ord_of_YIM (YIM_of_PIM (first_pim)) == Ord_of_YS (set))
+    return first_pim;
+  for (cil_ix = 0; cil_ix < deferred_ahm_count; cil_ix++)
+    {
+      const AHM ahm = AHM_by_ID (Item_of_CIL (deferred_ahmids, cil_ix));
+      if (cil_is_member (predicted_nsyids, LHS_NSYID_of_AHM (ahm)))
+        new_yim_count++;
+    }
+  if (new_yim_count <= 0)
+    return first_pim;
+  yims = marpa_obs_new (r->t_prediction_obs, YIM,
+                        old_yim_count + new_yim_count);
+  @<Merge the new predictions into |yims|@>@;
+  YIMs_of_YS (set) = yims;
+  if (pim_nsy_p)
+    *pim_nsy_p = first_pim;
+  else
+    postdot_item_insert (r, set, first_pim);
+  return first_pim;
+}
+
+@ @<Merge the new predictions into |yims|@> =
 {
-  int ix;
-  const int no_of_work_earley_items =
-    MARPA_DSTACK_LENGTH (r->t_yim_work_stack);
-  for (ix = 0; ix < no_of_work_earley_items; ix++)
+  const DBV dbv_ahm_predicted = &r->t_dbv_ahm_predicted;
+  int old_yim_ix = 0;
+  int yim_ix;
+  int predictions_to_place = old_yim_count + new_yim_count;
+  int no_of_work_earley_items;
+  int work_ix;
+  while (old_yim_ix < old_yim_count
+         && Origin_Ord_of_YIM (old_yims[old_yim_ix]) != Ord_of_YS (set))
     {
-      YIM earley_item = WORK_YIM_ITEM (r, ix);
+      yims[old_yim_ix] = old_yims[old_yim_ix];
+      old_yim_ix++;
+    }
+  no_of_work_earley_items = yim_ix = old_yim_ix;
+  predictions_to_place -= no_of_work_earley_items;
+  dbv_clear (dbv_ahm_predicted);
+  for (work_ix = 0; predictions_to_place > 0 && work_ix < no_of_work_earley_items;
+       work_ix++)
+    {
+      const NSYID postdot_nsyid = Postdot_NSYID_of_YIM (yims[work_ix]);
+      NSY postdot_nsy;
+      AHMID first_lhs_ahmid;
+      CIL prediction_cil;
+      int prediction_cil_count;
+      if (postdot_nsyid < 0)
+        continue;
+      postdot_nsy = NSY_by_ID (postdot_nsyid);
+      first_lhs_ahmid = First_LHS_AHMID_of_NSY (postdot_nsy);
+      if (first_lhs_ahmid < 0
+          || dbv_bit_test (dbv_ahm_predicted, first_lhs_ahmid))
+        continue;
+      prediction_cil = Predicted_AHM_CIL_of_NSY (postdot_nsy);
+      prediction_cil_count = Count_of_CIL (prediction_cil);
+      for (cil_ix = 0; cil_ix < prediction_cil_count; cil_ix++)
+        {
+          const AHMID ahmid = Item_of_CIL (prediction_cil, cil_ix);
+          const AHM ahm = AHM_by_ID (ahmid);
+          YIM yim;
+          if (dbv_bit_test_then_set (dbv_ahm_predicted, ahmid))
+            continue;
+          if (old_yim_ix < old_yim_count
+              && AHM_of_YIM (old_yims[old_yim_ix]) == ahm)
+            {
+              yim = old_yims[old_yim_ix++];
+            }
+          else if (Postdot_NSYID_of_AHM (ahm) == nsyid)
+            {
+              YIK_Object key;
+              PIM new_pim;
+              key.t_set = set;
+              key.t_origin = set;
+              key.t_ahm = ahm;
+              yim = earley_item_new (r, key, r->t_prediction_obs);
+              if (!yim)
+                {
+                  predictions_to_place = 0;
+                  break;
+                }
+              R_Stat_Add (r, t_prediction_count, 1);
+              new_pim =
+                (PIM) marpa_obs_new (r->t_prediction_obs, YIX_Object, 1);
+              Postdot_NSYID_of_PIM (new_pim) = nsyid;
+              YIM_of_PIM (new_pim) = yim;
+              Next_PIM_of_PIM (new_pim) = first_pim;
+              first_pim = new_pim;
+              R_Stat_Add (r, t_postdot_item_count, 1);
+            }
+          else
+            continue;
+          Ord_of_YIM (yim) = YIM_ORDINAL_CLAMP ((unsigned int) yim_ix);
+          yims[yim_ix++] = yim;
+          predictions_to_place--;
+        }
+    }
+  while (old_yim_ix < old_yim_count)
+    {
+      const YIM yim = old_yims[old_yim_ix++];
+      Ord_of_YIM (yim) = YIM_ORDINAL_CLAMP ((unsigned int) yim_ix);
+      yims[yim_ix++] = yim;
+    }
+  YIM_Count_of_YS (set) = yim_ix;
+}
 
+@ The postdot item array of |set| is copied,
+to make room for a postdot item with a new postdot NSY,
+and its postdot index, if it needs one, is built again.
+@<Function definitions@> =
+PRIVATE void
+postdot_item_insert (RECCE r, YS set, PIM pim)
+{
+  const NSYID nsyid = Postdot_NSYID_of_PIM (pim);
+  const int old_count = Postdot_SYM_Count_of_YS (set);
+  PIM *const old_array = set->t_postdot_ary;
+  PIM *const new_array =
+    marpa_obs_new (r->t_prediction_obs, PIM, old_count + 1);
+  int old_ix;
+  int new_ix = 0;
+  for (old_ix = 0; old_ix < old_count; old_ix++)
+    {
+      if (new_ix == old_ix
+          && Postdot_NSYID_of_PIM (old_array[old_ix]) > nsyid)
+        new_array[new_ix++] = pim;
+      new_array[new_ix++] = old_array[old_ix];
+    }
+  if (new_ix == old_count)
+    new_array[new_ix] = pim;
+  set->t_postdot_ary = new_array;
+  Postdot_SYM_Count_of_YS (set) = old_count + 1;
+  Postdot_Index_of_YS (set) = NULL;
+  postdot_index_build (r, set, r->t_prediction_obs);
+}
+
+@ Add all the deferred predictions of |set|.
+This is done before |set| is looked at as a whole,
+for progress reports,
+for tracing,
+and for cleaning up after rejected Earley items.
+@<Function definitions@> =
+PRIVATE void
+earley_set_predictions_materialize (RECCE r, YS set)
+{
+  const GRAMMAR g = G_of_R (r);
+  const CIL predicted_nsyids = Prediction_State_of_YS (set);
+  int nsy_ix;
+  if (!predicted_nsyids)
+    return;
+  for (nsy_ix = 0; nsy_ix < Count_of_CIL (predicted_nsyids); nsy_ix++)
+    {
+      const CIL lhs_cil =
+        LHS_CIL_of_NSYID (Item_of_CIL (predicted_nsyids, nsy_ix));
       int cil_ix;
-      const AHM ahm = AHM_of_YIM (earley_item);
-      const CIL prediction_cil = Predicted_IRL_CIL_of_AHM (ahm);
-      const int prediction_count = Count_of_CIL (prediction_cil);
-      for (cil_ix = 0; cil_ix < prediction_count; cil_ix++)
-	{
-	  const IRLID prediction_irlid = Item_of_CIL (prediction_cil, cil_ix);
-	  const IRL prediction_irl = IRL_by_ID (prediction_irlid);
-	  const AHM prediction_ahm = First_AHM_of_IRL (prediction_irl);
-	  earley_item_assign (r, current_earley_set, current_earley_set,
-			      prediction_ahm);
-	}
-
+      for (cil_ix = 0; cil_ix < Count_of_CIL (lhs_cil); cil_ix++)
+        {
+          const AHM prediction_ahm =
+            First_AHM_of_IRL (IRL_by_ID (Item_of_CIL (lhs_cil, cil_ix)));
+          predictions_materialize (r, set,
+                                   Postdot_NSYID_of_AHM (prediction_ahm));
+        }
     }
 }
 
@@ -8380,6 +11264,10 @@ PRIVATE void trigger_events(RECCE r)
           }
       }
     }
+  if (Prediction_State_of_YS (current_earley_set))
+    {
+      @<Trigger the events of the deferred predictions@>@;
+    }
 
   for (start = 0; bv_scan (bv_ahm_event_trigger, start, &min, &max);
        start = max + 2)
@@ -8453,7 +11341,7 @@ PRIVATE void trigger_events(RECCE r)
           if (lbv_bit_test
               (r->t_lbv_xsyid_completion_event_is_active, event_xsyid))
             {
-              int_event_new (g, MARPA_EVENT_SYMBOL_COMPLETED, event_xsyid);
+              int_event_new (Events_of_R (r), MARPA_EVENT_SYMBOL_COMPLETED, event_xsyid);
             }
         }
     }
@@ -8467,7 +11355,7 @@ PRIVATE void trigger_events(RECCE r)
           if (lbv_bit_test
               (r->t_lbv_xsyid_nulled_event_is_active, event_xsyid))
             {
-              int_event_new (g, MARPA_EVENT_SYMBOL_NULLED, event_xsyid);
+              int_event_new (Events_of_R (r), MARPA_EVENT_SYMBOL_NULLED, event_xsyid);
             }
 
         }
@@ -8482,7 +11370,7 @@ PRIVATE void trigger_events(RECCE r)
           if (lbv_bit_test
               (r->t_lbv_xsyid_prediction_event_is_active, event_xsyid))
             {
-              int_event_new (g, MARPA_EVENT_SYMBOL_PREDICTED, event_xsyid);
+              int_event_new (Events_of_R (r), MARPA_EVENT_SYMBOL_PREDICTED, event_xsyid);
             }
         }
     }
@@ -8510,7 +11398,7 @@ PRIVATE int trigger_trivial_events(RECCE r)
     {
       const XSYID nulled_xsyid = Item_of_CIL (nulled_xsyids, cil_ix);
       if (lbv_bit_test(r->t_lbv_xsyid_nulled_event_is_active, nulled_xsyid)) {
-        int_event_new (g, MARPA_EVENT_SYMBOL_NULLED, nulled_xsyid);
+        int_event_new (Events_of_R (r), MARPA_EVENT_SYMBOL_NULLED, nulled_xsyid);
         event_count++;
       }
     }
@@ -8524,7 +11412,7 @@ PRIVATE void earley_set_update_items(RECCE r, YS set)
     YIM* finished_earley_items;
     int working_earley_item_count;
     int i;
-    YIMs_of_YS(set) = marpa_obs_new(r->t_obs, YIM, YIM_Count_of_YS(set));
+    YIMs_of_YS(set) = marpa_obs_new(r->t_ys_obs, YIM, YIM_Count_of_YS(set));
     finished_earley_items = YIMs_of_YS(set);
     /* We know that no new earley items will be added in this scope */
     working_earley_items = Work_YIMs_of_R(r);
@@ -8534,37 +11422,721 @@ PRIVATE void earley_set_update_items(RECCE r, YS set)
          int ordinal = Ord_of_YIM(earley_item);
          finished_earley_items[ordinal] = earley_item;
     }
-    WORK_YIMS_CLEAR(r);
+    WORK_YIMS_CLEAR(r);
+}
+
+@ This function is called exactly once during a normal parse --
+at the end, when it is time for a bocage to be created.
+It is also called by trace and debugging methods.
+It must be used carefully since it takes $O(\log n)$ time,
+where $n$ is the number of Earley sets.
+If called after every Earley set, it would make Marpa
+$O(n \log n)$ in the best case.
+In streaming mode, the Earley set stack holds only
+the Earley sets which have not been discarded,
+and is always up to date.
+@d YS_of_R_by_Ord(r, ord) (R_is_Streaming(r)
+    ? ys_of_streaming_r_by_ord((r), (ord))
+    : *MARPA_DSTACK_INDEX((r)->t_earley_set_stack, YS, (ord)))
+@<Function definitions@> =
+PRIVATE void r_update_earley_sets(RECCE r)
+{
+    YS set;
+    YS first_unstacked_earley_set;
+    if (!MARPA_DSTACK_IS_INITIALIZED(r->t_earley_set_stack)) {
+        first_unstacked_earley_set = First_YS_of_R(r);
+        MARPA_DSTACK_INIT (r->t_earley_set_stack, YS,
+                 MAX (1024, YS_Count_of_R(r)));
+    } else {
+         YS* end_of_stack = MARPA_DSTACK_TOP(r->t_earley_set_stack, YS);
+         first_unstacked_earley_set = Next_YS_of_YS(*end_of_stack);
+    }
+    for (set = first_unstacked_earley_set; set; set = Next_YS_of_YS(set)) {
+          YS* end_of_stack = MARPA_DSTACK_PUSH(r->t_earley_set_stack, YS);
+          (*end_of_stack) = set;
+    }
+}
+
+@*0 Streaming.
+For a long input, most of the Earley sets
+eventually become unreachable from the latest Earley set,
+but they stay on the recognizer obstack until the
+recognizer is destroyed.
+In streaming mode, the recognizer discards them,
+so that an unbounded input can be recognized in bounded memory.
+@ Objects cannot be freed individually from an obstack,
+so in streaming mode
+the Earley sets,
+and everything allocated for them,
+are allocated from a series of
+{\it segments}, each of which is its own obstack,
+and which contains a run of Earley sets
+with consecutive ordinals.
+When the current segment is full,
+before the next Earley set is created,
+the recognizer finds the Earley sets which are still reachable,
+frees every segment which holds none of them,
+and starts a new segment.
+The entries for the Earley sets of the freed segments
+are also removed from the Earley set stack,
+so that the memory used in streaming mode
+is proportional to the number of Earley sets kept,
+and not to the length of the input.
+Outside of streaming mode,
+the Earley sets are allocated from the recognizer obstack,
+and there are no segments.
+@d YS_SEGMENT_SIZE (64*1024)
+@d R_is_Streaming(r) ((r)->t_is_streaming)
+@d Discarded_YS_Count_of_R(r) ((r)->t_discarded_ys_count)
+@<Private structures@> =
+struct s_earley_set_segment {
+    struct marpa_obstack* t_obs;
+    YSID t_first_ysid;
+    YSID t_end_ysid;
+    int t_first_stack_ix;
+};
+@ @<Bit aligned recognizer elements@> =
+BITFIELD t_is_streaming:1;
+@ @<Widely aligned recognizer elements@> =
+struct marpa_obstack* t_ys_obs;
+MARPA_DSTACK_DECLARE(t_ys_segments);
+@ @<Int aligned recognizer elements@> =
+int t_discarded_ys_count;
+int t_ys_live_mark;
+@ @<Initialize recognizer elements@> =
+r->t_is_streaming = 0;
+r->t_ys_obs = r->t_obs;
+MARPA_DSTACK_SAFE(r->t_ys_segments);
+r->t_discarded_ys_count = 0;
+r->t_ys_live_mark = 0;
+@ The segments are freed along with the recognizer obstack,
+because destroying the recognizer elements
+may touch the Earley sets.
+@<Destroy recognizer obstack@> =
+{
+  if (MARPA_DSTACK_IS_INITIALIZED (r->t_ys_segments))
+    {
+      int segment_ix;
+      const int segment_count = MARPA_DSTACK_LENGTH (r->t_ys_segments);
+      struct s_earley_set_segment *const segments =
+        MARPA_DSTACK_BASE (r->t_ys_segments, struct s_earley_set_segment);
+      for (segment_ix = 0; segment_ix < segment_count; segment_ix++)
+        {
+          marpa_obs_free (segments[segment_ix].t_obs);
+        }
+    }
+  MARPA_DSTACK_DESTROY (r->t_ys_segments);
+}
+
+@ An Earley set is live if its mark is the same
+as the recognizer's current mark.
+@<Int aligned Earley set elements@> =
+    int t_live_mark;
+@ @<Initialize Earley set@> =
+   set->t_live_mark = 0;
+
+@ Returns 1 if the recognizer is in streaming mode,
+0 if not,
+and |-2| if there was an error.
+@<Function definitions@> =
+int marpa_r_streaming(Marpa_Recognizer r)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@;
+    @<Fail if fatal error@>@;
+    return R_is_Streaming(r);
+}
+@ The mode can only be changed before input starts.
+@<Function definitions@> =
+int marpa_r_streaming_set(Marpa_Recognizer r, int value)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@/
+    @<Fail if fatal error@>@;
+    @<Fail if recognizer started@>@;
+    if (_MARPA_UNLIKELY (value < 0 || value > 1))
+      {
+        MARPA_ERROR (MARPA_ERR_INVALID_BOOLEAN);
+        return failure_indicator;
+      }
+    if (value && _MARPA_UNLIKELY (R_is_Using_Prediction_States (r)))
+      {
+        MARPA_ERROR (MARPA_ERR_PREDICTION_STATES_STREAMING);
+        return failure_indicator;
+      }
+    return R_is_Streaming(r) = value ? 1 : 0;
+}
+
+@ @<Function definitions@> =
+int marpa_r_discarded_earley_set_count(Marpa_Recognizer r)
+{
+   @<Unpack recognizer objects@>@;
+   @<Return |-2| on failure@>@;
+    @<Fail if fatal error@>@;
+    return Discarded_YS_Count_of_R(r);
+}
+
+@ Start a new segment.
+The Earley set stack is kept up to date in streaming mode,
+and the next Earley set will be the first in the new segment.
+@<Function definitions@> =
+PRIVATE void
+earley_set_segment_new (RECCE r)
+{
+  struct s_earley_set_segment *segment;
+  if (!MARPA_DSTACK_IS_INITIALIZED (r->t_ys_segments))
+    {
+      MARPA_DSTACK_INIT2 (r->t_ys_segments, struct s_earley_set_segment);
+    }
+  segment = MARPA_DSTACK_PUSH (r->t_ys_segments, struct s_earley_set_segment);
+  segment->t_obs = marpa_obs_init;
+  segment->t_first_ysid = YS_Count_of_R (r);
+  segment->t_end_ysid = -1;
+  segment->t_first_stack_ix = MARPA_DSTACK_LENGTH (r->t_earley_set_stack);
+  r->t_ys_obs = segment->t_obs;
+}
+
+@ Find an Earley set by ordinal in streaming mode.
+The Earley set is usually in the current segment,
+which is checked first.
+Otherwise, the kept segments, which are few,
+are searched.
+Returns |NULL| if the Earley set was discarded.
+@<Function definitions@> =
+PRIVATE YS
+ys_of_streaming_r_by_ord (RECCE r, YSID ord)
+{
+  const struct s_earley_set_segment *const segments =
+    MARPA_DSTACK_BASE (r->t_ys_segments, struct s_earley_set_segment);
+  const struct s_earley_set_segment *segment;
+  int lo = 0;
+  int hi = MARPA_DSTACK_LENGTH (r->t_ys_segments) - 1;
+  if (_MARPA_LIKELY (ord >= segments[hi].t_first_ysid))
+    {
+      segment = segments + hi;
+      return *MARPA_DSTACK_INDEX (r->t_earley_set_stack, YS,
+                                  segment->t_first_stack_ix + ord -
+                                  segment->t_first_ysid);
+    }
+  while (lo < hi)
+    {
+      const int mid = lo + (hi - lo + 1) / 2;
+      if (segments[mid].t_first_ysid <= ord)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+  segment = segments + lo;
+  if (ord < segment->t_first_ysid || ord >= segment->t_end_ysid)
+    return NULL;
+  return *MARPA_DSTACK_INDEX (r->t_earley_set_stack, YS,
+                              segment->t_first_stack_ix + ord -
+                              segment->t_first_ysid);
+}
+
+@ @<Start a new Earley set segment, if the current one is full@> =
+{
+  if (R_is_Streaming (r) && marpa__obs_size (r->t_ys_obs) >= YS_SEGMENT_SIZE)
+    {
+      struct s_earley_set_segment *const current_segment =
+        MARPA_DSTACK_TOP (r->t_ys_segments, struct s_earley_set_segment);
+      current_segment->t_end_ysid = YS_Count_of_R (r);
+      if (Checkpoint_Count_of_R (r) <= 0)
+        earley_sets_discard (r);
+      earley_set_segment_new (r);
+    }
+}
+
+@ Find the live Earley sets and free the segments that
+contain none of them.
+This is called between Earley sets,
+when the latest Earley set is complete.
+@ An Earley set can be reached in the future only as
+the origin of an Earley item,
+or as the start of a token.
+The latest Earley set is live,
+and so is the origin of every Earley item in it,
+because its Earley items' sources refer to
+the Earley sets which are the origins of their causes.
+A pending token makes its start Earley set live.
+Later Earley items are created only by scanning from,
+or completing into,
+the postdot items of live Earley sets,
+so the origins of
+the postdot items of every live Earley set are also live.
+The origin of a Leo item is the origin of the
+Earley items it completes,
+so it is live as well.
+@ Earley items in an Earley set which is kept
+may still refer to
+Earley sets that were discarded,
+through their origins and sources.
+This code,
+and the recognizer as it goes forward,
+never follows those references,
+but the bocage, and the trace functions,
+would.
+@<Function definitions@> =
+PRIVATE void
+earley_sets_discard (RECCE r)
+{
+  const int live_mark = ++r->t_ys_live_mark;
+  MARPA_DSTACK_DECLARE (live_stack);
+  MARPA_DSTACK_INIT (live_stack, YS, 1024);
+  @<Mark the roots of the live Earley sets@>@;
+  @<Mark the Earley sets reachable from the roots@>@;
+  MARPA_DSTACK_DESTROY (live_stack);
+  @<Free the segments with no live Earley sets@>@;
+  @<Relink the Earley sets which were kept@>@;
+  @<Clear data which may refer to discarded Earley sets@>@;
+}
+
+@ @<Mark the Earley set |set_to_mark| as live@> =
+{
+  if (set_to_mark && set_to_mark->t_live_mark != live_mark)
+    {
+      set_to_mark->t_live_mark = live_mark;
+      *MARPA_DSTACK_PUSH (live_stack, YS) = set_to_mark;
+    }
+}
+
+@ @<Mark the roots of the live Earley sets@> =
+{
+  const YS latest_set = Latest_YS_of_R (r);
+  const YIM *const yims = YIMs_of_YS (latest_set);
+  const int yim_count = YIM_Count_of_YS (latest_set);
+  const int alternative_count = MARPA_DSTACK_LENGTH (r->t_alternatives);
+  int ix;
+  {
+    const YS set_to_mark = latest_set;
+    @<Mark the Earley set |set_to_mark| as live@>@;
+  }
+  for (ix = 0; ix < yim_count; ix++)
+    {
+      const YS set_to_mark = Origin_of_YIM (yims[ix]);
+      @<Mark the Earley set |set_to_mark| as live@>@;
+    }
+  for (ix = 0; ix < alternative_count; ix++)
+    {
+      const ALT alternative =
+        MARPA_DSTACK_INDEX (r->t_alternatives, ALT_Object, ix);
+      const YS set_to_mark = Start_YS_of_ALT (alternative);
+      @<Mark the Earley set |set_to_mark| as live@>@;
+    }
+}
+
+@ @<Mark the Earley sets reachable from the roots@> =
+{
+  YS *p_live_set;
+  while ((p_live_set = MARPA_DSTACK_POP (live_stack, YS)))
+    {
+      const YS live_set = *p_live_set;
+      const int postdot_sym_count = Postdot_SYM_Count_of_YS (live_set);
+      PIM *const postdot_array = live_set->t_postdot_ary;
+      int postdot_sym_ix;
+      for (postdot_sym_ix = 0; postdot_sym_ix < postdot_sym_count;
+           postdot_sym_ix++)
+        {
+          PIM pim;
+          for (pim = postdot_array[postdot_sym_ix]; pim;
+               pim = Next_PIM_of_PIM (pim))
+            {
+              const YS set_to_mark = PIM_is_LIM (pim)
+                ? Origin_of_LIM (LIM_of_PIM (pim))
+                : Origin_of_YIM (YIM_of_PIM (pim));
+              @<Mark the Earley set |set_to_mark| as live@>@;
+            }
+        }
+    }
+}
+
+@ The current segment holds the latest Earley set,
+so it is never freed.
+The entries of the kept segments are moved down
+in the Earley set stack,
+over those of the freed segments.
+@<Free the segments with no live Earley sets@> =
+{
+  int segment_ix;
+  int kept_segment_count = 0;
+  int kept_set_count = 0;
+  const int segment_count = MARPA_DSTACK_LENGTH (r->t_ys_segments);
+  struct s_earley_set_segment *const segments =
+    MARPA_DSTACK_BASE (r->t_ys_segments, struct s_earley_set_segment);
+  YS *const stack = MARPA_DSTACK_BASE (r->t_earley_set_stack, YS);
+  for (segment_ix = 0; segment_ix < segment_count; segment_ix++)
+    {
+      struct s_earley_set_segment *const segment = segments + segment_ix;
+      const int set_count = segment->t_end_ysid - segment->t_first_ysid;
+      YS *const sets_of_segment = stack + segment->t_first_stack_ix;
+      int is_live = segment_ix >= segment_count - 1;
+      int ix;
+      for (ix = 0; !is_live && ix < set_count; ix++)
+        {
+          is_live = sets_of_segment[ix]->t_live_mark == live_mark;
+        }
+      if (is_live)
+        {
+          for (ix = 0; ix < set_count; ix++)
+            {
+              stack[kept_set_count + ix] = sets_of_segment[ix];
+            }
+          segment->t_first_stack_ix = kept_set_count;
+          kept_set_count += set_count;
+          segments[kept_segment_count++] = *segment;
+          continue;
+        }
+      Discarded_YS_Count_of_R (r) += set_count;
+      marpa_obs_free (segment->t_obs);
+    }
+  MARPA_DSTACK_COUNT_SET (r->t_ys_segments, kept_segment_count);
+  MARPA_DSTACK_COUNT_SET (r->t_earley_set_stack, kept_set_count);
+}
+
+@ The Earley sets within each segment are still linked,
+so only the last Earley set of each kept segment
+needs to be relinked.
+@<Relink the Earley sets which were kept@> =
+{
+  int segment_ix;
+  const int segment_count = MARPA_DSTACK_LENGTH (r->t_ys_segments);
+  const struct s_earley_set_segment *const segments =
+    MARPA_DSTACK_BASE (r->t_ys_segments, struct s_earley_set_segment);
+  First_YS_of_R (r) = YS_of_R_by_Ord (r, segments[0].t_first_ysid);
+  for (segment_ix = 1; segment_ix < segment_count; segment_ix++)
+    {
+      const YS last_set_of_previous_segment =
+        YS_of_R_by_Ord (r, segments[segment_ix - 1].t_end_ysid - 1);
+      Next_YS_of_YS (last_set_of_previous_segment) =
+        YS_of_R_by_Ord (r, segments[segment_ix].t_first_ysid);
+    }
+}
+
+@ The PSL's are not in use between Earley sets,
+but their stale data may point to discarded Earley items.
+The trace data may also point into discarded Earley sets.
+@<Clear data which may refer to discarded Earley sets@> =
+{
+  psar_clear (Dot_PSAR_of_R (r));
+  @<Clear trace Earley set dependent data@>@;
+}
+
+@ Once any Earley sets have been discarded,
+the Earley items of the Earley sets
+which were kept may refer to
+discarded Earley sets.
+Only the latest Earley set can be safely examined.
+@<Fail if |set_id| may refer to discarded Earley sets@> =
+if (_MARPA_UNLIKELY (Discarded_YS_Count_of_R (r) > 0
+    && set_id != Ord_of_YS (Latest_YS_of_R (r))))
+  {
+    MARPA_ERROR (MARPA_ERR_EARLEY_SET_DISCARDED);
+    return failure_indicator;
+  }
+
+@ @<Fail if |earley_set| was discarded@> =
+if (_MARPA_UNLIKELY (!earley_set))
+  {
+    MARPA_ERROR (MARPA_ERR_EARLEY_SET_DISCARDED);
+    return failure_indicator;
+  }
+
+@*0 Checkpoints.
+A checkpoint records the state of the recognizer
+between calls,
+so that the application can try some input
+and then roll the recognizer back,
+as if the input had never been read.
+This is useful for speculative lexing.
+@ Everything that the recognizer allocates
+for an Earley set after the checkpoint
+is on the Earley set obstack,
+so rolling back frees it with a single obstack operation,
+and the cost of a rollback is proportional to the work undone.
+The Earley sets up to and including the latest one at
+the checkpoint are not changed by later input,
+except for their links to the next Earley set
+and for their PSL's.
+What does change is recorded in the checkpoint itself:
+the location of the recognizer,
+its phase,
+the pending alternatives,
+the expected terminals and
+the event queue.
+@ Checkpoints are kept in a stack.
+Rolling back to a checkpoint discards the checkpoints made
+after it,
+but keeps the checkpoint itself,
+so that the application can roll back to it again.
+@d Checkpoint_Count_of_R(r) MARPA_DSTACK_LENGTH((r)->t_checkpoints)
+@<Private incomplete structures@> =
+struct s_checkpoint;
+typedef struct s_checkpoint* CHECKPOINT;
+@ @<Private structures@> =
+struct s_checkpoint {
+    struct marpa_obstack_mark t_ys_obs_mark;
+    YS t_latest_earley_set;
+    ALT t_alternatives;
+    ALT t_new_alternatives;
+    GEV t_events;
+    Bit_Vector t_bv_nsyid_is_expected;
+    JEARLEME t_current_earleme;
+    JEARLEME t_furthest_earleme;
+    YSID t_first_inconsistent_ys;
+    int t_earley_set_count;
+    int t_ys_segment_count;
+    int t_alternative_count;
+    int t_new_alternative_count;
+    int t_event_count;
+    BITFIELD t_input_phase:2;
+    BITFIELD t_is_exhausted:1;
+};
+typedef struct s_checkpoint CHECKPOINT_Object;
+@ @<Widely aligned recognizer elements@> =
+MARPA_DSTACK_DECLARE(t_checkpoints);
+@ @<Initialize recognizer elements@> =
+MARPA_DSTACK_SAFE(r->t_checkpoints);
+@ @<Destroy recognizer elements@> =
+{
+  checkpoints_release (r, 0);
+  MARPA_DSTACK_DESTROY (r->t_checkpoints);
+}
+
+@ Release the checkpoints from |first_checkpoint_id| on.
+@<Function definitions@> =
+PRIVATE void
+checkpoints_release (RECCE r, int first_checkpoint_id)
+{
+  int checkpoint_id;
+  for (checkpoint_id = first_checkpoint_id;
+       checkpoint_id < Checkpoint_Count_of_R (r); checkpoint_id++)
+    {
+      const CHECKPOINT checkpoint =
+        MARPA_DSTACK_INDEX (r->t_checkpoints, CHECKPOINT_Object,
+                            checkpoint_id);
+      my_free (checkpoint->t_alternatives);
+      my_free (checkpoint->t_new_alternatives);
+      my_free (checkpoint->t_events);
+      bv_free (checkpoint->t_bv_nsyid_is_expected);
+    }
+  if (first_checkpoint_id < Checkpoint_Count_of_R (r))
+    MARPA_DSTACK_COUNT_SET (r->t_checkpoints, first_checkpoint_id);
+}
+
+@ On success, returns the ID of the new checkpoint.
+@<Function definitions@> =
+int
+marpa_r_checkpoint (Marpa_Recognizer r)
+{
+  @<Return |-2| on failure@>@;
+  CHECKPOINT checkpoint;
+  int ix;
+  @<Unpack recognizer objects@>@;
+  @<Fail if fatal error@>@;
+  @<Fail if recognizer not started@>@;
+  if (!MARPA_DSTACK_IS_INITIALIZED (r->t_checkpoints))
+    {
+      MARPA_DSTACK_INIT2 (r->t_checkpoints, CHECKPOINT_Object);
+    }
+  checkpoint = MARPA_DSTACK_PUSH (r->t_checkpoints, CHECKPOINT_Object);
+  marpa_obs_mark (r->t_ys_obs, &checkpoint->t_ys_obs_mark);
+  checkpoint->t_latest_earley_set = Latest_YS_of_R (r);
+  checkpoint->t_current_earleme = Current_Earleme_of_R (r);
+  checkpoint->t_furthest_earleme = Furthest_Earleme_of_R (r);
+  checkpoint->t_first_inconsistent_ys = First_Inconsistent_YS_of_R (r);
+  checkpoint->t_earley_set_count = YS_Count_of_R (r);
+  checkpoint->t_ys_segment_count = MARPA_DSTACK_LENGTH (r->t_ys_segments);
+  checkpoint->t_input_phase = Input_Phase_of_R (r);
+  checkpoint->t_is_exhausted = R_is_Exhausted (r);
+  checkpoint->t_bv_nsyid_is_expected = bv_clone (r->t_bv_nsyid_is_expected);
+  @<Copy the alternatives into |checkpoint|@>@;
+  @<Copy the events into |checkpoint|@>@;
+  return Checkpoint_Count_of_R (r) - 1;
+}
+
+@ @<Copy the alternatives into |checkpoint|@> =
+{
+  const int alternative_count = MARPA_DSTACK_LENGTH (r->t_alternatives);
+  const int new_alternative_count =
+    MARPA_DSTACK_LENGTH (r->t_new_alternatives);
+  checkpoint->t_alternative_count = alternative_count;
+  checkpoint->t_alternatives = NULL;
+  if (alternative_count > 0)
+    {
+      const ALT alternatives = MARPA_DSTACK_BASE (r->t_alternatives, ALT_Object);
+      checkpoint->t_alternatives = marpa_new (ALT_Object, alternative_count);
+      for (ix = 0; ix < alternative_count; ix++)
+        checkpoint->t_alternatives[ix] = alternatives[ix];
+    }
+  checkpoint->t_new_alternative_count = new_alternative_count;
+  checkpoint->t_new_alternatives = NULL;
+  if (new_alternative_count > 0)
+    {
+      const ALT new_alternatives =
+        MARPA_DSTACK_BASE (r->t_new_alternatives, ALT_Object);
+      checkpoint->t_new_alternatives =
+        marpa_new (ALT_Object, new_alternative_count);
+      for (ix = 0; ix < new_alternative_count; ix++)
+        checkpoint->t_new_alternatives[ix] = new_alternatives[ix];
+    }
+}
+
+@ @<Copy the events into |checkpoint|@> =
+{
+  const int event_count = R_EVENT_COUNT (r);
+  checkpoint->t_event_count = event_count;
+  checkpoint->t_events = NULL;
+  if (event_count > 0)
+    {
+      const GEV events = MARPA_DSTACK_BASE (*Events_of_R (r), GEV_Object);
+      checkpoint->t_events = marpa_new (GEV_Object, event_count);
+      for (ix = 0; ix < event_count; ix++)
+        checkpoint->t_events[ix] = events[ix];
+    }
+}
+
+@ Roll back to a checkpoint.
+On success, returns the ID of the latest Earley set.
+Any bocage created after the checkpoint must not be used.
+@<Function definitions@> =
+Marpa_Earley_Set_ID
+marpa_r_rollback (Marpa_Recognizer r, int checkpoint_id)
+{
+  @<Return |-2| on failure@>@;
+  CHECKPOINT checkpoint;
+  int ix;
+  @<Unpack recognizer objects@>@;
+  @<Fail if fatal error@>@;
+  @<Fail if |checkpoint_id| is not valid@>@;
+  checkpoints_release (r, checkpoint_id + 1);
+  checkpoint =
+    MARPA_DSTACK_INDEX (r->t_checkpoints, CHECKPOINT_Object, checkpoint_id);
+  @<Clear data which may refer to Earley sets after |checkpoint|@>@;
+  @<Free the Earley sets after |checkpoint|@>@;
+  Latest_YS_of_R (r) = checkpoint->t_latest_earley_set;
+  Next_YS_of_YS (Latest_YS_of_R (r)) = NULL;
+  YS_Count_of_R (r) = checkpoint->t_earley_set_count;
+  @<Pop the Earley sets after |checkpoint| from the Earley set stack@>@;
+  Current_Earleme_of_R (r) = checkpoint->t_current_earleme;
+  Furthest_Earleme_of_R (r) = checkpoint->t_furthest_earleme;
+  First_Inconsistent_YS_of_R (r) = checkpoint->t_first_inconsistent_ys;
+  Input_Phase_of_R (r) = checkpoint->t_input_phase;
+  R_is_Exhausted (r) = checkpoint->t_is_exhausted;
+  bv_copy (r->t_bv_nsyid_is_expected, checkpoint->t_bv_nsyid_is_expected);
+  @<Restore the alternatives from |checkpoint|@>@;
+  @<Restore the events from |checkpoint|@>@;
+  return Ord_of_YS (Latest_YS_of_R (r));
+}
+
+@ @<Fail if |checkpoint_id| is not valid@> =
+if (_MARPA_UNLIKELY (checkpoint_id < 0
+    || checkpoint_id >= Checkpoint_Count_of_R (r)))
+  {
+    MARPA_ERROR (MARPA_ERR_NO_SUCH_CHECKPOINT);
+    return failure_indicator;
+  }
+
+@ The PSL's must be released while their owners,
+which may be in the Earley sets about to be freed,
+still exist.
+@<Clear data which may refer to Earley sets after |checkpoint|@> =
+{
+  psar_dealloc (Dot_PSAR_of_R (r));
+  psar_clear (Dot_PSAR_of_R (r));
+  @<Clear trace Earley set dependent data@>@;
+  @<Clear progress report in |r|@>@;
+}
+
+@ Earley sets are not discarded while there is a checkpoint,
+so any segments started after the checkpoint hold only
+Earley sets made after it.
+@<Free the Earley sets after |checkpoint|@> =
+{
+  const int segment_count = checkpoint->t_ys_segment_count;
+  if (segment_count > 0)
+    {
+      struct s_earley_set_segment *const segments =
+        MARPA_DSTACK_BASE (r->t_ys_segments, struct s_earley_set_segment);
+      for (ix = segment_count; ix < MARPA_DSTACK_LENGTH (r->t_ys_segments);
+           ix++)
+        {
+          marpa_obs_free (segments[ix].t_obs);
+        }
+      MARPA_DSTACK_COUNT_SET (r->t_ys_segments, segment_count);
+      segments[segment_count - 1].t_end_ysid = -1;
+      r->t_ys_obs = segments[segment_count - 1].t_obs;
+    }
+  marpa__obs_free_to_mark (r->t_ys_obs, &checkpoint->t_ys_obs_mark);
+}
+
+@ In streaming mode, the Earley set stack does not hold
+the discarded Earley sets,
+so its length is found from the current segment.
+@<Pop the Earley sets after |checkpoint| from the Earley set stack@> =
+{
+  int stacked_set_count = YS_Count_of_R (r);
+  if (R_is_Streaming (r))
+    {
+      const struct s_earley_set_segment *const current_segment =
+        MARPA_DSTACK_TOP (r->t_ys_segments, struct s_earley_set_segment);
+      stacked_set_count = current_segment->t_first_stack_ix
+        + YS_Count_of_R (r) - current_segment->t_first_ysid;
+    }
+  if (MARPA_DSTACK_LENGTH (r->t_earley_set_stack) > stacked_set_count)
+    MARPA_DSTACK_COUNT_SET (r->t_earley_set_stack, stacked_set_count);
+}
+
+@ The hash of the new alternatives may have been overwritten
+since the checkpoint,
+so it is rebuilt,
+even if there are no new alternatives to restore.
+Entries made since the checkpoint may be stamped with the restored
+earleme, and they would otherwise be live,
+with the indexes of alternatives that were rolled back.
+@<Restore the alternatives from |checkpoint|@> =
+{
+  MARPA_DSTACK_CLEAR (r->t_alternatives);
+  for (ix = 0; ix < checkpoint->t_alternative_count; ix++)
+    {
+      *MARPA_DSTACK_PUSH (r->t_alternatives, ALT_Object) =
+        checkpoint->t_alternatives[ix];
+    }
+  if (r->t_is_alternatives_hashed)
+    {
+      MARPA_DSTACK_CLEAR (r->t_new_alternatives);
+      for (ix = 0; ix < checkpoint->t_new_alternative_count; ix++)
+        {
+          *MARPA_DSTACK_PUSH (r->t_new_alternatives, ALT_Object) =
+            checkpoint->t_new_alternatives[ix];
+        }
+      alternative_hash_grow (r);
+    }
 }
 
-@ This function is called exactly once during a normal parse --
-at the end, when it is time for a bocage to be created.
-It is also called by trace and debugging methods.
-It must be used carefully since it takes $O(\log n)$ time,
-where $n$ is the number of Earley sets.
-If called after every Earley set, it would make Marpa
-$O(n \log n)$ in the best case.
-@d P_YS_of_R_by_Ord(r, ord) MARPA_DSTACK_INDEX((r)->t_earley_set_stack, YS, (ord))
-@d YS_of_R_by_Ord(r, ord) (*P_YS_of_R_by_Ord((r), (ord)))
-@<Function definitions@> =
-PRIVATE void r_update_earley_sets(RECCE r)
+@ @<Restore the events from |checkpoint|@> =
 {
-    YS set;
-    YS first_unstacked_earley_set;
-    if (!MARPA_DSTACK_IS_INITIALIZED(r->t_earley_set_stack)) {
-        first_unstacked_earley_set = First_YS_of_R(r);
-        MARPA_DSTACK_INIT (r->t_earley_set_stack, YS,
-                 MAX (1024, YS_Count_of_R(r)));
-    } else {
-         YS* end_of_stack = MARPA_DSTACK_TOP(r->t_earley_set_stack, YS);
-         first_unstacked_earley_set = Next_YS_of_YS(*end_of_stack);
-    }
-    for (set = first_unstacked_earley_set; set; set = Next_YS_of_YS(set)) {
-          YS* end_of_stack = MARPA_DSTACK_PUSH(r->t_earley_set_stack, YS);
-          (*end_of_stack) = set;
+  R_EVENTS_CLEAR (r);
+  for (ix = 0; ix < checkpoint->t_event_count; ix++)
+    {
+      *EVENT_PUSH (Events_of_R (r)) = checkpoint->t_events[ix];
     }
 }
 
+@ Release a checkpoint, and all the checkpoints made after it,
+without rolling back.
+On success, returns the number of checkpoints remaining.
+@<Function definitions@> =
+int
+marpa_r_checkpoint_release (Marpa_Recognizer r, int checkpoint_id)
+{
+  @<Return |-2| on failure@>@;
+  @<Unpack recognizer objects@>@;
+  @<Fail if fatal error@>@;
+  @<Fail if |checkpoint_id| is not valid@>@;
+  checkpoints_release (r, checkpoint_id);
+  return Checkpoint_Count_of_R (r);
+}
+
 @** Create the postdot items.
 
 @*0 About Leo items and unit rules.
@@ -8639,13 +12211,18 @@ of memoization here is in order
 now that I use Leo items only in cases of
 an actual right recursion.
 This may require running benchmarks.
-@ @<Widely aligned recognizer elements@> =
+@ The Leo candidate symbols are the postdot symbols
+of the current Earley set
+which are also Leo postdot symbols in the grammar.
+@<Widely aligned recognizer elements@> =
   Bit_Vector t_bv_lim_symbols;
   Bit_Vector t_bv_pim_symbols;
+  Bit_Vector t_bv_leo_candidate_symbols;
   void** t_pim_workarea;
 @ @<Allocate recognizer containers@> =
   r->t_bv_lim_symbols = bv_obs_create(r->t_obs, nsy_count);
   r->t_bv_pim_symbols = bv_obs_create(r->t_obs, nsy_count);
+  r->t_bv_leo_candidate_symbols = bv_obs_create(r->t_obs, nsy_count);
   r->t_pim_workarea = marpa_obs_new(r->t_obs, void*, nsy_count);
 @ @<Reinitialize containers used in PIM setup@> =
   bv_clear(r->t_bv_lim_symbols);
@@ -8657,49 +12234,80 @@ postdot_items_create (RECCE r,
   const YS current_earley_set)
 {
   @<Unpack recognizer objects@>@;
+  Bit_Vector bv_postdot_nsyids = r->t_bv_pim_symbols;
     @<Reinitialize containers used in PIM setup@>@;
     @<Start YIXes in PIM workarea@>@;
     if (r->t_is_using_leo) {
         @<Start LIMs in PIM workarea@>@;
         @<Add predecessors to LIMs@>@;
     }
+    if (Prediction_State_of_YS (current_earley_set)) {
+        @<Add the deferred postdot NSY's to the postdot NSY's@>@;
+    }
     @<Copy PIM workarea to postdot item array@>@;
-    bv_and(r->t_bv_nsyid_is_expected, r->t_bv_pim_symbols, g->t_bv_nsyid_is_terminal);
+    bv_and(r->t_bv_nsyid_is_expected, bv_postdot_nsyids, g->t_bv_nsyid_is_terminal);
 }
 
 @ This code creates the Earley indexes in the PIM workarea.
 At this point there are no Leo items.
+This is one of the larger serial costs of each earleme,
+so the YIXes for the whole Earley set are
+allocated as a single obstack object.
+Room is reserved for the worst case,
+one YIX per Earley item,
+and the object is then shrunk to the YIXes actually used.
+This saves an obstack allocation per YIX and
+leaves the YIXes of an Earley set contiguous in memory.
+Large Earley sets may be given to the postdot workers,
+which create the same YIXes, in the same places,
+and leave the PIM workarea as the loop below would.
 @<Start YIXes in PIM workarea@> = {
     /* No new Earley items are created in this scope */
     YIM* work_earley_items = MARPA_DSTACK_BASE (r->t_yim_work_stack, YIM );
     int no_of_work_earley_items = MARPA_DSTACK_LENGTH (r->t_yim_work_stack );
-    int ix;
-    for (ix = 0;
-         ix < no_of_work_earley_items;
-         ix++)
-     {
-        YIM earley_item = work_earley_items[ix];
-      AHM ahm = AHM_of_YIM (earley_item);
-      const NSYID postdot_nsyid = Postdot_NSYID_of_AHM(ahm);
-      if (postdot_nsyid < 0) continue;
-        {
-          PIM old_pim = NULL;
-          PIM new_pim;
-
-	  /* Need to be aligned for a PIM */
-          new_pim = marpa__obs_alloc(r->t_obs,
-            sizeof(YIX_Object), ALIGNOF(PIM_Object));
-
-          Postdot_NSYID_of_PIM(new_pim) = postdot_nsyid;
-          YIM_of_PIM(new_pim) = earley_item;
-          if (bv_bit_test(r->t_bv_pim_symbols, postdot_nsyid))
+    @t}\comment{@>
+    /* Each YIX needs to be aligned for a PIM */
+    const size_t yix_stride =
+      ALIGN_UP (sizeof (YIX_Object), ALIGNOF (PIM_Object));
+    char *const yix_base =
+      marpa_obs_start (r->t_ys_obs,
+        yix_stride * (size_t) no_of_work_earley_items,
+        ALIGNOF (PIM_Object));
+    int yix_count = 0;
+    if (Postdot_Worker_Count_of_R (r) > 1
+        && no_of_work_earley_items >= r->t_postdot_worker_threshold)
+      {
+        yix_count =
+          yixes_create_by_workers (r, current_earley_set, yix_base,
+                                   yix_stride);
+      }
+    else
+      {
+        int ix;
+        for (ix = 0; ix < no_of_work_earley_items; ix++)
+          {
+            const YIM earley_item = work_earley_items[ix];
+            const AHM ahm = AHM_of_YIM (earley_item);
+            const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
+            PIM old_pim = NULL;
+            PIM new_pim;
+            if (postdot_nsyid < 0)
+              continue;
+            new_pim = (PIM) (yix_base + yix_stride * (size_t) yix_count++);
+            Postdot_NSYID_of_PIM (new_pim) = postdot_nsyid;
+            YIM_of_PIM (new_pim) = earley_item;
+            if (bv_bit_test (r->t_bv_pim_symbols, postdot_nsyid))
               old_pim = r->t_pim_workarea[postdot_nsyid];
-          Next_PIM_of_PIM(new_pim) = old_pim;
-          if (!old_pim) current_earley_set->t_postdot_sym_count++;
-          r->t_pim_workarea[postdot_nsyid] = new_pim;
-          bv_bit_set(r->t_bv_pim_symbols, postdot_nsyid);
-        }
-    }
+            Next_PIM_of_PIM (new_pim) = old_pim;
+            if (!old_pim)
+              current_earley_set->t_postdot_sym_count++;
+            r->t_pim_workarea[postdot_nsyid] = new_pim;
+            bv_bit_set (r->t_bv_pim_symbols, postdot_nsyid);
+          }
+      }
+    marpa_obs_confirm_fast (r->t_ys_obs, (int) (yix_stride * (size_t) yix_count));
+    R_Stat_Add (r, t_postdot_item_count, yix_count);
+    marpa_obs_finish (r->t_ys_obs);
 }
 
 @ This code creates the Earley indexes in the PIM workarea.
@@ -8715,37 +12323,27 @@ Leo item have not been fully populated.
 @<Start LIMs in PIM workarea@> =
 {
   int min, max, start;
-  for (start = 0; bv_scan (r->t_bv_pim_symbols, start, &min, &max);
+  bv_and (r->t_bv_leo_candidate_symbols, r->t_bv_pim_symbols,
+          g->t_bv_nsyid_is_leo_postdot);
+  for (start = 0; bv_scan (r->t_bv_leo_candidate_symbols, start, &min, &max);
        start = max + 2)
     {
       NSYID nsyid;
       for (nsyid = (NSYID) min; nsyid <= (NSYID) max; nsyid++)
 	{
 	  const PIM this_pim = r->t_pim_workarea[nsyid];
+	  YIM leo_base;
+	  AHM trailhead_ahm;
 	  if (Next_PIM_of_PIM (this_pim))
-	    goto NEXT_NSYID;
+	    continue;
                 /* Do not create a Leo item if there is more
                    than one YIX */
-          {
-	    const YIM leo_base = YIM_of_PIM (this_pim);
-	    AHM potential_leo_penult_ahm = NULL;
-		const AHM leo_base_ahm = AHM_of_YIM (leo_base);
-		const IRL leo_base_irl = IRL_of_AHM (leo_base_ahm);
-
-		if (!IRL_is_Leo (leo_base_irl))
-		  goto NEXT_NSYID;
-		potential_leo_penult_ahm = leo_base_ahm;
-            MARPA_ASSERT((int)potential_leo_penult_ahm);
+	  leo_base = YIM_of_PIM (this_pim);
+	  trailhead_ahm = Leo_Trailhead_AHM_of_AHM (AHM_of_YIM (leo_base));
+	  if (trailhead_ahm)
 	    {
-	      const AHM trailhead_ahm =
-		Next_AHM_of_AHM (potential_leo_penult_ahm);
-	      if (AHM_is_Leo_Completion (trailhead_ahm))
-		{
-		  @<Create a new, unpopulated, LIM@>@;
-		}
+	      @<Create a new, unpopulated, LIM@>@;
 	    }
-	  }
-	NEXT_NSYID:;
 	}
     }
 }
@@ -8758,7 +12356,8 @@ That may become its actual value,
 once it is populated.
 @<Create a new, unpopulated, LIM@> = {
     LIM new_lim;
-    new_lim = marpa_obs_new(r->t_obs, LIM_Object, 1);
+    new_lim = marpa_obs_new(r->t_ys_obs, LIM_Object, 1);
+    R_Stat_Add (r, t_leo_item_count, 1);
     LIM_is_Active(new_lim) = 1;
     LIM_is_Rejected(new_lim) = 1;
     Postdot_NSYID_of_LIM(new_lim) = nsyid;
@@ -8900,6 +12499,10 @@ be transitions to Leo
 completions via several different symbols.
 The code is used for unpopulated LIMs.
 In a populated LIM, this will not necessarily be the case.
+@ If the transition symbol is not a Leo postdot symbol
+in the grammar,
+there can be no predecessor LIM,
+and the lookup is skipped.
 @<Find predecessor LIM of unpopulated LIM@> =
 {
   const YIM base_yim = Trailhead_YIM_of_LIM (lim_to_process);
@@ -8908,19 +12511,24 @@ In a populated LIM, this will not necessarily be the case.
   const NSYID predecessor_transition_nsyid =
     LHSID_of_AHM (trailhead_ahm);
   PIM predecessor_pim;
-  if (Ord_of_YS (predecessor_set) < Ord_of_YS (current_earley_set))
-    {
-      predecessor_pim
-	=
-	First_PIM_of_YS_by_NSYID (predecessor_set,
-				  predecessor_transition_nsyid);
-    }
-  else
+  predecessor_lim = NULL;
+  if (bv_bit_test (g->t_bv_nsyid_is_leo_postdot,
+                    predecessor_transition_nsyid))
     {
-      predecessor_pim = r->t_pim_workarea[predecessor_transition_nsyid];
+      if (Ord_of_YS (predecessor_set) < Ord_of_YS (current_earley_set))
+        {
+          predecessor_pim
+            =
+            First_PIM_of_YS_by_NSYID (predecessor_set,
+                                      predecessor_transition_nsyid);
+        }
+      else
+        {
+          predecessor_pim = r->t_pim_workarea[predecessor_transition_nsyid];
+        }
+      if (PIM_is_LIM (predecessor_pim))
+        predecessor_lim = LIM_of_PIM (predecessor_pim);
     }
-  predecessor_lim =
-    PIM_is_LIM (predecessor_pim) ? LIM_of_PIM (predecessor_pim) : NULL;
 }
 
 @ @<Widely aligned recognizer elements@> =
@@ -9036,7 +12644,7 @@ Secondary optimzations ensure this is fairly cheap as well.
         Event_AHMIDs_of_AHM (trailhead_ahm);
       if (Count_of_CIL (trailhead_ahm_event_ahmids))
         {
-          CIL new_cil = cil_merge_one (&g->t_cilar, predecessor_cil,
+          CIL new_cil = cil_merge_one (CILAR_of_R (r), predecessor_cil,
                                        Item_of_CIL
                                        (trailhead_ahm_event_ahmids, 0));
           if (new_cil)
@@ -9070,20 +12678,359 @@ of the base YIM.
 @ @<Copy PIM workarea to postdot item array@> = {
     PIM *postdot_array
         = current_earley_set->t_postdot_ary
-        = marpa_obs_new (r->t_obs, PIM, current_earley_set->t_postdot_sym_count );
+        = marpa_obs_new (r->t_ys_obs, PIM, current_earley_set->t_postdot_sym_count );
     int min, max, start;
     int postdot_array_ix = 0;
-    for (start = 0; bv_scan (r->t_bv_pim_symbols, start, &min, &max); start = max + 2) {
+    for (start = 0; bv_scan (bv_postdot_nsyids, start, &min, &max); start = max + 2) {
         NSYID nsyid;
         for (nsyid = min; nsyid <= max; nsyid++) {
-            PIM this_pim = r->t_pim_workarea[nsyid];
+            PIM this_pim;
             if (lbv_bit_test(r->t_nsy_expected_is_event, nsyid)) {
               XSY xsy = Source_XSY_of_NSYID(nsyid);
-              int_event_new (g, MARPA_EVENT_SYMBOL_EXPECTED, ID_of_XSY(xsy));
+              int_event_new (Events_of_R (r), MARPA_EVENT_SYMBOL_EXPECTED, ID_of_XSY(xsy));
             }
+            if (!bv_bit_test (r->t_bv_pim_symbols, nsyid)) continue;
+            this_pim = r->t_pim_workarea[nsyid];
             if (this_pim) postdot_array[postdot_array_ix++] = this_pim;
         }
     }
+    postdot_index_build (r, current_earley_set, r->t_ys_obs);
+}
+
+@*0 Postdot item workers.
+The YIXes of a large Earley set
+may be created by several {\it postdot workers},
+which may run at the same time,
+in threads of the application's choosing.
+As with bocages, the application passes a fork-join function,
+and Libmarpa never starts a thread.
+@ The work Earley items are divided among the workers in order.
+The workers make three passes.
+\li In the first, each worker counts the YIXes of its Earley items.
+The counts tell each worker where its YIXes go
+in the obstack object reserved for the YIXes of the Earley set,
+so that every YIX is where the single-threaded code puts it.
+\li In the second, each worker creates its YIXes,
+and links them into its own chains,
+one for each postdot NSY, newest first,
+keeping the first and last YIX of each chain.
+\li In the third, the NSYs are divided among the workers,
+in whole words of the bit vectors.
+For each of its NSYs,
+a worker joins the chains of all the workers,
+the later workers' YIXes first,
+and sets the PIM workarea and its bit vector.
+\par
+The chains which result are those that one worker would create,
+so nothing after this depends on the number of workers.
+Each pass writes only its own worker's data,
+and its own YIXes or NSYs,
+so that the workers need no locks.
+@s POSTDOT_WORKER int
+@<Private incomplete structures@> =
+struct s_postdot_worker;
+typedef struct s_postdot_worker* POSTDOT_WORKER;
+@ @<Private structures@> =
+struct s_postdot_worker {
+    RECCE t_recce;
+    char *t_yix_base;
+    PIM *t_first_pim_by_nsyid;
+    PIM *t_last_pim_by_nsyid;
+    Bit_Vector t_bv_nsyids;
+    size_t t_yix_stride;
+    int t_first_item;
+    int t_end_item;
+    int t_first_yix;
+    int t_yix_count;
+    int t_first_word;
+    int t_end_word;
+    int t_postdot_sym_count;
+};
+
+@ The workers and their arrays are allocated when the worker count is set,
+and are reused for every Earley set.
+They are not on the recognizer's obstack,
+because a rollback frees what is on it.
+@d Postdot_Worker_Count_of_R(r) ((r)->t_postdot_worker_count)
+@d DEFAULT_POSTDOT_WORKER_THRESHOLD (4096)
+@<Widely aligned recognizer elements@> =
+  POSTDOT_WORKER t_postdot_workers;
+  void **t_postdot_worker_args;
+  Marpa_Fork_Join t_postdot_fork_join;
+  void *t_postdot_fork_join_data;
+@ @<Int aligned recognizer elements@> =
+  int t_postdot_worker_count;
+  int t_postdot_worker_capacity;
+  int t_postdot_worker_threshold;
+@ @<Initialize recognizer elements@> =
+  r->t_postdot_workers = NULL;
+  r->t_postdot_worker_args = NULL;
+  r->t_postdot_fork_join = NULL;
+  r->t_postdot_fork_join_data = NULL;
+  Postdot_Worker_Count_of_R (r) = 1;
+  r->t_postdot_worker_capacity = 0;
+  r->t_postdot_worker_threshold = DEFAULT_POSTDOT_WORKER_THRESHOLD;
+@ @<Destroy recognizer elements@> =
+  postdot_workers_free (r);
+
+@ Returns the new worker count,
+or |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_r_postdot_workers_set (Marpa_Recognizer r, int worker_count,
+                             Marpa_Fork_Join fork_join,
+                             void *fork_join_data)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  if (_MARPA_UNLIKELY (worker_count < 1))
+    {
+      MARPA_ERROR (MARPA_ERR_INVALID_WORKER_COUNT);
+      return failure_indicator;
+    }
+  if (_MARPA_UNLIKELY (worker_count > 1 && !fork_join))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  if (worker_count > r->t_postdot_worker_capacity)
+    {
+      @<Allocate the postdot workers@>@;
+    }
+  Postdot_Worker_Count_of_R (r) = worker_count;
+  r->t_postdot_fork_join = fork_join;
+  r->t_postdot_fork_join_data = fork_join_data;
+  return worker_count;
+}
+
+@ @<Allocate the postdot workers@> =
+{
+  const int nsy_count = NSY_Count_of_G (g);
+  int worker_ix;
+  postdot_workers_free (r);
+  r->t_postdot_workers = marpa_new (struct s_postdot_worker, worker_count);
+  r->t_postdot_worker_args = marpa_new (void *, worker_count);
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      const POSTDOT_WORKER worker = r->t_postdot_workers + worker_ix;
+      worker->t_recce = r;
+      worker->t_first_pim_by_nsyid = marpa_new (PIM, nsy_count);
+      worker->t_last_pim_by_nsyid = marpa_new (PIM, nsy_count);
+      worker->t_bv_nsyids = bv_create (nsy_count);
+      r->t_postdot_worker_args[worker_ix] = worker;
+    }
+  r->t_postdot_worker_capacity = worker_count;
+}
+
+@ @<Function definitions@> =
+PRIVATE void
+postdot_workers_free (RECCE r)
+{
+  int worker_ix;
+  for (worker_ix = 0; worker_ix < r->t_postdot_worker_capacity; worker_ix++)
+    {
+      const POSTDOT_WORKER worker = r->t_postdot_workers + worker_ix;
+      my_free (worker->t_first_pim_by_nsyid);
+      my_free (worker->t_last_pim_by_nsyid);
+      bv_free (worker->t_bv_nsyids);
+    }
+  my_free (r->t_postdot_workers);
+  my_free (r->t_postdot_worker_args);
+  r->t_postdot_workers = NULL;
+  r->t_postdot_worker_args = NULL;
+  r->t_postdot_worker_capacity = 0;
+}
+
+@ Returns the worker count,
+or |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_r_postdot_workers (Marpa_Recognizer r)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return Postdot_Worker_Count_of_R (r);
+}
+
+@ Starting the workers costs something,
+even when the fork-join function keeps its threads,
+so small Earley sets are left to the single-threaded code.
+The threshold is a count of Earley items.
+@<Function definitions@> =
+int
+marpa_r_postdot_worker_threshold (Marpa_Recognizer r)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  return r->t_postdot_worker_threshold;
+}
+
+@ Returns the new threshold,
+or |-2| if there was an error.
+@<Function definitions@> =
+int
+marpa_r_postdot_worker_threshold_set (Marpa_Recognizer r, int threshold)
+{
+  @<Unpack recognizer objects@>@;
+  @<Return |-2| on failure@>@;
+  @<Fail if fatal error@>@;
+  {
+    const int new_threshold = threshold <= 0 ? INT_MAX : threshold;
+    r->t_postdot_worker_threshold = new_threshold;
+    return new_threshold;
+  }
+}
+
+@ Returns the number of YIXes created.
+@<Function definitions@> =
+PRIVATE_NOT_INLINE int
+yixes_create_by_workers (RECCE r, YS current_earley_set,
+  char *yix_base, size_t yix_stride)
+{
+  const int worker_count = Postdot_Worker_Count_of_R (r);
+  const int item_count = MARPA_DSTACK_LENGTH (r->t_yim_work_stack);
+  const int word_count = (int) bv_bits_to_size (NSY_Count_of_G (G_of_R (r)));
+  void **const worker_args = r->t_postdot_worker_args;
+  int yix_count = 0;
+  int worker_ix;
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      const POSTDOT_WORKER worker = r->t_postdot_workers + worker_ix;
+      worker->t_yix_base = yix_base;
+      worker->t_yix_stride = yix_stride;
+      worker->t_first_item =
+        (int) ((long) item_count * worker_ix / worker_count);
+      worker->t_end_item =
+        (int) ((long) item_count * (worker_ix + 1) / worker_count);
+      worker->t_first_word =
+        (int) ((long) word_count * worker_ix / worker_count);
+      worker->t_end_word =
+        (int) ((long) word_count * (worker_ix + 1) / worker_count);
+      worker->t_postdot_sym_count = 0;
+    }
+  r->t_postdot_fork_join (postdot_worker_yixes_count, worker_args,
+                          worker_count, r->t_postdot_fork_join_data);
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      const POSTDOT_WORKER worker = r->t_postdot_workers + worker_ix;
+      worker->t_first_yix = yix_count;
+      yix_count += worker->t_yix_count;
+    }
+  r->t_postdot_fork_join (postdot_worker_yixes_create, worker_args,
+                          worker_count, r->t_postdot_fork_join_data);
+  r->t_postdot_fork_join (postdot_worker_chains_join, worker_args,
+                          worker_count, r->t_postdot_fork_join_data);
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    current_earley_set->t_postdot_sym_count +=
+      r->t_postdot_workers[worker_ix].t_postdot_sym_count;
+  return yix_count;
+}
+
+@ In the compact Earley item layout,
+|AHM_of_YIM| needs the grammar.
+@<Function definitions@> =
+PRIVATE_NOT_INLINE void
+postdot_worker_yixes_count (void *worker_arg)
+{
+  const POSTDOT_WORKER worker = worker_arg;
+  const RECCE r = worker->t_recce;
+  const GRAMMAR g UNUSED = G_of_R (r);
+  YIM *const work_earley_items =
+    MARPA_DSTACK_BASE (r->t_yim_work_stack, YIM);
+  int yix_count = 0;
+  int ix;
+  for (ix = worker->t_first_item; ix < worker->t_end_item; ix++)
+    {
+      const AHM ahm = AHM_of_YIM (work_earley_items[ix]);
+      if (Postdot_NSYID_of_AHM (ahm) >= 0)
+        yix_count++;
+    }
+  worker->t_yix_count = yix_count;
+}
+
+@ The last YIX of a chain is the first one created,
+and its next PIM is set when the chains are joined.
+@<Function definitions@> =
+PRIVATE_NOT_INLINE void
+postdot_worker_yixes_create (void *worker_arg)
+{
+  const POSTDOT_WORKER worker = worker_arg;
+  const RECCE r = worker->t_recce;
+  const GRAMMAR g UNUSED = G_of_R (r);
+  YIM *const work_earley_items =
+    MARPA_DSTACK_BASE (r->t_yim_work_stack, YIM);
+  PIM *const first_pim_by_nsyid = worker->t_first_pim_by_nsyid;
+  const Bit_Vector bv_nsyids = worker->t_bv_nsyids;
+  int yix_ix = worker->t_first_yix;
+  int ix;
+  bv_clear (bv_nsyids);
+  for (ix = worker->t_first_item; ix < worker->t_end_item; ix++)
+    {
+      const YIM earley_item = work_earley_items[ix];
+      const AHM ahm = AHM_of_YIM (earley_item);
+      const NSYID postdot_nsyid = Postdot_NSYID_of_AHM (ahm);
+      PIM new_pim;
+      if (postdot_nsyid < 0)
+        continue;
+      new_pim =
+        (PIM) (worker->t_yix_base + worker->t_yix_stride * (size_t) yix_ix++);
+      Postdot_NSYID_of_PIM (new_pim) = postdot_nsyid;
+      YIM_of_PIM (new_pim) = earley_item;
+      if (bv_bit_test (bv_nsyids, postdot_nsyid))
+        {
+          Next_PIM_of_PIM (new_pim) = first_pim_by_nsyid[postdot_nsyid];
+        }
+      else
+        {
+          Next_PIM_of_PIM (new_pim) = NULL;
+          worker->t_last_pim_by_nsyid[postdot_nsyid] = new_pim;
+          bv_bit_set (bv_nsyids, postdot_nsyid);
+        }
+      first_pim_by_nsyid[postdot_nsyid] = new_pim;
+    }
+}
+
+@ The PIM bit vector was cleared for this Earley set,
+so each of its words is set whole.
+@<Function definitions@> =
+PRIVATE_NOT_INLINE void
+postdot_worker_chains_join (void *worker_arg)
+{
+  const POSTDOT_WORKER worker = worker_arg;
+  const RECCE r = worker->t_recce;
+  const POSTDOT_WORKER workers = r->t_postdot_workers;
+  const int worker_count = Postdot_Worker_Count_of_R (r);
+  int word_ix;
+  for (word_ix = worker->t_first_word; word_ix < worker->t_end_word;
+       word_ix++)
+    {
+      LBW word = 0;
+      LBW bits_left;
+      int worker_ix;
+      for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+        word |= workers[worker_ix].t_bv_nsyids[word_ix];
+      r->t_bv_pim_symbols[word_ix] = word;
+      for (bits_left = word; bits_left; bits_left &= bits_left - 1u)
+        {
+          const NSYID nsyid =
+            (NSYID) ((LBW) word_ix * bv_wordbits + bv_word_lowest (bits_left));
+          PIM pim = NULL;
+          for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+            {
+              const POSTDOT_WORKER chain_worker = workers + worker_ix;
+              if (!bv_bit_test (chain_worker->t_bv_nsyids, nsyid))
+                continue;
+              Next_PIM_of_PIM (chain_worker->t_last_pim_by_nsyid[nsyid]) =
+                pim;
+              pim = chain_worker->t_first_pim_by_nsyid[nsyid];
+            }
+          r->t_pim_workarea[nsyid] = pim;
+          worker->t_postdot_sym_count++;
+        }
+    }
 }
 
 
@@ -9095,6 +13042,10 @@ rejections.
 \li Re-determine if the parse is exhausted.
 \li What about postdot items?  If a LIM is now rejected, I should look
 at the YIM/PIM, I think, because it was {\bf not} necessarily rejected.
+\li In hashed mode, the new alternatives which are no longer acceptable
+must be removed, and the hash rebuilt.
+They should not be merged into the alternatives stack,
+or a duplicate read after the clean will not be found.
 
 @ Various notes about revision:
 \li I need to make sure that the reading of alternatives
@@ -9126,7 +13077,7 @@ marpa_r_clean(Marpa_Recognizer r)
 
   @<Fail if recognizer not accepting input@>@;
 
-  G_EVENTS_CLEAR(g);
+  R_EVENTS_CLEAR(r);
 
   @t}\comment{@>
   /* Return success if recognizer is already consistent */
@@ -9178,21 +13129,26 @@ YIMID *prediction_by_irl =
   marpa_obs_free(method_obstack);
 }
 
-@ @<Clean Earley set |ysid_to_clean|@> =
+@ The deferred predictions of the Earley set are added first,
+so that it is cleaned as a whole.
+@<Clean Earley set |ysid_to_clean|@> =
 {
   const YS ys_to_clean = YS_of_R_by_Ord (r, ysid_to_clean);
-  const YIM *yims_to_clean = YIMs_of_YS (ys_to_clean);
-  const int yim_to_clean_count = YIM_Count_of_YS (ys_to_clean);
-  Bit_Matrix acceptance_matrix = matrix_obs_create (method_obstack,
-    yim_to_clean_count,
-    yim_to_clean_count);
-  @<Map prediction rules to YIM ordinals in array@>@;
-  @<First revision pass over |ys_to_clean|@>@;
-  transitive_closure(acceptance_matrix);
-  @<Mark accepted YIM's@>@;
-  @<Mark un-accepted YIM's rejected@>@;
-  @<Mark accepted SRCL's@>@;
-  @<Mark rejected LIM's@>@;
+  earley_set_predictions_materialize (r, ys_to_clean);
+  {
+    const YIM *yims_to_clean = YIMs_of_YS (ys_to_clean);
+    const int yim_to_clean_count = YIM_Count_of_YS (ys_to_clean);
+    Bit_Matrix acceptance_matrix = matrix_obs_create (method_obstack,
+      yim_to_clean_count,
+      yim_to_clean_count);
+    @<Map prediction rules to YIM ordinals in array@>@;
+    @<First revision pass over |ys_to_clean|@>@;
+    transitive_closure(acceptance_matrix);
+    @<Mark accepted YIM's@>@;
+    @<Mark un-accepted YIM's rejected@>@;
+    @<Mark accepted SRCL's@>@;
+    @<Mark rejected LIM's@>@;
+  }
 }
 
 @ Rules not used in this YS
@@ -9610,7 +13566,9 @@ int marpa_r_progress_report_start(
       MARPA_ERROR(MARPA_ERR_NO_EARLEY_SET_AT_LOCATION);
       return failure_indicator;
     }
+  @<Fail if |set_id| may refer to discarded Earley sets@>@;
   earley_set = YS_of_R_by_Ord (r, set_id);
+  earley_set_predictions_materialize (r, earley_set);
 
   MARPA_OFF_DEBUG3("At %s, starting progress report Earley set %ld",
     STRLOC, (long)set_id);
@@ -10012,7 +13970,7 @@ I need to decide where to look at this.
     ur_node_stack_reset(ur_node_stack);
     @t}\comment{@>
     /* |start_yim| is never rejected */
-    push_ur_if_new (per_ys_data, ur_node_stack, start_yim);
+    push_ur_if_new (bocage_setup_obs, per_ys_data, ur_node_stack, start_yim);
     while ((ur_node = ur_node_pop(ur_node_stack)))
     {
         @t}\comment{@>/* rejected YIM's are never put on the ur-node stack */
@@ -10026,10 +13984,11 @@ I need to decide where to look at this.
 
 @ @<Function definitions@> =
 PRIVATE void push_ur_if_new(
+    struct marpa_obstack* obs,
     struct s_bocage_setup_per_ys* per_ys_data,
     URS ur_node_stack, YIM yim)
 {
-  if (!psi_test_and_set (per_ys_data, yim))
+  if (!psi_test_and_set (obs, per_ys_data, yim))
     {
       ur_node_push (ur_node_stack, yim);
     }
@@ -10040,16 +13999,37 @@ and within that, per Earley item.
 (In the past, it has also been called the PSIA.)
 This function ensures that the appropriate |PSI| boolean is set.
 It returns that boolean's value {\bf prior} to the call.
+@ The PSI data for an Earley set is allocated
+when the first of its Earley items is found to be in the parse.
+Only the Earley items reachable from the start Earley item
+are ever in the parse,
+and often most of the Earley sets have none of them.
+This is the case, for example,
+when the bocage is for a prefix of the input,
+or when most of the Earley items are predictions.
+The bocage then does no work for those Earley sets.
 @<Function definitions@> =
 PRIVATE int psi_test_and_set(
+    struct marpa_obstack* obs,
     struct s_bocage_setup_per_ys* per_ys_data,
     YIM earley_item
     )
 {
   const YSID set_ordinal = YS_Ord_of_YIM (earley_item);
   const int item_ordinal = Ord_of_YIM (earley_item);
-  const OR previous_or_node =
-    OR_by_PSI (per_ys_data, set_ordinal, item_ordinal);
+  OR previous_or_node;
+  struct s_bocage_setup_per_ys *const per_ys = per_ys_data + set_ordinal;
+  if (!per_ys->t_or_node_by_item)
+    {
+      int ix;
+      per_ys->t_or_node_by_item =
+        marpa_obs_new (obs, OR, per_ys->t_item_count);
+      for (ix = 0; ix < per_ys->t_item_count; ix++)
+        {
+          OR_by_PSI (per_ys_data, set_ordinal, ix) = NULL;
+        }
+    }
+  previous_or_node = OR_by_PSI (per_ys_data, set_ordinal, item_ordinal);
   if (!previous_or_node)
     {
       OR_by_PSI (per_ys_data, set_ordinal, item_ordinal) = dummy_or_node;
@@ -10070,11 +14050,12 @@ PRIVATE int psi_test_and_set(
       if (!predecessor_earley_item) continue;
       if (YIM_was_Predicted (predecessor_earley_item))
 	{
-	  Set_boolean_in_PSI_for_initial_nulls (per_ys_data,
+	  Set_boolean_in_PSI_for_initial_nulls (g, bocage_setup_obs, per_ys_data,
 						predecessor_earley_item);
 	  continue;
 	}
-      push_ur_if_new (per_ys_data, ur_node_stack, predecessor_earley_item);
+      push_ur_if_new (bocage_setup_obs, per_ys_data, ur_node_stack,
+        predecessor_earley_item);
     }
 }
 
@@ -10084,12 +14065,14 @@ We don't need to stack the prediction, because it can have
 no other descendants.
 @<Function definitions@> =
 PRIVATE void
-Set_boolean_in_PSI_for_initial_nulls (struct s_bocage_setup_per_ys *per_ys_data,
+Set_boolean_in_PSI_for_initial_nulls (GRAMMAR g,
+  struct marpa_obstack* obs,
+  struct s_bocage_setup_per_ys *per_ys_data,
   YIM yim)
 {
   const AHM ahm = AHM_of_YIM(yim);
   if (Null_Count_of_AHM (ahm))
-	  psi_test_and_set (per_ys_data, (yim));
+	  psi_test_and_set (obs, per_ys_data, (yim));
 }
 
 @ @<Push child Earley items from completion sources@> =
@@ -10102,16 +14085,18 @@ Set_boolean_in_PSI_for_initial_nulls (struct s_bocage_setup_per_ys *per_ys_data,
       YIM cause_earley_item;
       if (!SRCL_is_Active(source_link)) continue;
       cause_earley_item = Cause_of_SRCL (source_link);
-      push_ur_if_new (per_ys_data, ur_node_stack, cause_earley_item);
+      push_ur_if_new (bocage_setup_obs, per_ys_data, ur_node_stack,
+        cause_earley_item);
       predecessor_earley_item = Predecessor_of_SRCL (source_link);
       if (!predecessor_earley_item) continue;
       if (YIM_was_Predicted (predecessor_earley_item))
 	{
-	  Set_boolean_in_PSI_for_initial_nulls (per_ys_data,
+	  Set_boolean_in_PSI_for_initial_nulls (g, bocage_setup_obs, per_ys_data,
 						predecessor_earley_item);
 	  continue;
 	}
-      push_ur_if_new (per_ys_data, ur_node_stack, predecessor_earley_item);
+      push_ur_if_new (bocage_setup_obs, per_ys_data, ur_node_stack,
+        predecessor_earley_item);
     }
 }
 
@@ -10130,7 +14115,8 @@ Set_boolean_in_PSI_for_initial_nulls (struct s_bocage_setup_per_ys *per_ys_data,
       if (!SRCL_is_Active (source_link))
 	continue;
       cause_earley_item = Cause_of_SRCL (source_link);
-      push_ur_if_new (per_ys_data, ur_node_stack, cause_earley_item);
+      push_ur_if_new (bocage_setup_obs, per_ys_data, ur_node_stack,
+        cause_earley_item);
       for (leo_predecessor = LIM_of_SRCL (source_link); leo_predecessor;
     @t}\comment{@>/* Follow the predecessors chain back */
 	   leo_predecessor = Predecessor_LIM_of_LIM (leo_predecessor))
@@ -10138,12 +14124,13 @@ Set_boolean_in_PSI_for_initial_nulls (struct s_bocage_setup_per_ys *per_ys_data,
 	  const YIM leo_base_yim = Trailhead_YIM_of_LIM (leo_predecessor);
 	  if (YIM_was_Predicted (leo_base_yim))
 	    {
-	      Set_boolean_in_PSI_for_initial_nulls (per_ys_data,
+	      Set_boolean_in_PSI_for_initial_nulls (g, bocage_setup_obs, per_ys_data,
 						    leo_base_yim);
 	    }
 	  else
 	    {
-	      push_ur_if_new (per_ys_data, ur_node_stack, leo_base_yim);
+	      push_ur_if_new (bocage_setup_obs, per_ys_data, ur_node_stack,
+	        leo_base_yim);
 	    }
 	}
     }
@@ -10244,7 +14231,6 @@ static const OR dummy_or_node = (OR)&dummy_or_node_type;
 @ @d ORs_of_B(b) ((b)->t_or_nodes)
 @d OR_of_B_by_ID(b, id) (ORs_of_B(b)[(id)])
 @d OR_Count_of_B(b) ((b)->t_or_node_count)
-@d OR_Capacity_of_B(b) ((b)->t_or_node_capacity)
 @d ANDs_of_B(b) ((b)->t_and_nodes)
 @d AND_Count_of_B(b) ((b)->t_and_node_count)
 @d Top_ORID_of_B(b) ((b)->t_top_or_node_id)
@@ -10252,7 +14238,6 @@ static const OR dummy_or_node = (OR)&dummy_or_node_type;
 OR* t_or_nodes;
 AND t_and_nodes;
 @ @<Int aligned bocage elements@> =
-int t_or_node_capacity;
 int t_or_node_count;
 int t_and_node_count;
 ORID t_top_or_node_id;
@@ -10287,30 +14272,38 @@ Top_ORID_of_B(b) = -1;
 }
 
 @*0 Create the or-nodes.
+@ Earley sets with no Earley items in the parse are skipped.
+The or-nodes and draft and-nodes of an Earley set
+use only the PSI data of Earley items in the parse.
 @<Create the or-nodes for all earley sets@> =
 {
-  PSAR_Object or_per_ys_arena;
-  const PSAR or_psar = &or_per_ys_arena;
-  int work_earley_set_ordinal;
-  OR_Capacity_of_B(b) = count_of_earley_items_in_parse;
-  ORs_of_B (b) = marpa_new (OR, OR_Capacity_of_B(b));
-  psar_init (or_psar, SYMI_Count_of_G (g));
+  const BOCAGE_WORKER worker = workers;
+  YSID work_earley_set_ordinal;
   for (work_earley_set_ordinal = 0;
-      work_earley_set_ordinal < earley_set_count_of_r;
+      work_earley_set_ordinal < earley_set_count_in_parse;
       work_earley_set_ordinal++)
   {
-      const YS_Const earley_set = YS_of_R_by_Ord (r, work_earley_set_ordinal);
-    YIM* const yims_of_ys = YIMs_of_YS(earley_set);
-    const int item_count = YIM_Count_of_YS (earley_set);
-      PSL this_earley_set_psl;
-      psar_dealloc(or_psar);
-      this_earley_set_psl
-        = psl_claim_by_es(or_psar, per_ys_data, work_earley_set_ordinal);
-    @<Create the or-nodes for |work_earley_set_ordinal|@>@;
-    @<Create draft and-nodes for |work_earley_set_ordinal|@>@;
+      if (!per_ys_data[work_earley_set_ordinal].t_or_node_by_item)
+        continue;
+      or_nodes_of_set_create (worker, work_earley_set_ordinal);
+      draft_and_nodes_of_set_create (worker, work_earley_set_ordinal);
   }
-  psar_destroy (or_psar);
-  ORs_of_B(b) = marpa_renew (OR, ORs_of_B(b), OR_Count_of_B(b));
+}
+
+@ @<Function definitions@> =
+PRIVATE void
+or_nodes_of_set_create (BOCAGE_WORKER worker, YSID work_earley_set_ordinal)
+{
+  @<Unpack bocage worker objects@>@;
+  const YS_Const earley_set = YS_of_R_by_Ord (r, work_earley_set_ordinal);
+  YIM* const yims_of_ys = YIMs_of_YS(earley_set);
+  const int item_count = YIM_Count_of_YS (earley_set);
+  PSL this_earley_set_psl;
+  dand_hash_set_start (dand_hash, work_earley_set_ordinal);
+  psar_dealloc(or_psar);
+  this_earley_set_psl
+    = psl_claim_by_es(worker, work_earley_set_ordinal);
+  @<Create the or-nodes for |work_earley_set_ordinal|@>@;
 }
 
 @ @<Create the or-nodes for |work_earley_set_ordinal|@> =
@@ -10340,7 +14333,7 @@ Top_ORID_of_B(b) = -1;
   OR psi_or_node = NULL;
   ahm_symbol_instance = SYMI_of_AHM(ahm);
   {
-        PSL or_psl = psl_claim_by_es(or_psar, per_ys_data, work_origin_ordinal);
+        PSL or_psl = psl_claim_by_es(worker, work_origin_ordinal);
         OR last_or_node = NULL;
         @<Add main or-node@>@;
           @<Add nulling token or-nodes@>@;
@@ -10373,7 +14366,8 @@ MARPA_ASSERT(ahm_symbol_instance < SYMI_Count_of_G(g))@;
       if (!or_node || YS_Ord_of_OR(or_node) != work_earley_set_ordinal)
         {
           const IRL irl = IRL_of_AHM(ahm);
-          or_node = last_or_node = or_node_new(b);
+          or_node = last_or_node =
+            or_node_new (worker, work_origin_ordinal);
           PSL_Datum (or_psl, ahm_symbol_instance) = last_or_node;
           Origin_Ord_of_OR(or_node) = Origin_Ord_of_YIM(work_earley_item);
           YS_Ord_of_OR(or_node) = work_earley_set_ordinal;
@@ -10385,20 +14379,31 @@ MARPA_ASSERT(ahm_symbol_instance < SYMI_Count_of_G(g))@;
     }
 }
 
-@ @<Function definitions@> =
-PRIVATE OR or_node_new(BOCAGE b)
+@ The ID of a new or-node is its index among the or-nodes
+of its worker.
+|psl_ysid| is the Earley set of the PSL
+into which the caller puts the new or-node.
+Workers which must later restore their PSL's keep a log of it.
+@<Function definitions@> =
+PRIVATE OR or_node_new(BOCAGE_WORKER worker, YSID psl_ysid)
 {
-  const int or_node_id = OR_Count_of_B (b)++;
-  const OR new_or_node = (OR)marpa_obs_new (OBS_of_B(b), OR_Object, 1);
+  const int or_node_id = worker->t_or_node_count++;
+  const OR new_or_node = (OR)marpa_obs_new (worker->t_obs, OR_Object, 1);
   ID_of_OR(new_or_node) = or_node_id;
   DANDs_of_OR(new_or_node) = NULL;
-  if (_MARPA_UNLIKELY(or_node_id >= OR_Capacity_of_B(b)))
+  if (_MARPA_UNLIKELY(or_node_id >= worker->t_or_node_capacity))
     {
-      OR_Capacity_of_B(b) *= 2;
-      ORs_of_B (b) =
-        marpa_renew (OR, ORs_of_B(b), OR_Capacity_of_B(b));
-    }
-  OR_of_B_by_ID(b,or_node_id) = new_or_node;
+      worker->t_or_node_capacity *= 2;
+      worker->t_or_nodes =
+        marpa_renew (OR, worker->t_or_nodes, worker->t_or_node_capacity);
+      if (worker->t_psl_ysids)
+        worker->t_psl_ysids =
+          marpa_renew (YSID, worker->t_psl_ysids,
+                       worker->t_or_node_capacity);
+    }
+  worker->t_or_nodes[or_node_id] = new_or_node;
+  if (worker->t_psl_ysids)
+    worker->t_psl_ysids[or_node_id] = psl_ysid;
   return new_or_node;
 }
 
@@ -10431,13 +14436,14 @@ and this is the case if |Position_of_OR(or_node) == 0|.
                 const OR predecessor = rhs_ix ? last_or_node : NULL;
                 const OR cause = Nulling_OR_by_NSYID( RHSID_of_IRL (irl, rhs_ix ) );
                 or_node = PSL_Datum (or_psl, symbol_instance)
-                  = last_or_node = or_node_new(b);
+                  = last_or_node = or_node_new (worker, work_origin_ordinal);
                 Origin_Ord_of_OR (or_node) = work_origin_ordinal;
                 YS_Ord_of_OR (or_node) = work_earley_set_ordinal;
                 IRL_of_OR (or_node) = irl;
                 Position_of_OR (or_node) = rhs_ix + 1;
 MARPA_ASSERT(Position_of_OR(or_node) <= 1 || predecessor);
-                draft_and_node_add (bocage_setup_obs, or_node, predecessor,
+                draft_and_node_add (bocage_setup_obs, dand_hash, or_node,
+                      predecessor,
                       cause);
               }
               psi_or_node = or_node;
@@ -10490,11 +14496,12 @@ corresponds to the Leo predecessor.
     {
       OR or_node;
       PSL leo_psl
-        = psl_claim_by_es(or_psar, per_ys_data, ordinal_of_set_of_this_leo_item);
+        = psl_claim_by_es(worker, ordinal_of_set_of_this_leo_item);
       or_node = PSL_Datum (leo_psl, symbol_instance_of_path_ahm);
       if (!or_node || YS_Ord_of_OR(or_node) != work_earley_set_ordinal)
         {
-          last_or_node = or_node_new(b);
+          last_or_node =
+            or_node_new (worker, ordinal_of_set_of_this_leo_item);
           PSL_Datum (leo_psl, symbol_instance_of_path_ahm) = or_node =
               last_or_node;
           Origin_Ord_of_OR(or_node) = ordinal_of_set_of_this_leo_item;
@@ -10527,14 +14534,16 @@ or-nodes follow a completion.
           const OR cause = Nulling_OR_by_NSYID( RHSID_of_IRL (path_irl, rhs_ix ) );
           MARPA_ASSERT (symbol_instance < Length_of_IRL (path_irl)) @;
           MARPA_ASSERT (symbol_instance >= 0) @;
-          or_node = last_or_node = or_node_new(b);
+          or_node = last_or_node =
+            or_node_new (worker, work_earley_set_ordinal);
           PSL_Datum (this_earley_set_psl, symbol_instance) = or_node;
           Origin_Ord_of_OR (or_node) = ordinal_of_set_of_this_leo_item;
           YS_Ord_of_OR (or_node) = work_earley_set_ordinal;
           IRL_of_OR (or_node) = path_irl;
           Position_of_OR (or_node) = rhs_ix + 1;
 MARPA_ASSERT(Position_of_OR(or_node) <= 1 || predecessor);
-          draft_and_node_add (bocage_setup_obs, or_node, predecessor, cause);
+          draft_and_node_add (bocage_setup_obs, dand_hash, or_node,
+            predecessor, cause);
         }
       MARPA_ASSERT (Position_of_OR (or_node) <=
                     SYMI_of_IRL (path_irl) + Length_of_IRL (path_irl)) @;
@@ -10596,14 +14605,32 @@ DAND draft_and_node_new(struct marpa_obstack *obs, OR predecessor, OR cause)
     return draft_and_node;
 }
 
-@ @<Function definitions@> =
+@ If the draft and-nodes of |parent| are hashed,
+the new one is added to the hash.
+@<Function definitions@> =
 PRIVATE
-void draft_and_node_add(struct marpa_obstack *obs, OR parent, OR predecessor, OR cause)
+void draft_and_node_add(struct marpa_obstack *obs, DAND_HASH dand_hash,
+  OR parent, OR predecessor, OR cause)
 {
     MARPA_OFF_ASSERT(Position_of_OR(parent) <= 1 || predecessor)
     const DAND new = draft_and_node_new(obs, predecessor, cause);
     Next_DAND_of_DAND(new) = DANDs_of_OR(parent);
     DANDs_of_OR(parent) = new;
+    if (dand_hash->t_count > 0 && dand_hash_has_parent (dand_hash, parent))
+      dand_hash_insert (dand_hash, parent, new);
+}
+
+@ @<Function definitions@> =
+PRIVATE void
+draft_and_nodes_of_set_create (BOCAGE_WORKER worker,
+  YSID work_earley_set_ordinal)
+{
+  @<Unpack bocage worker objects@>@;
+  const YS_Const earley_set = YS_of_R_by_Ord (r, work_earley_set_ordinal);
+  YIM* const yims_of_ys = YIMs_of_YS(earley_set);
+  const int item_count = YIM_Count_of_YS (earley_set);
+  dand_hash_set_start (dand_hash, work_earley_set_ordinal);
+  @<Create draft and-nodes for |work_earley_set_ordinal|@>@;
 }
 
 @ @<Create draft and-nodes for |work_earley_set_ordinal|@> =
@@ -10642,7 +14669,7 @@ predecessor.  Set |or_node| to 0 if there is none.
     const AHM work_ahm = AHM_of_YIM (work_earley_item);
     MARPA_ASSERT (work_ahm >= AHM_by_ID (1))@;
     const int work_symbol_instance = SYMI_of_AHM (work_ahm);
-    const OR work_proper_or_node = or_by_origin_and_symi(per_ys_data,
+    const OR work_proper_or_node = or_by_origin_and_symi(worker,
       work_origin_ordinal, work_symbol_instance);
     @<Create Leo draft and-nodes@>@;
     @<Create draft and-nodes for token sources@>@;
@@ -10738,11 +14765,11 @@ bit set.  At that point I can stop the ascent.
 
 @ @<Function definitions@> =
 PRIVATE
-OR or_by_origin_and_symi ( struct s_bocage_setup_per_ys *per_ys_data,
+OR or_by_origin_and_symi ( BOCAGE_WORKER worker,
     YSID origin,
     SYMI symbol_instance)
 {
-  const PSL or_psl_at_origin = per_ys_data[(origin)].t_or_psl;
+  const PSL or_psl_at_origin = Or_PSL_of_Worker (worker, origin);
   return PSL_Datum (or_psl_at_origin, (symbol_instance));
 }
 
@@ -10750,8 +14777,8 @@ OR or_by_origin_and_symi ( struct s_bocage_setup_per_ys *per_ys_data,
 {
   const OR dand_cause
     = set_or_from_yim(per_ys_data, cause_earley_item);
-  if (!dand_is_duplicate(path_or_node, dand_predecessor, dand_cause)) {
-    draft_and_node_add (bocage_setup_obs, path_or_node,
+  if (!dand_is_duplicate(dand_hash, path_or_node, dand_predecessor, dand_cause)) {
+    draft_and_node_add (bocage_setup_obs, dand_hash, path_or_node,
 		      dand_predecessor, dand_cause);
   }
 }
@@ -10776,9 +14803,9 @@ If so, the loop that ascends the Leo path can be ended at that point.
 {
   const SYMI symbol_instance = SYMI_of_Completed_IRL(previous_path_irl);
   const int origin = Ord_of_YS(YS_of_LIM(path_leo_item));
-  const OR dand_cause = or_by_origin_and_symi(per_ys_data, origin, symbol_instance);
-  if (!dand_is_duplicate(path_or_node, dand_predecessor, dand_cause)) {
-    draft_and_node_add (bocage_setup_obs, path_or_node,
+  const OR dand_cause = or_by_origin_and_symi(worker, origin, symbol_instance);
+  if (!dand_is_duplicate(dand_hash, path_or_node, dand_predecessor, dand_cause)) {
+    draft_and_node_add (bocage_setup_obs, dand_hash, path_or_node,
           dand_predecessor, dand_cause);
   }
 }
@@ -10817,34 +14844,215 @@ int dands_are_equal(OR predecessor_a, OR cause_a,
 	const NSYID nsyid_of_b = NSYID_of_OR (cause_b);
 	return nsyid_of_a == nsyid_of_b;
     }
-  {
-    /* If here, we know that both causes are rule completions. */
-    const IRLID irlid_of_a = IRLID_of_OR (cause_a);
-    const IRLID irlid_of_b = IRLID_of_OR (cause_b);
-    return irlid_of_a == irlid_of_b;
-  }
-  // Not reached
+  {
+    /* If here, we know that both causes are rule completions. */
+    const IRLID irlid_of_a = IRLID_of_OR (cause_a);
+    const IRLID irlid_of_b = IRLID_of_OR (cause_b);
+    return irlid_of_a == irlid_of_b;
+  }
+  // Not reached
+}
+
+@ Return 1 if a new dand made up of |predecessor| and |cause| would
+duplicate any already in |parent|.
+Otherwise, return 0.
+Short lists of draft and-nodes are searched.
+Once a search finds a list which is not short,
+the list is put into the hash,
+and later searches of it use the hash.
+@d DAND_HASH_THRESHOLD 8
+@<Function definitions@> =
+PRIVATE
+int dand_is_duplicate(DAND_HASH dand_hash, OR parent, OR predecessor, OR cause)
+{
+  DAND dand;
+  int dand_count = 0;
+  if (dand_hash->t_count > 0 && dand_hash_has_parent (dand_hash, parent))
+    return dand_hash_find (dand_hash, parent, predecessor, cause);
+  for (dand = DANDs_of_OR (parent); dand; dand = Next_DAND_of_DAND (dand)) {
+      if (dands_are_equal(predecessor, cause,
+        Predecessor_OR_of_DAND(dand), Cause_OR_of_DAND(dand)))
+      {
+          return 1;
+      }
+      dand_count++;
+  }
+  if (dand_count >= DAND_HASH_THRESHOLD)
+    {
+      dand_hash_insert (dand_hash, parent, NULL);
+      for (dand = DANDs_of_OR (parent); dand; dand = Next_DAND_of_DAND (dand))
+        dand_hash_insert (dand_hash, parent, dand);
+    }
+  return 0;
+}
+
+@*0 The draft and-node hash.
+On highly ambiguous input,
+an or-node may have hundreds of draft and-nodes,
+and searching its list for each new one
+makes building the bocage quadratic.
+The hash holds the draft and-nodes of such or-nodes,
+and a marker entry for each of them,
+with a |NULL| draft and-node,
+which shows that its list is in the hash.
+@ All the draft and-nodes which are searched for duplicates
+have parents which end at the Earley set being worked on.
+So, like the hash of alternatives,
+a hash entry is live only if it is stamped with
+the current Earley set,
+and the hash is emptied by changing the Earley set.
+An or-node whose entries are stale
+no longer has its marker,
+and goes back to being searched as a list.
+@s DAND_HASH int
+@<Private incomplete structures@> =
+struct s_dand_hash;
+typedef struct s_dand_hash* DAND_HASH;
+@ @<Private structures@> =
+struct s_dand_hash_entry {
+    OR t_parent;
+    DAND t_dand;
+    YSID t_set;
+};
+struct s_dand_hash {
+    struct s_dand_hash_entry* t_entries;
+    int t_size;
+    int t_count;
+    YSID t_set;
+};
+
+@ @<Function definitions@> =
+PRIVATE void dand_hash_init(DAND_HASH dand_hash)
+{
+  dand_hash->t_entries = NULL;
+  dand_hash->t_size = 0;
+  dand_hash->t_count = 0;
+  dand_hash->t_set = -1;
+}
+
+@ @<Function definitions@> =
+PRIVATE void dand_hash_destroy(DAND_HASH dand_hash)
+{
+  my_free (dand_hash->t_entries);
+  dand_hash->t_entries = NULL;
+}
+
+@ @<Function definitions@> =
+PRIVATE void dand_hash_set_start(DAND_HASH dand_hash, YSID set)
+{
+  dand_hash->t_set = set;
+  dand_hash->t_count = 0;
+}
+
+@ The hash is of the parent, and of the fields
+that |dands_are_equal| compares.
+The marker of a parent hashes as if it had
+a middle of |-2|.
+@<Function definitions@> =
+PRIVATE unsigned int
+dand_hash_key (OR parent, OR predecessor, OR cause, int is_marker)
+{
+  unsigned int key = (unsigned int) ID_of_OR (parent) * 2654435761u;
+  if (is_marker)
+    return key ^ (unsigned int) -2;
+  key ^= (unsigned int) (predecessor ? YS_Ord_of_OR (predecessor) : -1);
+  key *= 2654435761u;
+  return key ^ (OR_is_Token (cause)
+                ? (unsigned int) NSYID_of_OR (cause) * 2u + 1u
+                : (unsigned int) IRLID_of_OR (cause) * 2u);
+}
+
+@ @<Function definitions@> =
+PRIVATE int
+dand_hash_has_parent (DAND_HASH dand_hash, OR parent)
+{
+  const struct s_dand_hash_entry *const entries = dand_hash->t_entries;
+  const unsigned int mask = (unsigned int) dand_hash->t_size - 1;
+  unsigned int probe;
+  for (probe = dand_hash_key (parent, NULL, NULL, 1) & mask;
+       entries[probe].t_set == dand_hash->t_set;
+       probe = (probe + 1) & mask)
+    {
+      if (entries[probe].t_parent == parent && !entries[probe].t_dand)
+        return 1;
+    }
+  return 0;
+}
+
+@ @<Function definitions@> =
+PRIVATE int
+dand_hash_find (DAND_HASH dand_hash, OR parent, OR predecessor, OR cause)
+{
+  const struct s_dand_hash_entry *const entries = dand_hash->t_entries;
+  const unsigned int mask = (unsigned int) dand_hash->t_size - 1;
+  unsigned int probe;
+  for (probe = dand_hash_key (parent, predecessor, cause, 0) & mask;
+       entries[probe].t_set == dand_hash->t_set;
+       probe = (probe + 1) & mask)
+    {
+      const DAND dand = entries[probe].t_dand;
+      if (entries[probe].t_parent == parent && dand
+          && dands_are_equal (predecessor, cause,
+                              Predecessor_OR_of_DAND (dand),
+                              Cause_OR_of_DAND (dand)))
+        return 1;
+    }
+  return 0;
 }
 
-@ Return 1 if a new dand made up of |predecessor| and |cause| would
-duplicate any already in |parent|.
-Otherwise, return 0.
+@ Adds |dand| to the hash,
+or the marker of |parent| if |dand| is |NULL|.
+The caller must make sure the entry is not already in the hash.
+The hash is grown so that its load is always less than one half.
 @<Function definitions@> =
-PRIVATE
-int dand_is_duplicate(OR parent, OR predecessor, OR cause)
-{
-  DAND dand;
-  for (dand = DANDs_of_OR (parent); dand; dand = Next_DAND_of_DAND (dand)) {
-      if (dands_are_equal(predecessor, cause,
-        Predecessor_OR_of_DAND(dand), Cause_OR_of_DAND(dand)))
-      {
-          return 1;
-      }
-  }
-  return 0;
+PRIVATE void
+dand_hash_insert (DAND_HASH dand_hash, OR parent, DAND dand)
+{
+  unsigned int mask;
+  unsigned int probe;
+  if ((dand_hash->t_count + 1) * 2 >= dand_hash->t_size)
+    dand_hash_grow (dand_hash);
+  mask = (unsigned int) dand_hash->t_size - 1;
+  probe = (dand
+           ? dand_hash_key (parent, Predecessor_OR_of_DAND (dand),
+                            Cause_OR_of_DAND (dand), 0)
+           : dand_hash_key (parent, NULL, NULL, 1)) & mask;
+  while (dand_hash->t_entries[probe].t_set == dand_hash->t_set)
+    probe = (probe + 1) & mask;
+  dand_hash->t_entries[probe].t_parent = parent;
+  dand_hash->t_entries[probe].t_dand = dand;
+  dand_hash->t_entries[probe].t_set = dand_hash->t_set;
+  dand_hash->t_count++;
 }
 
 @ @<Function definitions@> =
+PRIVATE void
+dand_hash_grow (DAND_HASH dand_hash)
+{
+  struct s_dand_hash_entry *const old_entries = dand_hash->t_entries;
+  const int old_size = dand_hash->t_size;
+  const int live_count = dand_hash->t_count;
+  int new_size = MAX (64, old_size);
+  int slot;
+  while (new_size <= (live_count + 1) * 2)
+    new_size *= 2;
+  dand_hash->t_entries = marpa_new (struct s_dand_hash_entry, new_size);
+  dand_hash->t_size = new_size;
+  dand_hash->t_count = 0;
+  for (slot = 0; slot < new_size; slot++)
+    dand_hash->t_entries[slot].t_set = -1;
+  for (slot = 0; slot < old_size; slot++)
+    {
+      const struct s_dand_hash_entry *const entry = old_entries + slot;
+      if (entry->t_set == dand_hash->t_set)
+        dand_hash_insert (dand_hash, entry->t_parent, entry->t_dand);
+    }
+  my_free (old_entries);
+}
+
+@ A predicted Earley item may not be in the parse,
+and its Earley set may have no PSI data.
+@<Function definitions@> =
 PRIVATE
 OR set_or_from_yim ( struct s_bocage_setup_per_ys *per_ys_data,
   YIM psi_yim)
@@ -10852,6 +15060,8 @@ OR set_or_from_yim ( struct s_bocage_setup_per_ys *per_ys_data,
   const YIM psi_earley_item = psi_yim;
   const int psi_earley_set_ordinal = YS_Ord_of_YIM (psi_earley_item);
   const int psi_item_ordinal = Ord_of_YIM (psi_earley_item);
+  if (!per_ys_data[psi_earley_set_ordinal].t_or_node_by_item)
+    return NULL;
   return OR_by_PSI(per_ys_data, psi_earley_set_ordinal, psi_item_ordinal);
 }
 
@@ -10862,7 +15072,7 @@ OR set_or_from_yim ( struct s_bocage_setup_per_ys *per_ys_data,
   const AHM ahm = AHM_of_YIM (base_earley_item);
   path_irl = IRL_of_AHM (ahm);
   symbol_instance = Last_Proper_SYMI_of_IRL (path_irl);
-  path_or_node = or_by_origin_and_symi(per_ys_data, origin_ordinal, symbol_instance);
+  path_or_node = or_by_origin_and_symi(worker, origin_ordinal, symbol_instance);
 }
 
 
@@ -10879,14 +15089,14 @@ and are not traversed when traversing or-nodes by ID.
       OR new_token_or_node;
       const NSYID token_nsyid = NSYID_of_SRCL (tkn_source_link);
       const YIM predecessor_earley_item = Predecessor_of_SRCL (tkn_source_link);
-      const OR dand_predecessor = safe_or_from_yim (per_ys_data,
+      const OR dand_predecessor = safe_or_from_yim (g, per_ys_data,
 					      predecessor_earley_item);
       if (NSYID_is_Valued_in_B (b, token_nsyid))
 	{
           @t}\comment{@>
 	  /* I probably can and should use a smaller allocation,
           sized just for a token or-node */
-	  new_token_or_node = (OR) marpa_obs_new (OBS_of_B (b), OR_Object, 1);
+	  new_token_or_node = (OR) marpa_obs_new (worker->t_obs, OR_Object, 1);
 	  Type_of_OR (new_token_or_node) = VALUED_TOKEN_OR_NODE;
 	  NSYID_of_OR (new_token_or_node) = token_nsyid;
 	  Value_of_OR (new_token_or_node) = Value_of_SRCL (tkn_source_link);
@@ -10895,7 +15105,7 @@ and are not traversed when traversing or-nodes by ID.
 	{
 	  new_token_or_node = Unvalued_OR_by_NSYID (token_nsyid);
 	}
-      draft_and_node_add (bocage_setup_obs, work_proper_or_node,
+      draft_and_node_add (bocage_setup_obs, dand_hash, work_proper_or_node,
 			  dand_predecessor, new_token_or_node);
     }
 }
@@ -10905,6 +15115,7 @@ an or-node exists.
 @<Function definitions@> =
 PRIVATE
 OR safe_or_from_yim(
+  GRAMMAR g,
   struct s_bocage_setup_per_ys* per_ys_data,
   YIM yim)
 {
@@ -10924,12 +15135,12 @@ OR safe_or_from_yim(
       const AHM cause_ahm = AHM_of_YIM (cause_earley_item);
       const SYMI cause_symbol_instance =
 	SYMI_of_Completed_IRL (IRL_of_AHM (cause_ahm));
-      OR dand_predecessor = safe_or_from_yim (per_ys_data,
+      OR dand_predecessor = safe_or_from_yim (g, per_ys_data,
 					      predecessor_earley_item);
       const OR dand_cause =
-	or_by_origin_and_symi (per_ys_data, middle_ordinal,
+	or_by_origin_and_symi (worker, middle_ordinal,
 			       cause_symbol_instance);
-      draft_and_node_add (bocage_setup_obs, work_proper_or_node,
+      draft_and_node_add (bocage_setup_obs, dand_hash, work_proper_or_node,
 			  dand_predecessor, dand_cause);
     }
 }
@@ -10937,21 +15148,25 @@ OR safe_or_from_yim(
 @ The need for this count is a vestige of duplicate checking.
 Now that duplicates no longer occur,
 the whole process probably can and should be simplified.
-@<Count draft and-nodes@> =
+@<Function definitions@> =
+PRIVATE void
+draft_and_nodes_count (BOCAGE_WORKER worker)
 {
-  const int or_node_count_of_b = OR_Count_of_B (b);
-  int or_node_id = 0;
-  while (or_node_id < or_node_count_of_b)
+  const int or_node_count_of_worker = worker->t_or_node_count;
+  int unique_draft_and_node_count = 0;
+  int or_node_ix = 0;
+  while (or_node_ix < or_node_count_of_worker)
     {
-      const OR work_or_node = OR_of_B_by_ID (b, or_node_id);
+      const OR work_or_node = worker->t_or_nodes[or_node_ix];
       DAND dand = DANDs_of_OR (work_or_node);
       while (dand)
 	{
 	  unique_draft_and_node_count++;
 	  dand = Next_DAND_of_DAND (dand);
 	}
-      or_node_id++;
+      or_node_ix++;
     }
+  worker->t_and_node_count = unique_draft_and_node_count;
 }
 
 @** And-node (AND) code.
@@ -10984,25 +15199,83 @@ struct s_and_node {
 };
 typedef struct s_and_node AND_Object;
 
-@ @<Create the final and-nodes for all earley sets@> =
+@ Each worker's or-nodes and and-nodes follow those
+of the worker before it.
+Once the or-nodes are in the bocage,
+the workers give their or-nodes their final IDs,
+and create the final and-nodes.
+@<Create the final and-nodes for all earley sets@> =
 {
   int unique_draft_and_node_count = 0;
-  @<Count draft and-nodes@>@;
-  @<Create the final and-node array@>@;
+  int worker_ix;
+  @<Put the or-nodes of the workers into |b|@>@;
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      workers[worker_ix].t_first_andid = unique_draft_and_node_count;
+      unique_draft_and_node_count += workers[worker_ix].t_and_node_count;
+    }
+  ANDs_of_B (b) = marpa_new (AND_Object, unique_draft_and_node_count);
+  AND_Count_of_B (b) = unique_draft_and_node_count;
+  if (worker_count > 1)
+    fork_join (bocage_worker_and_nodes, worker_args, worker_count,
+               fork_join_data);
+  else
+    bocage_worker_and_nodes (workers);
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      if (workers[worker_ix].t_is_ambiguous)
+        Ambiguity_Metric_of_B (b) = 2;
+    }
+}
+
+@ The or-nodes of a single worker already have their final IDs,
+and their array becomes that of the bocage.
+@<Put the or-nodes of the workers into |b|@> =
+{
+  int worker_ix;
+  if (worker_count == 1)
+    {
+      OR_Count_of_B (b) = workers->t_or_node_count;
+      ORs_of_B (b) =
+        marpa_renew (OR, workers->t_or_nodes, OR_Count_of_B (b));
+      workers->t_or_nodes = NULL;
+    }
+  else
+    {
+      int or_node_count = 0;
+      for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+        {
+          workers[worker_ix].t_first_orid = or_node_count;
+          or_node_count += workers[worker_ix].t_or_node_count;
+        }
+      OR_Count_of_B (b) = or_node_count;
+      ORs_of_B (b) = marpa_new (OR, or_node_count);
+      for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+        {
+          const BOCAGE_WORKER worker = workers + worker_ix;
+          memcpy (ORs_of_B (b) + worker->t_first_orid, worker->t_or_nodes,
+                  sizeof (OR) * (size_t) worker->t_or_node_count);
+        }
+    }
 }
 
-@ @<Create the final and-node array@> =
+@ @<Function definitions@> =
+PRIVATE_NOT_INLINE void
+bocage_worker_and_nodes (void *worker_arg)
 {
-  const int or_count_of_b = OR_Count_of_B (b);
+  const BOCAGE_WORKER worker = worker_arg;
+  const BOCAGE b = worker->t_bocage;
+  const int or_count_of_worker = worker->t_or_node_count;
   int or_node_id;
-  int and_node_id = 0;
-  const AND ands_of_b = ANDs_of_B (b) =
-    marpa_new (AND_Object, unique_draft_and_node_count);
-  for (or_node_id = 0; or_node_id < or_count_of_b; or_node_id++)
+  int and_node_id = worker->t_first_andid;
+  const AND ands_of_b = ANDs_of_B (b);
+  for (or_node_id = worker->t_first_orid;
+       or_node_id < worker->t_first_orid + or_count_of_worker; or_node_id++)
     {
       int and_count_of_parent_or = 0;
       const OR or_node = OR_of_B_by_ID (b, or_node_id);
       DAND dand = DANDs_of_OR (or_node);
+      ID_of_OR (or_node) = or_node_id;
       First_ANDID_of_OR (or_node) = and_node_id;
       while (dand)
 	{
@@ -11016,10 +15289,10 @@ typedef struct s_and_node AND_Object;
 	  dand = Next_DAND_of_DAND (dand);
 	}
       AND_Count_of_OR (or_node) = and_count_of_parent_or;
-      if (and_count_of_parent_or > 1) Ambiguity_Metric_of_B (b) = 2;
+      if (and_count_of_parent_or > 1) worker->t_is_ambiguous = 1;
     }
-  AND_Count_of_B (b) = and_node_id;
-  MARPA_ASSERT (and_node_id == unique_draft_and_node_count);
+  MARPA_ASSERT (and_node_id
+    == worker->t_first_andid + worker->t_and_node_count);
 }
 
 
@@ -11057,6 +15330,16 @@ marpa_obs_free(OBS_of_B(b));
 @<Function definitions@> =
 Marpa_Bocage marpa_b_new(Marpa_Recognizer r,
     Marpa_Earley_Set_ID ordinal_arg)
+{
+  return marpa_b_new_parallel (r, ordinal_arg, 1, NULL, NULL);
+}
+
+@ @<Function definitions@> =
+Marpa_Bocage marpa_b_new_parallel(Marpa_Recognizer r,
+    Marpa_Earley_Set_ID ordinal_arg,
+    int worker_count_arg,
+    Marpa_Fork_Join fork_join,
+    void *fork_join_data)
 {
     @<Return |NULL| on failure@>@;
     @<Declare bocage locals@>@;
@@ -11066,8 +15349,23 @@ Marpa_Bocage marpa_b_new(Marpa_Recognizer r,
         MARPA_ERROR(MARPA_ERR_INVALID_LOCATION);
         return failure_indicator;
     }
+    if (_MARPA_UNLIKELY (worker_count_arg < 1))
+      {
+        MARPA_ERROR (MARPA_ERR_INVALID_WORKER_COUNT);
+        return failure_indicator;
+      }
+    if (_MARPA_UNLIKELY (worker_count_arg > 1 && !fork_join))
+      {
+        MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+        return failure_indicator;
+      }
 
     @<Fail if recognizer not started@>@;
+    if (_MARPA_UNLIKELY (Discarded_YS_Count_of_R (r) > 0))
+      {
+        MARPA_ERROR (MARPA_ERR_EARLEY_SET_DISCARDED);
+        return failure_indicator;
+      }
     {
         struct marpa_obstack* const obstack = marpa_obs_init;
         b = marpa_obs_new (obstack, struct marpa_bocage, 1);
@@ -11097,9 +15395,23 @@ Marpa_Bocage marpa_b_new(Marpa_Recognizer r,
     bocage_setup_obs = marpa_obs_init;
     @<Allocate bocage setup working data@>@;
     @<Populate the PSI data@>@;
-    @<Create the or-nodes for all earley sets@>@;
+    @<Count the Earley items in the parse@>@;
+    @<Initialize the bocage workers@>@;
+    if (worker_count > 1)
+      {
+        fork_join (bocage_worker_or_nodes, worker_args, worker_count,
+                   fork_join_data);
+        fork_join (bocage_worker_draft_and_nodes, worker_args, worker_count,
+                   fork_join_data);
+      }
+    else
+      {
+        @<Create the or-nodes for all earley sets@>@;
+        draft_and_nodes_count (workers);
+      }
     @<Create the final and-nodes for all earley sets@>@;
     @<Set top or node id in |b|@>;
+    @<Destroy the bocage workers@>@;
     marpa_obs_free(bocage_setup_obs);
     return b;
     NO_PARSE: ;
@@ -11134,7 +15446,7 @@ JEARLEME end_of_parse_earleme;
 YIM start_yim = NULL;
 struct marpa_obstack* bocage_setup_obs = NULL;
 int count_of_earley_items_in_parse;
-const int earley_set_count_of_r = YS_Count_of_R (r);
+int earley_set_count_in_parse;
 
 @ @<Private incomplete structures@> =
 struct s_bocage_setup_per_ys;
@@ -11145,8 +15457,8 @@ They may be worth keeping.
 @<Private structures@> =
 struct s_bocage_setup_per_ys {
      OR * t_or_node_by_item;
-     PSL t_or_psl;
      PSL t_and_psl;
+     int t_item_count;
 };
 @ @<Declare bocage locals@> =
 struct s_bocage_setup_per_ys* per_ys_data = NULL;
@@ -11172,35 +15484,45 @@ struct s_bocage_setup_per_ys* per_ys_data = NULL;
   end_of_parse_earleme = Earleme_of_YS (end_of_parse_earley_set);
 }
 
-@
+@ No Earley item after the end of the parse can be in it,
+so the working data stops at the end of parse Earley set.
+The PSI data for each Earley set
+is allocated when it is first needed.
 @<Allocate bocage setup working data@>=
 {
   int earley_set_ordinal;
-  int earley_set_count = YS_Count_of_R (r);
-  count_of_earley_items_in_parse = 0;
+  earley_set_count_in_parse = Ord_of_YS (end_of_parse_earley_set) + 1;
   per_ys_data = marpa_obs_new (
-    bocage_setup_obs, struct s_bocage_setup_per_ys, earley_set_count);
-  for (earley_set_ordinal = 0; earley_set_ordinal < earley_set_count;
+    bocage_setup_obs, struct s_bocage_setup_per_ys, earley_set_count_in_parse);
+  for (earley_set_ordinal = 0; earley_set_ordinal < earley_set_count_in_parse;
        earley_set_ordinal++)
     {
       const YS_Const earley_set = YS_of_R_by_Ord (r, earley_set_ordinal);
-      const int item_count = YIM_Count_of_YS (earley_set);
-      count_of_earley_items_in_parse += item_count;
-      {
-        int item_ordinal;
-        struct s_bocage_setup_per_ys *per_ys = per_ys_data + earley_set_ordinal;
-        per_ys->t_or_node_by_item =
-          marpa_obs_new (bocage_setup_obs, OR, item_count);
-        per_ys->t_or_psl = NULL;
-        per_ys->t_and_psl = NULL;
-        for (item_ordinal = 0; item_ordinal < item_count; item_ordinal++)
-          {
-            OR_by_PSI (per_ys_data, earley_set_ordinal, item_ordinal) = NULL;
-          }
-      }
+      struct s_bocage_setup_per_ys *per_ys = per_ys_data + earley_set_ordinal;
+      per_ys->t_or_node_by_item = NULL;
+      per_ys->t_and_psl = NULL;
+      per_ys->t_item_count = YIM_Count_of_YS (earley_set);
   }
 }
 
+@ The count is of the Earley items in the Earley sets
+which have PSI data,
+and is used to size the or-node arrays,
+and to divide the work among the workers.
+@<Count the Earley items in the parse@> =
+{
+  int earley_set_ordinal;
+  count_of_earley_items_in_parse = 0;
+  for (earley_set_ordinal = 0; earley_set_ordinal < earley_set_count_in_parse;
+       earley_set_ordinal++)
+    {
+      const struct s_bocage_setup_per_ys *per_ys =
+        per_ys_data + earley_set_ordinal;
+      if (per_ys->t_or_node_by_item)
+        count_of_earley_items_in_parse += per_ys->t_item_count;
+    }
+}
+
 @ Predicted AHFA states can be skipped since they
 contain no completions.
 Note that AHFA state 0 is not marked as a predicted AHFA state,
@@ -11247,6 +15569,248 @@ to make sense.
   Top_ORID_of_B (b) = ID_of_OR (root_or_node);
 }
 
+@*0 Bocage workers.
+The or-nodes and draft and-nodes are created by one or more
+{\it workers}.
+Each worker has the Earley sets in a range,
+and its own PSL's, draft and-node hash, and obstacks,
+so that the workers can run at the same time,
+in different threads.
+Which threads, if any, is up to the application,
+which passes a {\it fork-join} function to |marpa_b_new_parallel|.
+The fork-join function calls a work function once for each worker,
+and returns after all of the calls have returned.
+Libmarpa itself never starts a thread.
+@<Public typedefs@> =
+typedef void (*Marpa_Work) (void *work_arg);
+typedef void (*Marpa_Fork_Join) (Marpa_Work work, void **work_args,
+  int work_count, void *fork_join_data);
+
+@ The or-nodes of an Earley set depend on nothing
+outside of that Earley set,
+except the PSI data and the Leo items.
+But its draft and-nodes need the PSI data
+of the earlier Earley sets,
+which may belong to other workers.
+So, with more than one worker,
+all the workers first create their or-nodes,
+and only then create their draft and-nodes.
+A single worker does not wait,
+and creates the or-nodes and draft and-nodes of each
+Earley set together,
+as |marpa_b_new| always has.
+@s BOCAGE_WORKER int
+@<Private incomplete structures@> =
+struct s_bocage_worker;
+typedef struct s_bocage_worker* BOCAGE_WORKER;
+@ |t_obs| has the lifetime of the bocage,
+and holds the worker's or-nodes.
+|t_setup_obs| is freed when the bocage is built.
+@<Private structures@> =
+struct s_bocage_worker {
+    BOCAGE t_bocage;
+    RECCE t_recce;
+    struct s_bocage_setup_per_ys *t_per_ys_data;
+    struct marpa_obstack *t_obs;
+    struct marpa_obstack *t_setup_obs;
+    PSAR t_or_psar;
+    PSL **t_or_psl_pages;
+    OR *t_or_nodes;
+    YSID *t_psl_ysids;
+    struct s_dand_hash t_dand_hash;
+    YSID t_first_ysid;
+    YSID t_end_ysid;
+    int t_or_node_count;
+    int t_or_node_capacity;
+    ORID t_first_orid;
+    ANDID t_first_andid;
+    int t_and_node_count;
+    BITFIELD t_is_ambiguous:1;
+};
+
+@ @<Unpack bocage worker objects@> =
+const BOCAGE b @,@, UNUSED = worker->t_bocage;
+const GRAMMAR g @,@, UNUSED = G_of_B (b);
+const RECCE r = worker->t_recce;
+struct s_bocage_setup_per_ys *const per_ys_data = worker->t_per_ys_data;
+const PSAR or_psar @,@, UNUSED = worker->t_or_psar;
+const DAND_HASH dand_hash = &worker->t_dand_hash;
+struct marpa_obstack *const bocage_setup_obs @,@, UNUSED =
+  worker->t_setup_obs;
+
+@ The obstacks of all workers but the first are kept in the bocage,
+and freed with it.
+@d Worker_OBS_Count_of_B(b) ((b)->t_worker_obs_count)
+@d Worker_OBSs_of_B(b) ((b)->t_worker_obs)
+@<Widely aligned bocage elements@> =
+struct marpa_obstack **t_worker_obs;
+@ @<Int aligned bocage elements@> =
+int t_worker_obs_count;
+@ @<Initialize bocage elements@> =
+Worker_OBSs_of_B(b) = NULL;
+Worker_OBS_Count_of_B(b) = 0;
+@ @<Destroy bocage elements, main phase@> =
+{
+  int obs_ix;
+  for (obs_ix = 0; obs_ix < Worker_OBS_Count_of_B (b); obs_ix++)
+    marpa_obs_free (Worker_OBSs_of_B (b)[obs_ix]);
+}
+
+@ @<Declare bocage locals@> =
+int worker_count = 0;
+BOCAGE_WORKER workers = NULL;
+void **worker_args = NULL;
+
+@ The Earley sets are divided among the workers in order,
+so that the or-nodes of each worker follow
+those of the worker before it.
+Each worker gets about the same number of Earley items.
+A worker may get none.
+@<Initialize the bocage workers@> =
+{
+  int worker_ix;
+  YSID ysid = 0;
+  int items_so_far = 0;
+  worker_count = worker_count_arg;
+  workers =
+    marpa_obs_new (bocage_setup_obs, struct s_bocage_worker, worker_count);
+  worker_args = marpa_obs_new (bocage_setup_obs, void *, worker_count);
+  if (worker_count > 1)
+    {
+      Worker_OBS_Count_of_B (b) = worker_count - 1;
+      Worker_OBSs_of_B (b) =
+        marpa_obs_new (OBS_of_B (b), struct marpa_obstack *,
+                       worker_count - 1);
+    }
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      const BOCAGE_WORKER worker = workers + worker_ix;
+      const double item_goal = (double) count_of_earley_items_in_parse
+        * (worker_ix + 1) / worker_count;
+      int item_count_of_worker = 0;
+      worker->t_first_ysid = ysid;
+      while (ysid < earley_set_count_in_parse
+             && (worker_ix == worker_count - 1
+                 || (double) items_so_far < item_goal))
+        {
+          if (per_ys_data[ysid].t_or_node_by_item)
+            {
+              item_count_of_worker += per_ys_data[ysid].t_item_count;
+              items_so_far += per_ys_data[ysid].t_item_count;
+            }
+          ysid++;
+        }
+      worker->t_end_ysid = ysid;
+      @<Initialize |worker|@>@;
+      worker_args[worker_ix] = worker;
+    }
+}
+
+@ @<Initialize |worker|@> =
+{
+  const int psl_page_count =
+    (earley_set_count_in_parse >> PSL_PAGE_BITS) + 1;
+  int psl_page_ix;
+  worker->t_bocage = b;
+  worker->t_recce = r;
+  worker->t_per_ys_data = per_ys_data;
+  if (worker_ix > 0)
+    {
+      worker->t_obs = Worker_OBSs_of_B (b)[worker_ix - 1] = marpa_obs_init;
+      worker->t_setup_obs = marpa_obs_init;
+    }
+  else
+    {
+      worker->t_obs = OBS_of_B (b);
+      worker->t_setup_obs = bocage_setup_obs;
+    }
+  worker->t_or_psar = marpa_obs_new (worker->t_setup_obs, PSAR_Object, 1);
+  psar_init (worker->t_or_psar, SYMI_Count_of_G (g));
+  worker->t_or_psl_pages =
+    marpa_obs_new (worker->t_setup_obs, PSL *, psl_page_count);
+  for (psl_page_ix = 0; psl_page_ix < psl_page_count; psl_page_ix++)
+    worker->t_or_psl_pages[psl_page_ix] = NULL;
+  worker->t_or_node_capacity = MAX (1, item_count_of_worker);
+  worker->t_or_nodes = marpa_new (OR, worker->t_or_node_capacity);
+  worker->t_psl_ysids =
+    worker_count > 1 ? marpa_new (YSID, worker->t_or_node_capacity) : NULL;
+  dand_hash_init (&worker->t_dand_hash);
+  worker->t_or_node_count = 0;
+  worker->t_first_orid = 0;
+  worker->t_first_andid = 0;
+  worker->t_and_node_count = 0;
+  worker->t_is_ambiguous = 0;
+}
+
+@ The PSAR's must be destroyed before the obstacks which hold
+their owners.
+@<Destroy the bocage workers@> =
+{
+  int worker_ix;
+  for (worker_ix = 0; worker_ix < worker_count; worker_ix++)
+    {
+      const BOCAGE_WORKER worker = workers + worker_ix;
+      psar_destroy (worker->t_or_psar);
+      dand_hash_destroy (&worker->t_dand_hash);
+      my_free (worker->t_or_nodes);
+      my_free (worker->t_psl_ysids);
+      if (worker_ix > 0)
+        marpa_obs_free (worker->t_setup_obs);
+    }
+}
+
+@ @<Function definitions@> =
+PRIVATE_NOT_INLINE void
+bocage_worker_or_nodes (void *worker_arg)
+{
+  const BOCAGE_WORKER worker = worker_arg;
+  YSID ysid;
+  for (ysid = worker->t_first_ysid; ysid < worker->t_end_ysid; ysid++)
+    {
+      if (worker->t_per_ys_data[ysid].t_or_node_by_item)
+        or_nodes_of_set_create (worker, ysid);
+    }
+}
+
+@ @<Function definitions@> =
+PRIVATE_NOT_INLINE void
+bocage_worker_draft_and_nodes (void *worker_arg)
+{
+  const BOCAGE_WORKER worker = worker_arg;
+  int or_node_ix = 0;
+  YSID ysid;
+  for (ysid = worker->t_first_ysid; ysid < worker->t_end_ysid; ysid++)
+    {
+      if (!worker->t_per_ys_data[ysid].t_or_node_by_item)
+        continue;
+      @<Restore the or-node PSL's of |ysid|@>@;
+      draft_and_nodes_of_set_create (worker, ysid);
+    }
+  draft_and_nodes_count (worker);
+}
+
+@ When the draft and-nodes of an Earley set are created,
+the PSL's for its or-nodes are gone,
+and are restored from the or-nodes.
+The or-nodes of an Earley set follow each other,
+and each goes back into the PSL of the Earley set in the log,
+which is not always its origin.
+@<Restore the or-node PSL's of |ysid|@> =
+{
+  psar_dealloc (worker->t_or_psar);
+  for (; or_node_ix < worker->t_or_node_count; or_node_ix++)
+    {
+      const OR or_node = worker->t_or_nodes[or_node_ix];
+      PSL psl;
+      if (YS_Ord_of_OR (or_node) != ysid)
+        break;
+      psl = psl_claim_by_es (worker, worker->t_psl_ysids[or_node_ix]);
+      PSL_Datum (psl,
+                 SYMI_of_IRL (IRL_of_OR (or_node)) + Position_of_OR (or_node)
+                 - 1) = or_node;
+    }
+}
+
 @*0 Top or-node.
 @ If |b| is nulling, the top Or node ID will be -1.
 @<Function definitions@> =
@@ -11349,6 +15913,125 @@ int marpa_b_is_null(Marpa_Bocage b)
   return B_is_Nulling(b);
 }
 
+@*0 Exporting the bocage.
+Applications which analyze the whole bocage,
+and especially those which call Libmarpa through another language,
+would pay for one call per field of every node
+if they used the trace functions.
+|marpa_b_export()| instead copies the or-nodes and and-nodes
+into a single buffer supplied by the caller,
+as a structure of arrays,
+all of whose elements are integers.
+The values are those returned by the trace functions:
+-1 stands for a missing predecessor, cause or symbol,
+and the symbol is the internal symbol of a token.
+@<Public structures@> =
+struct marpa_bocage_export {
+     int t_or_node_count;
+     int t_and_node_count;
+     Marpa_Or_Node_ID t_top_or_node;
+     Marpa_IRL_ID *t_or_node_irl;
+     int *t_or_node_position;
+     Marpa_Earley_Set_ID *t_or_node_origin;
+     Marpa_Earley_Set_ID *t_or_node_set;
+     Marpa_And_Node_ID *t_or_node_first_and;
+     int *t_or_node_and_count;
+     Marpa_Or_Node_ID *t_and_node_parent;
+     Marpa_Or_Node_ID *t_and_node_predecessor;
+     Marpa_Or_Node_ID *t_and_node_cause;
+     Marpa_Symbol_ID *t_and_node_symbol;
+     Marpa_Earley_Set_ID *t_and_node_middle;
+};
+typedef struct marpa_bocage_export Marpa_Bocage_Export;
+
+@ The buffer starts with a |Marpa_Bocage_Export| structure,
+whose pointers point to the arrays which follow it
+in the same buffer.
+The size protocol is that of |marpa_g_serialize()|.
+@d Or_Node_Export_Array_Count 6
+@d And_Node_Export_Array_Count 5
+@<Function definitions@> =
+int
+marpa_b_export (Marpa_Bocage b, void *buffer, size_t * p_size)
+{
+  size_t export_size;
+  @<Return |-2| on failure@>@;
+  @<Unpack bocage objects@>@;
+  @<Fail if fatal error@>@;
+  if (_MARPA_UNLIKELY (!p_size))
+    {
+      MARPA_ERROR (MARPA_ERR_POINTER_ARG_NULL);
+      return failure_indicator;
+    }
+  export_size = sizeof (Marpa_Bocage_Export)
+    + sizeof (int) *
+    ((size_t) OR_Count_of_B (b) * Or_Node_Export_Array_Count
+     + (size_t) AND_Count_of_B (b) * And_Node_Export_Array_Count);
+  if (!buffer || *p_size < export_size)
+    {
+      *p_size = export_size;
+      return 0;
+    }
+  *p_size = export_size;
+  @<Write the export of |b| into |buffer|@>@;
+  return 1;
+}
+
+@ @<Write the export of |b| into |buffer|@> =
+{
+  Marpa_Bocage_Export *const bocage_export = buffer;
+  const int or_node_count = OR_Count_of_B (b);
+  const int and_node_count = AND_Count_of_B (b);
+  const AND and_nodes = ANDs_of_B (b);
+  int *next_array = (int *) (bocage_export + 1);
+  ORID or_node_id;
+  ANDID and_node_id;
+  bocage_export->t_or_node_count = or_node_count;
+  bocage_export->t_and_node_count = and_node_count;
+  bocage_export->t_top_or_node = Top_ORID_of_B (b);
+  bocage_export->t_or_node_irl = next_array;
+  bocage_export->t_or_node_position = (next_array += or_node_count);
+  bocage_export->t_or_node_origin = (next_array += or_node_count);
+  bocage_export->t_or_node_set = (next_array += or_node_count);
+  bocage_export->t_or_node_first_and = (next_array += or_node_count);
+  bocage_export->t_or_node_and_count = (next_array += or_node_count);
+  bocage_export->t_and_node_parent = (next_array += or_node_count);
+  bocage_export->t_and_node_predecessor = (next_array += and_node_count);
+  bocage_export->t_and_node_cause = (next_array += and_node_count);
+  bocage_export->t_and_node_symbol = (next_array += and_node_count);
+  bocage_export->t_and_node_middle = (next_array += and_node_count);
+  for (or_node_id = 0; or_node_id < or_node_count; or_node_id++)
+    {
+      const OR or_node = OR_of_B_by_ID (b, or_node_id);
+      bocage_export->t_or_node_irl[or_node_id] = IRLID_of_OR (or_node);
+      bocage_export->t_or_node_position[or_node_id] = Position_of_OR (or_node);
+      bocage_export->t_or_node_origin[or_node_id] = Origin_Ord_of_OR (or_node);
+      bocage_export->t_or_node_set[or_node_id] = YS_Ord_of_OR (or_node);
+      bocage_export->t_or_node_first_and[or_node_id] =
+        First_ANDID_of_OR (or_node);
+      bocage_export->t_or_node_and_count[or_node_id] =
+        AND_Count_of_OR (or_node);
+    }
+  for (and_node_id = 0; and_node_id < and_node_count; and_node_id++)
+    {
+      const AND and_node = and_nodes + and_node_id;
+      const OR parent_or = OR_of_AND (and_node);
+      const OR predecessor_or = Predecessor_OR_of_AND (and_node);
+      const OR cause_or = Cause_OR_of_AND (and_node);
+      const int cause_is_token = OR_is_Token (cause_or);
+      bocage_export->t_and_node_parent[and_node_id] = ID_of_OR (parent_or);
+      bocage_export->t_and_node_predecessor[and_node_id] =
+        predecessor_or ? ID_of_OR (predecessor_or) : -1;
+      bocage_export->t_and_node_cause[and_node_id] =
+        cause_is_token ? -1 : ID_of_OR (cause_or);
+      bocage_export->t_and_node_symbol[and_node_id] =
+        cause_is_token ? NSYID_of_OR (cause_or) : -1;
+      bocage_export->t_and_node_middle[and_node_id] =
+        predecessor_or ? YS_Ord_of_OR (predecessor_or)
+        : Origin_Ord_of_OR (parent_or);
+    }
+}
+
 @** Ordering (O, ORDER) code.
 @<Public incomplete structures@> =
 struct marpa_order;
@@ -11364,6 +16047,7 @@ It is non-null if and only if
 @d OBS_of_O(order) ((order)->t_ordering_obs)
 @d O_is_Default(order) (!OBS_of_O(order))
 @d O_is_Frozen(o) ((o)->t_is_frozen)
+@d O_is_Lazy(o) ((o)->t_is_lazy)
 @<Private structures@> =
 struct marpa_order {
     struct marpa_obstack* t_ordering_obs;
@@ -11372,11 +16056,13 @@ struct marpa_order {
     @<Int aligned order elements@>@;
     @<Bit aligned order elements@>@;
     BITFIELD t_is_frozen:1;
+    BITFIELD t_is_lazy:1;
 };
 @ @<Pre-initialize order elements@> =
 {
     o->t_and_node_orderings = NULL;
     o->t_is_frozen = 0;
+    o->t_is_lazy = 0;
     OBS_of_O(o) = NULL;
 }
 
@@ -11490,7 +16176,6 @@ the bocage is ambiguous,
 and that we are using the high rank order.
 @<Compute ambiguity metric of ordering by high rank@> =
 {
-    ANDID ** const and_node_orderings = o->t_and_node_orderings;
     const AND and_nodes = ANDs_of_B (b);
     ORID* top_of_stack;
     const ORID root_or_id = Top_ORID_of_B (b);
@@ -11508,7 +16193,7 @@ and that we are using the high rank order.
     {
       const ORID or_id = *top_of_stack;
       const OR or_node = OR_of_B_by_ID (b, or_id);
-      ANDID *ordering = and_node_orderings[or_id];
+      ANDID *ordering = and_node_ordering_of_or (o, or_id);
       int and_count = ordering ? ordering[0] : AND_Count_of_OR (or_node);
       if (and_count > 1)
         {
@@ -11820,6 +16505,105 @@ and code-size savings in exchange for the space.
     }
 }
 
+@*0 Lazy ranking.
+Applications often want only the first few parses in rank order.
+Ranking every or-node of the bocage, as |marpa_o_rank()| does,
+is wasted work when most of those or-nodes are never visited.
+|marpa_o_lazy_rank()| instead freezes the ordering at once,
+and ranks the and-nodes of each or-node
+the first time the ordering of that or-node is asked for.
+Since every ordering is computed with the same logic as in
+|marpa_o_rank()|, the parse trees come out in the same order,
+but the cost of ranking is only that of the or-nodes
+on the paths which the tree iterator actually follows.
+\par
+In a lazy ordering, |t_and_node_orderings| is indexed by or-node ID,
+and its entries are valid only when the or-node's bit
+in |t_or_node_is_ranked| is set,
+so that neither array needs to be initialized.
+@d OR_Node_is_Ranked_of_O(o) ((o)->t_or_node_is_ranked)
+@d Rank_by_ANDID_of_O(o) ((o)->t_rank_by_and_id)
+@<Widely aligned order elements@> =
+    Bit_Vector t_or_node_is_ranked;
+    int *t_rank_by_and_id;
+@ @<Pre-initialize order elements@> =
+{
+    OR_Node_is_Ranked_of_O(o) = NULL;
+    Rank_by_ANDID_of_O(o) = NULL;
+}
+
+@ All the memory for lazy ranking comes from the ordering's
+obstack, so it is freed with the ordering.
+The array of and-node ranks is allocated, but not filled,
+for the whole bocage,
+for the reasons given for |marpa_o_rank()|.
+@<Function definitions@> =
+int marpa_o_lazy_rank( Marpa_Order o)
+{
+  struct marpa_obstack *obs;
+  @<Return |-2| on failure@>@;
+  @<Unpack order objects@>@;
+  @<Fail if fatal error@>@;
+  if (O_is_Frozen (o))
+    {
+      MARPA_ERROR (MARPA_ERR_ORDER_FROZEN);
+      return failure_indicator;
+    }
+  obs = OBS_of_O (o) = marpa_obs_init;
+  o->t_and_node_orderings = marpa_obs_new (obs, ANDID*, OR_Count_of_B (b));
+  OR_Node_is_Ranked_of_O(o) = bv_obs_create (obs, OR_Count_of_B (b));
+  if (!High_Rank_Count_of_O (o))
+    Rank_by_ANDID_of_O(o) = marpa_obs_new (obs, int, AND_Count_of_B (b));
+  O_is_Lazy(o) = 1;
+  O_is_Frozen(o) = 1;
+  return 1;
+}
+
+@ Return the ordering of the and-nodes of an or-node,
+or |NULL| if the and-nodes are in their default order.
+The caller must ensure that the order is not the default.
+@<Function definitions@> =
+PRIVATE ANDID* and_node_ordering_of_or(ORDER o, ORID or_node_id)
+{
+  if (O_is_Lazy (o)
+      && !bv_bit_test_then_set (OR_Node_is_Ranked_of_O (o), or_node_id))
+    or_node_rank (o, or_node_id);
+  return o->t_and_node_orderings[or_node_id];
+}
+
+@ Rank the and-nodes of one or-node, for a lazy ordering.
+Only the ranks of the and-nodes of this or-node are
+put into the array of ranks.
+@<Function definitions@> =
+PRIVATE void or_node_rank(ORDER o, ORID or_node_id)
+{
+  @<Unpack order objects@>@;
+  struct marpa_obstack *const obs = OBS_of_O (o);
+  ANDID **const and_node_orderings = o->t_and_node_orderings;
+  const AND and_nodes = ANDs_of_B (b);
+  const OR work_or_node = OR_of_B_by_ID (b, or_node_id);
+  const ANDID and_count_of_or = AND_Count_of_OR (work_or_node);
+  int bocage_was_reordered @,@, UNUSED = 0;
+  and_node_orderings[or_node_id] = NULL;
+  if (High_Rank_Count_of_O (o)) {
+    @<Sort |work_or_node| for "high rank only"@>@;
+  } else {
+    int *const rank_by_and_id = Rank_by_ANDID_of_O (o);
+    const ANDID first_ranked_and_id = First_ANDID_of_OR (work_or_node);
+    ANDID and_node_id;
+    for (and_node_id = first_ranked_and_id;
+         and_node_id < first_ranked_and_id + and_count_of_or;
+         and_node_id++)
+      {
+        const AND and_node = and_nodes + and_node_id;
+        int and_node_rank;
+        @<Set |and_node_rank| from |and_node|@>@;
+        rank_by_and_id[and_node_id] = and_node_rank;
+      }
+    @<Sort |work_or_node| for "rank by rule"@>@;
+  }
+}
+
 @
 Check that |ix| is the index of a valid and-node
 in |or_node|.
@@ -11829,9 +16613,7 @@ PRIVATE ANDID and_order_ix_is_valid(ORDER o, OR or_node, int ix)
   if (ix >= AND_Count_of_OR (or_node)) return 0;
   if (!O_is_Default(o))
     {
-      ANDID ** const and_node_orderings = o->t_and_node_orderings;
-      ORID or_node_id = ID_of_OR(or_node);
-      ANDID *ordering = and_node_orderings[or_node_id];
+      ANDID *ordering = and_node_ordering_of_or (o, ID_of_OR (or_node));
       if (ordering)
         {
           int length = ordering[0];
@@ -11849,9 +16631,7 @@ PRIVATE ANDID and_order_get(ORDER o, OR or_node, int ix)
 {
   if (!O_is_Default(o))
     {
-      ANDID ** const and_node_orderings = o->t_and_node_orderings;
-      ORID or_node_id = ID_of_OR (or_node);
-      ANDID *ordering = and_node_orderings[or_node_id];
+      ANDID *ordering = and_node_ordering_of_or (o, ID_of_OR (or_node));
       if (ordering)
         return ordering[1 + ix];
     }
@@ -13220,6 +18000,44 @@ PRIVATE unsigned int bv_bits_to_unused_mask(int bits)
     return(mask);
 }
 
+@*0 Word operations.
+Counting the bits in a word,
+and finding the lowest bit set in a word,
+are done with the compiler's builtins, where it has them.
+The compiler turns these into single instructions,
+when the target processor has them.
+Elsewhere, they fall back to loops,
+which are no slower than the bit-at-a-time code they replace.
+|bv_word_lowest| must not be called with a zero word.
+@<Function definitions@> =
+PRIVATE int bv_word_count(LBW word)
+{
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return __builtin_popcount (word);
+#else
+  int count = 0;
+  while (word) {
+      word &= word - 1u;
+      count++;
+  }
+  return count;
+#endif
+}
+
+PRIVATE unsigned int bv_word_lowest(LBW word)
+{
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return (unsigned int) __builtin_ctz (word);
+#else
+  unsigned int bit = 0;
+  while (!(word & bv_lsb)) {
+      word >>= 1;
+      bit++;
+  }
+  return bit;
+#endif
+}
+
 @*0 Create a boolean vector.
 @ Always start with an all-zero vector.
 Note this code is a bit tricky ---
@@ -13471,7 +18289,11 @@ int bv_scan(Bit_Vector bv, int raw_start, int* raw_min, int* raw_max)
     min = start;
     max = start;
     offset = start / bv_wordbits;
-    *(bv+size-1) &= mask;
+    @t}\comment{@>
+    /* Write only if needed, so that the
+      vectors of a shared grammar can be scanned */
+    if (*(bv+size-1) & ~mask)
+      *(bv+size-1) &= mask;
     bv += offset;
     size -= offset;
     bitmask = (LBW)1 << (start & bv_modmask);
@@ -13494,14 +18316,10 @@ int bv_scan(Bit_Vector bv, int raw_start, int* raw_min, int* raw_max)
               return 0;
             }
         }
-        start = offset * bv_wordbits;
-        bitmask = bv_lsb;
-        mask = value;
-        while (!(mask & bv_lsb))
         {
-            bitmask <<= 1;
-            mask >>= 1;
-            start++;
+          const unsigned int lowest = bv_word_lowest (value);
+          start = offset * bv_wordbits + lowest;
+          bitmask = bv_lsb << lowest;
         }
         mask = ~ (bitmask | (bitmask - 1));
         min = start;
@@ -13519,12 +18337,7 @@ int bv_scan(Bit_Vector bv, int raw_start, int* raw_min, int* raw_max)
         }
         if (empty) value = bv_lsb;
     }
-    start = offset * bv_wordbits;
-    while (! (value & bv_lsb))
-    {
-        value >>= 1;
-        start++;
-    }
+    start = offset * bv_wordbits + bv_word_lowest (value);
     max = --start;
     *raw_min = (int)min;
     *raw_max = (int)max;
@@ -13532,17 +18345,81 @@ int bv_scan(Bit_Vector bv, int raw_start, int* raw_min, int* raw_max)
 }
 
 @*0 Count the bits in a boolean vector.
+The count is taken a word at a time.
+The trailing bits are masked, but not written,
+so that the vectors of a shared grammar can be counted.
 @<Function definitions@>=
 PRIVATE int
 bv_count (Bit_Vector v)
 {
-  int start, min, max;
+  LBW size = BV_SIZE (v);
+  const LBW mask = BV_MASK (v);
   int count = 0;
-  for (start = 0; bv_scan (v, start, &min, &max); start = max + 2)
+  if (size == 0)
+    return 0;
+  while (--size > 0)
+    count += bv_word_count (*v++);
+  return count + bv_word_count (*v & mask);
+}
+
+@*0 Dirty-word boolean vectors.
+Some boolean vectors are cleared at every earleme,
+but have only a few bits set between clears.
+For these, a dirty-word vector keeps a second boolean vector,
+with one bit for each word of the first,
+which is set when that word is written.
+Clearing it zeroes only the words written since the last clear.
+Only the operations in this section keep the second vector current,
+so the bits must not be set by other means.
+@s DBV int
+@<Private structures@> =
+struct s_dirty_bv {
+     Bit_Vector t_bv;
+     Bit_Vector t_dirty_words;
+};
+typedef struct s_dirty_bv* DBV;
+
+@ The dirty-word vector is created zeroed.
+@<Function definitions@> =
+PRIVATE void
+dbv_obs_init (struct marpa_obstack *obs, DBV dbv, int bits)
+{
+  dbv->t_bv = bv_obs_create (obs, bits);
+  dbv->t_dirty_words = bv_obs_create (obs, (int) BV_SIZE (dbv->t_bv));
+}
+
+PRIVATE int
+dbv_bit_test (DBV dbv, int bit)
+{
+  return bv_bit_test (dbv->t_bv, bit);
+}
+
+PRIVATE int
+dbv_bit_test_then_set (DBV dbv, int bit)
+{
+  if (bv_bit_test_then_set (dbv->t_bv, bit))
+    return 1;
+  bv_bit_set (dbv->t_dirty_words, (int) ((LBW) bit / bv_wordbits));
+  return 0;
+}
+
+PRIVATE void
+dbv_clear (DBV dbv)
+{
+  const Bit_Vector bv = dbv->t_bv;
+  Bit_Vector dirty_words = dbv->t_dirty_words;
+  LBW size = BV_SIZE (dirty_words);
+  LBW offset;
+  for (offset = 0; offset < size; offset++)
     {
-      count += max - min + 1;
+      LBW dirty = dirty_words[offset];
+      while (dirty)
+        {
+          bv[offset * bv_wordbits + bv_word_lowest (dirty)] = 0u;
+          dirty &= dirty - 1u;
+        }
+      dirty_words[offset] = 0u;
     }
-    return count;
 }
 
 @*0 The RHS closure of a vector.
@@ -13848,28 +18725,173 @@ and produces a matrix that represents the transitive closure
 of the relation.
 The matrix is assumed to be square.
 The input matrix will be destroyed.
-
-Its uses Warshall's algorithm,
-which is
-$O(n^3)$ where the matrix is $n$x$n$.
+\par
+Warshall's algorithm, which was used here originally,
+is $O(n^3)$ where the matrix is $n$x$n$,
+even if the relation is sparse, as the relations
+in grammars almost always are.
+With tens of thousands of symbols, it dominated
+the precomputation.
+\par
+Instead, the strongly connected components (SCC's) are found
+with Tarjan's algorithm.
+Every member of an SCC has the same closure,
+so each SCC's closure is found only once,
+as soon as the SCC is complete,
+following Nuutila.
+At that point, the closure of every SCC reachable from it
+is already complete,
+so that the closure of the SCC is simply
+the union of its successors and of their closures.
+The unions are of whole rows, a word at a time.
+A successor whose bit is already in the closure can be skipped,
+because then its closure is already in the union.
+\par
+The depth-first search is iterative,
+so that its depth is not limited by the C stack.
+Each row is left unchanged until its SCC is complete,
+which is after the search is finished with it.
 @<Function definitions@> =
 PRIVATE_NOT_INLINE void transitive_closure(Bit_Matrix matrix)
 {
-  int size = matrix_columns (matrix);
-  int outer_row;
-  for (outer_row = 0; outer_row < size; outer_row++)
+  const int size = matrix_columns (matrix);
+  int *dfs_index;
+  int *low_link;
+  int *scc_of;
+  int *next_column;
+  int *dfs_stack;
+  int *scc_stack;
+  Bit_Vector scc_closure;
+  int dfs_top = 0;
+  int scc_top = 0;
+  int next_dfs_index = 0;
+  int root;
+  if (size <= 0)
+    return;
+  dfs_index = marpa_new (int, size);
+  low_link = marpa_new (int, size);
+  scc_of = marpa_new (int, size);
+  next_column = marpa_new (int, size);
+  dfs_stack = marpa_new (int, size);
+  scc_stack = marpa_new (int, size);
+  scc_closure = bv_create (size);
+  for (root = 0; root < size; root++)
+    {
+      dfs_index[root] = -1;
+      scc_of[root] = -1;
+    }
+  for (root = 0; root < size; root++)
     {
-      Bit_Vector outer_row_v = matrix_row (matrix, outer_row);
-      int column;
-      for (column = 0; column < size; column++)
+      if (dfs_index[root] >= 0)
+        continue;
+      @<Visit |root| in the transitive closure search@>@;
+      while (dfs_top > 0)
+        {
+          const int vertex = dfs_stack[dfs_top - 1];
+          int min, max;
+          if (bv_scan
+              (matrix_row (matrix, vertex), next_column[vertex], &min, &max))
+            {
+              next_column[vertex] = min + 1;
+              if (dfs_index[min] < 0)
+                {
+                  @<Visit |min| in the transitive closure search@>@;
+                }
+              else if (scc_of[min] < 0)
+                {
+                  low_link[vertex] = MIN (low_link[vertex], dfs_index[min]);
+                }
+              continue;
+            }
+          dfs_top--;
+          if (dfs_top > 0)
+            {
+              const int parent = dfs_stack[dfs_top - 1];
+              low_link[parent] = MIN (low_link[parent], low_link[vertex]);
+            }
+          if (low_link[vertex] == dfs_index[vertex])
+            {
+              @<Find the closure of the SCC of |vertex|@>@;
+            }
+        }
+    }
+  bv_free (scc_closure);
+  my_free (scc_stack);
+  my_free (dfs_stack);
+  my_free (next_column);
+  my_free (scc_of);
+  my_free (low_link);
+  my_free (dfs_index);
+}
+
+@ @<Visit |root| in the transitive closure search@> =
+{
+  dfs_index[root] = low_link[root] = next_dfs_index++;
+  next_column[root] = 0;
+  dfs_stack[dfs_top++] = root;
+  scc_stack[scc_top++] = root;
+}
+@ @<Visit |min| in the transitive closure search@> =
+{
+  dfs_index[min] = low_link[min] = next_dfs_index++;
+  next_column[min] = 0;
+  dfs_stack[dfs_top++] = min;
+  scc_stack[scc_top++] = min;
+}
+
+@ |vertex| is the root of its SCC,
+and the SCC's members are at the top of the SCC stack,
+down to and including |vertex|.
+The members are marked first,
+so that the edges within the SCC can be recognized.
+If there are any,
+every member reaches every other member, and itself.
+@<Find the closure of the SCC of |vertex|@> =
+{
+  int scc_base = scc_top - 1;
+  int member_ix;
+  int is_cyclic = 0;
+  while (scc_stack[scc_base] != vertex)
+    scc_base--;
+  for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+    {
+      scc_of[scc_stack[member_ix]] = vertex;
+    }
+  bv_clear (scc_closure);
+  for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+    {
+      const Bit_Vector member_row = matrix_row (matrix, scc_stack[member_ix]);
+      int start, min, max;
+      for (start = 0; bv_scan (member_row, start, &min, &max);
+           start = max + 2)
         {
-          Bit_Vector inner_row_v = matrix_row (matrix, column);
-          if (bv_bit_test (inner_row_v, outer_row))
+          int successor;
+          for (successor = min; successor <= max; successor++)
             {
-              bv_or_assign (inner_row_v, outer_row_v);
+              if (scc_of[successor] == vertex)
+                {
+                  is_cyclic = 1;
+                  continue;
+                }
+              if (bv_bit_test (scc_closure, successor))
+                continue;
+              bv_bit_set (scc_closure, successor);
+              bv_or_assign (scc_closure, matrix_row (matrix, successor));
             }
         }
     }
+  if (is_cyclic)
+    {
+      for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+        {
+          bv_bit_set (scc_closure, scc_stack[member_ix]);
+        }
+    }
+  for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+    {
+      bv_copy (matrix_row (matrix, scc_stack[member_ix]), scc_closure);
+    }
+  scc_top = scc_base;
 }
 
 @** Efficient stacks and queues.
@@ -13964,21 +18986,37 @@ of memory which is both random-access
 and content-addressable.
 Content-addressability saves space -- when the
 contents are identical they can be reused.
-The content-addressability is implemented in software
-(as an AVL).
-While lookup is not slow
-the intention is that the content-addressability will used
+The content-addressability is implemented in software,
+as a hash table with open addressing.
+Lookup is fast,
+but the intention is still that the content-addressability will used
 infrequently --
 once created or found the CIL will be memoized
 for random-access through a pointer.
-
-@ An obstack for the actual data, and a tree
+\par
+A CILAR may be an overlay on a base CILAR,
+which it treats as read-only.
+A CIL is looked for first in the base,
+and only added to the overlay if it is not there.
+This allows recognizers of a shared grammar
+to intern CIL's without writing to the grammar's CILAR,
+and without locks.
+
+@ An obstack for the actual data, and a hash table
 for the lookups.
+The table holds pointers to the CIL's,
+and |NULL| for an empty slot.
+Its capacity is a power of two,
+and it is kept at most three-quarters full.
+@d CILAR_INITIAL_CAPACITY 64
 @<Private utility structures@> =
 struct s_cil_arena {
     struct marpa_obstack* t_obs;
-    MARPA_AVL_TREE t_avl;
+    CIL* t_table;
+    struct s_cil_arena* t_base;
     MARPA_DSTACK_DECLARE(t_buffer);
+    int t_capacity;
+    int t_count;
 };
 typedef struct s_cil_arena CILAR_Object;
 
@@ -13998,10 +19036,24 @@ PRIVATE void
 cilar_init (const CILAR cilar)
 {
   cilar->t_obs = marpa_obs_init;
-  cilar->t_avl = _marpa_avl_create (cil_cmp, NULL);
+  cilar->t_base = NULL;
+  cilar->t_capacity = CILAR_INITIAL_CAPACITY;
+  cilar->t_count = 0;
+  cilar->t_table =
+    my_malloc0 (sizeof (CIL) * (size_t) CILAR_INITIAL_CAPACITY);
   MARPA_DSTACK_INIT(cilar->t_buffer, int, 2);
   *MARPA_DSTACK_INDEX(cilar->t_buffer, int, 0) = 0;
 }
+
+@ Initialize |cilar| as an overlay on |base|.
+|base| must not change while the overlay is in use.
+@<Function definitions@> =
+PRIVATE void
+cilar_overlay_init (const CILAR cilar, const CILAR base)
+{
+  cilar_init (cilar);
+  cilar->t_base = base;
+}
 @
 {\bf To Do}: @^To Do@> The initial capacity of the CILAR dstack
 is absurdly small, in order to test the logic during development.
@@ -14019,7 +19071,7 @@ cilar_buffer_reinit (const CILAR cilar)
 @ @<Function definitions@> =
 PRIVATE void cilar_destroy(const CILAR cilar)
 {
-  _marpa_avl_destroy (cilar->t_avl );
+  my_free (cilar->t_table);
   marpa_obs_free(cilar->t_obs);
   MARPA_DSTACK_DESTROY((cilar->t_buffer));
 }
@@ -14045,6 +19097,78 @@ PRIVATE CIL cil_singleton(CILAR cilar, int element)
   return cil_buffer_add (cilar);
 }
 
+@ The hash of a CIL, count included.
+It is FNV-1a, taken an |int| at a time,
+with a final shift to bring the high bits
+into the low bits used as the table index.
+@<Function definitions@> =
+PRIVATE unsigned int
+cil_hash (CIL cil)
+{
+  int ix;
+  const int int_count = Count_of_CIL (cil) + 1;
+  unsigned int hash = 2166136261u;
+  for (ix = 0; ix < int_count; ix++)
+    {
+      hash ^= (unsigned int) cil[ix];
+      hash *= 16777619u;
+    }
+  return hash ^ (hash >> 16);
+}
+
+@ @<Function definitions@> =
+PRIVATE int
+cil_is_equal (CIL cil1, CIL cil2)
+{
+  int ix;
+  const int int_count = Count_of_CIL (cil1) + 1;
+  for (ix = 0; ix < int_count; ix++)
+    {
+      if (cil1[ix] != cil2[ix])
+        return 0;
+    }
+  return 1;
+}
+
+@ Find the slot for |cil| in |cilar|'s own table:
+either the slot holding an equal CIL,
+or the empty slot where it belongs.
+This only reads the CILAR.
+@<Function definitions@> =
+PRIVATE CIL*
+cilar_slot (CILAR cilar, CIL cil, unsigned int hash)
+{
+  const unsigned int mask = (unsigned int) cilar->t_capacity - 1;
+  unsigned int table_ix = hash & mask;
+  for (;;)
+    {
+      CIL *const slot = cilar->t_table + table_ix;
+      if (!*slot || cil_is_equal (*slot, cil))
+        return slot;
+      table_ix = (table_ix + 1) & mask;
+    }
+}
+
+@ Double the capacity of the table,
+and re-insert the CIL's.
+@<Function definitions@> =
+PRIVATE void
+cilar_grow (CILAR cilar)
+{
+  int table_ix;
+  CIL *const old_table = cilar->t_table;
+  const int old_capacity = cilar->t_capacity;
+  cilar->t_capacity = old_capacity * 2;
+  cilar->t_table = my_malloc0 (sizeof (CIL) * (size_t) cilar->t_capacity);
+  for (table_ix = 0; table_ix < old_capacity; table_ix++)
+    {
+      const CIL cil = old_table[table_ix];
+      if (cil)
+        *cilar_slot (cilar, cil, cil_hash (cil)) = cil;
+    }
+  my_free (old_table);
+}
+
 @ Add the CIL in the buffer to the
 CILAR.
 This method
@@ -14056,7 +19180,17 @@ PRIVATE CIL cil_buffer_add(CILAR cilar)
 {
 
   CIL cil_in_buffer = MARPA_DSTACK_BASE (cilar->t_buffer, int);
-  CIL found_cil = _marpa_avl_find (cilar->t_avl, cil_in_buffer);
+  const unsigned int hash = cil_hash (cil_in_buffer);
+  CIL *slot;
+  CIL found_cil;
+  if (cilar->t_base)
+    {
+      found_cil = *cilar_slot (cilar->t_base, cil_in_buffer, hash);
+      if (found_cil)
+        return found_cil;
+    }
+  slot = cilar_slot (cilar, cil_in_buffer, hash);
+  found_cil = *slot;
   if (!found_cil)
     {
       int i;
@@ -14066,7 +19200,10 @@ PRIVATE CIL cil_buffer_add(CILAR cilar)
         {                       /* Assumes that the CIL's are |int*| */
           found_cil[i] = cil_in_buffer[i];
         }
-      _marpa_avl_insert (cilar->t_avl, found_cil);
+      *slot = found_cil;
+      cilar->t_count++;
+      if (cilar->t_count * 4 > cilar->t_capacity * 3)
+        cilar_grow (cilar);
     }
   return found_cil;
 }
@@ -14095,6 +19232,64 @@ PRIVATE CIL cil_bv_add(CILAR cilar, Bit_Vector bv)
   return cil_buffer_add (cilar);
 }
 
+@ Add a copy of |cil|, which need not be
+in any CILAR, to the CILAR.
+The CILAR buffer is used,
+so its current contents will be destroyed.
+@<Function definitions@> =
+PRIVATE CIL cil_add(CILAR cilar, CIL cil)
+{
+  const int cil_count = Count_of_CIL (cil);
+  CIL new_cil = cil_buffer_reserve (cilar, cil_count);
+  int cil_ix;
+  for (cil_ix = 0; cil_ix < cil_count; cil_ix++)
+    {
+      Item_of_CIL (new_cil, cil_ix) = Item_of_CIL (cil, cil_ix);
+    }
+  Count_of_CIL (new_cil) = cil_count;
+  return cil_buffer_add (cilar);
+}
+
+@ Add a CIL of the distinct |int|'s in |ints|,
+which may be in any order,
+and which are sorted in place.
+The CILAR buffer is used,
+so its current contents will be destroyed.
+@<Function definitions@> =
+PRIVATE CIL cil_ints_add(CILAR cilar, int* ints, int count)
+{
+  int ix;
+  qsort (ints, (size_t) count, sizeof (int), int_cmp);
+  cil_buffer_clear (cilar);
+  for (ix = 0; ix < count; ix++)
+    {
+      if (ix > 0 && ints[ix] == ints[ix - 1])
+        continue;
+      cil_buffer_push (cilar, ints[ix]);
+    }
+  return cil_buffer_add (cilar);
+}
+
+@ Returns 1 if |item| is in |cil|, 0 otherwise.
+@<Function definitions@> =
+PRIVATE int cil_is_member(CIL cil, int item)
+{
+  int lo = 0;
+  int hi = Count_of_CIL (cil) - 1;
+  while (hi >= lo)
+    {
+      const int trial = lo + (hi - lo) / 2;
+      const int trial_item = Item_of_CIL (cil, trial);
+      if (trial_item == item)
+        return 1;
+      if (trial_item < item)
+        lo = trial + 1;
+      else
+        hi = trial - 1;
+    }
+  return 0;
+}
+
 @ Clear the CILAR buffer.
 @<Function definitions@> =
 PRIVATE void cil_buffer_clear(CILAR cilar)
@@ -14143,7 +19338,6 @@ PRIVATE CIL cil_buffer_reserve(CILAR cilar, int element_count)
 }
 
 @ Merge two CIL's into a new one.
-Not used at this point.
 This method trades unneeded obstack block
 allocations for CPU speed.
 @<Function definitions@> =
@@ -14234,28 +19428,479 @@ PRIVATE CIL cil_merge_one(CILAR cilar, CIL cil, int new_element)
   return cil_buffer_add (cilar);
 }
 
-@ @<Function definitions@> =
-PRIVATE_NOT_INLINE int
-cil_cmp (const void *ap, const void *bp, void *param @,@, UNUSED)
+@** Sparse reachability (REACH) code.
+Boolean matrices are a fast representation of the
+relations used in the precomputation, but a square matrix
+grows with the square of the number of symbols or rules.
+With 50,000 NSY's, one matrix is over 300 megabytes,
+even though the relations of real grammars are extremely sparse.
+\par
+A |REACH| holds a relation and, once it is closed,
+the relation's transitive closure.
+The edges of the relation are accumulated in a stack.
+Each row of the closure is a sorted CIL.
+The rows are not in a CILAR, but
+the members of an SCC always have identical rows,
+and they share them.
+The rows are allocated on an obstack,
+so that there is nothing to free,
+once the |REACH| is closed.
+\par
+The closure of a small or dense relation
+is found in a boolean matrix,
+which is faster, and its rows are then converted to CIL's.
+Otherwise, the closure is found directly in sparse form,
+with the same algorithm as |transitive_closure()|,
+so that the memory needed grows with the size of the
+relation and of its closure, not with the square of the
+number of vertices.
+The result is the same either way.
+\par
+A |REACH| may also be given the closed rows of an earlier
+version of the relation, to be kept
+for the vertices which the changes cannot affect.
+@<Private incomplete structures@> =
+struct s_reach;
+@ @s REACH int
+@<Private typedefs@> =
+typedef struct s_reach* REACH;
+@ @<Private utility structures@> =
+struct s_reach {
+    struct marpa_obstack* t_obs;
+    MARPA_DSTACK_DECLARE(t_edges);
+    CIL* t_rows;
+    const CIL* t_kept_rows;
+    Bit_Vector t_is_changed;
+    int t_vertex_count;
+    int t_kept_vertex_count;
+    int t_entry_count;
+};
+typedef struct s_reach REACH_Object;
+
+@ The entry count is the number of
+pairs in the closure,
+and is only valid once the |REACH| is closed.
+@d Vertex_Count_of_REACH(reach) ((reach)->t_vertex_count)
+@d Entry_Count_of_REACH(reach) ((reach)->t_entry_count)
+@d Row_of_REACH(reach, vertex) ((reach)->t_rows[vertex])
+@<Function definitions@> =
+PRIVATE void
+reach_init (REACH reach, struct marpa_obstack *obs, int vertex_count)
+{
+  reach->t_obs = obs;
+  reach->t_vertex_count = vertex_count;
+  reach->t_entry_count = 0;
+  reach->t_rows = marpa_obs_new (obs, CIL, vertex_count);
+  reach->t_kept_rows = NULL;
+  reach->t_is_changed = NULL;
+  reach->t_kept_vertex_count = 0;
+  MARPA_DSTACK_INIT2 (reach->t_edges, int);
+}
+
+@ |kept_rows| are the closed rows of an earlier version
+of the relation,
+for the vertices below |kept_vertex_count|.
+The application of the |REACH| must add all the edges of the
+relation, as usual, and must also mark as changed
+every vertex whose edges are not
+the same as in the earlier version.
+The rows of the vertices which reach a changed
+vertex, or a vertex that was not in the earlier version,
+are found again.
+The other rows are kept.
+A vertex which reaches no change
+reaches only edges that are in both versions,
+so that its row is the same in both.
+The kept rows are not copied,
+and must live as long as the |REACH|.
+@<Function definitions@> =
+PRIVATE void
+reach_rows_keep (REACH reach, const CIL * kept_rows, int kept_vertex_count)
+{
+  reach->t_kept_rows = kept_rows;
+  reach->t_kept_vertex_count = kept_vertex_count;
+  reach->t_is_changed =
+    bv_obs_create (reach->t_obs, Vertex_Count_of_REACH (reach));
+}
+
+@ Marking a vertex as changed has no effect
+unless rows are kept.
+@<Function definitions@> =
+PRIVATE void
+reach_vertex_change (REACH reach, int vertex)
+{
+  if (reach->t_is_changed)
+    bv_bit_set (reach->t_is_changed, vertex);
+}
+
+@ Each edge is pushed as two |int|'s,
+its from-vertex and its to-vertex.
+@<Function definitions@> =
+PRIVATE void
+reach_edge_add (REACH reach, int from, int to)
+{
+  *MARPA_DSTACK_PUSH (reach->t_edges, int) = from;
+  *MARPA_DSTACK_PUSH (reach->t_edges, int) = to;
+}
+
+@ Test whether the closure has an edge from |from| to |to|.
+The rows are sorted, so this is a binary search.
+@<Function definitions@> =
+PRIVATE int
+reach_test (REACH reach, int from, int to)
+{
+  const CIL row = Row_of_REACH (reach, from);
+  int lo = 0;
+  int hi = Count_of_CIL (row) - 1;
+  while (lo <= hi)
+    {
+      const int mid = lo + (hi - lo) / 2;
+      const int item = Item_of_CIL (row, mid);
+      if (item == to)
+        return 1;
+      if (item < to)
+        lo = mid + 1;
+      else
+        hi = mid - 1;
+    }
+  return 0;
+}
+
+@ A boolean matrix is used if it is small,
+or if the relation is so dense that its closure
+probably is as well.
+A CIL takes an |int| for each element,
+so that a row is smaller as a CIL than as a bit vector
+only if fewer than one bit in |sizeof(int)*8| is set.
+@d REACH_DENSE_MAX_VERTICES 1024
+@<Function definitions@> =
+PRIVATE int
+reach_is_dense (int vertex_count, int edge_count)
+{
+  if (vertex_count <= REACH_DENSE_MAX_VERTICES)
+    return 1;
+  return (double) edge_count * (double) (sizeof (int) * 8) >=
+    (double) vertex_count * (double) vertex_count;
+}
+
+@ Copy the |int|'s in |buffer| to a new row on the obstack.
+@<Function definitions@> =
+PRIVATE CIL
+reach_row_new (REACH reach, const int *buffer, int count)
 {
   int ix;
-  CIL cil1 = (CIL) ap;
-  CIL cil2 = (CIL) bp;
-  int count1 = Count_of_CIL (cil1);
-  int count2 = Count_of_CIL (cil2);
-  if (count1 != count2)
+  const CIL row = marpa_obs_new (reach->t_obs, int, count + 1);
+  Count_of_CIL (row) = count;
+  for (ix = 0; ix < count; ix++)
+    {
+      Item_of_CIL (row, ix) = buffer[ix];
+    }
+  return row;
+}
+
+@ Replace the relation with its transitive closure.
+The edges are no longer needed, and are freed.
+The search for the rows which can be kept
+is done in sparse form.
+@<Function definitions@> =
+PRIVATE void
+reach_close (REACH reach)
+{
+  const int vertex_count = Vertex_Count_of_REACH (reach);
+  const int edge_count = MARPA_DSTACK_LENGTH (reach->t_edges) / 2;
+  const int *const edges = MARPA_DSTACK_BASE (reach->t_edges, int);
+  int *const row_buffer = marpa_new (int, vertex_count + 1);
+  if (!reach->t_kept_rows && reach_is_dense (vertex_count, edge_count))
+    {
+      @<Find the dense closure of |reach|@>@;
+    }
+  else
+    {
+      @<Find the sparse closure of |reach|@>@;
+    }
+  {
+    int vertex;
+    for (vertex = 0; vertex < vertex_count; vertex++)
+      {
+        Entry_Count_of_REACH (reach) +=
+          Count_of_CIL (Row_of_REACH (reach, vertex));
+      }
+  }
+  my_free (row_buffer);
+  MARPA_DSTACK_DESTROY (reach->t_edges);
+}
+
+@ @<Find the dense closure of |reach|@> =
+{
+  int edge_ix;
+  int vertex;
+  void *const matrix_buffer =
+    my_malloc (matrix_sizeof (vertex_count, vertex_count));
+  const Bit_Matrix matrix =
+    matrix_buffer_create (matrix_buffer, vertex_count, vertex_count);
+  for (edge_ix = 0; edge_ix < edge_count; edge_ix++)
+    {
+      matrix_bit_set (matrix, edges[2 * edge_ix], edges[2 * edge_ix + 1]);
+    }
+  transitive_closure (matrix);
+  for (vertex = 0; vertex < vertex_count; vertex++)
+    {
+      int start, min, max;
+      int count = 0;
+      for (start = 0; bv_scan (matrix_row (matrix, vertex), start, &min, &max);
+           start = max + 2)
+        {
+          int column;
+          for (column = min; column <= max; column++)
+            row_buffer[count++] = column;
+        }
+      Row_of_REACH (reach, vertex) = reach_row_new (reach, row_buffer, count);
+    }
+  my_free (matrix_buffer);
+}
+
+@ The edges are first sorted into per-vertex lists of successors,
+by counting.
+The successors of |vertex| are
+|successors[first_edge[vertex]]| up to, but not including,
+|successors[first_edge[vertex+1]]|.
+The search is that of |transitive_closure()|, which see.
+@<Find the sparse closure of |reach|@> =
+{
+  int *const first_edge = marpa_new (int, vertex_count + 1);
+  int *const successors = marpa_new (int, MAX (edge_count, 1));
+  int *const dfs_index = marpa_new (int, vertex_count);
+  int *const low_link = marpa_new (int, vertex_count);
+  int *const scc_of = marpa_new (int, vertex_count);
+  int *const next_edge = marpa_new (int, vertex_count);
+  int *const dfs_stack = marpa_new (int, vertex_count);
+  int *const scc_stack = marpa_new (int, vertex_count);
+  const Bit_Vector in_closure = bv_create (vertex_count);
+  int dfs_top = 0;
+  int scc_top = 0;
+  int next_dfs_index = 0;
+  int edge_ix;
+  int root;
+  for (root = 0; root <= vertex_count; root++)
+    first_edge[root] = 0;
+  for (edge_ix = 0; edge_ix < edge_count; edge_ix++)
+    first_edge[edges[2 * edge_ix] + 1]++;
+  for (root = 0; root < vertex_count; root++)
     {
-      return count1 > count2 ? 1 : -1;
+      first_edge[root + 1] += first_edge[root];
+      next_edge[root] = first_edge[root];
+      dfs_index[root] = -1;
+      scc_of[root] = -1;
     }
-  for (ix = 0; ix < count1; ix++)
+  for (edge_ix = 0; edge_ix < edge_count; edge_ix++)
     {
-      const int item1 = Item_of_CIL (cil1, ix);
-      const int item2 = Item_of_CIL (cil2, ix);
-      if (item1 == item2)
+      successors[next_edge[edges[2 * edge_ix]]++] = edges[2 * edge_ix + 1];
+    }
+  if (reach->t_kept_rows)
+    {
+      @<Keep the rows of the unchanged vertices of |reach|@>@;
+    }
+  for (root = 0; root < vertex_count; root++)
+    {
+      if (dfs_index[root] >= 0)
         continue;
-      return item1 > item2 ? 1 : -1;
+      @<Visit |root| in the sparse closure search@>@;
+      while (dfs_top > 0)
+        {
+          const int vertex = dfs_stack[dfs_top - 1];
+          if (next_edge[vertex] < first_edge[vertex + 1])
+            {
+              const int successor = successors[next_edge[vertex]++];
+              if (dfs_index[successor] < 0)
+                {
+                  @<Visit |successor| in the sparse closure search@>@;
+                }
+              else if (scc_of[successor] < 0)
+                {
+                  low_link[vertex] =
+                    MIN (low_link[vertex], dfs_index[successor]);
+                }
+              continue;
+            }
+          dfs_top--;
+          if (dfs_top > 0)
+            {
+              const int parent = dfs_stack[dfs_top - 1];
+              low_link[parent] = MIN (low_link[parent], low_link[vertex]);
+            }
+          if (low_link[vertex] == dfs_index[vertex])
+            {
+              @<Find the sparse closure of the SCC of |vertex|@>@;
+            }
+        }
     }
-  return 0;
+  bv_free (in_closure);
+  my_free (scc_stack);
+  my_free (dfs_stack);
+  my_free (next_edge);
+  my_free (scc_of);
+  my_free (low_link);
+  my_free (dfs_index);
+  my_free (successors);
+  my_free (first_edge);
+}
+
+@ A vertex must be found again if it is changed,
+if it is new,
+or if it has a successor which must be found again.
+These vertices are found by a search backwards
+from the changed and new vertices,
+using |dfs_stack| as its stack,
+and marking the vertices in the bit vector of changed vertices,
+which is not needed after this.
+The other vertices are given their kept rows,
+and are marked as visited, and as belonging to a closed SCC,
+so that the search for the closure treats them as it
+does the vertices of an SCC whose closure is already found.
+@<Keep the rows of the unchanged vertices of |reach|@> =
+{
+  int *const first_predecessor = marpa_new (int, vertex_count + 1);
+  int *const predecessors = marpa_new (int, MAX (edge_count, 1));
+  const Bit_Vector is_found_again = reach->t_is_changed;
+  const int kept_vertex_count = reach->t_kept_vertex_count;
+  int vertex;
+  for (vertex = 0; vertex <= vertex_count; vertex++)
+    first_predecessor[vertex] = 0;
+  for (edge_ix = 0; edge_ix < edge_count; edge_ix++)
+    first_predecessor[edges[2 * edge_ix + 1] + 1]++;
+  for (vertex = 0; vertex < vertex_count; vertex++)
+    {
+      first_predecessor[vertex + 1] += first_predecessor[vertex];
+      next_edge[vertex] = first_predecessor[vertex];
+    }
+  for (edge_ix = 0; edge_ix < edge_count; edge_ix++)
+    {
+      predecessors[next_edge[edges[2 * edge_ix + 1]]++] = edges[2 * edge_ix];
+    }
+  for (vertex = kept_vertex_count; vertex < vertex_count; vertex++)
+    bv_bit_set (is_found_again, vertex);
+  for (vertex = 0; vertex < vertex_count; vertex++)
+    {
+      if (bv_bit_test (is_found_again, vertex))
+        dfs_stack[dfs_top++] = vertex;
+    }
+  while (dfs_top > 0)
+    {
+      const int found_again = dfs_stack[--dfs_top];
+      for (edge_ix = first_predecessor[found_again];
+           edge_ix < first_predecessor[found_again + 1]; edge_ix++)
+        {
+          const int predecessor = predecessors[edge_ix];
+          if (!bv_bit_test_then_set (is_found_again, predecessor))
+            dfs_stack[dfs_top++] = predecessor;
+        }
+    }
+  for (vertex = 0; vertex < kept_vertex_count; vertex++)
+    {
+      if (bv_bit_test (is_found_again, vertex))
+        continue;
+      Row_of_REACH (reach, vertex) = reach->t_kept_rows[vertex];
+      dfs_index[vertex] = low_link[vertex] = 0;
+      scc_of[vertex] = vertex;
+    }
+  my_free (predecessors);
+  my_free (first_predecessor);
+}
+
+@ @<Visit |root| in the sparse closure search@> =
+{
+  dfs_index[root] = low_link[root] = next_dfs_index++;
+  next_edge[root] = first_edge[root];
+  dfs_stack[dfs_top++] = root;
+  scc_stack[scc_top++] = root;
+}
+@ @<Visit |successor| in the sparse closure search@> =
+{
+  dfs_index[successor] = low_link[successor] = next_dfs_index++;
+  next_edge[successor] = first_edge[successor];
+  dfs_stack[dfs_top++] = successor;
+  scc_stack[scc_top++] = successor;
+}
+
+@ The closure is collected in |row_buffer|,
+with |in_closure| used to avoid duplicates.
+No vertex outside the SCC can reach a member,
+so that the members are never in the closure of a successor.
+Once the closure is sorted, the bits in |in_closure| are cleared
+one by one, which takes time proportional to the size of the closure,
+rather than to the number of vertices.
+@<Find the sparse closure of the SCC of |vertex|@> =
+{
+  int scc_base = scc_top - 1;
+  int member_ix;
+  int item_ix;
+  int count = 0;
+  int is_cyclic = 0;
+  CIL scc_row;
+  while (scc_stack[scc_base] != vertex)
+    scc_base--;
+  for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+    {
+      scc_of[scc_stack[member_ix]] = vertex;
+    }
+  for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+    {
+      const int member = scc_stack[member_ix];
+      for (edge_ix = first_edge[member]; edge_ix < first_edge[member + 1];
+           edge_ix++)
+        {
+          const int successor = successors[edge_ix];
+          CIL successor_row;
+          int successor_count;
+          if (scc_of[successor] == vertex)
+            {
+              is_cyclic = 1;
+              continue;
+            }
+          if (bv_bit_test (in_closure, successor))
+            continue;
+          bv_bit_set (in_closure, successor);
+          row_buffer[count++] = successor;
+          successor_row = Row_of_REACH (reach, successor);
+          successor_count = Count_of_CIL (successor_row);
+          for (item_ix = 0; item_ix < successor_count; item_ix++)
+            {
+              const int item = Item_of_CIL (successor_row, item_ix);
+              if (bv_bit_test (in_closure, item))
+                continue;
+              bv_bit_set (in_closure, item);
+              row_buffer[count++] = item;
+            }
+        }
+    }
+  if (is_cyclic)
+    {
+      for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+        {
+          row_buffer[count++] = scc_stack[member_ix];
+        }
+    }
+  qsort (row_buffer, (size_t) count, sizeof (int), int_cmp);
+  for (item_ix = 0; item_ix < count; item_ix++)
+    {
+      bv_bit_clear (in_closure, row_buffer[item_ix]);
+    }
+  scc_row = reach_row_new (reach, row_buffer, count);
+  for (member_ix = scc_base; member_ix < scc_top; member_ix++)
+    {
+      Row_of_REACH (reach, scc_stack[member_ix]) = scc_row;
+    }
+  scc_top = scc_base;
+}
+
+@ Compare two |int|'s, for |qsort()|.
+@<Function definitions@> =
+PRIVATE_NOT_INLINE int
+int_cmp (const void *ap, const void *bp)
+{
+  const int a = *(const int *) ap;
+  const int b = *(const int *) bp;
+  return a < b ? -1 : a > b ? 1 : 0;
 }
 
 @** Per-Earley-set list (PSL) code.
@@ -14446,6 +20091,20 @@ PRIVATE void psar_reset(const PSAR psar)
     psar_dealloc(psar);
 }
 
+@ A PSAR clear nulls out the data in all of the PSL's,
+whether or not they are claimed.
+@<Function definitions@> =
+PRIVATE void psar_clear(const PSAR psar)
+{
+    PSL psl;
+    for (psl = psar->t_first_psl; psl; psl = psl->t_next) {
+        int i;
+        for (i = 0; i < psar->t_psl_length; i++) {
+            PSL_Datum(psl, i) = NULL;
+        }
+    }
+}
+
 @ A PSAR dealloc removes an owner's claim to the all of
 its PSLs,
 and puts them back on the free list.
@@ -14480,15 +20139,35 @@ PRIVATE void psl_claim(
 }
 
 
-@ @<Function definitions@> =
+@ A bocage worker finds its PSL's by the ordinal of their
+Earley set,
+in pages which are allocated when first needed.
+A worker may use only a few Earley sets' PSL's,
+and this keeps its memory small,
+however long the input.
+@d PSL_PAGE_BITS 10
+@d PSL_PAGE_SIZE (1 << PSL_PAGE_BITS)
+@d Or_PSL_Page_of_Worker(worker, ysid)
+  ((worker)->t_or_psl_pages[(ysid) >> PSL_PAGE_BITS])
+@d Or_PSL_of_Worker(worker, ysid)
+  (Or_PSL_Page_of_Worker((worker), (ysid))[(ysid) & (PSL_PAGE_SIZE - 1)])
+@<Function definitions@> =
 PRIVATE PSL psl_claim_by_es(
-    PSAR or_psar,
-    struct s_bocage_setup_per_ys* per_ys_data,
+    BOCAGE_WORKER worker,
     YSID ysid)
 {
-    PSL *psl_owner = &(per_ys_data[ysid].t_or_psl);
+    PSL *psl_owner;
+    if (!Or_PSL_Page_of_Worker (worker, ysid))
+      {
+        int psl_ix;
+        PSL *const page = Or_PSL_Page_of_Worker (worker, ysid) =
+          marpa_obs_new (worker->t_setup_obs, PSL, PSL_PAGE_SIZE);
+        for (psl_ix = 0; psl_ix < PSL_PAGE_SIZE; psl_ix++)
+          page[psl_ix] = NULL;
+      }
+    psl_owner = &Or_PSL_of_Worker (worker, ysid);
     if (!*psl_owner)
-      psl_claim (psl_owner, or_psar);
+      psl_claim (psl_owner, worker->t_or_psar);
     return *psl_owner;
 }
 
@@ -14719,11 +20398,27 @@ In this case space clearly is much more important than speed.
 PRIVATE_NOT_INLINE void
 set_error (GRAMMAR g, Marpa_Error_Code code, const char* message, unsigned int flags)
 {
+  if (G_is_Shared (g) && !(flags & FATAL_FLAG))
+    {
+      shared_error = code;
+      shared_error_string = message;
+      return;
+    }
   g->t_error = code;
   g->t_error_string = message;
   if (flags & FATAL_FLAG)
     g->t_is_ok = 0;
 }
+
+@ The errors of shared grammars are kept per thread,
+much as |errno| is.
+In a thread, the error code of a shared grammar is that
+of the last failure, in that thread, of a method for any
+shared grammar.
+Fatal errors are kept in the grammar.
+@<Thread-local variables@> =
+static MARPA_THREAD_LOCAL Marpa_Error_Code shared_error = MARPA_ERR_NONE;
+static MARPA_THREAD_LOCAL const char *shared_error_string = NULL;
 @ If this is called when Libmarpa is in a ``not OK'' state,
 it means very bad things are happening --
 possibly memory overwrites.
@@ -14744,6 +20439,12 @@ clear_error (GRAMMAR g)
         g->t_error = MARPA_ERR_I_AM_NOT_OK;
       return g->t_error;
     }
+  if (G_is_Shared (g))
+    {
+      shared_error = MARPA_ERR_NONE;
+      shared_error_string = NULL;
+      return MARPA_ERR_NONE;
+    }
   g->t_error = MARPA_ERR_NONE;
   g->t_error_string = NULL;
   return MARPA_ERR_NONE;
@@ -14850,6 +20551,7 @@ Marpa_Earleme marpa_r_earleme(Marpa_Recognizer r, Marpa_Earley_Set_ID set_id)
         return failure_indicator;
       }
     earley_set = YS_of_R_by_Ord (r, set_id);
+    @<Fail if |earley_set| was discarded@>@;
     return Earleme_of_YS (earley_set);
 }
 
@@ -14871,6 +20573,8 @@ int _marpa_r_earley_set_size(Marpa_Recognizer r, Marpa_Earley_Set_ID set_id)
         return failure_indicator;
       }
     earley_set = YS_of_R_by_Ord (r, set_id);
+    @<Fail if |earley_set| was discarded@>@;
+    earley_set_predictions_materialize (r, earley_set);
     return YIM_Count_of_YS (earley_set);
 }
 
@@ -14927,11 +20631,13 @@ _marpa_r_earley_set_trace (Marpa_Recognizer r, Marpa_Earley_Set_ID set_id)
         return failure_indicator;
     }
   r_update_earley_sets (r);
-    if (set_id >= MARPA_DSTACK_LENGTH (r->t_earley_set_stack))
+    if (set_id >= YS_Count_of_R (r))
       {
         return es_does_not_exist;
       }
+    @<Fail if |set_id| may refer to discarded Earley sets@>@;
     earley_set = YS_of_R_by_Ord (r, set_id);
+  earley_set_predictions_materialize (r, earley_set);
   r->t_trace_earley_set = earley_set;
   return Earleme_of_YS(earley_set);
 }
@@ -15784,8 +21490,7 @@ int _marpa_o_or_node_and_node_count(Marpa_Order o,
   @<Check |or_node_id|@>@;
   if (!O_is_Default(o))
   {
-    ANDID ** const and_node_orderings = o->t_and_node_orderings;
-    ANDID *ordering = and_node_orderings[or_node_id];
+    ANDID *ordering = and_node_ordering_of_or (o, or_node_id);
     if (ordering) return ordering[0];
   }
   {
@@ -15805,8 +21510,7 @@ int _marpa_o_or_node_and_node_id_by_ix(Marpa_Order o,
   @<Check |or_node_id|@>@;
   if (!O_is_Default(o))
   {
-      ANDID ** const and_node_orderings = o->t_and_node_orderings;
-      ANDID *ordering = and_node_orderings[or_node_id];
+      ANDID *ordering = and_node_ordering_of_or (o, or_node_id);
       if (ordering) return ordering[1 + ix];
   }
   {
@@ -16209,6 +21913,13 @@ So I add such a comment.
 #define MARPA_DEBUG 0
 #endif
 
+#ifndef MARPA_COMPACT_YIM
+#define MARPA_COMPACT_YIM 0
+#endif
+
+#include <string.h>
+#include <time.h>
+
 #include "marpa.h"
 #include "marpa_ami.h"
 @h
@@ -16221,14 +21932,17 @@ So I add such a comment.
 
 @ To preserve thread-safety,
 global variables are either constants,
+thread-local,
 or used strictly for debugging.
 @(marpa.c.p10@> =
 @<Global constant variables@>@;
+@<Thread-local variables@>@;
 
 @ @(marpa.c.p10@> =
 @<Recognizer structure@>@;
 @<Source object structure@>@;
 @<Earley item structure@>@;
+@<Earley item key accessors@>@;
 @<Bocage structure@>@;
 
 @ @(marpa.c.p50@> =
@@ -125,4 +125,40 @@ marpa__obs_free (struct marpa_obstack *h)
     }
 }
 
+/* Free every object allocated in H after MARK was made.
+   The chunk which was current when MARK was made must not
+   have been freed since.  */
+void
+marpa__obs_free_to_mark (struct marpa_obstack *h,
+  const struct marpa_obstack_mark *mark)
+{
+  struct marpa_obstack_chunk *lp;       /* below addr of any objects in this chunk */
+  struct marpa_obstack_chunk *plp;      /* point to previous chunk if any */
+
+  lp = h->chunk;
+  while (lp != mark->chunk)
+    {
+      plp = lp->header.prev;
+      my_free (lp);
+      lp = plp;
+    }
+  h->chunk = lp;
+  h->object_base = h->next_free = mark->next_free;
+}
+
+/* The total size of the chunks in H, including their headers
+   and any space not yet used.  */
+size_t
+marpa__obs_size (struct marpa_obstack *h)
+{
+  struct marpa_obstack_chunk *lp;
+  size_t size = 0;
+
+  if (!h)
+    return 0;
+  for (lp = h->chunk; lp != 0; lp = lp->header.prev)
+    size += lp->header.size;
+  return size;
+}
+
 /* vim: set expandtab shiftwidth=4: */
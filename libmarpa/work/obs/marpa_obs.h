@@ -85,12 +85,25 @@ struct marpa_obstack_chunk
   char contents[4];
 };
 
+/* A mark records the state of an idle obstack,
+   so that every object allocated after it can be freed at once. */
+struct marpa_obstack_mark
+{
+  struct marpa_obstack_chunk *chunk;
+  char *next_free;
+};
+
 extern void* marpa__obs_newchunk (struct marpa_obstack *, size_t, size_t);
 
 extern struct marpa_obstack* marpa__obs_begin (size_t);
 
 void marpa__obs_free (struct marpa_obstack *__obstack);
 
+size_t marpa__obs_size (struct marpa_obstack *__obstack);
+
+void marpa__obs_free_to_mark (struct marpa_obstack *__obstack,
+  const struct marpa_obstack_mark *mark);
+
 /* Pointer to beginning of object being allocated or to be allocated next.
    Note that this might not be the final address of the object
    because a new chunk might be needed to hold the final size.  */
@@ -108,6 +121,10 @@ void marpa__obs_free (struct marpa_obstack *__obstack);
 # define marpa_obs_reject(h) \
   ((h)->next_free = (h)->object_base)
 
+/* Mark the obstack, which must be idle */
+# define marpa_obs_mark(h, mark) \
+  ((mark)->chunk = (h)->chunk, (mark)->next_free = (h)->next_free)
+
 # define marpa_obstack_room(h)          \
  ((h)->chunk->header.size - ((h)->next_free - (char*)((h)->chunk)))
 
@@ -146,6 +146,14 @@ MARPA_ERR_INVALID_ASSERTION_ID
 MARPA_ERR_NO_SUCH_ASSERTION_ID
 MARPA_ERR_HEADERS_DO_NOT_MATCH
 MARPA_ERR_NOT_A_SEQUENCE
+MARPA_ERR_EARLEY_SET_DISCARDED
+MARPA_ERR_NO_SUCH_CHECKPOINT
+MARPA_ERR_BAD_GRAMMAR_IMAGE
+MARPA_ERR_NO_THREADS
+MARPA_ERR_INVALID_PRECOMPUTE_PHASE
+MARPA_ERR_NO_PREDICTION_STATES
+MARPA_ERR_PREDICTION_STATES_STREAMING
+MARPA_ERR_INVALID_WORKER_COUNT
 );
 
 my %error_number = map { $error_codes[$_], $_ } (0 .. $#error_codes);